@@ -0,0 +1,486 @@
+/** @file
+   Testy wydajnościowe operacji na wielomianach
+
+   Program uruchamia wybrany test (lub wszystkie, dla argumentu `all`)
+   i wypisuje na standardowe wyjście czas wykonania mierzonych operacji.
+
+   @author agent
+   @date 2026-10-19
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "poly.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define ALL_BENCHMARKS "all"
+#define GCD "gcd"
+#define MUL "mul"
+#define COMPOSE "compose"
+#define ADD_MONOS "add-monos"
+#define THROUGHPUT "throughput"
+
+/** Stan generatora liczb pseudolosowych testów. */
+static uint64_t bench_seed = 42;
+
+/**
+ * Losuje liczbę z przedziału `[0, range)`.
+ * @param[in] range : górna granica przedziału
+ * @return wylosowana liczba
+ */
+static unsigned BenchRandom(unsigned range)
+{
+    bench_seed = bench_seed * UINT64_C(6364136223846793005) + 1442695040888963407;
+    return (unsigned)(bench_seed >> 33) % range;
+}
+
+/**
+ * Zwraca czas w sekundach od ustalonej chwili.
+ * @return czas w sekundach
+ */
+static double BenchNow()
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Losuje wielomian o zadanej liczbie zmiennych.
+ * Każdy poziom zagnieżdżenia ma co najwyżej @p terms jednomianów.
+ * @param[in] vars    : liczba zmiennych
+ * @param[in] terms   : największa liczba jednomianów na poziomie
+ * @param[in] max_exp : największy wykładnik
+ * @param[in] range   : współczynniki są niezerowe, o wartości bezwzględnej
+ *                      nie większej niż @p range
+ * @return wylosowany wielomian
+ */
+static Poly RandomPoly(unsigned vars, unsigned terms, poly_exp_t max_exp,
+                       unsigned range)
+{
+    if (vars == 0)
+    {
+        poly_coeff_t value = 1 + BenchRandom(range);
+        return PolyFromCoeff(BenchRandom(2) == 0 ? value : -value);
+    }
+    unsigned count = 1 + BenchRandom(terms);
+    Mono *monos = calloc(count, sizeof(Mono));
+    for (unsigned i = 0; i < count; ++i)
+    {
+        Poly coeff = RandomPoly(vars - 1, terms, max_exp, range);
+        monos[i] = MonoFromPoly(&coeff, BenchRandom(max_exp + 1));
+    }
+    Poly out = PolyAddMonos(count, monos);
+    free(monos);
+    return out;
+}
+
+/**
+ * Mierzy czas wyznaczania NWD iloczynów losowych wielomianów z zasadzonym
+ * wspólnym czynnikiem.
+ * @param[in] vars    : liczba zmiennych
+ * @param[in] terms   : największa liczba jednomianów na poziomie
+ * @param[in] max_exp : największy wykładnik
+ * @return Czy wyznaczony NWD jest podzielny przez wspólny czynnik?
+ */
+static bool GcdBenchmark(unsigned vars, unsigned terms, poly_exp_t max_exp)
+{
+    Poly a = RandomPoly(vars, terms, max_exp, 9);
+    Poly b = RandomPoly(vars, terms, max_exp, 9);
+    Poly g = RandomPoly(vars, terms, max_exp, 9);
+    Poly p = PolyMul(&a, &g), q = PolyMul(&b, &g);
+    double start = BenchNow();
+    Poly gcd = PolyGcd(&p, &q);
+    double elapsed = BenchNow() - start;
+    Poly quot = PolyDivExact(&gcd, &g), check = PolyMul(&quot, &g);
+    bool ok = PolyIsEq(&check, &gcd);
+    printf("%s vars=%u terms=%u deg=%d: %.3f s (deg gcd %d)%s\n", GCD, vars,
+           terms, max_exp, elapsed, PolyDeg(&gcd), ok ? "" : " WRONG");
+    PolyDestroy(&a);
+    PolyDestroy(&b);
+    PolyDestroy(&g);
+    PolyDestroy(&p);
+    PolyDestroy(&q);
+    PolyDestroy(&gcd);
+    PolyDestroy(&quot);
+    PolyDestroy(&check);
+    return ok;
+}
+
+/**
+ * Uruchamia testy wydajnościowe NWD.
+ * @return Czy wszystkie wyniki są poprawne?
+ */
+static bool GcdBenchmarks()
+{
+    bool res = true;
+    res &= GcdBenchmark(1, 400, 1000);
+    res &= GcdBenchmark(2, 30, 30);
+    res &= GcdBenchmark(3, 8, 10);
+    res &= GcdBenchmark(4, 5, 5);
+    return res;
+}
+
+/**
+ * Mierzy czas mnożenia losowych wielomianów przy różnej liczbie wątków.
+ * @param[in] vars    : liczba zmiennych
+ * @param[in] terms   : największa liczba jednomianów na poziomie
+ * @param[in] max_exp : największy wykładnik
+ * @return Czy iloczyny wyznaczone wielowątkowo są równe iloczynowi
+ * wyznaczonemu przez jeden wątek?
+ */
+static bool MulBenchmark(unsigned vars, unsigned terms, poly_exp_t max_exp)
+{
+    static const unsigned thread_counts[] = {1, 2, 4, 8};
+    Poly p = RandomPoly(vars, terms, max_exp, 9);
+    Poly q = RandomPoly(vars, terms, max_exp, 9);
+    Poly serial = PolyZero();
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(thread_counts) / sizeof(unsigned); ++i)
+    {
+        PolySetThreadCount(thread_counts[i]);
+        double start = BenchNow();
+        Poly product = PolyMul(&p, &q);
+        double elapsed = BenchNow() - start;
+        bool equal = i == 0 || PolyIsEq(&product, &serial);
+        printf("%s vars=%u terms=%u deg=%d threads=%u: %.3f s%s\n", MUL, vars,
+               terms, max_exp, thread_counts[i], elapsed, equal ? "" : " WRONG");
+        ok &= equal;
+        if (i == 0)
+        {
+            serial = product;
+        }
+        else
+        {
+            PolyDestroy(&product);
+        }
+    }
+    PolySetThreadCount(1);
+    PolyDestroy(&p);
+    PolyDestroy(&q);
+    PolyDestroy(&serial);
+    return ok;
+}
+
+/**
+ * Uruchamia testy wydajnościowe mnożenia.
+ * @return Czy wszystkie wyniki są poprawne?
+ */
+static bool MulBenchmarks()
+{
+    bool res = true;
+    res &= MulBenchmark(1, 3000, 100000);
+    res &= MulBenchmark(2, 60, 200);
+    res &= MulBenchmark(3, 16, 20);
+    res &= MulBenchmark(4, 8, 6);
+    return res;
+}
+
+/**
+ * Mierzy czas składania losowego wielomianu z losowymi jednomianami przy
+ * różnej liczbie wątków.
+ * @param[in] vars    : liczba zmiennych
+ * @param[in] terms   : największa liczba jednomianów na poziomie
+ * @param[in] max_exp : największy wykładnik
+ * @return Czy złożenia wyznaczone wielowątkowo są równe złożeniu
+ * wyznaczonemu przez jeden wątek?
+ */
+static bool ComposeBenchmark(unsigned vars, unsigned terms, poly_exp_t max_exp)
+{
+    static const unsigned thread_counts[] = {1, 2, 4, 8};
+    Poly p = RandomPoly(vars, terms, max_exp, 9);
+    Poly x[vars];
+    for (unsigned i = 0; i < vars; ++i)
+    {
+        x[i] = RandomPoly(1 + i % 2, 1, 3, 1);
+    }
+    Poly serial = PolyZero();
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(thread_counts) / sizeof(unsigned); ++i)
+    {
+        PolySetThreadCount(thread_counts[i]);
+        double start = BenchNow();
+        Poly composed = PolyCompose(&p, vars, x);
+        double elapsed = BenchNow() - start;
+        bool equal = i == 0 || PolyIsEq(&composed, &serial);
+        printf("%s vars=%u terms=%u deg=%d threads=%u: %.3f s%s\n", COMPOSE,
+               vars, terms, max_exp, thread_counts[i], elapsed,
+               equal ? "" : " WRONG");
+        ok &= equal;
+        if (i == 0)
+        {
+            serial = composed;
+        }
+        else
+        {
+            PolyDestroy(&composed);
+        }
+    }
+    PolySetThreadCount(1);
+    PolyDestroy(&p);
+    for (unsigned i = 0; i < vars; ++i)
+    {
+        PolyDestroy(&x[i]);
+    }
+    PolyDestroy(&serial);
+    return ok;
+}
+
+/**
+ * Uruchamia testy wydajnościowe składania wielomianów.
+ * @return Czy wszystkie wyniki są poprawne?
+ */
+static bool ComposeBenchmarks()
+{
+    bool res = true;
+    res &= ComposeBenchmark(1, 3000, 100000);
+    res &= ComposeBenchmark(3, 25, 50);
+    return res;
+}
+
+/**
+ * Mierzy czas sumowania nieuporządkowanej tablicy jednomianów przy różnej
+ * liczbie wątków.
+ * @param[in] count   : liczba jednomianów
+ * @param[in] vars    : liczba zmiennych współczynników jednomianów
+ * @param[in] max_exp : największy wykładnik
+ * @return Czy sumy wyznaczone wielowątkowo są równe sumie wyznaczonej
+ * przez jeden wątek?
+ */
+static bool AddMonosBenchmark(unsigned count, unsigned vars, poly_exp_t max_exp)
+{
+    static const unsigned thread_counts[] = {1, 2, 4, 8};
+    Mono *monos = calloc(count, sizeof(Mono));
+    for (unsigned i = 0; i < count; ++i)
+    {
+        Poly coeff = RandomPoly(vars, 3, 3, 9);
+        monos[i] = MonoFromPoly(&coeff, BenchRandom(max_exp + 1));
+    }
+    Mono *copy = calloc(count, sizeof(Mono));
+    Poly serial = PolyZero();
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(thread_counts) / sizeof(unsigned); ++i)
+    {
+        for (unsigned j = 0; j < count; ++j)
+        {
+            copy[j] = MonoClone(&monos[j]);
+        }
+        PolySetThreadCount(thread_counts[i]);
+        double start = BenchNow();
+        Poly sum = PolyAddMonos(count, copy);
+        double elapsed = BenchNow() - start;
+        bool equal = i == 0 || PolyIsEq(&sum, &serial);
+        printf("%s count=%u vars=%u deg=%d threads=%u: %.3f s%s\n", ADD_MONOS,
+               count, vars, max_exp, thread_counts[i], elapsed,
+               equal ? "" : " WRONG");
+        ok &= equal;
+        if (i == 0)
+        {
+            serial = sum;
+        }
+        else
+        {
+            PolyDestroy(&sum);
+        }
+    }
+    PolySetThreadCount(1);
+    for (unsigned j = 0; j < count; ++j)
+    {
+        MonoDestroy(&monos[j]);
+    }
+    free(monos);
+    free(copy);
+    PolyDestroy(&serial);
+    return ok;
+}
+
+/**
+ * Uruchamia testy wydajnościowe sumowania jednomianów.
+ * @return Czy wszystkie wyniki są poprawne?
+ */
+static bool AddMonosBenchmarks()
+{
+    bool res = true;
+    res &= AddMonosBenchmark(1000000, 0, 1 << 30);
+    res &= AddMonosBenchmark(1000000, 0, 1000);
+    res &= AddMonosBenchmark(200000, 2, 1000);
+    return res;
+}
+
+/** Liczba operacji wykonywanych przez każdy wątek testu przepustowości. */
+#define THROUGHPUT_ROUNDS 200
+
+/**
+ * Praca jednego wątku testu przepustowości.
+ */
+typedef struct ThroughputJob
+{
+    Poly p; ///< pierwszy argument operacji
+    Poly q; ///< drugi argument operacji
+    poly_hash_t checksum; ///< suma skrótów wyników
+} ThroughputJob;
+
+/**
+ * Wielokrotnie mnoży i dodaje wielomiany wątku, niezależnie od pozostałych
+ * wątków.
+ * @param[in, out] arg : praca wątku (ThroughputJob)
+ * @return NULL
+ */
+static void* ThroughputWorker(void *arg)
+{
+    ThroughputJob *job = arg;
+    job->checksum = 0;
+    for (unsigned i = 0; i < THROUGHPUT_ROUNDS; ++i)
+    {
+        Poly product = PolyMul(&job->p, &job->q);
+        Poly sum = PolyAdd(&product, &job->p);
+        job->checksum += PolyHash(&sum);
+        PolyDestroy(&product);
+        PolyDestroy(&sum);
+    }
+    PolyReleaseThreadCache();
+    return NULL;
+}
+
+/**
+ * Mierzy przepustowość niezależnych operacji PolyMul i PolyAdd wykonywanych
+ * równocześnie przez rosnącą liczbę wątków (aż do liczby procesorów).
+ * Każdy wątek działa na własnych kopiach tych samych wielomianów, więc przy
+ * braku rywalizacji o zasoby czas powinien pozostawać stały.
+ * @param[in] vars    : liczba zmiennych
+ * @param[in] terms   : największa liczba jednomianów na poziomie
+ * @param[in] max_exp : największy wykładnik
+ * @return Czy wszystkie wątki otrzymały te same wyniki?
+ */
+static bool ThroughputBenchmark(unsigned vars, unsigned terms,
+                                poly_exp_t max_exp)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned max_threads = cpus > 1 ? (unsigned)cpus : 1;
+    Poly p = RandomPoly(vars, terms, max_exp, 9);
+    Poly q = RandomPoly(vars, terms, max_exp, 9);
+    ThroughputJob *jobs = calloc(max_threads, sizeof(ThroughputJob));
+    pthread_t *threads = calloc(max_threads, sizeof(pthread_t));
+    bool ok = true;
+    double single = 0;
+    for (unsigned count = 1; count <= max_threads; count *= 2)
+    {
+        for (unsigned i = 0; i < count; ++i)
+        {
+            jobs[i].p = PolyClone(&p);
+            jobs[i].q = PolyClone(&q);
+        }
+        double start = BenchNow();
+        for (unsigned i = 0; i < count; ++i)
+        {
+            pthread_create(&threads[i], NULL, ThroughputWorker, &jobs[i]);
+        }
+        for (unsigned i = 0; i < count; ++i)
+        {
+            pthread_join(threads[i], NULL);
+        }
+        double elapsed = BenchNow() - start;
+        if (count == 1)
+        {
+            single = elapsed;
+        }
+        bool equal = true;
+        for (unsigned i = 0; i < count; ++i)
+        {
+            equal &= jobs[i].checksum == jobs[0].checksum;
+            PolyDestroy(&jobs[i].p);
+            PolyDestroy(&jobs[i].q);
+        }
+        printf("%s vars=%u terms=%u deg=%d threads=%u: %.3f s, %.0f ops/s, "
+               "speedup %.2f%s\n", THROUGHPUT, vars, terms, max_exp, count,
+               elapsed, 2.0 * THROUGHPUT_ROUNDS * count / elapsed,
+               single * count / elapsed, equal ? "" : " WRONG");
+        ok &= equal;
+        if (count < max_threads && 2 * count > max_threads)
+        {
+            count = max_threads / 2;
+        }
+    }
+    PolyDestroy(&p);
+    PolyDestroy(&q);
+    free(jobs);
+    free(threads);
+    return ok;
+}
+
+/**
+ * Uruchamia testy przepustowości.
+ * @return Czy wszystkie wyniki są poprawne?
+ */
+static bool ThroughputBenchmarks()
+{
+    bool res = true;
+    res &= ThroughputBenchmark(1, 60, 200);
+    res &= ThroughputBenchmark(3, 5, 5);
+    return res;
+}
+
+/**
+ * Wypisuje sposób użycia programu.
+ * @param[in] program_name : nazwa programu
+ */
+static void PrintHelp(const char *program_name)
+{
+    printf("Usage: %s [%s|%s|%s|%s|%s|%s]\n", program_name, ALL_BENCHMARKS,
+           GCD, MUL, COMPOSE, ADD_MONOS, THROUGHPUT);
+}
+
+/**
+ * Uruchamia wybrane testy wydajnościowe.
+ * @param[in] argc : liczba argumentów
+ * @param[in] argv : argumenty
+ * @return 0, gdy wyniki wszystkich testów są poprawne
+ */
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        PrintHelp(argv[0]);
+        return -1;
+    }
+    bool all = strcmp(argv[1], ALL_BENCHMARKS) == 0;
+    bool res = true;
+    bool known = all;
+    if (all || strcmp(argv[1], GCD) == 0)
+    {
+        res &= GcdBenchmarks();
+        known = true;
+    }
+    if (all || strcmp(argv[1], MUL) == 0)
+    {
+        res &= MulBenchmarks();
+        known = true;
+    }
+    if (all || strcmp(argv[1], COMPOSE) == 0)
+    {
+        res &= ComposeBenchmarks();
+        known = true;
+    }
+    if (all || strcmp(argv[1], ADD_MONOS) == 0)
+    {
+        res &= AddMonosBenchmarks();
+        known = true;
+    }
+    if (all || strcmp(argv[1], THROUGHPUT) == 0)
+    {
+        res &= ThroughputBenchmarks();
+        known = true;
+    }
+    if (!known)
+    {
+        PrintHelp(argv[0]);
+        return -1;
+    }
+    PolyReleaseThreadCache();
+    return !res;
+}
@@ -6,39 +6,203 @@
    @date 2017-05-27
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
+#include <ctype.h>
 #include <limits.h>
 #include <string.h>
 #include <assert.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+#include "chunk_queue.h"
+#include "memo_cache.h"
 #include "poly.h"
+#include "printer.h"
+#include "reader.h"
 #include "stack.h"
+#include "thread_pool.h"
 #include "utils.h"
 
 
-/** Ostatni wczytany ze standardowego wejścia znak. */
-static char global_pcalc_read_buffer;
 
-/** Główny stos wielomianów, na którym operuje kalkulator. */
-static PointerStack global_pcalc_poly_stack;
 
-/** Numer wiersza, z którego były ostatnio wczytywane znaki. */
-static unsigned global_pcalc_line_number;
 
-/** Numer ostatnio wczytanej kolumny. */
-static unsigned global_pcalc_column_number;
+/**
+ * Rosnący bufor jednomianów wczytywanych przez parser wielomianów.
+ * Jednomiany wielomianu zagnieżdżonego jako współczynnik dokładane są za
+ * jednomianami wielomianów zewnętrznych i zdejmowane z bufora po zbudowaniu
+ * współczynnika, więc jeden bufor obsługuje dowolne zagnieżdżenie.
+ */
+typedef struct MonoArena
+{
+    Mono *monos; ///< tablica jednomianów
+    unsigned size; ///< liczba jednomianów w buforze
+    unsigned capacity; ///< rozmiar tablicy
+} MonoArena;
 
 
 /**
- * Alokuje na stercie (ang - heap) miejsce na strukturę Mono.
- * @return wskaźnik na nowy obszar w pamięci
+ * Stos otwartych wielomianów parsera: dla każdego wielomianu, którego
+ * jednomiany są właśnie wczytywane, indeks jego pierwszego jednomianu
+ * w buforze jednomianów.
  */
-static Mono* MonoMalloc()
+typedef struct PolyFrameStack
 {
-    Mono *out = (Mono*)malloc(sizeof(Mono));
-    assert(out);
-    return out;
+    unsigned *bases; ///< indeksy pierwszych jednomianów otwartych wielomianów
+    unsigned size; ///< liczba otwartych wielomianów
+    unsigned capacity; ///< rozmiar tablicy
+} PolyFrameStack;
+
+
+
+/** Największa liczba wątków, którą można podać w argumencie `--threads`
+    lub w poleceniu COMPOSE. */
+static const long MAX_THREAD_COUNT = 256;
+
+/** Największy budżet pamięci podręcznej (w MiB) w argumencie `--memo`. */
+static const long MAX_MEMO_MEGABYTES = 1 << 20;
+
+
+/**
+ * Stan kodu bajtowego kalkulatora. W trybie `--compile` polecenia
+ * i wielomiany ze skryptu nie są wykonywane, tylko zapisywane jako instrukcje
+ * kodu bajtowego, a w trybie `--run` instrukcje te są wczytywane i wykonywane
+ * bez analizy tekstu.
+ */
+typedef struct Bytecode
+{
+    bool compiling; ///< czy skrypt jest kompilowany do kodu bajtowego
+    bool running; ///< czy wykonywany jest kod bajtowy
+    unsigned line; ///< wiersz skryptu ostatnio zapisanej lub wykonywanej instrukcji
+    Printer output; ///< drukarka zapisująca kod bajtowy
+} Bytecode;
+
+
+/**
+ * Stan łańcucha skryptów wykonywanego w trybie `--chain`. Ostatni wiersz
+ * każdego skryptu to `FILE nazwa`, wskazujący kolejny skrypt, lub `STOP`.
+ * Wyniki wypisywane przez skrypt, po którym następuje kolejny, nie trafiają
+ * na wyjście, tylko w tej samej kolejności na stos, z którym kolejny skrypt
+ * rozpoczyna działanie - bez wypisywania i ponownego parsowania.
+ */
+typedef struct Chain
+{
+    bool carrying; ///< czy wyniki trafiają na stos kolejnego skryptu
+    PointerStack carried; ///< stos, z którym rozpocznie się kolejny skrypt
+    int line_offset; ///< przesunięcie numerów wierszy bieżącego skryptu
+} Chain;
+
+/**
+ * Stan kalkulatora wykonującego jeden skrypt. Procedury kalkulatora nie
+ * korzystają ze zmiennych globalnych, tylko z przekazanego im stanu, więc
+ * w trybie `--batch` wiele skryptów może być wykonywanych równocześnie.
+ * W trybie `--lazy` elementami stosu są leniwe wyrażenia: ADD, SUB, NEG, MUL
+ * i AT tylko budują wyrażenia, DEG, IS_ZERO i IS_COEFF w miarę możliwości
+ * nie rozwijają ich, a obliczane są dopiero wtedy, gdy potrzebny jest
+ * wielomian (np. przez PRINT). Z argumentem `--memo` wyniki MUL, AT,
+ * COMPOSE i POW zapamiętywane są w pamięci podręcznej, która przetrwa
+ * przejście do kolejnego skryptu łańcucha.
+ */
+typedef struct Calculator
+{
+    int read_buffer; ///< ostatni wczytany znak wejścia
+    Reader reader; ///< czytnik wejścia
+    /**
+     * Drukarka wyjścia. Jej bufor opróżniany jest po zapełnieniu, przed
+     * oczekiwaniem na kolejny blok wejścia i na końcu działania skryptu.
+     */
+    Printer printer;
+    FILE *errors; ///< plik, do którego wypisywane są komunikaty błędów
+    MonoArena mono_arena; ///< bufor jednomianów parsera wielomianów
+    PolyFrameStack poly_frames; ///< stos otwartych wielomianów parsera
+    PointerStack poly_stack; ///< stos wielomianów, na którym operuje kalkulator
+    unsigned thread_count; ///< liczba wątków ustalona argumentem `--threads`
+    Bytecode bytecode; ///< stan kodu bajtowego
+    Chain chain; ///< stan łańcucha skryptów
+    bool lazy; ///< czy stos przechowuje leniwe wyrażenia (PolyExpr) zamiast wielomianów
+    MemoCache memo; ///< pamięć podręczna wyników działań
+    /**
+     * Czy pula wątków jest współdzielona z innymi skryptami lub etapami
+     * (tryby `--batch` i `--pipeline`). Wtedy COMPOSE nie może zmieniać
+     * liczby wątków biblioteki.
+     */
+    bool shared_pool;
+} Calculator;
+
+/**
+ * Rodzaje działań, których wyniki zapamiętywane są w pamięci podręcznej.
+ */
+enum MemoOperation
+{
+    MEMO_MUL, ///< mnożenie
+    MEMO_AT, ///< wartość w punkcie
+    MEMO_COMPOSE, ///< złożenie
+    MEMO_POW ///< potęgowanie
+};
+
+/** Nagłówek pliku z kodem bajtowym. */
+static const char BYTECODE_MAGIC[4] = "PCB1";
+
+/** Nagłówek pliku z wielomianem zapisanym poleceniem SAVE. */
+static const char POLY_FILE_MAGIC[4] = "PLY1";
+
+/**
+ * Kody instrukcji kodu bajtowego niebędących poleceniami kalkulatora.
+ * Kodem polecenia jest jego indeks w tablicy COMMANDS.
+ */
+enum BytecodeOpcode
+{
+    OPCODE_LITERAL = 0x80, ///< wstawienie wielomianu na stos
+    OPCODE_ERROR = 0x81 ///< błąd wykryty podczas kompilacji
+};
+
+/**
+ * Kody zdarzeń budowy wielomianu w instrukcji OPCODE_LITERAL. Wielomian
+ * budowany jest tak jak przez parser - w buforze jednomianów, ze stosem
+ * otwartych wielomianów.
+ */
+enum LiteralOpcode
+{
+    LITERAL_PUSH, ///< otwarcie wielomianu
+    LITERAL_POP, ///< zamknięcie wielomianu, który staje się bieżącym
+    LITERAL_COEFF, ///< wielomian stały (liczba) staje się bieżącym
+    LITERAL_MONO, ///< jednomian z bieżącym wielomianem jako współczynnikiem (wykładnik)
+    LITERAL_CONST_MONO ///< jednomian o stałym współczynniku (liczba i wykładnik)
+};
+
+/** Błędy zgłaszane przez kalkulator. */
+typedef enum CalcError
+{
+    ERROR_STACK_UNDERFLOW, ///< za mało wielomianów na stosie
+    ERROR_WRONG_COMMAND, ///< niepoprawne polecenie
+    ERROR_DIVISION_BY_ZERO, ///< dzielenie przez zero
+    ERROR_WRONG_VALUE, ///< niepoprawny argument polecenia AT
+    ERROR_WRONG_VARIABLE, ///< niepoprawny argument polecenia DEG_BY
+    ERROR_WRONG_COUNT, ///< niepoprawny argument polecenia COMPOSE
+    ERROR_WRONG_THREAD_COUNT, ///< niepoprawna liczba wątków polecenia COMPOSE
+    ERROR_PARSE_POLY, ///< niepoprawny wielomian
+    ERROR_WRONG_FILE, ///< niepoprawny plik poleceń SAVE i LOAD
+    ERROR_WRONG_EXPONENT, ///< niepoprawny argument polecenia POW
+    ERROR_COUNT ///< liczba rodzajów błędów
+} CalcError;
+
+/** Komunikaty błędów kalkulatora (poza błędem parsowania wielomianu). */
+static const char *const ERROR_MESSAGES[ERROR_COUNT] = {
+    [ERROR_STACK_UNDERFLOW] = "STACK UNDERFLOW",
+    [ERROR_WRONG_COMMAND] = "WRONG COMMAND",
+    [ERROR_DIVISION_BY_ZERO] = "DIVISION BY ZERO",
+    [ERROR_WRONG_VALUE] = "WRONG VALUE",
+    [ERROR_WRONG_VARIABLE] = "WRONG VARIABLE",
+    [ERROR_WRONG_COUNT] = "WRONG COUNT",
+    [ERROR_WRONG_THREAD_COUNT] = "WRONG THREAD COUNT",
+    [ERROR_WRONG_FILE] = "WRONG FILE",
+    [ERROR_WRONG_EXPONENT] = "WRONG EXPONENT",
+};
+
 
-}
 /**
  * Alokuje na stercie (ang - heap) miejsce na strukturę Poly.
  * @return wskaźnik na nowy obszar w pamięci
@@ -52,32 +216,74 @@ static Poly* PolyMalloc()
 
 /**
  * Wczytuje kolejną literę z wejścia do pamięci.
- * Ostatnio wczytany znak jest dostępny dla parserów w globalnej zmiennej.
+ * Ostatnio wczytany znak jest dostępny dla parserów w stanie kalkulatora.
+ * @param[in,out] calc : stan kalkulatora
+ */
+static void ReadCharacter(Calculator *calc)
+{
+    calc->read_buffer = ReaderNext(&calc->reader);
+}
+
+/**
+ * Wyznacza numer wiersza i kolumny ostatnio wczytanego znaku. W łańcuchu
+ * skryptów wiersze numerowane są tak, jakby skrypt poprzedzały wiersze
+ * z wielomianami stosu, z którym rozpoczął działanie.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[out] line   : numer wiersza
+ * @param[out] column : numer kolumny
+ */
+static void LocateInput(Calculator *calc, unsigned *line, unsigned *column)
+{
+    ReaderLocate(&calc->reader, line, column);
+    *line += calc->chain.line_offset;
+}
+
+/**
+ * Wyznacza numer wiersza, z którego pochodzi ostatnio wczytany znak, a przy
+ * wykonywaniu kodu bajtowego - numer wiersza skryptu wykonywanej instrukcji.
+ * @param[in,out] calc : stan kalkulatora
+ * @return numer wiersza
  */
-static void ReadCharacter()
+static unsigned CurrentLineNumber(Calculator *calc)
 {
-    if (global_pcalc_read_buffer == '\n')
+    if (calc->bytecode.running)
     {
-        global_pcalc_line_number += 1;
-        global_pcalc_column_number = 1;
+        return calc->bytecode.line;
     }
-    else
+    unsigned line, column;
+    LocateInput(calc, &line, &column);
+    return line;
+}
+
+/**
+ * Dokłada jednomian na koniec bufora jednomianów, w razie potrzeby go
+ * powiększając.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] mono : jednomian
+ */
+static void MonoArenaPush(Calculator *calc, Mono mono)
+{
+    MonoArena *arena = &calc->mono_arena;
+    if (arena->size == arena->capacity)
     {
-        global_pcalc_column_number += 1;
+        arena->capacity = 2 * arena->capacity + 16;
+        arena->monos = realloc(arena->monos, arena->capacity * sizeof(Mono));
+        assert(arena->monos);
     }
-    global_pcalc_read_buffer = getchar();
+    arena->monos[arena->size++] = mono;
 }
 
 /**
- * Usuwa zawartość stosu jednomianów z pamięci.
- * @param[in,out] mono_stack : stos jednomianów, który chcemy wyczyścić
+ * Usuwa z pamięci jednomiany bufora od indeksu @p base.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] base : liczba jednomianów pozostawianych w buforze
  */
-static void MonoStackDestroy(PointerStack *mono_stack)
+static void MonoArenaTruncate(Calculator *calc, unsigned base)
 {
-    while (mono_stack->next_elem != NULL)
+    MonoArena *arena = &calc->mono_arena;
+    while (arena->size > base)
     {
-        free(mono_stack->elem_pointer);
-        PopStack(mono_stack);
+        MonoDestroy(&arena->monos[--arena->size]);
     }
 }
 
@@ -95,207 +301,531 @@ static void PolyStackDestroy(PointerStack *poly_stack)
     }
 }
 
+/**
+ * Usuwa z pamięci zawartość stosu leniwych wyrażeń.
+ * @param[in,out] expr_stack : stos wyrażeń, który chcemy wyczyścić
+ */
+static void ExprStackDestroy(PointerStack *expr_stack)
+{
+    while (expr_stack->next_elem != NULL)
+    {
+        PolyExprRelease(PollStackTop(expr_stack));
+    }
+}
+
+/**
+ * Usuwa z pamięci zawartość stosu kalkulatora.
+ * @param[in,out] calc : stan kalkulatora
+ */
+static void CalculatorStackDestroy(Calculator *calc)
+{
+    if (calc->lazy)
+    {
+        ExprStackDestroy(&calc->poly_stack);
+    }
+    else
+    {
+        PolyStackDestroy(&calc->poly_stack);
+    }
+}
+
+/**
+ * Wstawia na stos kalkulatora wielomian, a w trybie `--lazy` - wyrażenie
+ * o jego wartości.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] p        : wielomian zaalokowany funkcją PolyMalloc
+ */
+static void PushPoly(Calculator *calc, Poly *p)
+{
+    if (calc->lazy)
+    {
+        PushOntoStack(PolyExprCreate(p), &calc->poly_stack);
+        free(p);
+        return;
+    }
+    PushOntoStack(p, &calc->poly_stack);
+}
+
+/**
+ * Sprawdza, czy ostatnio wczytany znak jest cyfrą.
+ * @param[in,out] calc : stan kalkulatora
+ * @return czy bufor jest cyfrą
+ */
+static bool BufferIsDigit(Calculator *calc)
+{
+    return '0' <= calc->read_buffer && calc->read_buffer <= '9';
+}
+
 /**
  * Sprawdza, czy ostatnio wczytany znak opisuje liczbę.
+ * @param[in,out] calc : stan kalkulatora
  * @return czy bufor jest cyfrą bądź minusem
  */
-static bool BufferIsNumber()
+static bool BufferIsNumber(Calculator *calc)
 {
-    return (('0' <= global_pcalc_read_buffer) &&
-            (global_pcalc_read_buffer <= '9')) ||
-           global_pcalc_read_buffer == '-';
+    return (('0' <= calc->read_buffer) &&
+            (calc->read_buffer <= '9')) ||
+           calc->read_buffer == '-';
 }
 
 /**
  * Sprawdza, czy ostatnio wczytany znak opisuje koniec wiersza lub pliku wejścia.
+ * @param[in,out] calc : stan kalkulatora
  * @return czy bufor jest znakiem końcą wiersza bądź oznacza koniec pliku
  */
-static bool BufferIsEndline()
+static bool BufferIsEndline(Calculator *calc)
 {
-    return global_pcalc_read_buffer == '\n' ||
-           global_pcalc_read_buffer == EOF;
+    return calc->read_buffer == '\n' ||
+           calc->read_buffer == EOF;
 }
 
 /**
  * Sprawdza, czy ostatnio wczytany znak jest literą alfabetu łacińskiego.
+ * @param[in,out] calc : stan kalkulatora
  * @return czy bufor jest literą
  */
-static bool BufferIsLetter()
+static bool BufferIsLetter(Calculator *calc)
+{
+    return ('a' <= calc->read_buffer &&
+            calc->read_buffer <= 'z') ||
+           ('A' <= calc->read_buffer &&
+            calc->read_buffer <= 'Z');
+}
+
+/**
+ * Sprawdza, czy ostatnio wczytany znak kończy słowo polecenia.
+ * @param[in,out] calc : stan kalkulatora
+ * @return czy bufor jest białym znakiem bądź oznacza koniec pliku
+ */
+static bool BufferIsSpace(Calculator *calc)
 {
-    return ('a' <= global_pcalc_read_buffer &&
-            global_pcalc_read_buffer <= 'z') ||
-           ('A' <= global_pcalc_read_buffer &&
-            global_pcalc_read_buffer <= 'Z');
+    return calc->read_buffer == EOF || isspace(calc->read_buffer);
 }
 
 /**
  * Wczytuje znaki z wejścia póki nie napotka znaku końca wiersza lub znaku EOF.
  * Używane przede wszystkim w przypadku napotkania błędu przez któryś z parserów.
+ * @param[in,out] calc : stan kalkulatora
  */
-static void ReadUntilNewline()
+static void ReadUntilNewline(Calculator *calc)
 {
-    while (!BufferIsEndline())
+    if (!BufferIsEndline(calc))
     {
-        ReadCharacter();
+        calc->read_buffer = ReaderSkipLine(&calc->reader);
     }
 }
 
 /**
- * Wypisuje na standardowe wyjście wartość wyrażenia.
+ * Wypisuje na standardowe wyjście wartość wyrażenia, a w łańcuchu skryptów
+ * przed kolejnym skryptem - wstawia ją na jego stos jako wielomian stały.
+ * @param[in,out] calc   : stan kalkulatora
  * @param[in] expression : wyrażenie do wypisania
  */
-static void PrintExpressionResult(int expression)
+static void PrintExpressionResult(Calculator *calc, int expression)
+{
+    if (calc->chain.carrying)
+    {
+        Poly *p = PolyMalloc();
+        *p = PolyFromCoeff(expression);
+        PushOntoStack(p, &calc->chain.carried);
+        return;
+    }
+    PrinterPutLong(&calc->printer, expression);
+    PrinterPutChar(&calc->printer, '\n');
+}
+
+/**
+ * Zapisuje do kodu bajtowego liczbę bez znaku w kodowaniu o zmiennej
+ * długości: po 7 bitów w bajcie, od najmłodszych, z najstarszym bitem
+ * bajtu ustawionym, gdy liczba ma kolejne bajty.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] value : liczba
+ */
+static void EmitVarint(Calculator *calc, unsigned long value)
+{
+    while (value >= 0x80)
+    {
+        PrinterPutChar(&calc->bytecode.output, (value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    PrinterPutChar(&calc->bytecode.output, value);
+}
+
+/**
+ * Zapisuje do kodu bajtowego liczbę ze znakiem - liczby o małej wartości
+ * bezwzględnej odwzorowywane są na małe liczby bez znaku (0, -1, 1, -2, ...
+ * na 0, 1, 2, 3, ...).
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] value : liczba
+ */
+static void EmitSigned(Calculator *calc, long value)
+{
+    EmitVarint(calc, ((unsigned long)value << 1) ^ -(unsigned long)(value < 0));
+}
+
+/**
+ * Rozpoczyna w kodzie bajtowym instrukcję pochodzącą z bieżącego wiersza
+ * skryptu. Instrukcja zaczyna się kodem, po którym następuje różnica
+ * numerów wierszy jej i poprzedniej instrukcji.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] opcode : kod instrukcji
+ * @param[in] line   : numer wiersza
+ */
+static void EmitInstruction(Calculator *calc, unsigned char opcode,
+                            unsigned line)
+{
+    PrinterPutChar(&calc->bytecode.output, opcode);
+    EmitVarint(calc, line - calc->bytecode.line);
+    calc->bytecode.line = line;
+}
+
+/**
+ * Wczytuje z kodu bajtowego liczbę zapisaną przez EmitVarint.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[out] out : liczba
+ * @return status wykonania (błąd, gdy kod bajtowy jest uszkodzony)
+ */
+static bool DecodeVarint(Calculator *calc, unsigned long *out)
+{
+    unsigned long value = 0;
+    for (unsigned shift = 0; shift < CHAR_BIT * sizeof(value); shift += 7)
+    {
+        int c = ReaderNext(&calc->reader);
+        if (c == EOF)
+        {
+            return true;
+        }
+        value |= (unsigned long)(c & 0x7f) << shift;
+        if (c < 0x80)
+        {
+            *out = value;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Wczytuje z kodu bajtowego liczbę zapisaną przez EmitSigned.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[out] out : liczba
+ * @return status wykonania (błąd, gdy kod bajtowy jest uszkodzony)
+ */
+static bool DecodeSigned(Calculator *calc, long *out)
+{
+    unsigned long value;
+    if (DecodeVarint(calc, &value))
+    {
+        return true;
+    }
+    *out = (long)((value >> 1) ^ -(value & 1));
+    return false;
+}
+
+/**
+ * Zgłasza błąd pochodzący z wiersza @p line i wypisuje odpowiedni komunikat.
+ * Podczas kompilacji błąd nie jest wypisywany, tylko zapisywany jako
+ * instrukcja kodu bajtowego, by wypisać go przy wykonaniu kodu.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] error  : rodzaj błędu
+ * @param[in] line   : numer wiersza
+ * @param[in] column : numer kolumny (tylko dla błędu parsowania wielomianu)
+ * @return status wykonania dla błędu
+ */
+static bool ThrowError(Calculator *calc, CalcError error, unsigned line,
+                       unsigned column)
 {
-    printf("%d\n", expression);
+    if (calc->bytecode.compiling)
+    {
+        EmitInstruction(calc, OPCODE_ERROR, line);
+        PrinterPutChar(&calc->bytecode.output, error);
+        if (error == ERROR_PARSE_POLY)
+        {
+            EmitVarint(calc, column);
+        }
+    }
+    else if (error == ERROR_PARSE_POLY)
+    {
+        fprintf(calc->errors, "ERROR %d %d\n", line, column);
+    }
+    else
+    {
+        fprintf(calc->errors, "ERROR %d %s\n", line, ERROR_MESSAGES[error]);
+    }
+    return true;
 }
 
 /**
  * Zwraca błąd o zbyt małej liczbie wielomianów na stosie i wypisuje odpowiedni
  * komunikat.
+ * @param[in,out] calc : stan kalkulatora
  * @return status wykonania dla błędu
  */
-static bool ThrowStackUnderflow()
+static bool ThrowStackUnderflow(Calculator *calc)
 {
-    fprintf(stderr, "ERROR %d STACK UNDERFLOW\n", global_pcalc_line_number);
-    return true;
+    return ThrowError(calc, ERROR_STACK_UNDERFLOW, CurrentLineNumber(calc), 0);
 }
 
 /**
  * Zwraca błąd parsowania wielomianu i wypisuje odpowiedni komunikat.
+ * @param[in,out] calc : stan kalkulatora
  * @return status wykonania dla błędu
  */
-static bool ThrowParsePolyError()
+static bool ThrowParsePolyError(Calculator *calc)
 {
-    fprintf(stderr, "ERROR %d %d\n",
-            global_pcalc_line_number, global_pcalc_column_number);
-    return true;
+    unsigned line, column;
+    LocateInput(calc, &line, &column);
+    return ThrowError(calc, ERROR_PARSE_POLY, line, column);
 }
 
 /**
  * Zwraca błąd parsowania polecenia i wypisuje odpowiedni komunikat.
+ * @param[in,out] calc : stan kalkulatora
  * @return status wykonania dla błędu
  */
-static bool ThrowParseCommandError()
+static bool ThrowParseCommandError(Calculator *calc)
 {
-    fprintf(stderr, "ERROR %d WRONG COMMAND\n", global_pcalc_line_number);
-    return true;
+    return ThrowError(calc, ERROR_WRONG_COMMAND, CurrentLineNumber(calc), 0);
+}
+
+/**
+ * Zwraca błąd dzielenia przez wielomian tożsamościowo równy zeru i wypisuje
+ * odpowiedni komunikat.
+ * @param[in,out] calc : stan kalkulatora
+ * @return status wykonania dla błędu
+ */
+static bool ThrowDivisionByZero(Calculator *calc)
+{
+    return ThrowError(calc, ERROR_DIVISION_BY_ZERO, CurrentLineNumber(calc), 0);
 }
 
 /**
  * Zwraca błąd parsowania argumentu polecenia AT i wypisuje odpowiedni
  * komunikat.
+ * @param[in,out] calc : stan kalkulatora
  * @return status wykonania dla błędu
  */
-static bool ThrowParseAtArgError()
+static bool ThrowParseAtArgError(Calculator *calc)
 {
-    fprintf(stderr, "ERROR %d WRONG VALUE\n", global_pcalc_line_number);
-    return true;
+    return ThrowError(calc, ERROR_WRONG_VALUE, CurrentLineNumber(calc), 0);
 }
 
 /**
  * Zwraca błąd parsowania argumentu polecenia DEG_BY i wypisuje odpowiedni
  * komunikat.
+ * @param[in,out] calc : stan kalkulatora
  * @return status wykonania dla błędu
  */
-static bool ThrowParseDegByArgError()
+static bool ThrowParseDegByArgError(Calculator *calc)
 {
-    fprintf(stderr, "ERROR %d WRONG VARIABLE\n", global_pcalc_line_number);
-    return true;
+    return ThrowError(calc, ERROR_WRONG_VARIABLE, CurrentLineNumber(calc), 0);
 }
 
 /**
  * Zwraca błąd parsowania argumentu polecenia COMPOSE i wypisuje odpowiedni
  * komunikat.
+ * @param[in,out] calc : stan kalkulatora
  * @return status wykonania dla błędu
  */
-static bool ThrowParseComposeArgError()
+static bool ThrowParseComposeArgError(Calculator *calc)
 {
-    fprintf(stderr, "ERROR %d WRONG COUNT\n", global_pcalc_line_number);
-    return true;
+    return ThrowError(calc, ERROR_WRONG_COUNT, CurrentLineNumber(calc), 0);
+}
+
+/**
+ * Zwraca błąd parsowania liczby wątków polecenia COMPOSE i wypisuje
+ * odpowiedni komunikat.
+ * @param[in,out] calc : stan kalkulatora
+ * @return status wykonania dla błędu
+ */
+static bool ThrowParseThreadCountError(Calculator *calc)
+{
+    return ThrowError(calc, ERROR_WRONG_THREAD_COUNT, CurrentLineNumber(calc),
+                      0);
+}
+
+/**
+ * Zwraca błąd argumentu lub wykonania polecenia SAVE albo LOAD i wypisuje
+ * odpowiedni komunikat.
+ * @param[in,out] calc : stan kalkulatora
+ * @return status wykonania dla błędu
+ */
+static bool ThrowWrongFileError(Calculator *calc)
+{
+    return ThrowError(calc, ERROR_WRONG_FILE, CurrentLineNumber(calc), 0);
+}
+
+/**
+ * Zwraca błąd parsowania argumentu polecenia POW i wypisuje odpowiedni
+ * komunikat.
+ * @param[in,out] calc : stan kalkulatora
+ * @return status wykonania dla błędu
+ */
+static bool ThrowParsePowArgError(Calculator *calc)
+{
+    return ThrowError(calc, ERROR_WRONG_EXPONENT, CurrentLineNumber(calc), 0);
 }
 
 /**
  * Wykonuje na stosie wielomianów operację IS_ZERO.
  * Sprawdza, czy wielomian na wierzchołku stosu jest tożsamościowo równy zeru –
  * wypisuje na standardowe wyjście 0 lub 1.
+ * @param[in,out] calc : stan kalkulatora
  */
-static void StackTopIsZero()
+static void StackTopIsZero(Calculator *calc)
 {
-    PrintExpressionResult(PolyIsZero(GetStackTop(&global_pcalc_poly_stack)));
+    PrintExpressionResult(calc, PolyIsZero(GetStackTop(&calc->poly_stack)));
 }
 
 /**
  * Wykonuje na stosie wielomianów operację IS_COEFF.
  * Sprawdza, czy wielomian na wierzchołku stosu jest współczynnikiem –
  * wypisuje na standardowe wyjście 0 lub 1.
+ * @param[in,out] calc : stan kalkulatora
  */
-static void StackTopIsCoeff()
+static void StackTopIsCoeff(Calculator *calc)
 {
-    PrintExpressionResult(PolyIsCoeff(GetStackTop(&global_pcalc_poly_stack)));
+    PrintExpressionResult(calc, PolyIsCoeff(GetStackTop(&calc->poly_stack)));
 }
 
 /**
  * Wykonuje na stosie wielomianów operację DEG.
  * Wypisuje na standardowe wyjście stopień wielomianu
  * (−1 dla wielomianu tożsamościowo równego zeru).
+ * @param[in,out] calc : stan kalkulatora
  */
-static void StackTopDeg()
+static void StackTopDeg(Calculator *calc)
 {
-    PrintExpressionResult(PolyDeg(GetStackTop(&global_pcalc_poly_stack)));
+    PrintExpressionResult(calc, PolyDeg(GetStackTop(&calc->poly_stack)));
 }
 
 /**
  * Wykonuje na stosie wielomianów operację DEG_BY dla zadanego numeru zmiennej.
  * Wypisuje na standardowe wyjście stopień wielomianu ze względu na zmienną
  * o numerze idx (−1 dla wielomianu tożsamościowo równego zeru).
+ * @param[in,out] calc : stan kalkulatora
  * @param[in] idx : indeks zmiennej
  */
-static void StackTopDegBy(unsigned idx)
+static void StackTopDegBy(Calculator *calc, unsigned idx)
+{
+    PrintExpressionResult(calc, PolyDegBy(GetStackTop(&calc->poly_stack), idx));
+}
+
+/**
+ * Wypisuje na standardowe wyjście wielomian w formacie akceptowanym przez
+ * parser, a w łańcuchu skryptów przed kolejnym skryptem - wstawia jego kopię
+ * na stos kolejnego skryptu.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] p        : wielomian
+ */
+static void PrintPolyResult(Calculator *calc, const Poly *p)
 {
-    PrintExpressionResult(PolyDegBy(GetStackTop(&global_pcalc_poly_stack), idx));
+    if (calc->chain.carrying)
+    {
+        Poly *copy = PolyMalloc();
+        *copy = PolyClone(p);
+        PushOntoStack(copy, &calc->chain.carried);
+        return;
+    }
+    PrinterPutPoly(&calc->printer, p);
+    PrinterPutChar(&calc->printer, '\n');
 }
 
 /**
  * Wykonuje na stosie wielomianów operację PRINT.
- * Wypisuje na standardowe wyjście wielomian z wierzchołka stosu w formacie
- * akceptowanym przez parser.
+ * Wypisuje wielomian z wierzchołka stosu zgodnie z PrintPolyResult.
+ * @param[in,out] calc : stan kalkulatora
+ */
+static void StackTopPrint(Calculator *calc)
+{
+    PrintPolyResult(calc, GetStackTop(&calc->poly_stack));
+}
+
+/**
+ * Szuka w pamięci podręcznej kalkulatora wyniku działania.
+ * Znaleziony wynik jest kopiowany: stos kalkulatora jest właścicielem swoich
+ * wielomianów, a polecenia niszczą zdjęte z niego argumenty (POP, MUL, ...)
+ * lub przenoszą je (COMPOSE, przejście do trybu `--lazy`, łańcuch skryptów),
+ * więc nie może on przechowywać wielomianu współdzielonego z pamięcią
+ * podręczną. Uchwyt wpisu zwalniany jest zaraz po skopiowaniu - wpis może
+ * zostać usunięty przy kolejnym działaniu bez unieważniania wyniku na stosie.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] op       : rodzaj działania (MemoOperation)
+ * @param[in] arg      : argument liczbowy działania
+ * @param[in] count    : liczba wielomianów
+ * @param[in] operands : wielomiany
+ * @param[out] result  : kopia znalezionego wyniku
+ * @return Czy wynik został znaleziony?
+ */
+static bool MemoFind(Calculator *calc, enum MemoOperation op, long arg,
+                     unsigned count, const Poly *const operands[],
+                     Poly *result)
+{
+    PolyRef *ref = MemoCacheFind(&calc->memo, op, arg, count, operands);
+    if (ref == NULL)
+    {
+        return false;
+    }
+    *result = PolyClone(PolyRefGet(ref));
+    PolyRefRelease(ref);
+    return true;
+}
+
+/**
+ * Zapamiętuje w pamięci podręcznej kalkulatora kopię wyniku działania.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] op       : rodzaj działania (MemoOperation)
+ * @param[in] arg      : argument liczbowy działania
+ * @param[in] count    : liczba wielomianów
+ * @param[in] operands : wielomiany
+ * @param[in] result   : wynik działania
  */
-static void StackTopPrint()
+static void MemoStore(Calculator *calc, enum MemoOperation op, long arg,
+                      unsigned count, const Poly *const operands[],
+                      const Poly *result)
 {
-    PrintPoly(GetStackTop(&global_pcalc_poly_stack));
-    printf("\n");
+    if (calc->memo.budget == 0)
+    {
+        return;
+    }
+    Poly copy = PolyClone(result);
+    MemoCacheInsert(&calc->memo, op, arg, count, operands,
+                    PolyRefCreate(&copy));
 }
 
 /**
  * Wykonuje na stosie wielomianów operację ZERO.
  * Wstawia na wierzchołek stosu wielomian tożsamościowo równy zeru.
+ * @param[in,out] calc : stan kalkulatora
  */
-static void StackTopInsertZero()
+static void StackTopInsertZero(Calculator *calc)
 {
     Poly *new_poly = PolyMalloc();
     *new_poly = PolyZero();
-    PushOntoStack(new_poly, &global_pcalc_poly_stack);
+    PushOntoStack(new_poly, &calc->poly_stack);
 }
 
 /**
  * Wykonuje na stosie wielomianów operację CLONE.
  * Wstawia na stos kopię wielomianu z wierzchu stosu.
+ * @param[in,out] calc : stan kalkulatora
  */
-static void StackTopClone()
+static void StackTopClone(Calculator *calc)
 {
     Poly *new_poly = PolyMalloc();
-    *new_poly = PolyClone(GetStackTop(&global_pcalc_poly_stack));
-    PushOntoStack(new_poly, &global_pcalc_poly_stack);
+    *new_poly = PolyClone(GetStackTop(&calc->poly_stack));
+    PushOntoStack(new_poly, &calc->poly_stack);
 }
 
 /**
  * Wykonuje na stosie wielomianów operację POP.
  * Usuwa wielomian z wierzchołka stosu.
+ * @param[in,out] calc : stan kalkulatora
  */
-static void StackTopPop()
+static void StackTopPop(Calculator *calc)
 {
-    Poly *a = global_pcalc_poly_stack.elem_pointer;
-    PopStack(&global_pcalc_poly_stack);
+    Poly *a = calc->poly_stack.elem_pointer;
+    PopStack(&calc->poly_stack);
     PolyDestroy(a);
     free(a);
 }
@@ -303,43 +833,46 @@ static void StackTopPop()
 /**
  * Wykonuje na stosie wielomianów operację NEG.
  * Neguje wielomian na wierzchołku stosu.
+ * @param[in,out] calc : stan kalkulatora
  */
-static void StackTopNeg()
+static void StackTopNeg(Calculator *calc)
 {
-    Poly *a = PollStackTop(&global_pcalc_poly_stack);
+    Poly *a = PollStackTop(&calc->poly_stack);
     Poly *b = PolyMalloc();
     *b = PolyNeg(a);
     PolyDestroy(a);
     free(a);
-    PushOntoStack(b, &global_pcalc_poly_stack);
+    PushOntoStack(b, &calc->poly_stack);
 }
 
 /**
  * Wykonuje na stosie wielomianów operację IS_EQ.
  * Sprawdza, czy dwa wielomiany na wierzchu stosu są równe –
  * wypisuje na standardowe wyjście 0 lub 1.
+ * @param[in,out] calc : stan kalkulatora
  */
-static void StackTopIsEq()
+static void StackTopIsEq(Calculator *calc)
 {
-    Poly *a = PollStackTop(&global_pcalc_poly_stack);
-    Poly *b = GetStackTop(&global_pcalc_poly_stack);
-    PushOntoStack(a, &global_pcalc_poly_stack);
-    PrintExpressionResult(PolyIsEq(a, b));
+    Poly *a = PollStackTop(&calc->poly_stack);
+    Poly *b = GetStackTop(&calc->poly_stack);
+    PushOntoStack(a, &calc->poly_stack);
+    PrintExpressionResult(calc, PolyIsEq(a, b));
 }
 
 /**
  * Wykonuje na dwóch pierwszych elementach stosu daną operację i umieszcza jej
  * wynik na stosie.
+ * @param[in,out] calc : stan kalkulatora
  * @param Operation : operacja do wykonania na stosie
  */
 static void PushBinaryPolyOperationResultOntoStack
-    (Poly (*Operation)(const Poly *a, const Poly *b))
+    (Calculator *calc, Poly (*Operation)(const Poly *a, const Poly *b))
 {
-    Poly *a = PollStackTop(&global_pcalc_poly_stack);
-    Poly *b = PollStackTop(&global_pcalc_poly_stack);
+    Poly *a = PollStackTop(&calc->poly_stack);
+    Poly *b = PollStackTop(&calc->poly_stack);
     Poly *res = PolyMalloc();
     *res = Operation(a, b);
-    PushOntoStack(res, &global_pcalc_poly_stack);
+    PushOntoStack(res, &calc->poly_stack);
     PolyDestroy(a);
     free(a);
     PolyDestroy(b);
@@ -350,46 +883,129 @@ static void PushBinaryPolyOperationResultOntoStack
  * Wykonuje na stosie wielomianów operację ADD.
  * Dodaje dwa wielomiany z wierzchu stosu, usuwa je i wstawia na wierzchołek
  * stosu ich sumę.
+ * @param[in,out] calc : stan kalkulatora
  */
-static void StackTopAdd()
+static void StackTopAdd(Calculator *calc)
 {
-    PushBinaryPolyOperationResultOntoStack(PolyAdd);
+    PushBinaryPolyOperationResultOntoStack(calc, PolyAdd);
 }
 
 /**
  * Wykonuje na stosie wielomianów operację MUL.
  * Mnoży dwa wielomiany z wierzchu stosu, usuwa je i wstawia na wierzchołek
  * stosu ich iloczyn.
+ * @param[in,out] calc : stan kalkulatora
+ */
+static void StackTopMul(Calculator *calc)
+{
+    Poly *a = PollStackTop(&calc->poly_stack);
+    Poly *b = PollStackTop(&calc->poly_stack);
+    const Poly *operands[] = {a, b};
+    Poly *res = PolyMalloc();
+    if (!MemoFind(calc, MEMO_MUL, 0, 2, operands, res))
+    {
+        *res = PolyMul(a, b);
+        MemoStore(calc, MEMO_MUL, 0, 2, operands, res);
+    }
+    PushOntoStack(res, &calc->poly_stack);
+    PolyDestroy(a);
+    free(a);
+    PolyDestroy(b);
+    free(b);
+}
+
+/**
+ * Zwraca iloraz z dzielenia wielomianów zgodnie z PolyDivRem.
+ * @param[in] a : dzielna
+ * @param[in] b : dzielnik
+ * @return iloraz
+ */
+static Poly PolyQuotient(const Poly *a, const Poly *b)
+{
+    Poly quot, rem;
+    PolyDivRem(a, b, &quot, &rem);
+    PolyDestroy(&rem);
+    return quot;
+}
+
+/**
+ * Zwraca resztę z dzielenia wielomianów zgodnie z PolyDivRem.
+ * @param[in] a : dzielna
+ * @param[in] b : dzielnik
+ * @return reszta
+ */
+static Poly PolyRemainder(const Poly *a, const Poly *b)
+{
+    Poly quot, rem;
+    PolyDivRem(a, b, &quot, &rem);
+    PolyDestroy(&quot);
+    return rem;
+}
+
+/**
+ * Wykonuje na stosie wielomianów operację DIV.
+ * Dzieli wielomian z wierzchołka przez wielomian pod wierzchołkiem, usuwa je
+ * i wstawia na wierzchołek stosu iloraz.
+ * @param[in,out] calc : stan kalkulatora
+ */
+static void StackTopDiv(Calculator *calc)
+{
+    PushBinaryPolyOperationResultOntoStack(calc, PolyQuotient);
+}
+
+/**
+ * Wykonuje na stosie wielomianów operację REM.
+ * Dzieli wielomian z wierzchołka przez wielomian pod wierzchołkiem, usuwa je
+ * i wstawia na wierzchołek stosu resztę z dzielenia.
+ * @param[in,out] calc : stan kalkulatora
  */
-static void StackTopMul()
+static void StackTopRem(Calculator *calc)
 {
-    PushBinaryPolyOperationResultOntoStack(PolyMul);
+    PushBinaryPolyOperationResultOntoStack(calc, PolyRemainder);
+}
+
+/**
+ * Wykonuje na stosie wielomianów operację GCD.
+ * Wyznacza największy wspólny dzielnik dwóch wielomianów z wierzchu stosu,
+ * usuwa je i wstawia na wierzchołek stosu ich NWD.
+ * @param[in,out] calc : stan kalkulatora
+ */
+static void StackTopGcd(Calculator *calc)
+{
+    PushBinaryPolyOperationResultOntoStack(calc, PolyGcd);
 }
 
 /**
  * Wykonuje na stosie wielomianów operację SUB.
  * Odejmuje od wielomianu z wierzchołka wielomian pod wierzchołkiem, usuwa je
  * i wstawia na wierzchołek stosu różnicę.
+ * @param[in,out] calc : stan kalkulatora
  */
-static void StackTopSub()
+static void StackTopSub(Calculator *calc)
 {
-    PushBinaryPolyOperationResultOntoStack(PolySub);
+    PushBinaryPolyOperationResultOntoStack(calc, PolySub);
 }
 
 /**
  * Wykonuje na stosie wielomianów operację AT dla zadanej wartości zmiennej.
  * Wylicza wartość wielomianu w punkcie x, usuwa wielomian z wierzchołka i
  * wstawia na stos wynik operacji.
+ * @param[in,out] calc : stan kalkulatora
  * @param[in] x : wartość pierwszej ze zmiennych
  */
-static void StackTopAt(poly_coeff_t x)
+static void StackTopAt(Calculator *calc, poly_coeff_t x)
 {
-    Poly *a = PollStackTop(&global_pcalc_poly_stack);
+    Poly *a = PollStackTop(&calc->poly_stack);
+    const Poly *operands[] = {a};
     Poly *b = PolyMalloc();
-    *b = PolyAt(a, x);
+    if (!MemoFind(calc, MEMO_AT, x, 1, operands, b))
+    {
+        *b = PolyAt(a, x);
+        MemoStore(calc, MEMO_AT, x, 1, operands, b);
+    }
     PolyDestroy(a);
     free(a);
-    PushOntoStack(b, &global_pcalc_poly_stack);
+    PushOntoStack(b, &calc->poly_stack);
 }
 
 /**
@@ -398,21 +1014,42 @@ static void StackTopAt(poly_coeff_t x)
  * stosie kolejne wielomiany ze stosu: za @p i -tą zmienną wielomianu z wierzchu
  * stosu podstawia @p i+1 - wszy wielomian ze względu na głębokość w stosie. Po
  * podstawieniu umieszcza wynik operacji na wierzchu stosu kalkulatora.
- * @param[in] count : liczba wielomianów do podstawienia
+ * Dla niezerowej wartości @p thread_count złożenie wykonywane jest przy użyciu
+ * podanej liczby wątków zamiast liczby ustalonej argumentem `--threads`.
+ * @param[in,out] calc     : stan kalkulatora
+ * @param[in] count        : liczba wielomianów do podstawienia
+ * @param[in] thread_count : liczba wątków lub 0
  */
-static void StackTopCompose(unsigned count)
+static void StackTopCompose(Calculator *calc, unsigned count,
+                            unsigned thread_count)
 {
-    Poly *a = PollStackTop(&global_pcalc_poly_stack);
+    Poly *a = PollStackTop(&calc->poly_stack);
     Poly x[count];
+    const Poly *operands[count + 1];
+    operands[0] = a;
     for (unsigned i = 0; i < count; ++i)
     {
-        Poly *t = PollStackTop(&global_pcalc_poly_stack);
+        Poly *t = PollStackTop(&calc->poly_stack);
         x[i] = *t;
         free(t);
+        operands[i + 1] = &x[i];
     }
     Poly *res = PolyMalloc();
-    *res = PolyCompose(a, count, x);
-    PushOntoStack(res, &global_pcalc_poly_stack);
+    if (!MemoFind(calc, MEMO_COMPOSE, 0, count + 1, operands, res))
+    {
+        assert(thread_count == 0 || !calc->shared_pool);
+        if (thread_count != 0)
+        {
+            PolySetThreadCount(thread_count);
+        }
+        *res = PolyCompose(a, count, x);
+        if (thread_count != 0)
+        {
+            PolySetThreadCount(calc->thread_count);
+        }
+        MemoStore(calc, MEMO_COMPOSE, 0, count + 1, operands, res);
+    }
+    PushOntoStack(res, &calc->poly_stack);
     PolyDestroy(a);
     free(a);
     for (unsigned i = 0; i < count; ++i)
@@ -421,6 +1058,28 @@ static void StackTopCompose(unsigned count)
     }
 }
 
+/**
+ * Wykonuje na stosie wielomianów operację POW dla zadanego wykładnika.
+ * Podnosi wielomian z wierzchołka do potęgi @p exp, usuwa go i wstawia
+ * na stos wynik operacji.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] exp : wykładnik
+ */
+static void StackTopPow(Calculator *calc, poly_exp_t exp)
+{
+    Poly *a = PollStackTop(&calc->poly_stack);
+    const Poly *operands[] = {a};
+    Poly *b = PolyMalloc();
+    if (!MemoFind(calc, MEMO_POW, exp, 1, operands, b))
+    {
+        *b = PolyPow(a, exp);
+        MemoStore(calc, MEMO_POW, exp, 1, operands, b);
+    }
+    PolyDestroy(a);
+    free(a);
+    PushOntoStack(b, &calc->poly_stack);
+}
+
 
 /**
  * Dodaje @p b do @p a.
@@ -481,31 +1140,33 @@ static bool MultiplyByTen(long lower_limit, long upper_limit, long *a)
  * zawiera się w podanym zakresie.
  * Parser zwraca niezerowy status wykonania, gdy w trakcie jego działania
  * wystąpi błąd.
+ * @param[in,out] calc     : stan kalkulatora
  * @param[in]  lower_limit : dolny zakres liczby do wczytania
  * @param[in]  upper_limit : górny zakres liczby do wczytania
  * @param[out] output      : wyjście parsera
  * @return             status wykonania parsowania
  */
-static bool ParseNumber(long lower_limit, long upper_limit, long *output)
+static bool ParseNumber(Calculator *calc, long lower_limit, long upper_limit,
+                        long *output)
 {
     long out = 0;
-    bool negative = (global_pcalc_read_buffer == '-');
+    bool negative = (calc->read_buffer == '-');
     if (negative)
     {
-        ReadCharacter(); //pomijam minus
+        ReadCharacter(calc); //pomijam minus
     }
-    while (BufferIsNumber())
+    while (BufferIsNumber(calc))
     {
         if (MultiplyByTen(lower_limit, upper_limit, &out))
         {
             return true;
         }
         if (AddNumbers(lower_limit, upper_limit, &out,
-                       (negative ? -1 : 1) * (global_pcalc_read_buffer - '0')))
+                       (negative ? -1 : 1) * (calc->read_buffer - '0')))
         {
             return true;
         }
-        ReadCharacter();
+        ReadCharacter(calc);
     }
     *output = out;
     return false;
@@ -515,13 +1176,14 @@ static bool ParseNumber(long lower_limit, long upper_limit, long *output)
  * Parsuje ze standardowego wejścia współczynnik.
  * Parser zwraca niezerowy status wykonania, gdy w trakcie jego działania
  * wystąpi błąd.
+ * @param[in,out] calc  : stan kalkulatora
  * @param[out] out      : wyjście parsera
  * @return             status wykonania parsowania
  */
-static bool ParseCoeff(poly_coeff_t *out)
+static bool ParseCoeff(Calculator *calc, poly_coeff_t *out)
 {
     long parser_output;
-    if (ParseNumber(LONG_MIN, LONG_MAX, &parser_output))
+    if (ParseNumber(calc, LONG_MIN, LONG_MAX, &parser_output))
     {
         return true;
     }
@@ -533,13 +1195,14 @@ static bool ParseCoeff(poly_coeff_t *out)
  * Parsuje ze standardowego wejścia wartość wykładnika.
  * Parser zwraca niezerowy status wykonania, gdy w trakcie jego działania
  * wystąpi błąd.
+ * @param[in,out] calc  : stan kalkulatora
  * @param[out] out      : wyjście parsera
  * @return             status wykonania parsowania
  */
-static bool ParseExp(poly_exp_t *out)
+static bool ParseExp(Calculator *calc, poly_exp_t *out)
 {
     long parser_output;
-    if (ParseNumber(0, INT_MAX, &parser_output))
+    if (ParseNumber(calc, 0, INT_MAX, &parser_output))
     {
         return true;
     }
@@ -547,369 +1210,2238 @@ static bool ParseExp(poly_exp_t *out)
     return false;
 }
 
+/** Największa liczba argumentów liczbowych polecenia. */
+#define MAX_ARGUMENT_COUNT 2
+
+/** Największa długość ścieżki pliku w argumencie polecenia. */
+#define MAX_PATH_LENGTH 4095
+
+/**
+ * Argumenty polecenia kalkulatora.
+ */
+typedef struct CommandArguments
+{
+    long numbers[MAX_ARGUMENT_COUNT]; ///< argumenty liczbowe
+    char path[MAX_PATH_LENGTH + 1]; ///< ścieżka pliku zakończona bajtem 0
+} CommandArguments;
+
+/**
+ * Wykonuje na stosie leniwych wyrażeń operację ZERO.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] args     : argumenty polecenia (nieużywane)
+ */
+static void LazyTopInsertZero(Calculator *calc, const CommandArguments *args)
+{
+    (void)args;
+    Poly zero = PolyZero();
+    PushOntoStack(PolyExprCreate(&zero), &calc->poly_stack);
+}
+
+/**
+ * Wykonuje na stosie leniwych wyrażeń operację IS_COEFF.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] args     : argumenty polecenia (nieużywane)
+ */
+static void LazyTopIsCoeff(Calculator *calc, const CommandArguments *args)
+{
+    (void)args;
+    PrintExpressionResult(calc,
+                          PolyExprIsCoeff(GetStackTop(&calc->poly_stack)));
+}
+
+/**
+ * Wykonuje na stosie leniwych wyrażeń operację IS_ZERO.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] args     : argumenty polecenia (nieużywane)
+ */
+static void LazyTopIsZero(Calculator *calc, const CommandArguments *args)
+{
+    (void)args;
+    PrintExpressionResult(calc,
+                          PolyExprIsZero(GetStackTop(&calc->poly_stack)));
+}
+
+/**
+ * Wykonuje na stosie leniwych wyrażeń operację CLONE - kopia współdzieli
+ * wyrażenie z oryginałem.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] args     : argumenty polecenia (nieużywane)
+ */
+static void LazyTopClone(Calculator *calc, const CommandArguments *args)
+{
+    (void)args;
+    PushOntoStack(PolyExprAcquire(GetStackTop(&calc->poly_stack)),
+                  &calc->poly_stack);
+}
+
+/**
+ * Zastępuje dwa wyrażenia z wierzchu stosu wyrażeniem zbudowanym z nich
+ * przez @p Operation (wierzchołek jest pierwszym argumentem).
+ * @param[in,out] calc : stan kalkulatora
+ * @param Operation    : operacja budująca wyrażenie
+ */
+static void LazyTopBinary(Calculator *calc,
+                          PolyExpr* (*Operation)(PolyExpr *p, PolyExpr *q))
+{
+    PolyExpr *a = PollStackTop(&calc->poly_stack);
+    PolyExpr *b = PollStackTop(&calc->poly_stack);
+    PushOntoStack(Operation(a, b), &calc->poly_stack);
+}
+
+/**
+ * Wykonuje na stosie leniwych wyrażeń operację ADD.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] args     : argumenty polecenia (nieużywane)
+ */
+static void LazyTopAdd(Calculator *calc, const CommandArguments *args)
+{
+    (void)args;
+    LazyTopBinary(calc, PolyExprAdd);
+}
+
+/**
+ * Wykonuje na stosie leniwych wyrażeń operację MUL.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] args     : argumenty polecenia (nieużywane)
+ */
+static void LazyTopMul(Calculator *calc, const CommandArguments *args)
+{
+    (void)args;
+    LazyTopBinary(calc, PolyExprMul);
+}
+
+/**
+ * Wykonuje na stosie leniwych wyrażeń operację NEG.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] args     : argumenty polecenia (nieużywane)
+ */
+static void LazyTopNeg(Calculator *calc, const CommandArguments *args)
+{
+    (void)args;
+    PushOntoStack(PolyExprNeg(PollStackTop(&calc->poly_stack)),
+                  &calc->poly_stack);
+}
+
+/**
+ * Wykonuje na stosie leniwych wyrażeń operację SUB.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] args     : argumenty polecenia (nieużywane)
+ */
+static void LazyTopSub(Calculator *calc, const CommandArguments *args)
+{
+    (void)args;
+    LazyTopBinary(calc, PolyExprSub);
+}
+
+/**
+ * Wykonuje na stosie leniwych wyrażeń operację DEG.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] args     : argumenty polecenia (nieużywane)
+ */
+static void LazyTopDeg(Calculator *calc, const CommandArguments *args)
+{
+    (void)args;
+    PrintExpressionResult(calc, PolyExprDeg(GetStackTop(&calc->poly_stack)));
+}
+
+/**
+ * Wykonuje na stosie leniwych wyrażeń operację PRINT - oblicza wyrażenie
+ * z wierzchołka stosu.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] args     : argumenty polecenia (nieużywane)
+ */
+static void LazyTopPrint(Calculator *calc, const CommandArguments *args)
+{
+    (void)args;
+    PrintPolyResult(calc, PolyExprEval(GetStackTop(&calc->poly_stack)));
+}
+
+/**
+ * Wykonuje na stosie leniwych wyrażeń operację POP.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] args     : argumenty polecenia (nieużywane)
+ */
+static void LazyTopPop(Calculator *calc, const CommandArguments *args)
+{
+    (void)args;
+    PolyExprRelease(PollStackTop(&calc->poly_stack));
+}
+
+/**
+ * Wykonuje na stosie leniwych wyrażeń operację AT.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] args     : argumenty polecenia
+ */
+static void LazyTopAt(Calculator *calc, const CommandArguments *args)
+{
+    PushOntoStack(PolyExprAt(PollStackTop(&calc->poly_stack),
+                             args->numbers[0]),
+                  &calc->poly_stack);
+}
+
+/**
+ * Zastępuje @p count wyrażeń z wierzchu stosu obliczonymi wielomianami
+ * (zaalokowanymi funkcją PolyMalloc), by wykonać na nich polecenie, które
+ * nie ma leniwej postaci.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] count    : liczba wyrażeń
+ */
+static void LazyStackMaterialize(Calculator *calc, unsigned count)
+{
+    PointerStack *elem = &calc->poly_stack;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        Poly *p = PolyMalloc();
+        *p = PolyExprTake(elem->elem_pointer);
+        elem->elem_pointer = p;
+        elem = elem->next_elem;
+    }
+}
+
+/**
+ * Zastępuje @p count wielomianów z wierzchu stosu wyrażeniami o ich wartości.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] count    : liczba wielomianów
+ */
+static void LazyStackWrap(Calculator *calc, unsigned count)
+{
+    PointerStack *elem = &calc->poly_stack;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        Poly *p = elem->elem_pointer;
+        elem->elem_pointer = PolyExprCreate(p);
+        free(p);
+        elem = elem->next_elem;
+    }
+}
+
+/**
+ * Opis polecenia kalkulatora.
+ * Polecenie bez argumentów wykonywane jest przez procedurę `Procedure` po
+ * sprawdzeniu, czy na stosie jest `arity` wielomianów. Argumenty polecenia
+ * z argumentami wczytywane są przez `ParseArguments`, a samo polecenie,
+ * razem ze sprawdzeniem stosu, wykonuje `Execute`. Zakresy argumentów
+ * liczbowych sprawdza `ArgumentsInRange`, wywoływana zarówno przy parsowaniu
+ * tekstu, jak i przy wczytywaniu kodu bajtowego. Gdy argumentów brakuje,
+ * zgłaszany jest błąd `ThrowArgumentError`. Argumentem polecenia
+ * z `path_argument` jest ścieżka pliku ciągnąca się do końca wiersza.
+ * W trybie `--lazy`, po sprawdzeniu stosu, polecenie wykonuje
+ * `LazyProcedure`, a polecenia bez niej wykonywane są na obliczonych
+ * wielomianach z wierzchu stosu - `arity` wielomianach, a dla polecenia
+ * z `counted` powiększonej o pierwszy argument polecenia.
+ */
+typedef struct Command
+{
+    const char *name; ///< nazwa polecenia
+    unsigned arity; ///< liczba wielomianów wymaganych na stosie
+    bool divisor; ///< czy wielomian pod wierzchołkiem stosu musi być niezerowy
+    unsigned argument_count; ///< liczba argumentów liczbowych polecenia
+    void (*Procedure)(Calculator*); ///< procedura polecenia bez argumentów lub NULL
+    bool path_argument; ///< czy argumentem polecenia jest ścieżka pliku
+    bool (*ParseArguments)(Calculator*, CommandArguments*); ///< parser argumentów lub NULL
+    bool (*ArgumentsInRange)(const Calculator*, const CommandArguments*); ///< sprawdza zakresy argumentów liczbowych lub NULL
+    bool (*Execute)(Calculator*, const struct Command*, const CommandArguments*); ///< procedura polecenia z argumentami lub NULL
+    bool (*ThrowArgumentError)(Calculator*); ///< błąd polecenia z argumentami bez argumentów
+    void (*LazyProcedure)(Calculator*, const CommandArguments*); ///< procedura polecenia w trybie `--lazy` lub NULL
+    bool counted; ///< czy pierwszy argument to liczba dodatkowych wielomianów polecenia
+} Command;
+
+/**
+ * Sprawdza, czy na stosie jest co najmniej @p count wielomianów.
+ * W przeciwnym wypadku zwraca błąd i wypisuje komunikat.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] count : wymagana liczba elementów na stosie
+ * @return status wykonania
+ */
+static bool RequireOnStack(Calculator *calc, unsigned long count)
+{
+    if (calc->poly_stack.size < count)
+    {
+        return ThrowStackUnderflow(calc);
+    }
+    return false;
+}
+
+/**
+ * Wykonuje polecenie o wczytanych już argumentach na stosie wielomianów.
+ * Polecenie bez argumentów wykonywane jest jedynie, gdy na stosie jest
+ * wystarczająca liczba elementów, a w przypadku dzielenia - gdy dzielnik
+ * (wielomian pod wierzchołkiem) jest niezerowy. W przeciwnym wypadku zwraca
+ * błąd i wypisuje komunikat.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] command : polecenie
+ * @param[in] args    : argumenty polecenia
+ * @return status wykonania operacji na stosie
+ */
+static bool ExecuteEagerCommand(Calculator *calc, const Command *command,
+                                const CommandArguments *args)
+{
+    if (command->Execute != NULL)
+    {
+        return command->Execute(calc, command, args);
+    }
+    if (RequireOnStack(calc, command->arity))
+    {
+        return true;
+    }
+    if (command->divisor &&
+        PolyIsZero(GetStackTop(calc->poly_stack.next_elem)))
+    {
+        return ThrowDivisionByZero(calc);
+    }
+    command->Procedure(calc);
+    return false;
+}
+
+/**
+ * Wykonuje polecenie o wczytanych już argumentach na stosie leniwych wyrażeń.
+ * Polecenie bez leniwej postaci wykonywane jest przez ExecuteEagerCommand
+ * na obliczonych wielomianach z wierzchu stosu, które potem znów stają się
+ * wyrażeniami.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] command : polecenie
+ * @param[in] args    : argumenty polecenia
+ * @return status wykonania operacji na stosie
+ */
+static bool ExecuteLazyCommand(Calculator *calc, const Command *command,
+                               const CommandArguments *args)
+{
+    if (command->LazyProcedure != NULL)
+    {
+        if (RequireOnStack(calc, command->arity))
+        {
+            return true;
+        }
+        command->LazyProcedure(calc, args);
+        return false;
+    }
+    unsigned long depth = command->arity;
+    if (command->counted)
+    {
+        depth += (unsigned long)args->numbers[0];
+    }
+    unsigned size = calc->poly_stack.size;
+    unsigned base = size > depth ? size - depth : 0;
+    LazyStackMaterialize(calc, size - base);
+    calc->lazy = false;
+    bool status = ExecuteEagerCommand(calc, command, args);
+    calc->lazy = true;
+    LazyStackWrap(calc, calc->poly_stack.size - base);
+    return status;
+}
+
+/**
+ * Wykonuje polecenie o wczytanych już argumentach.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] command : polecenie
+ * @param[in] args    : argumenty polecenia
+ * @return status wykonania operacji na stosie
+ */
+static bool ExecuteCommand(Calculator *calc, const Command *command,
+                           const CommandArguments *args)
+{
+    if (calc->lazy)
+    {
+        return ExecuteLazyCommand(calc, command, args);
+    }
+    return ExecuteEagerCommand(calc, command, args);
+}
+
+/**
+ * Parsuje argument dla poleceń kalkulatora zawierających argument.
+ * @param[in,out] calc      : stan kalkulatora
+ * @param[out]  out         : wyjście parsera
+ * @param[in]   lower_limit : dolny zakres liczby do wczytania
+ * @param[in]   upper_limit : górny zakres liczby do wczytania
+ * @return      status wykonania parsowania
+ */
+static bool ParseArgument(Calculator *calc, long *out, long lower_limit,
+                          long upper_limit)
+{
+    if (!BufferIsNumber(calc))
+    {
+        return true;
+    }
+    long arg;
+    if (ParseNumber(calc, lower_limit, upper_limit, &arg))
+    {
+        return true;
+    }
+    if (!BufferIsEndline(calc))
+    {
+        return true;
+    }
+    *out = arg;
+    return false;
+}
+
+/**
+ * Sprawdza, czy liczba wielomianów polecenia COMPOSE mieści się w zakresie.
+ * @param[in] count : liczba wielomianów do podstawienia
+ * @return Czy liczba jest poprawna?
+ */
+static bool ComposeCountInRange(long count)
+{
+    return 0 <= count && count <= UINT_MAX;
+}
+
+/**
+ * Sprawdza, czy podana liczba wątków polecenia COMPOSE jest poprawna. Nie
+ * jest, gdy pula wątków jest współdzielona, bo jej zmiana wpłynęłaby na
+ * pozostałych użytkowników puli.
+ * @param[in] calc         : stan kalkulatora
+ * @param[in] thread_count : liczba wątków
+ * @return Czy liczba jest poprawna?
+ */
+static bool ThreadCountInRange(const Calculator *calc, long thread_count)
+{
+    return 1 <= thread_count && thread_count <= MAX_THREAD_COUNT &&
+           !calc->shared_pool;
+}
+
+/**
+ * Parsuje argumenty polecenia COMPOSE: liczbę wielomianów do podstawienia
+ * oraz opcjonalną liczbę wątków. Błąd liczby wątków zgłaszany jest tylko
+ * wtedy, gdy po liczbie wielomianów i spacji wiersz kończy się liczbą -
+ * pozostałe niepoprawne argumenty, jak bez opcjonalnego argumentu, dają błąd
+ * liczby wielomianów. Zakresy sprawdzają ComposeCountInRange
+ * i ThreadCountInRange. W razie błędu wypisuje odpowiedni komunikat.
+ * @param[in,out] calc      : stan kalkulatora
+ * @param[out] count        : liczba wielomianów do podstawienia
+ * @param[out] thread_count : liczba wątków lub 0, gdy jej nie podano
+ * @return      status wykonania parsowania
+ */
+static bool ParseComposeArguments(Calculator *calc, long *count,
+                                  long *thread_count)
+{
+    *thread_count = 0;
+    if (!BufferIsNumber(calc) || ParseNumber(calc, LONG_MIN, LONG_MAX, count) ||
+        !ComposeCountInRange(*count))
+    {
+        return ThrowParseComposeArgError(calc);
+    }
+    if (BufferIsEndline(calc))
+    {
+        return false;
+    }
+    if (calc->read_buffer != ' ')
+    {
+        return ThrowParseComposeArgError(calc);
+    }
+    ReadCharacter(calc);
+    bool negative = calc->read_buffer == '-';
+    if (negative)
+    {
+        ReadCharacter(calc);
+    }
+    if (!BufferIsDigit(calc))
+    {
+        return ThrowParseComposeArgError(calc);
+    }
+    bool out_of_range = ParseNumber(calc, 0, LONG_MAX, thread_count);
+    while (BufferIsDigit(calc))
+    {
+        ReadCharacter(calc);
+    }
+    if (!BufferIsEndline(calc))
+    {
+        return ThrowParseComposeArgError(calc);
+    }
+    if (negative || out_of_range || !ThreadCountInRange(calc, *thread_count))
+    {
+        return ThrowParseThreadCountError(calc);
+    }
+    return false;
+}
+
+/**
+ * Parsuje argument polecenia AT.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[out] args : argumenty polecenia
+ * @return status wykonania parsowania
+ */
+static bool ParseAtArguments(Calculator *calc, CommandArguments *args)
+{
+    if (ParseArgument(calc, &args->numbers[0], LONG_MIN, LONG_MAX))
+    {
+        return ThrowParseAtArgError(calc);
+    }
+    return false;
+}
+
+/**
+ * Wykonuje polecenie AT.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] command : polecenie
+ * @param[in] args    : argumenty polecenia
+ * @return status wykonania
+ */
+static bool ExecuteAt(Calculator *calc, const Command *command,
+                      const CommandArguments *args)
+{
+    if (RequireOnStack(calc, command->arity))
+    {
+        return true;
+    }
+    StackTopAt(calc, args->numbers[0]);
+    return false;
+}
+
+/**
+ * Sprawdza, czy numer zmiennej polecenia DEG_BY mieści się w zakresie.
+ * @param[in] calc : stan kalkulatora
+ * @param[in] args : argumenty polecenia
+ * @return Czy argumenty są poprawne?
+ */
+static bool DegByArgumentsInRange(const Calculator *calc,
+                                  const CommandArguments *args)
+{
+    (void)calc;
+    return 0 <= args->numbers[0] && args->numbers[0] <= UINT_MAX;
+}
+
+/**
+ * Parsuje argument polecenia DEG_BY.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[out] args : argumenty polecenia
+ * @return status wykonania parsowania
+ */
+static bool ParseDegByArguments(Calculator *calc, CommandArguments *args)
+{
+    if (ParseArgument(calc, &args->numbers[0], LONG_MIN, LONG_MAX) ||
+        !DegByArgumentsInRange(calc, args))
+    {
+        return ThrowParseDegByArgError(calc);
+    }
+    return false;
+}
+
+/**
+ * Wykonuje polecenie DEG_BY.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] command : polecenie
+ * @param[in] args    : argumenty polecenia
+ * @return status wykonania
+ */
+static bool ExecuteDegBy(Calculator *calc, const Command *command,
+                         const CommandArguments *args)
+{
+    if (RequireOnStack(calc, command->arity))
+    {
+        return true;
+    }
+    StackTopDegBy(calc, args->numbers[0]);
+    return false;
+}
+
+/**
+ * Sprawdza, czy argumenty polecenia COMPOSE mieszczą się w zakresach:
+ * liczba wielomianów zgodnie z ComposeCountInRange, a liczba wątków - gdy
+ * jest podana (niezerowa) - zgodnie z ThreadCountInRange.
+ * @param[in] calc : stan kalkulatora
+ * @param[in] args : argumenty polecenia
+ * @return Czy argumenty są poprawne?
+ */
+static bool ComposeArgumentsInRange(const Calculator *calc,
+                                    const CommandArguments *args)
+{
+    return ComposeCountInRange(args->numbers[0]) &&
+           (args->numbers[1] == 0 || ThreadCountInRange(calc, args->numbers[1]));
+}
+
+/**
+ * Parsuje argumenty polecenia COMPOSE.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[out] args : argumenty polecenia
+ * @return status wykonania parsowania
+ */
+static bool ParseComposeCommandArguments(Calculator *calc,
+                                         CommandArguments *args)
+{
+    return ParseComposeArguments(calc, &args->numbers[0], &args->numbers[1]);
+}
+
+/**
+ * Wykonuje polecenie COMPOSE. Poza składanym wielomianem na stosie muszą się
+ * znajdować wielomiany do podstawienia.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] command : polecenie
+ * @param[in] args    : argumenty polecenia
+ * @return status wykonania
+ */
+static bool ExecuteCompose(Calculator *calc, const Command *command,
+                           const CommandArguments *args)
+{
+    unsigned count = args->numbers[0];
+    if (RequireOnStack(calc, command->arity + (unsigned long)count))
+    {
+        return true;
+    }
+    StackTopCompose(calc, count, args->numbers[1]);
+    return false;
+}
+
+/**
+ * Sprawdza, czy wykładnik polecenia POW mieści się w zakresie poly_exp_t.
+ * @param[in] calc : stan kalkulatora
+ * @param[in] args : argumenty polecenia
+ * @return Czy argumenty są poprawne?
+ */
+static bool PowArgumentsInRange(const Calculator *calc,
+                                const CommandArguments *args)
+{
+    (void)calc;
+    return 0 <= args->numbers[0] && args->numbers[0] <= INT_MAX;
+}
+
+/**
+ * Parsuje argument polecenia POW.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[out] args : argumenty polecenia
+ * @return status wykonania parsowania
+ */
+static bool ParsePowArguments(Calculator *calc, CommandArguments *args)
+{
+    if (ParseArgument(calc, &args->numbers[0], LONG_MIN, LONG_MAX) ||
+        !PowArgumentsInRange(calc, args))
+    {
+        return ThrowParsePowArgError(calc);
+    }
+    return false;
+}
+
+/**
+ * Wykonuje polecenie POW. Wykładnik, dla którego stopień potęgi względem
+ * którejś zmiennej przekroczyłby zakres poly_exp_t, zgłaszany jest jako błąd.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] command : polecenie
+ * @param[in] args    : argumenty polecenia
+ * @return status wykonania
+ */
+static bool ExecutePow(Calculator *calc, const Command *command,
+                       const CommandArguments *args)
+{
+    if (RequireOnStack(calc, command->arity))
+    {
+        return true;
+    }
+    const Poly *p = GetStackTop(&calc->poly_stack);
+    poly_exp_t deg = 0;
+    for (unsigned i = 0; i < p->depth; ++i)
+    {
+        if (PolyDegBy(p, i) > deg)
+        {
+            deg = PolyDegBy(p, i);
+        }
+    }
+    if (deg > 0 && args->numbers[0] > INT_MAX / deg)
+    {
+        return ThrowParsePowArgError(calc);
+    }
+    StackTopPow(calc, args->numbers[0]);
+    return false;
+}
+
+/**
+ * Parsuje argument polecenia SAVE lub LOAD: niepustą ścieżkę pliku ciągnącą
+ * się do końca wiersza.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[out] args : argumenty polecenia
+ * @return status wykonania parsowania
+ */
+static bool ParsePathArgument(Calculator *calc, CommandArguments *args)
+{
+    size_t length = 0;
+    while (!BufferIsEndline(calc))
+    {
+        if (length == MAX_PATH_LENGTH || calc->read_buffer == '\0')
+        {
+            return ThrowWrongFileError(calc);
+        }
+        args->path[length++] = calc->read_buffer;
+        ReadCharacter(calc);
+    }
+    if (length == 0)
+    {
+        return ThrowWrongFileError(calc);
+    }
+    args->path[length] = '\0';
+    return false;
+}
+
+/**
+ * Wykonuje polecenie SAVE. Zapisuje wielomian z wierzchołka stosu w pliku
+ * o podanej ścieżce: po nagłówku POLY_FILE_MAGIC następuje zapis wielomianu
+ * utworzony przez PolySerialize. Stos nie jest zmieniany.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] command : polecenie
+ * @param[in] args    : argumenty polecenia
+ * @return status wykonania
+ */
+static bool ExecuteSave(Calculator *calc, const Command *command,
+                        const CommandArguments *args)
+{
+    if (RequireOnStack(calc, command->arity))
+    {
+        return true;
+    }
+    size_t size;
+    void *data = PolySerialize(GetStackTop(&calc->poly_stack), &size);
+    FILE *file = fopen(args->path, "wb");
+    bool error = file == NULL ||
+                 fwrite(POLY_FILE_MAGIC, 1, sizeof(POLY_FILE_MAGIC), file) !=
+                 sizeof(POLY_FILE_MAGIC) ||
+                 fwrite(data, 1, size, file) != size;
+    if (file != NULL && fclose(file) != 0)
+    {
+        error = true;
+    }
+    free(data);
+    return error ? ThrowWrongFileError(calc) : false;
+}
+
+/**
+ * Wczytuje cały plik o ścieżce @p path.
+ * @param[in] path  : ścieżka pliku
+ * @param[out] size : długość pliku w bajtach
+ * @return zawartość pliku zaalokowana funkcją malloc lub NULL w razie błędu
+ */
+static unsigned char* ReadWholeFile(const char *path, size_t *size)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+    unsigned char *data = NULL;
+    long length;
+    if (fseek(file, 0, SEEK_END) == 0 && (length = ftell(file)) >= 0 &&
+        fseek(file, 0, SEEK_SET) == 0)
+    {
+        data = malloc(length > 0 ? length : 1);
+        assert(data);
+        if (fread(data, 1, length, file) != (size_t)length)
+        {
+            free(data);
+            data = NULL;
+        }
+        *size = length;
+    }
+    fclose(file);
+    return data;
+}
+
+/**
+ * Wykonuje polecenie LOAD. Wstawia na stos wielomian zapisany poleceniem SAVE
+ * w pliku o podanej ścieżce. Wielomian odtwarzany jest bezpośrednio z zapisu,
+ * bez parsowania tekstu i porządkowania jednomianów.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] command : polecenie
+ * @param[in] args    : argumenty polecenia
+ * @return status wykonania
+ */
+static bool ExecuteLoad(Calculator *calc, const Command *command,
+                        const CommandArguments *args)
+{
+    (void)command;
+    size_t size;
+    unsigned char *data = ReadWholeFile(args->path, &size);
+    if (data == NULL)
+    {
+        return ThrowWrongFileError(calc);
+    }
+    Poly *p = PolyMalloc();
+    size_t consumed = 0;
+    if (size >= sizeof(POLY_FILE_MAGIC) &&
+        memcmp(data, POLY_FILE_MAGIC, sizeof(POLY_FILE_MAGIC)) == 0)
+    {
+        consumed = PolyDeserialize(data + sizeof(POLY_FILE_MAGIC),
+                                   size - sizeof(POLY_FILE_MAGIC), p);
+    }
+    free(data);
+    if (consumed == 0 || consumed != size - sizeof(POLY_FILE_MAGIC))
+    {
+        if (consumed > 0) //po zapisie wielomianu są zbędne bajty
+        {
+            PolyDestroy(p);
+        }
+        free(p);
+        return ThrowWrongFileError(calc);
+    }
+    PushOntoStack(p, &calc->poly_stack);
+    return false;
+}
+
+/**
+ * Polecenia kalkulatora. Indeks polecenia w tablicy jest jego kodem
+ * w kodzie bajtowym, więc nowe polecenia należy dopisywać na końcu.
+ */
+static const Command COMMANDS[] = {
+    {.name = "ZERO", .arity = 0, .Procedure = StackTopInsertZero,
+     .LazyProcedure = LazyTopInsertZero},
+    {.name = "IS_COEFF", .arity = 1, .Procedure = StackTopIsCoeff,
+     .LazyProcedure = LazyTopIsCoeff},
+    {.name = "IS_ZERO", .arity = 1, .Procedure = StackTopIsZero,
+     .LazyProcedure = LazyTopIsZero},
+    {.name = "CLONE", .arity = 1, .Procedure = StackTopClone,
+     .LazyProcedure = LazyTopClone},
+    {.name = "ADD", .arity = 2, .Procedure = StackTopAdd,
+     .LazyProcedure = LazyTopAdd},
+    {.name = "MUL", .arity = 2, .Procedure = StackTopMul,
+     .LazyProcedure = LazyTopMul},
+    {.name = "NEG", .arity = 1, .Procedure = StackTopNeg,
+     .LazyProcedure = LazyTopNeg},
+    {.name = "SUB", .arity = 2, .Procedure = StackTopSub,
+     .LazyProcedure = LazyTopSub},
+    {.name = "IS_EQ", .arity = 2, .Procedure = StackTopIsEq},
+    {.name = "DEG", .arity = 1, .Procedure = StackTopDeg,
+     .LazyProcedure = LazyTopDeg},
+    {.name = "DIV", .arity = 2, .divisor = true, .Procedure = StackTopDiv},
+    {.name = "REM", .arity = 2, .divisor = true, .Procedure = StackTopRem},
+    {.name = "GCD", .arity = 2, .Procedure = StackTopGcd},
+    {.name = "PRINT", .arity = 1, .Procedure = StackTopPrint,
+     .LazyProcedure = LazyTopPrint},
+    {.name = "POP", .arity = 1, .Procedure = StackTopPop,
+     .LazyProcedure = LazyTopPop},
+    {.name = "AT", .arity = 1, .argument_count = 1,
+     .ParseArguments = ParseAtArguments, .Execute = ExecuteAt,
+     .ThrowArgumentError = ThrowParseAtArgError, .LazyProcedure = LazyTopAt},
+    {.name = "DEG_BY", .arity = 1, .argument_count = 1,
+     .ParseArguments = ParseDegByArguments,
+     .ArgumentsInRange = DegByArgumentsInRange, .Execute = ExecuteDegBy,
+     .ThrowArgumentError = ThrowParseDegByArgError},
+    {.name = "COMPOSE", .arity = 1, .argument_count = 2, .counted = true,
+     .ParseArguments = ParseComposeCommandArguments,
+     .ArgumentsInRange = ComposeArgumentsInRange, .Execute = ExecuteCompose,
+     .ThrowArgumentError = ThrowParseComposeArgError},
+    {.name = "SAVE", .arity = 1, .path_argument = true,
+     .ParseArguments = ParsePathArgument, .Execute = ExecuteSave,
+     .ThrowArgumentError = ThrowWrongFileError},
+    {.name = "LOAD", .arity = 0, .path_argument = true,
+     .ParseArguments = ParsePathArgument, .Execute = ExecuteLoad,
+     .ThrowArgumentError = ThrowWrongFileError},
+    {.name = "POW", .arity = 1, .argument_count = 1,
+     .ParseArguments = ParsePowArguments,
+     .ArgumentsInRange = PowArgumentsInRange, .Execute = ExecutePow,
+     .ThrowArgumentError = ThrowParsePowArgError},
+};
+
+/** Liczba poleceń kalkulatora. */
+#define COMMAND_COUNT (sizeof(COMMANDS) / sizeof(COMMANDS[0]))
+
+/** Liczba pól tablicy rozproszonej poleceń; musi być potęgą dwójki. */
+#define COMMAND_TABLE_SIZE 64
+
+/**
+ * Tablica rozproszona poleceń kalkulatora indeksowana funkcją CommandHash.
+ * Funkcja ta nie ma kolizji na nazwach poleceń, więc polecenie wyszukiwane
+ * jest jednym porównaniem nazwy.
+ */
+static const Command *global_pcalc_command_table[COMMAND_TABLE_SIZE];
+
+/**
+ * Wyznacza indeks polecenia w tablicy rozproszonej na podstawie długości
+ * nazwy oraz jej pierwszego i ostatniego znaku.
+ * @param[in] name   : nazwa polecenia
+ * @param[in] length : długość nazwy (dodatnia)
+ * @return indeks w tablicy rozproszonej
+ */
+static unsigned CommandHash(const char *name, unsigned length)
+{
+    return (length + 2 * (unsigned char)name[0] +
+            8 * (unsigned char)name[length - 1]) & (COMMAND_TABLE_SIZE - 1);
+}
+
+/**
+ * Wypełnia tablicę rozproszoną poleceń. Dodając polecenie, należy upewnić
+ * się, że funkcja CommandHash nie ma kolizji - sprawdza to asercja.
+ */
+static void InitCommandTable()
+{
+    for (size_t i = 0; i < COMMAND_COUNT; ++i)
+    {
+        const char *name = COMMANDS[i].name;
+        unsigned idx = CommandHash(name, strlen(name));
+        assert(global_pcalc_command_table[idx] == NULL ||
+               global_pcalc_command_table[idx] == &COMMANDS[i]);
+        global_pcalc_command_table[idx] = &COMMANDS[i];
+    }
+}
+
+/**
+ * Wyszukuje polecenie o nazwie @p name.
+ * @param[in] name   : nazwa (niekoniecznie zakończona bajtem o wartości 0)
+ * @param[in] length : długość nazwy (dodatnia)
+ * @return polecenie lub NULL, gdy nie ma polecenia o takiej nazwie
+ */
+static const Command* FindCommand(const char *name, unsigned length)
+{
+    const Command *command =
+        global_pcalc_command_table[CommandHash(name, length)];
+    if (command == NULL || strncmp(command->name, name, length) != 0 ||
+        command->name[length] != '\0')
+    {
+        return NULL;
+    }
+    return command;
+}
+
+/**
+ * Wykonuje wczytane polecenie, a podczas kompilacji - zapisuje je jako
+ * instrukcję kodu bajtowego.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] command : polecenie
+ * @param[in] args    : argumenty polecenia
+ * @return status wykonania
+ */
+static bool RunCommand(Calculator *calc, const Command *command,
+                       const CommandArguments *args)
+{
+    if (!calc->bytecode.compiling)
+    {
+        return ExecuteCommand(calc, command, args);
+    }
+    EmitInstruction(calc, command - COMMANDS, CurrentLineNumber(calc));
+    for (unsigned i = 0; i < command->argument_count; ++i)
+    {
+        EmitSigned(calc, args->numbers[i]);
+    }
+    if (command->path_argument)
+    {
+        size_t length = strlen(args->path);
+        EmitVarint(calc, length);
+        PrinterPutString(&calc->bytecode.output, args->path);
+    }
+    return false;
+}
+
+/**
+ * Parsuje polecenie ze standardowego wejścia oraz wykonuje je.
+ * Parser zwraca niezerowy status wykonania, gdy w trakcie jego działania
+ * wystąpi błąd.
+ * @param[in,out] calc : stan kalkulatora
+ * @return      status wykonania parsowania
+ */
+static bool ParseCommand(Calculator *calc)
+{
+    static const unsigned max_command_length = 20;
+    char name[max_command_length];
+    unsigned length = 0;
+    do
+    {
+        name[length++] = calc->read_buffer;
+        ReadCharacter(calc);
+    } while (length < max_command_length && !BufferIsSpace(calc));
+    const Command *command = FindCommand(name, length);
+    if (command == NULL)
+    {
+        return ThrowParseCommandError(calc);
+    }
+    CommandArguments args;
+    if (BufferIsEndline(calc))
+    {
+        if (command->ParseArguments != NULL) //polecenie wymaga argumentu
+        {
+            return command->ThrowArgumentError(calc);
+        }
+        return RunCommand(calc, command, &args);
+    }
+    if (calc->read_buffer == ' ' && command->ParseArguments != NULL)
+    {
+        ReadCharacter(calc);
+        if (command->ParseArguments(calc, &args))
+        {
+            return true;
+        }
+        return RunCommand(calc, command, &args);
+    }
+    return ThrowParseCommandError(calc);
+}
+
+/**
+ * Dokłada na stos otwartych wielomianów parsera nowy wielomian, którego
+ * jednomiany zaczynają się od bieżącego końca bufora jednomianów.
+ * @param[in,out] calc : stan kalkulatora
+ */
+static void PolyFramePush(Calculator *calc)
+{
+    PolyFrameStack *frames = &calc->poly_frames;
+    if (frames->size == frames->capacity)
+    {
+        frames->capacity = 2 * frames->capacity + 16;
+        frames->bases = realloc(frames->bases,
+                                frames->capacity * sizeof(unsigned));
+        assert(frames->bases);
+    }
+    frames->bases[frames->size++] = calc->mono_arena.size;
+}
+
+/**
+ * Zdejmuje ze stosu otwartych wielomianów parsera ostatni wielomian i buduje
+ * go z jego jednomianów, bez kopiowania przez PolyAddMonosInPlace -
+ * jednomiany podane w kolejności wykładników nie są sortowane.
+ * @param[in,out] calc : stan kalkulatora
+ * @return zbudowany wielomian
+ */
+static Poly PolyFramePop(Calculator *calc)
+{
+    MonoArena *arena = &calc->mono_arena;
+    PolyFrameStack *frames = &calc->poly_frames;
+    unsigned base = frames->bases[--frames->size];
+    Poly out = PolyAddMonosInPlace(arena->size - base, arena->monos + base);
+    arena->size = base;
+    return out;
+}
+
+/**
+ * Przerywa parsowanie wielomianu - usuwa z pamięci wszystkie wczytane
+ * jednomiany i opróżnia stos otwartych wielomianów.
+ * @param[in,out] calc : stan kalkulatora
+ * @return status wykonania dla błędu
+ */
+static bool ParsePolyAbort(Calculator *calc)
+{
+    if (calc->poly_frames.size > 0)
+    {
+        MonoArenaTruncate(calc, calc->poly_frames.bases[0]);
+        calc->poly_frames.size = 0;
+    }
+    return true;
+}
+
+/**
+ * Parsuje ze standardowego wejścia zakończenie jednomianu `,exp)` następujące
+ * po jego współczynniku i dokłada jednomian do bufora jednomianów.
+ * Przejmuje na własność współczynnik @p coeff, także w przypadku błędu.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] coeff : współczynnik jednomianu
+ * @return      status wykonania parsowania
+ */
+static bool ParseMonoEnd(Calculator *calc, Poly *coeff)
+{
+    poly_exp_t e;
+    if (calc->read_buffer != ',')
+    {
+        PolyDestroy(coeff);
+        return true;
+    }
+    ReadCharacter(calc);
+    if (!BufferIsNumber(calc) || ParseExp(calc, &e) || calc->read_buffer != ')')
+    {
+        PolyDestroy(coeff);
+        return true;
+    }
+    ReadCharacter(calc);
+    MonoArenaPush(calc, MonoFromPoly(coeff, e));
+    return false;
+}
+
+/**
+ * Parsuje ze standardowego wejścia wielomian.
+ * Parser jest iteracyjny: każdy napotkany nawias otwierający współczynnik
+ * dokłada wielomian na stos otwartych wielomianów, a jednomiany wszystkich
+ * poziomów trafiają do wspólnego bufora jednomianów. Dzięki temu głębokość
+ * zagnieżdżenia nie jest ograniczona rozmiarem stosu wywołań.
+ * Parser zwraca niezerowy status wykonania, gdy w trakcie jego działania
+ * wystąpi błąd.
+ * @param[in,out] calc     : stan kalkulatora
+ * @param[out] output      : wyjście parsera
+ * @return             status wykonania parsowania
+ */
+static bool ParsePoly(Calculator *calc, Poly *output)
+{
+    while (true)
+    {
+        //otwieramy kolejne wielomiany aż do współczynnika liczbowego
+        while (calc->read_buffer == '(')
+        {
+            PolyFramePush(calc);
+            ReadCharacter(calc);
+        }
+        poly_coeff_t coeff;
+        if (!BufferIsNumber(calc) || ParseCoeff(calc, &coeff))
+        {
+            return ParsePolyAbort(calc);
+        }
+        Poly current = PolyFromCoeff(coeff);
+        //zamykamy jednomiany, których współczynnikiem jest current
+        while (true)
+        {
+            if (calc->poly_frames.size == 0)
+            {
+                *output = current;
+                return false;
+            }
+            if (ParseMonoEnd(calc, &current))
+            {
+                return ParsePolyAbort(calc);
+            }
+            if (calc->read_buffer == '+')
+            {
+                ReadCharacter(calc);
+                if (calc->read_buffer != '(')
+                {
+                    return ParsePolyAbort(calc);
+                }
+                ReadCharacter(calc);
+                break;
+            }
+            if (!BufferIsEndline(calc) && calc->read_buffer != ',')
+            {
+                return ParsePolyAbort(calc);
+            }
+            current = PolyFramePop(calc);
+        }
+    }
+}
+
+/**
+ * Zapisuje w kodzie bajtowym otwarcie wielomianu @p p wraz z jego wyrazem
+ * wolnym.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] p : wielomian niebędący współczynnikiem
+ * @return jednomian wielomianu o najmniejszym wykładniku
+ */
+static Mono* EmitLiteralOpen(Calculator *calc, const Poly *p)
+{
+    PrinterPutChar(&calc->bytecode.output, LITERAL_PUSH);
+    if (p->abs_term != 0)
+    {
+        PrinterPutChar(&calc->bytecode.output, LITERAL_CONST_MONO);
+        EmitSigned(calc, p->abs_term);
+        EmitVarint(calc, 0);
+    }
+    return p->last;
+}
+
+/**
+ * Zapisuje w kodzie bajtowym zdarzenia budowy wielomianu @p p.
+ * Jednomiany zapisywane są w kolejności rosnących wykładników, więc przy
+ * budowie nie trzeba ich sortować. Struktura wielomianu przechodzona jest
+ * bez rekurencji - na stosie pamiętane są jednomiany, których
+ * współczynniki są właśnie zapisywane.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] p : wielomian
+ */
+static void EmitLiteral(Calculator *calc, const Poly *p)
+{
+    if (PolyIsCoeff(p))
+    {
+        PrinterPutChar(&calc->bytecode.output, LITERAL_COEFF);
+        EmitSigned(calc, p->abs_term);
+        return;
+    }
+    Mono **stack = malloc(p->depth * sizeof(Mono*));
+    assert(stack);
+    unsigned top = 0;
+    Mono *next = EmitLiteralOpen(calc, p);
+    while (true)
+    {
+        while (next != NULL && PolyIsCoeff(&next->p))
+        {
+            PrinterPutChar(&calc->bytecode.output, LITERAL_CONST_MONO);
+            EmitSigned(calc, next->p.abs_term);
+            EmitVarint(calc, next->exp);
+            next = next->prev;
+        }
+        if (next != NULL)
+        {
+            stack[top++] = next;
+            next = EmitLiteralOpen(calc, &next->p);
+            continue;
+        }
+        PrinterPutChar(&calc->bytecode.output, LITERAL_POP);
+        if (top == 0)
+        {
+            break;
+        }
+        Mono *mono = stack[--top];
+        PrinterPutChar(&calc->bytecode.output, LITERAL_MONO);
+        EmitVarint(calc, mono->exp);
+        next = mono->prev;
+    }
+    free(stack);
+}
+
+/**
+ * Wczytuje z kodu bajtowego wykładnik jednomianu.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[out] out : wykładnik
+ * @return status wykonania (błąd, gdy kod bajtowy jest uszkodzony)
+ */
+static bool DecodeExp(Calculator *calc, poly_exp_t *out)
+{
+    unsigned long exp;
+    if (DecodeVarint(calc, &exp) || exp > INT_MAX)
+    {
+        return true;
+    }
+    *out = exp;
+    return false;
+}
+
+/**
+ * Buduje wielomian ze zdarzeń zapisanych w kodzie bajtowym przez EmitLiteral.
+ * Korzysta z bufora jednomianów i stosu otwartych wielomianów parsera.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[out] output : zbudowany wielomian
+ * @return status wykonania (błąd, gdy kod bajtowy jest uszkodzony)
+ */
+static bool DecodeLiteral(Calculator *calc, Poly *output)
+{
+    Poly current = PolyZero();
+    while (true)
+    {
+        poly_coeff_t coeff;
+        poly_exp_t exp;
+        switch (ReaderNext(&calc->reader))
+        {
+            case LITERAL_PUSH:
+                PolyFramePush(calc);
+                continue;
+            case LITERAL_COEFF:
+                if (DecodeSigned(calc, &coeff))
+                {
+                    break;
+                }
+                PolyDestroy(&current);
+                current = PolyFromCoeff(coeff);
+                if (calc->poly_frames.size == 0)
+                {
+                    *output = current;
+                    return false;
+                }
+                continue;
+            case LITERAL_MONO:
+                if (calc->poly_frames.size == 0 || DecodeExp(calc, &exp))
+                {
+                    break;
+                }
+                MonoArenaPush(calc, MonoFromPoly(&current, exp));
+                current = PolyZero();
+                continue;
+            case LITERAL_CONST_MONO:
+                if (calc->poly_frames.size == 0 ||
+                    DecodeSigned(calc, &coeff) || DecodeExp(calc, &exp))
+                {
+                    break;
+                }
+                Poly constant = PolyFromCoeff(coeff);
+                MonoArenaPush(calc, MonoFromPoly(&constant, exp));
+                continue;
+            case LITERAL_POP:
+                if (calc->poly_frames.size == 0)
+                {
+                    break;
+                }
+                PolyDestroy(&current);
+                current = PolyFramePop(calc);
+                if (calc->poly_frames.size == 0)
+                {
+                    *output = current;
+                    return false;
+                }
+                continue;
+        }
+        PolyDestroy(&current);
+        return ParsePolyAbort(calc);
+    }
+}
+
+/**
+ * Wstawia na stos wczytany wielomian, a podczas kompilacji - zapisuje go jako
+ * instrukcję kodu bajtowego.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] p : wielomian (przejmowany na własność)
+ */
+static void PushLiteral(Calculator *calc, Poly *p)
+{
+    if (!calc->bytecode.compiling)
+    {
+        PushPoly(calc, p);
+        return;
+    }
+    EmitInstruction(calc, OPCODE_LITERAL, CurrentLineNumber(calc));
+    EmitLiteral(calc, p);
+    PolyDestroy(p);
+    free(p);
+}
+
+/**
+ * Wczytuje z kodu bajtowego ścieżkę pliku zapisaną przez RunCommand.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[out] path : ścieżka zakończona bajtem 0 (co najmniej
+ *                    MAX_PATH_LENGTH + 1 bajtów)
+ * @return status wykonania (błąd, gdy kod bajtowy jest uszkodzony)
+ */
+static bool DecodePath(Calculator *calc, char *path)
+{
+    unsigned long length;
+    if (DecodeVarint(calc, &length) || length == 0 || length > MAX_PATH_LENGTH)
+    {
+        return true;
+    }
+    for (unsigned long i = 0; i < length; ++i)
+    {
+        int c = ReaderNext(&calc->reader);
+        if (c == EOF || c == '\0')
+        {
+            return true;
+        }
+        path[i] = c;
+    }
+    path[length] = '\0';
+    return false;
+}
+
+/**
+ * Wykonuje instrukcję kodu bajtowego o kodzie @p opcode. Argumenty liczbowe
+ * polecenia spoza zakresów sprawdzanych przy parsowaniu tekstu oznaczają
+ * uszkodzony kod bajtowy.
+ * @param[in,out] calc : stan kalkulatora
+ * @param[in] opcode : kod instrukcji
+ * @return status wykonania (błąd, gdy kod bajtowy jest uszkodzony)
+ */
+static bool RunInstruction(Calculator *calc, int opcode)
+{
+    unsigned long delta;
+    if (DecodeVarint(calc, &delta))
+    {
+        return true;
+    }
+    calc->bytecode.line += delta;
+    if (opcode >= 0 && (size_t)opcode < COMMAND_COUNT)
+    {
+        const Command *command = &COMMANDS[opcode];
+        CommandArguments args;
+        for (unsigned i = 0; i < command->argument_count; ++i)
+        {
+            if (DecodeSigned(calc, &args.numbers[i]))
+            {
+                return true;
+            }
+        }
+        if (command->ArgumentsInRange != NULL &&
+            !command->ArgumentsInRange(calc, &args))
+        {
+            return true;
+        }
+        if (command->path_argument && DecodePath(calc, args.path))
+        {
+            return true;
+        }
+        ExecuteCommand(calc, command, &args);
+        return false;
+    }
+    if (opcode == OPCODE_LITERAL)
+    {
+        Poly *p = PolyMalloc();
+        if (DecodeLiteral(calc, p))
+        {
+            free(p);
+            return true;
+        }
+        PushPoly(calc, p);
+        return false;
+    }
+    if (opcode == OPCODE_ERROR)
+    {
+        int error = ReaderNext(&calc->reader);
+        unsigned long column = 0;
+        if (error == EOF || error >= ERROR_COUNT ||
+            (error == ERROR_PARSE_POLY && DecodeVarint(calc, &column)))
+        {
+            return true;
+        }
+        ThrowError(calc, error, calc->bytecode.line, column);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Wykonuje kod bajtowy wczytywany przez czytnik wejścia.
+ * @param[in,out] calc : stan kalkulatora
+ * @return status wykonania (błąd, gdy kod bajtowy jest uszkodzony)
+ */
+static bool RunBytecode(Calculator *calc)
+{
+    for (size_t i = 0; i < sizeof(BYTECODE_MAGIC); ++i)
+    {
+        if (ReaderNext(&calc->reader) != BYTECODE_MAGIC[i])
+        {
+            return true;
+        }
+    }
+    calc->bytecode.running = true;
+    int opcode;
+    while ((opcode = ReaderNext(&calc->reader)) != EOF)
+    {
+        if (RunInstruction(calc, opcode))
+        {
+            return true;
+        }
+        if (ReaderBlockConsumed(&calc->reader))
+        {
+            PrinterFlush(&calc->printer);
+        }
+    }
+    return false;
+}
+
+/**
+ * Interpretuje jedną linię standardowego wejścia dla kalkulatora.
+ * Założenie - po wykonaniu tego polecenia w buforze znajdować się będzie
+ * ostatni znak zinterpretowanego właśnie wiersza.
+ * @param[in,out] calc : stan kalkulatora
+ */
+static void ParseLine(Calculator *calc)
+{
+    ReadCharacter(calc);
+    if (BufferIsLetter(calc))
+    {
+        if (ParseCommand(calc))
+        {
+            ReadUntilNewline(calc);
+        }
+    }
+    else if (BufferIsEndline(calc))
+    {
+    }
+    else
+    {
+        Poly *new_poly = PolyMalloc();
+        if (ParsePoly(calc, new_poly) || !BufferIsEndline(calc))
+        {
+            free(new_poly);
+            ThrowParsePolyError(calc);
+            ReadUntilNewline(calc);
+        }
+        else
+        {
+            PushLiteral(calc, new_poly);
+        }
+    }
+    if (!BufferIsEndline(calc))
+    {
+        assert(false);
+    }
+}
+
+/**
+ * Interpretuje kolejne wiersze wejścia aż do jego końca.
+ * @param[in,out] calc : stan kalkulatora
+ */
+static void RunScript(Calculator *calc)
+{
+    calc->read_buffer = 1;
+    while (calc->read_buffer != EOF)
+    {
+        ParseLine(calc);
+        if (ReaderBlockConsumed(&calc->reader))
+        {
+            PrinterFlush(&calc->printer);
+            if (calc->bytecode.compiling)
+            {
+                PrinterFlush(&calc->bytecode.output);
+            }
+        }
+    }
+}
+
+/**
+ * Sprawdza, czy pierwszym wierszem pliku o ścieżce @p path jest `START`.
+ * @param[in] path : ścieżka pliku
+ * @return Czy plik rozpoczyna łańcuch skryptów?
+ */
+static bool IsChainStart(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        return false;
+    }
+    char line[sizeof("START\n")];
+    bool start = fgets(line, sizeof(line), file) != NULL &&
+                 (strcmp(line, "START\n") == 0 || strcmp(line, "START") == 0);
+    fclose(file);
+    return start;
+}
+
+/**
+ * Wyszukuje w katalogu @p directory skrypt rozpoczynający łańcuch, czyli plik,
+ * którego pierwszym wierszem jest `START`. Spośród kilku takich plików
+ * wybierany jest ten o najmniejszej nazwie.
+ * @param[in] directory : katalog
+ * @param[out] path     : ścieżka skryptu (co najmniej MAX_PATH_LENGTH + 1
+ *                        bajtów)
+ * @return Czy znaleziono skrypt?
+ */
+static bool FindChainStart(const char *directory, char *path)
+{
+    DIR *dir = opendir(directory);
+    if (dir == NULL)
+    {
+        return false;
+    }
+    char candidate[MAX_PATH_LENGTH + 1];
+    const char *best = NULL;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        int length = snprintf(candidate, sizeof(candidate), "%s/%s",
+                              directory, entry->d_name);
+        if (length < 0 || (size_t)length >= sizeof(candidate) ||
+            (best != NULL && strcmp(entry->d_name, best) >= 0) ||
+            !IsChainStart(candidate))
+        {
+            continue;
+        }
+        strcpy(path, candidate);
+        best = path + strlen(directory) + 1;
+    }
+    closedir(dir);
+    return best != NULL;
+}
+
+/**
+ * Wykonuje łańcuch skryptów z katalogu @p directory, rozpoczynając od skryptu
+ * zaczynającego się wierszem `START`. Każdy skrypt wykonywany jest bez
+ * ostatniego wiersza, który wskazuje kolejny skrypt (`FILE nazwa`, nazwa
+ * względem katalogu) lub kończy łańcuch (`STOP`). Inny ostatni wiersz kończy
+ * łańcuch komunikatem `parse error`. Na wyjście trafiają tylko wyniki
+ * ostatniego skryptu.
+ * @param[in,out] calc  : stan kalkulatora
+ * @param[in] directory : katalog ze skryptami
+ * @return status wykonania (błąd, gdy nie udało się przeczytać skryptu)
+ */
+static bool RunChain(Calculator *calc, const char *directory)
+{
+    char path[MAX_PATH_LENGTH + 1];
+    if (!FindChainStart(directory, path))
+    {
+        fprintf(stderr, "Cannot find START in %s\n", directory);
+        return true;
+    }
+    bool first = true;
+    bool next = true;
+    while (next)
+    {
+        if (!ReaderInitMapped(&calc->reader, path))
+        {
+            fprintf(stderr, "Cannot read %s\n", path);
+            return true;
+        }
+        //wiersze ze stosem poprzedzają skrypt, a wiersz START jest pomijany
+        calc->chain.line_offset = calc->poly_stack.size;
+        if (first)
+        {
+            ReaderSkipLine(&calc->reader);
+            calc->chain.line_offset -= 1;
+            first = false;
+        }
+        size_t length;
+        const char *last = ReaderDetachLastLine(&calc->reader, &length);
+        next = length > 5 && strncmp(last, "FILE ", 5) == 0;
+        if (next)
+        {
+            int path_length = snprintf(path, sizeof(path), "%s/%.*s",
+                                       directory, (int)(length - 5), last + 5);
+            if (path_length < 0 || (size_t)path_length >= sizeof(path) ||
+                memchr(last, '\0', length) != NULL)
+            {
+                path[0] = '\0'; //ścieżki nie da się otworzyć
+            }
+        }
+        else if (length != 4 || strncmp(last, "STOP", 4) != 0)
+        {
+            PrinterPutString(&calc->printer, "parse error\n");
+        }
+        calc->chain.carrying = next;
+        RunScript(calc);
+        ReaderDestroy(&calc->reader);
+        if (next)
+        {
+            CalculatorStackDestroy(calc);
+            calc->poly_stack = calc->chain.carried;
+            calc->chain.carried = NewPointerStack();
+            if (calc->lazy)
+            {
+                LazyStackWrap(calc, calc->poly_stack.size);
+            }
+        }
+    }
+    return false;
+}
+
 /**
- * Wykonuje daną operację jedynie, gdy na stosie jest wystarczająca liczba elementów.
- * W przeciwnym wypadku zwraca błąd i wypisuje komunikat.
- * @param[in]  size_requirement : wymagana liczba elementów na stosie
- * @param[in]  Procedure        : procedura do wykonania
- * @return                  status wykonania operacji na stosie
+ * Przygotowuje stan kalkulatora z pustym stosem. Czytnik wejścia przygotowuje
+ * wywołujący - do tego czasu jest pusty.
+ * @param[out] calc        : stan kalkulatora
+ * @param[in] output       : plik, do którego wypisywane są wyniki
+ * @param[in] errors       : plik, do którego wypisywane są komunikaty błędów
+ * @param[in] thread_count : liczba wątków ustalona argumentem `--threads`
+ */
+static void CalculatorInit(Calculator *calc, FILE *output, FILE *errors,
+                           unsigned thread_count)
+{
+    *calc = (Calculator) {.read_buffer = 1, .errors = errors,
+                          .thread_count = thread_count};
+    PrinterInit(&calc->printer, output);
+    calc->poly_stack = NewPointerStack();
+    calc->chain.carried = NewPointerStack();
+    MemoCacheInit(&calc->memo, 0);
+}
+
+/**
+ * Wypisuje statystyki pamięci podręcznej kalkulatora na wyjście błędów.
+ * @param[in] calc : stan kalkulatora
+ */
+static void PrintMemoStatistics(const Calculator *calc)
+{
+    unsigned long long lookups = calc->memo.hits + calc->memo.misses;
+    fprintf(calc->errors, "Memo: %llu hits, %llu misses (%.1f%% hit rate), "
+            "%llu evictions\n", calc->memo.hits, calc->memo.misses,
+            lookups == 0 ? 0.0 : 100.0 * calc->memo.hits / lookups,
+            calc->memo.evictions);
+}
+
+/**
+ * Opróżnia bufor drukarki wyjścia kalkulatora i zwalnia pamięć jego stanu.
+ * Jeśli pamięć podręczna była włączona, wypisuje jej statystyki.
+ * @param[in,out] calc : stan kalkulatora
  */
-static bool ExecuteOnPolyStack(unsigned size_requirement, void (*Procedure)())
+static void CalculatorDestroy(Calculator *calc)
 {
-    if (global_pcalc_poly_stack.size >= size_requirement)
+    PrinterFlush(&calc->printer);
+    if (calc->memo.budget > 0)
     {
-        Procedure();
-        return false;
+        PrintMemoStatistics(calc);
     }
-    else
+    MemoCacheDestroy(&calc->memo);
+    CalculatorStackDestroy(calc);
+    PolyStackDestroy(&calc->chain.carried);
+    free(calc->mono_arena.monos);
+    free(calc->poly_frames.bases);
+    ReaderDestroy(&calc->reader);
+}
+
+/**
+ * Zbiór niezależnych skryptów wykonywanych w trybie `--batch`.
+ */
+typedef struct Batch
+{
+    char **paths; ///< ścieżki skryptów
+    unsigned count; ///< liczba skryptów
+    unsigned capacity; ///< rozmiar tablicy ścieżek
+    unsigned thread_count; ///< liczba wątków ustalona argumentem `--threads`
+    bool lazy; ///< czy skrypty wykonywane są w trybie `--lazy`
+    size_t memo_budget; ///< budżet pamięci podręcznej każdego skryptu w bajtach
+    atomic_uint failed; ///< liczba skryptów, których nie udało się wykonać
+} Batch;
+
+/**
+ * Dokłada do zbioru skryptów skrypt o ścieżce @p path długości @p length.
+ * @param[in,out] batch : zbiór skryptów
+ * @param[in] path      : ścieżka (niekoniecznie zakończona bajtem 0)
+ * @param[in] length    : długość ścieżki
+ */
+static void BatchAdd(Batch *batch, const char *path, size_t length)
+{
+    if (batch->count == batch->capacity)
     {
-        return ThrowStackUnderflow();
+        batch->capacity = batch->capacity > 0 ? 2 * batch->capacity : 16;
+        batch->paths = realloc(batch->paths,
+                               batch->capacity * sizeof(char*));
+        assert(batch->paths);
     }
+    char *copy = malloc(length + 1);
+    assert(copy);
+    memcpy(copy, path, length);
+    copy[length] = '\0';
+    batch->paths[batch->count++] = copy;
 }
 
 /**
- * Parsuje argument dla poleceń kalkulatora zawierających argument.
- * @param[out]  out         : wyjście parsera
- * @param[in]   lower_limit : dolny zakres liczby do wczytania
- * @param[in]   upper_limit : górny zakres liczby do wczytania
- * @return      status wykonania parsowania
+ * Porównuje ścieżki skryptów dla funkcji qsort.
+ * @param[in] a : wskaźnik na ścieżkę
+ * @param[in] b : wskaźnik na ścieżkę
+ * @return wynik porównania ścieżek
  */
-static bool ParseArgument(long *out, long lower_limit, long upper_limit)
+static int CompareScriptPaths(const void *a, const void *b)
 {
-    if (!BufferIsNumber())
+    return strcmp(*(char *const*)a, *(char *const*)b);
+}
+
+/**
+ * Sprawdza, czy nazwa pliku kończy się przyrostkiem @p suffix.
+ * @param[in] name   : nazwa pliku
+ * @param[in] suffix : przyrostek
+ * @return Czy nazwa kończy się przyrostkiem?
+ */
+static bool HasSuffix(const char *name, const char *suffix)
+{
+    size_t length = strlen(name), suffix_length = strlen(suffix);
+    return length >= suffix_length &&
+           strcmp(name + length - suffix_length, suffix) == 0;
+}
+
+/**
+ * Wyznacza skrypty trybu `--batch`: wszystkie pliki katalogu @p source
+ * (poza plikami wyników `.out` i `.err`, w kolejności nazw) albo - gdy
+ * @p source nie jest katalogiem - ścieżki z kolejnych niepustych wierszy
+ * pliku @p source.
+ * @param[out] batch : zbiór skryptów
+ * @param[in] source : katalog lub plik z listą skryptów
+ * @return Czy udało się wyznaczyć skrypty?
+ */
+static bool BatchCollect(Batch *batch, const char *source)
+{
+    DIR *dir = opendir(source);
+    if (dir != NULL)
     {
+        char path[MAX_PATH_LENGTH + 1];
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL)
+        {
+            int length = snprintf(path, sizeof(path), "%s/%s", source,
+                                  entry->d_name);
+            struct stat info;
+            if (length < 0 || (size_t)length >= sizeof(path) ||
+                stat(path, &info) != 0 || !S_ISREG(info.st_mode) ||
+                HasSuffix(entry->d_name, ".out") ||
+                HasSuffix(entry->d_name, ".err"))
+            {
+                continue;
+            }
+            BatchAdd(batch, path, length);
+        }
+        closedir(dir);
+        qsort(batch->paths, batch->count, sizeof(char*), CompareScriptPaths);
         return true;
     }
-    long arg;
-    if (ParseNumber(lower_limit, upper_limit, &arg))
+    size_t size;
+    char *list = (char*)ReadWholeFile(source, &size);
+    if (list == NULL)
     {
-        return true;
+        return false;
+    }
+    size_t begin = 0;
+    while (begin < size)
+    {
+        const char *newline = memchr(list + begin, '\n', size - begin);
+        size_t end = newline != NULL ? (size_t)(newline - list) : size;
+        if (end > begin)
+        {
+            BatchAdd(batch, list + begin, end - begin);
+        }
+        begin = end + 1;
+    }
+    free(list);
+    return true;
+}
+
+/**
+ * Otwiera do zapisu plik o ścieżce skryptu @p path z przyrostkiem @p suffix.
+ * @param[in] path   : ścieżka skryptu
+ * @param[in] suffix : przyrostek
+ * @return plik lub NULL w razie błędu
+ */
+static FILE* OpenScriptResult(const char *path, const char *suffix)
+{
+    char result_path[MAX_PATH_LENGTH + 1];
+    int length = snprintf(result_path, sizeof(result_path), "%s%s", path,
+                          suffix);
+    if (length < 0 || (size_t)length >= sizeof(result_path))
+    {
+        return NULL;
+    }
+    return fopen(result_path, "w");
+}
+
+/**
+ * Wykonuje skrypt o indeksie @p idx zbioru skryptów z własnym stanem
+ * kalkulatora. Wyniki zapisywane są do pliku o ścieżce skryptu
+ * z przyrostkiem `.out`, a komunikaty błędów - z przyrostkiem `.err`.
+ * @param[in,out] arg : zbiór skryptów (Batch)
+ * @param[in] idx     : indeks skryptu
+ */
+static void RunBatchScript(void *arg, unsigned idx)
+{
+    Batch *batch = arg;
+    const char *path = batch->paths[idx];
+    FILE *output = OpenScriptResult(path, ".out");
+    FILE *errors = OpenScriptResult(path, ".err");
+    Calculator calc;
+    CalculatorInit(&calc, output, errors, batch->thread_count);
+    calc.lazy = batch->lazy;
+    calc.shared_pool = true;
+    MemoCacheSetBudget(&calc.memo, batch->memo_budget);
+    bool failed = output == NULL || errors == NULL ||
+                  !ReaderInitMapped(&calc.reader, path);
+    if (!failed)
+    {
+        RunScript(&calc);
+    }
+    CalculatorDestroy(&calc);
+    if (output != NULL && fclose(output) != 0)
+    {
+        failed = true;
+    }
+    if (errors != NULL && fclose(errors) != 0)
+    {
+        failed = true;
     }
-    if (!BufferIsEndline(global_pcalc_read_buffer))
+    if (failed)
     {
+        fprintf(stderr, "Cannot run %s\n", path);
+        atomic_fetch_add(&batch->failed, 1);
+    }
+}
+
+/**
+ * Wykonuje równolegle niezależne skrypty trybu `--batch`. Skrypty są
+ * zadaniami puli wątków biblioteki, które bezczynne wątki podkradają sobie
+ * nawzajem, więc długie skrypty nie wstrzymują pozostałych.
+ * @param[in] source       : katalog lub plik z listą skryptów
+ * @param[in] thread_count : liczba wątków ustalona argumentem `--threads`
+ * @param[in] lazy         : czy skrypty wykonywane są w trybie `--lazy`
+ * @param[in] memo_budget  : budżet pamięci podręcznej każdego skryptu w bajtach
+ * @return status wykonania (błąd, gdy któregoś skryptu nie udało się wykonać)
+ */
+static bool RunBatch(const char *source, unsigned thread_count, bool lazy,
+                     size_t memo_budget)
+{
+    Batch batch = {.paths = NULL, .count = 0, .capacity = 0,
+                   .thread_count = thread_count, .lazy = lazy,
+                   .memo_budget = memo_budget};
+    atomic_init(&batch.failed, 0);
+    if (!BatchCollect(&batch, source))
+    {
+        fprintf(stderr, "Cannot read %s\n", source);
         return true;
     }
-    *out = arg;
-    return false;
+    PoolParallelFor(batch.count, RunBatchScript, &batch);
+    for (unsigned i = 0; i < batch.count; ++i)
+    {
+        free(batch.paths[i]);
+    }
+    free(batch.paths);
+    return atomic_load(&batch.failed) > 0;
 }
 
 /**
- * Parsuje polecenie ze standardowego wejścia oraz wykonuje je.
- * Parser zwraca niezerowy status wykonania, gdy w trakcie jego działania
- * wystąpi błąd.
- * @return      status wykonania parsowania
+ * Rozpoczyna kompilację skryptu do kodu bajtowego wypisywanego przez
+ * przygotowaną już drukarkę `bytecode.output`.
+ * @param[in,out] calc : stan kalkulatora
  */
-static bool ParseCommand()
+static void StartCompilation(Calculator *calc)
 {
-    static unsigned max_command_length = 20;
-    char command[max_command_length];
-    command[0] = global_pcalc_read_buffer;
-    bool status = scanf("%20s", command + 1); //max_command_length used
-    assert(status);
-    ReadCharacter();
-    if (BufferIsEndline())
+    for (size_t i = 0; i < sizeof(BYTECODE_MAGIC); ++i)
     {
-        if (strcmp(command, "DEG") == 0)
-        {
-            return ExecuteOnPolyStack(1, StackTopDeg);
-        }
-        if (strcmp(command, "IS_COEFF") == 0)
-        {
-            return ExecuteOnPolyStack(1, StackTopIsCoeff);
-        }
-        else if (strcmp(command, "IS_ZERO") == 0)
-        {
-            return ExecuteOnPolyStack(1, StackTopIsZero);
-        }
-        else if (strcmp(command, "PRINT") == 0)
-        {
-            return ExecuteOnPolyStack(1, StackTopPrint);
-        }
-        else if (strcmp(command, "ZERO") == 0)
-        {
-            return ExecuteOnPolyStack(0, StackTopInsertZero);
-        }
-        else if (strcmp(command, "CLONE") == 0)
-        {
-            return ExecuteOnPolyStack(1, StackTopClone);
-        }
-        else if (strcmp(command, "POP") == 0)
-        {
-            return ExecuteOnPolyStack(1, StackTopPop);
-        }
-        else if (strcmp(command, "NEG") == 0)
+        PrinterPutChar(&calc->bytecode.output, BYTECODE_MAGIC[i]);
+    }
+    calc->bytecode.compiling = true;
+}
+
+/** Liczba miejsc w każdej z kolejek łączących etapy trybu `--pipeline`. */
+static const unsigned PIPELINE_QUEUE_CAPACITY = 64;
+
+/**
+ * Stan potoku wykonującego skrypt w trybie `--pipeline`. Skrypt przechodzi
+ * przez trzy etapy działające w osobnych wątkach: parser kompiluje tekst
+ * do kodu bajtowego, wykonawca wykonuje kod bajtowy, a pisarz przekazuje
+ * wyniki na standardowe wyjście. Etapy łączą kolejki bloków, więc czytanie
+ * i analiza kolejnych wierszy oraz wypisywanie wyników nie wstrzymują
+ * obliczeń. Kod bajtowy niesie numery wierszy, a obie kolejki zachowują
+ * kolejność bloków, więc wyniki i komunikaty błędów są takie same jak przy
+ * zwykłym wykonaniu skryptu.
+ */
+typedef struct Pipeline
+{
+    Calculator parser; ///< stan kalkulatora kompilującego skrypt
+    ChunkQueue bytecode; ///< kod bajtowy przekazywany wykonawcy
+    bool holding; ///< czy wykonawca czyta blok zdjęty z kolejki kodu bajtowego
+    ChunkQueue output; ///< wyniki przekazywane pisarzowi
+} Pipeline;
+
+/**
+ * Przekazuje wykonawcy kod bajtowy z bufora drukarki parsera.
+ * @param[in,out] arg : potok
+ * @param[in] data    : kod bajtowy
+ * @param[in] size    : długość kodu bajtowego
+ */
+static void PipelineEmitBytecode(void *arg, const char *data, size_t size)
+{
+    ChunkQueuePush(&((Pipeline*)arg)->bytecode, data, size);
+}
+
+/**
+ * Dostarcza czytnikowi wykonawcy kolejny blok kodu bajtowego, zwalniając
+ * poprzedni.
+ * @param[in,out] arg : potok
+ * @param[out] size   : długość bloku (0 na końcu kodu bajtowego)
+ * @return blok
+ */
+static const char* PipelineNextBytecode(void *arg, size_t *size)
+{
+    Pipeline *pipeline = arg;
+    if (pipeline->holding)
+    {
+        ChunkQueueRelease(&pipeline->bytecode);
+    }
+    pipeline->holding = true;
+    return ChunkQueueFront(&pipeline->bytecode, size);
+}
+
+/**
+ * Przekazuje pisarzowi wyniki z bufora drukarki wykonawcy.
+ * @param[in,out] arg : potok
+ * @param[in] data    : wyniki
+ * @param[in] size    : długość wyników
+ */
+static void PipelineEmitOutput(void *arg, const char *data, size_t size)
+{
+    ChunkQueuePush(&((Pipeline*)arg)->output, data, size);
+}
+
+/**
+ * Kompiluje skrypt do kodu bajtowego w wątku parsera; na końcu wstawia
+ * do kolejki pusty blok.
+ * @param[in,out] arg : potok
+ * @return NULL
+ */
+static void* PipelineParse(void *arg)
+{
+    Pipeline *pipeline = arg;
+    RunScript(&pipeline->parser);
+    PrinterFlush(&pipeline->parser.bytecode.output);
+    ChunkQueueReserve(&pipeline->bytecode);
+    ChunkQueuePublish(&pipeline->bytecode, 0);
+    PolyReleaseThreadCache();
+    return NULL;
+}
+
+/**
+ * Wypisuje na standardowe wyjście bloki wyników aż do pustego bloku.
+ * @param[in,out] arg : potok
+ * @return NULL
+ */
+static void* PipelineWrite(void *arg)
+{
+    Pipeline *pipeline = arg;
+    size_t size;
+    const char *chunk;
+    while ((chunk = ChunkQueueFront(&pipeline->output, &size), size > 0))
+    {
+        fwrite(chunk, 1, size, stdout);
+        ChunkQueueRelease(&pipeline->output);
+    }
+    return NULL;
+}
+
+/**
+ * Wykonuje skrypt potokowo (tryb `--pipeline`). Parser i pisarz działają
+ * w nowych wątkach, a kod bajtowy wykonywany jest w bieżącym.
+ * @param[in] input_path   : ścieżka pliku ze skryptem lub NULL
+ *                           (standardowe wejście)
+ * @param[in] thread_count : liczba wątków ustalona argumentem `--threads`
+ * @param[in] lazy         : czy kod bajtowy wykonywany jest w trybie `--lazy`
+ * @param[in] memo_budget  : budżet pamięci podręcznej w bajtach
+ * @return status wykonania
+ */
+static int RunPipeline(const char *input_path, unsigned thread_count,
+                       bool lazy, size_t memo_budget)
+{
+    Pipeline pipeline = {.holding = false};
+    CalculatorInit(&pipeline.parser, stdout, stderr, thread_count);
+    pipeline.parser.shared_pool = true;
+    if (input_path == NULL)
+    {
+        ReaderInitFile(&pipeline.parser.reader, stdin);
+    }
+    else if (!ReaderInitMapped(&pipeline.parser.reader, input_path))
+    {
+        fprintf(stderr, "Cannot read %s\n", input_path);
+        CalculatorDestroy(&pipeline.parser);
+        return 1;
+    }
+    ChunkQueueInit(&pipeline.bytecode, PIPELINE_QUEUE_CAPACITY,
+                   PRINTER_BUFFER_SIZE);
+    ChunkQueueInit(&pipeline.output, PIPELINE_QUEUE_CAPACITY,
+                   PRINTER_BUFFER_SIZE);
+    PrinterInitSink(&pipeline.parser.bytecode.output, PipelineEmitBytecode,
+                    &pipeline);
+    StartCompilation(&pipeline.parser);
+    Calculator executor;
+    CalculatorInit(&executor, stdout, stderr, thread_count);
+    executor.lazy = lazy;
+    executor.shared_pool = true;
+    MemoCacheSetBudget(&executor.memo, memo_budget);
+    PrinterInitSink(&executor.printer, PipelineEmitOutput, &pipeline);
+    ReaderInitSource(&executor.reader, PipelineNextBytecode, &pipeline);
+    pthread_t parser_thread, writer_thread;
+    int created = pthread_create(&parser_thread, NULL, PipelineParse,
+                                 &pipeline);
+    assert(created == 0);
+    created = pthread_create(&writer_thread, NULL, PipelineWrite, &pipeline);
+    assert(created == 0);
+    (void)created;
+    int status = 0;
+    if (RunBytecode(&executor))
+    {
+        fprintf(stderr, "Invalid bytecode\n");
+        status = 1;
+        while (ReaderNext(&executor.reader) != EOF) //parser nie może utknąć
         {
-            return ExecuteOnPolyStack(1, StackTopNeg);
         }
-        else if (strcmp(command, "IS_EQ") == 0)
+    }
+    PrinterFlush(&executor.printer);
+    ChunkQueueReserve(&pipeline.output);
+    ChunkQueuePublish(&pipeline.output, 0);
+    pthread_join(writer_thread, NULL);
+    pthread_join(parser_thread, NULL);
+    CalculatorDestroy(&executor);
+    CalculatorDestroy(&pipeline.parser);
+    ChunkQueueDestroy(&pipeline.bytecode);
+    ChunkQueueDestroy(&pipeline.output);
+    return status;
+}
+
+/**
+ * Opcje wywołania kalkulatora.
+ */
+typedef struct CalcOptions
+{
+    unsigned thread_count; ///< liczba wątków
+    const char *input_path; ///< ścieżka pliku wejściowego lub NULL
+    const char *compile_path; ///< ścieżka tworzonego pliku z kodem bajtowym lub NULL
+    const char *run_path; ///< ścieżka wykonywanego pliku z kodem bajtowym lub NULL
+    const char *chain_directory; ///< katalog z łańcuchem skryptów lub NULL
+    const char *batch_source; ///< katalog lub lista skryptów trybu `--batch` lub NULL
+    unsigned job_count; ///< liczba skryptów wykonywanych równocześnie lub 0
+    bool pipeline; ///< czy skrypt jest wykonywany potokowo
+    bool lazy; ///< czy stos przechowuje leniwe wyrażenia
+    size_t memo_budget; ///< budżet pamięci podręcznej w bajtach lub 0
+} CalcOptions;
+
+/**
+ * Interpretuje argumenty wywołania kalkulatora. Rozpoznawane są argumenty
+ * `--threads N`, ustalający liczbę wątków używanych przez operacje na
+ * wielomianach, `--input FILE`, wskazujący plik czytany zamiast
+ * standardowego wejścia, `--compile FILE`, kompilujący skrypt do pliku
+ * z kodem bajtowym, `--run FILE`, wykonujący kod bajtowy z pliku, oraz
+ * `--chain DIR`, wykonujący łańcuch skryptów z katalogu,
+ * `--batch DIR|LIST`, wykonujący niezależne skrypty z katalogu lub listy,
+ * po `-j N` naraz, `--pipeline`, wykonujący skrypt potokowo, `--lazy`,
+ * odkładający obliczenia na stosie leniwych wyrażeń, oraz `--memo N`,
+ * zapamiętujący wyniki działań w pamięci podręcznej o budżecie N MiB.
+ * Argumentów `--run`, `--chain` i `--batch` nie można łączyć ze sobą ani
+ * z `--input` i `--compile`, `-j` wymaga `--batch`, `--pipeline` można
+ * połączyć jedynie z `--threads`, `--input`, `--lazy` i `--memo`, a `--lazy`
+ * i `--memo` nie dotyczą `--compile`.
+ * @param[in] argc     : liczba argumentów
+ * @param[in] argv     : argumenty
+ * @param[out] options : opcje wywołania
+ * @return Czy argumenty są poprawne?
+ */
+static bool ParseProgramArguments(int argc, char **argv, CalcOptions *options)
+{
+    *options = (CalcOptions) {.thread_count = 1, .input_path = NULL,
+                              .compile_path = NULL, .run_path = NULL,
+                              .chain_directory = NULL, .batch_source = NULL,
+                              .job_count = 0, .pipeline = false,
+                              .lazy = false, .memo_budget = 0};
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--pipeline") == 0)
         {
-            return ExecuteOnPolyStack(2, StackTopIsEq);
+            options->pipeline = true;
+            continue;
         }
-        else if (strcmp(command, "ADD") == 0)
+        if (strcmp(argv[i], "--lazy") == 0)
         {
-            return ExecuteOnPolyStack(2, StackTopAdd);
+            options->lazy = true;
+            continue;
         }
-        else if (strcmp(command, "MUL") == 0)
+        if (i + 1 == argc)
         {
-            return ExecuteOnPolyStack(2, StackTopMul);
+            return false;
         }
-        else if (strcmp(command, "SUB") == 0)
+        const char *value = argv[++i];
+        if (strcmp(argv[i - 1], "--input") == 0)
         {
-            return ExecuteOnPolyStack(2, StackTopSub);
+            options->input_path = value;
         }
-        else if (strcmp(command, "AT") == 0) //polecenia wymagają argumentu
+        else if (strcmp(argv[i - 1], "--compile") == 0)
         {
-            return ThrowParseAtArgError();
+            options->compile_path = value;
         }
-        else if (strcmp(command, "DEG_BY") == 0)
+        else if (strcmp(argv[i - 1], "--run") == 0)
         {
-            return ThrowParseDegByArgError();
+            options->run_path = value;
         }
-        else if (strcmp(command, "COMPOSE") == 0)
+        else if (strcmp(argv[i - 1], "--chain") == 0)
         {
-            return ThrowParseComposeArgError();
+            options->chain_directory = value;
         }
-        else
+        else if (strcmp(argv[i - 1], "--batch") == 0)
         {
-            return ThrowParseCommandError();
+            options->batch_source = value;
         }
-    }
-    else if (global_pcalc_read_buffer == ' ')
-    {
-        ReadCharacter();
-        if (strcmp(command, "AT") == 0)
+        else if (strcmp(argv[i - 1], "--memo") == 0)
         {
-            poly_coeff_t arg;
-            if (ParseArgument(&arg, LONG_MIN, LONG_MAX))
-            {
-                return ThrowParseAtArgError();
-            }
-            if (global_pcalc_poly_stack.size >= 1)
+            char *end;
+            long megabytes = strtol(value, &end, 10);
+            if (*value == '\0' || *end != '\0' || megabytes < 1 ||
+                megabytes > MAX_MEMO_MEGABYTES)
             {
-                StackTopAt(arg);
                 return false;
             }
-            else
-            {
-                return ThrowStackUnderflow();
-            }
+            options->memo_budget = (size_t)megabytes << 20;
         }
-        else if (strcmp(command, "DEG_BY") == 0)
+        else if (strcmp(argv[i - 1], "--threads") == 0 ||
+                 strcmp(argv[i - 1], "-j") == 0)
         {
-            long arg;
-            if (ParseArgument(&arg, 0, UINT_MAX))
-            {
-                return ThrowParseDegByArgError();
-            }
-            unsigned idx = arg;
-            if (global_pcalc_poly_stack.size >= 1)
+            char *end;
+            long threads = strtol(value, &end, 10);
+            if (*value == '\0' || *end != '\0' || threads < 1 ||
+                threads > MAX_THREAD_COUNT)
             {
-                StackTopDegBy(idx);
                 return false;
             }
-            else
-            {
-                return ThrowStackUnderflow();
-            }
-        }
-        else if (strcmp(command, "COMPOSE") == 0)
-        {
-            long arg;
-            if (ParseArgument(&arg, 0, UINT_MAX))
-            {
-                return ThrowParseComposeArgError();
-            }
-            unsigned count = arg;
-            if (global_pcalc_poly_stack.size > count)
+            if (argv[i - 1][1] == 'j')
             {
-                StackTopCompose(count);
-                return false;
+                options->job_count = threads;
             }
             else
             {
-                return ThrowStackUnderflow();
+                options->thread_count = threads;
             }
         }
         else
         {
-            return ThrowParseCommandError();
+            return false;
         }
-
     }
-    return ThrowParseCommandError();
+    unsigned modes = (options->input_path != NULL ||
+                      options->compile_path != NULL) +
+                     (options->run_path != NULL) +
+                     (options->chain_directory != NULL) +
+                     (options->batch_source != NULL);
+    bool pipeline_alone = options->compile_path == NULL &&
+                          options->run_path == NULL &&
+                          options->chain_directory == NULL &&
+                          options->batch_source == NULL;
+    return modes <= 1 &&
+           (options->job_count == 0 || options->batch_source != NULL) &&
+           (!options->pipeline || pipeline_alone) &&
+           ((!options->lazy && options->memo_budget == 0) ||
+            options->compile_path == NULL);
 }
 
-static bool ParsePoly(Poly *output);
-
 /**
- * Parsuje ze standardowego wejścia jednomian.
- * Parser zwraca niezerowy status wykonania, gdy w trakcie jego działania
- * wystąpi błąd.
- * @param[out] output      : wyjście parsera
- * @return             status wykonania parsowania
+ * Główna funkcja kalkulatora wielomianów.
+ * @param[in] argc : liczba argumentów
+ * @param[in] argv : argumenty
+ * @return status wykonania
  */
-static bool ParseMono(Mono *output)
+int main(int argc, char **argv)
 {
-    Poly *poly_coeff = PolyMalloc();
-    if (ParsePoly(poly_coeff))
+    CalcOptions options;
+    if (!ParseProgramArguments(argc, argv, &options))
     {
-        free(poly_coeff);
-        return true;
-    }
-    if (global_pcalc_read_buffer != ',')
-    {
-        PolyDestroy(poly_coeff);
-        free(poly_coeff);
-        return true;
+        fprintf(stderr, "Usage: %s [--threads N] [--lazy] [--memo MB] "
+                "[--input FILE] "
+                "[--pipeline | --compile FILE | --run FILE | --chain DIR | "
+                "--batch DIR|LIST [-j N]]\n", argv[0]);
+        return 1;
     }
-    ReadCharacter();
-    poly_exp_t e;
-    if (!BufferIsNumber())
+    InitCommandTable();
+    if (options.pipeline)
     {
-        PolyDestroy(poly_coeff);
-        free(poly_coeff);
-        return true;
+        PolySetThreadCount(options.thread_count);
+        int status = RunPipeline(options.input_path, options.thread_count,
+                                 options.lazy, options.memo_budget);
+        PolySetThreadCount(1);
+        PolyReleaseThreadCache();
+        return status;
     }
-    if (ParseExp(&e))
+    if (options.batch_source != NULL)
     {
-        PolyDestroy(poly_coeff);
-        free(poly_coeff);
-        return true;
+        unsigned pool_size = options.job_count > options.thread_count ?
+                             options.job_count : options.thread_count;
+        PolySetThreadCount(pool_size);
+        int status = RunBatch(options.batch_source, options.thread_count,
+                              options.lazy, options.memo_budget);
+        PolySetThreadCount(1);
+        PolyReleaseThreadCache();
+        return status;
     }
-    if (global_pcalc_read_buffer != ')')
+    Calculator calc;
+    CalculatorInit(&calc, stdout, stderr, options.thread_count);
+    calc.lazy = options.lazy;
+    MemoCacheSetBudget(&calc.memo, options.memo_budget);
+    const char *input_path = options.input_path;
+    if (options.run_path != NULL)
     {
-        PolyDestroy(poly_coeff);
-        free(poly_coeff);
-        return true;
+        input_path = options.run_path;
     }
-    ReadCharacter();
-    *output = MonoFromPoly(poly_coeff, e);
-    free(poly_coeff);
-    return false;
-}
-
-/**
- * Parsuje ze standardowego wejścia wielomian.
- * Parser zwraca niezerowy status wykonania, gdy w trakcie jego działania
- * wystąpi błąd.
- * @param[out] output      : wyjście parsera
- * @return             status wykonania parsowania
- */
-static bool ParsePoly(Poly *output)
-{
-    if (global_pcalc_read_buffer == '(')
+    if (input_path != NULL)
     {
-        PointerStack mono_stack = NewPointerStack();
-        while (global_pcalc_read_buffer == '(')
-        {
-            Mono *new_mono = MonoMalloc();
-            ReadCharacter();
-            if (ParseMono(new_mono))
-            {
-                free(new_mono);
-                MonoStackDestroy(&mono_stack);
-                return true;
-            }
-            PushOntoStack(new_mono, &mono_stack);
-            if (BufferIsEndline() || global_pcalc_read_buffer == ',')
-            {
-                break;
-            }
-            else if (global_pcalc_read_buffer == '+')
-            {
-                ReadCharacter();
-                if (global_pcalc_read_buffer != '(')
-                {
-                    MonoStackDestroy(&mono_stack);
-                    return true;
-                }
-            }
-            else
-            {
-                MonoStackDestroy(&mono_stack);
-                return true;
-            }
-        }
-        unsigned monos_size = mono_stack.size;
-        Mono monos[monos_size];
-        for (PointerStack *ptr = &mono_stack; ptr->next_elem != NULL;
-             ptr = ptr->next_elem)
+        if (!ReaderInitMapped(&calc.reader, input_path))
         {
-            monos[ptr->size - 1] = *(Mono*)(GetStackTop(ptr));
+            fprintf(stderr, "Cannot read %s\n", input_path);
+            CalculatorDestroy(&calc);
+            return 1;
         }
-        MonoStackDestroy(&mono_stack);
-        *output = PolyAddMonos(monos_size, monos);
     }
-    else if (BufferIsNumber())
+    else if (options.chain_directory == NULL) //łańcuch otwiera RunChain
     {
-        poly_coeff_t coeff;
-        if (ParseCoeff(&coeff))
-        {
-            return true;
-        }
-        *output = PolyFromCoeff(coeff);
-
+        ReaderInitFile(&calc.reader, stdin);
     }
-    else
+    FILE *bytecode_file = NULL;
+    if (options.compile_path != NULL)
     {
-        return true;
+        bytecode_file = fopen(options.compile_path, "wb");
+        if (bytecode_file == NULL)
+        {
+            fprintf(stderr, "Cannot write %s\n", options.compile_path);
+            CalculatorDestroy(&calc);
+            return 1;
+        }
+        PrinterInit(&calc.bytecode.output, bytecode_file);
+        StartCompilation(&calc);
     }
-    return false;
-}
-
-/**
- * Interpretuje jedną linię standardowego wejścia dla kalkulatora.
- * Założenie - po wykonaniu tego polecenia w buforze znajdować się będzie
- * ostatni znak zinterpretowanego właśnie wiersza.
- */
-static void ParseLine()
-{
-    ReadCharacter();
-    if (BufferIsLetter())
+    PolySetThreadCount(options.thread_count);
+    int status = 0;
+    if (options.run_path != NULL)
     {
-        if (ParseCommand())
+        if (RunBytecode(&calc))
         {
-            ReadUntilNewline();
+            fprintf(stderr, "Invalid bytecode %s\n", options.run_path);
+            status = 1;
         }
     }
-    else if (BufferIsEndline())
+    else if (options.chain_directory != NULL)
     {
+        status = RunChain(&calc, options.chain_directory);
     }
     else
     {
-        Poly *new_poly = PolyMalloc();
-        if (ParsePoly(new_poly) || !BufferIsEndline())
-        {
-            free(new_poly);
-            ThrowParsePolyError();
-            ReadUntilNewline();
-        }
-        else
-        {
-            PushOntoStack(new_poly, &global_pcalc_poly_stack);
-        }
-    }
-    if (!BufferIsEndline())
-    {
-        assert(false);
+        RunScript(&calc);
     }
-}
-
-/**
- * Główna funkcja kalkulatora wielomianów.
- * @return status wykonania
- */
-int main()
-{
-    //inicjalizacja
-    global_pcalc_poly_stack = NewPointerStack();
-    global_pcalc_read_buffer = 1;
-    global_pcalc_line_number = 1;
-    global_pcalc_column_number = 0;
-    while (global_pcalc_read_buffer != EOF)
+    if (bytecode_file != NULL)
     {
-        ParseLine();
+        PrinterFlush(&calc.bytecode.output);
+        if (fclose(bytecode_file) != 0)
+        {
+            fprintf(stderr, "Cannot write %s\n", options.compile_path);
+            status = 1;
+        }
     }
-    PolyStackDestroy(&global_pcalc_poly_stack);
-    return 0;
+    CalculatorDestroy(&calc);
+    PolySetThreadCount(1);
+    PolyReleaseThreadCache();
+    return status;
 }
@@ -0,0 +1,200 @@
+/** @file
+   Implementacja ograniczonej kolejki bloków bez blokad
+
+   @author agent
+   @date 2026-10-19
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include "chunk_queue.h"
+#include "utils.h"
+
+
+/// Liczba sprawdzeń indeksu przed oddaniem procesora przez czekający wątek.
+static const unsigned CHUNK_QUEUE_SPIN_COUNT = 64;
+
+/// Liczba oddań procesora, po której czekający wątek zasypia.
+static const unsigned CHUNK_QUEUE_YIELD_COUNT = 16;
+
+
+/**
+ * @details Implementacja procedury ChunkQueueInit udokumentowanej w pliku
+ * chunk_queue.h.
+ * @param[out] queue     : kolejka
+ * @param[in] capacity   : liczba miejsc na bloki
+ * @param[in] chunk_size : pojemność jednego miejsca w bajtach
+ */
+void ChunkQueueInit(ChunkQueue *queue, unsigned capacity, size_t chunk_size)
+{
+    assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+    queue->data = malloc(capacity * chunk_size);
+    queue->sizes = malloc(capacity * sizeof(size_t));
+    assert(queue->data && queue->sizes);
+    queue->chunk_size = chunk_size;
+    queue->capacity = capacity;
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    atomic_init(&queue->sleepers, 0);
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->wake, NULL);
+}
+
+/**
+ * @details Implementacja procedury ChunkQueueDestroy udokumentowanej w pliku
+ * chunk_queue.h.
+ * @param[in, out] queue : kolejka
+ */
+void ChunkQueueDestroy(ChunkQueue *queue)
+{
+    free(queue->data);
+    free(queue->sizes);
+    queue->data = NULL;
+    queue->sizes = NULL;
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->wake);
+}
+
+/**
+ * Czeka, aż licznik @p counter będzie różny od @p value. Najpierw sprawdza
+ * go w pętli, co pewien czas oddając procesor innym wątkom, a po
+ * wyczerpaniu limitu oddań zasypia na zmiennej warunkowej kolejki.
+ * Zgłoszenie się w `sleepers` poprzedza ponowne sprawdzenie licznika, a drugi
+ * wątek zmienia licznik przed sprawdzeniem `sleepers` (oba w porządku
+ * sekwencyjnym), więc zmiana licznika nie może zostać przeoczona.
+ * @param[in, out] queue : kolejka
+ * @param[in] counter    : licznik zmieniany przez drugi wątek
+ * @param[in] value      : wartość, której zmiany oczekujemy
+ * @return nowa wartość licznika
+ */
+static unsigned ChunkQueueAwait(ChunkQueue *queue, atomic_uint *counter,
+                                unsigned value)
+{
+    unsigned current;
+    for (unsigned yields = 0; yields < CHUNK_QUEUE_YIELD_COUNT; ++yields)
+    {
+        for (unsigned spins = 0; spins < CHUNK_QUEUE_SPIN_COUNT; ++spins)
+        {
+            current = atomic_load_explicit(counter, memory_order_acquire);
+            if (current != value)
+            {
+                return current;
+            }
+        }
+        sched_yield();
+    }
+    pthread_mutex_lock(&queue->lock);
+    atomic_fetch_add(&queue->sleepers, 1);
+    while ((current = atomic_load(counter)) == value)
+    {
+        pthread_cond_wait(&queue->wake, &queue->lock);
+    }
+    atomic_fetch_sub(&queue->sleepers, 1);
+    pthread_mutex_unlock(&queue->lock);
+    return current;
+}
+
+/**
+ * Budzi wątek uśpiony w ChunkQueueAwait po zmianie indeksu kolejki, o ile
+ * taki wątek istnieje.
+ * @param[in, out] queue : kolejka
+ */
+static void ChunkQueueNotify(ChunkQueue *queue)
+{
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&queue->sleepers, memory_order_relaxed) == 0)
+    {
+        return;
+    }
+    pthread_mutex_lock(&queue->lock);
+    pthread_cond_broadcast(&queue->wake);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+/**
+ * @details Implementacja procedury ChunkQueueReserve udokumentowanej w pliku
+ * chunk_queue.h. Miejsce jest wolne, gdy konsument zdjął blok dołożony
+ * `capacity` bloków wcześniej.
+ * @param[in, out] queue : kolejka
+ * @return miejsce na blok
+ */
+char* ChunkQueueReserve(ChunkQueue *queue)
+{
+    unsigned tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    while (tail - head == queue->capacity)
+    {
+        head = ChunkQueueAwait(queue, &queue->head, head);
+    }
+    return queue->data + (tail & (queue->capacity - 1)) * queue->chunk_size;
+}
+
+/**
+ * @details Implementacja procedury ChunkQueuePublish udokumentowanej w pliku
+ * chunk_queue.h.
+ * @param[in, out] queue : kolejka
+ * @param[in] size       : długość bloku
+ */
+void ChunkQueuePublish(ChunkQueue *queue, size_t size)
+{
+    assert(size <= queue->chunk_size);
+    unsigned tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    queue->sizes[tail & (queue->capacity - 1)] = size;
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    ChunkQueueNotify(queue);
+}
+
+/**
+ * @details Implementacja procedury ChunkQueuePush udokumentowanej w pliku
+ * chunk_queue.h.
+ * @param[in, out] queue : kolejka
+ * @param[in] data       : dane
+ * @param[in] size       : długość danych
+ */
+void ChunkQueuePush(ChunkQueue *queue, const char *data, size_t size)
+{
+    while (size > 0)
+    {
+        size_t part = size < queue->chunk_size ? size : queue->chunk_size;
+        memcpy(ChunkQueueReserve(queue), data, part);
+        ChunkQueuePublish(queue, part);
+        data += part;
+        size -= part;
+    }
+}
+
+/**
+ * @details Implementacja procedury ChunkQueueFront udokumentowanej w pliku
+ * chunk_queue.h.
+ * @param[in, out] queue : kolejka
+ * @param[out] size      : długość bloku
+ * @return blok
+ */
+const char* ChunkQueueFront(ChunkQueue *queue, size_t *size)
+{
+    unsigned head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    if (tail == head)
+    {
+        ChunkQueueAwait(queue, &queue->tail, tail);
+    }
+    unsigned slot = head & (queue->capacity - 1);
+    *size = queue->sizes[slot];
+    return queue->data + slot * queue->chunk_size;
+}
+
+/**
+ * @details Implementacja procedury ChunkQueueRelease udokumentowanej w pliku
+ * chunk_queue.h.
+ * @param[in, out] queue : kolejka
+ */
+void ChunkQueueRelease(ChunkQueue *queue)
+{
+    unsigned head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    ChunkQueueNotify(queue);
+}
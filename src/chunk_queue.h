@@ -0,0 +1,105 @@
+/** @file
+   Interfejs ograniczonej kolejki bloków bez blokad
+
+   Kolejka przekazuje bloki bajtów od jednego wątku producenta do jednego
+   wątku konsumenta. Bloki przechowywane są w buforze cyklicznym o stałej
+   liczbie miejsc, przydzielonym raz przy tworzeniu kolejki. Producent może
+   zapisać blok bezpośrednio w wolnym miejscu bufora (ChunkQueueReserve),
+   a konsument czyta go bezpośrednio stamtąd. ChunkQueuePush kopiuje do
+   bufora dane przygotowane przez producenta gdzie indziej (np. w buforze
+   drukarki) - jest to jedyna kopia w drodze między wątkami.
+   Wątki synchronizują się przez atomowe indeksy początku i końca kolejki.
+   Wątek, który musi czekać na wolne miejsce lub na blok, najpierw sprawdza
+   indeks w pętli, co pewien czas oddając procesor, a potem zasypia na
+   zmiennej warunkowej. Drugi wątek sięga po muteks tylko wtedy, gdy ktoś
+   na niej śpi.
+
+   @author agent
+   @date 2026-10-19
+ */
+
+#ifndef __CHUNK_QUEUE_H__
+#define __CHUNK_QUEUE_H__
+
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+
+/// Rozmiar linii pamięci podręcznej; indeksy kolejki leżą w osobnych liniach.
+#define CHUNK_QUEUE_CACHE_LINE 64
+
+/**
+ * Struktura przechowująca stan kolejki.
+ */
+typedef struct ChunkQueue
+{
+    char *data; ///< bufor miejsc na bloki
+    size_t *sizes; ///< długości bloków w kolejnych miejscach
+    size_t chunk_size; ///< pojemność jednego miejsca w bajtach
+    unsigned capacity; ///< liczba miejsc; potęga dwójki
+    alignas(CHUNK_QUEUE_CACHE_LINE) atomic_uint head; ///< licznik zdjętych bloków
+    alignas(CHUNK_QUEUE_CACHE_LINE) atomic_uint tail; ///< licznik dołożonych bloków
+    alignas(CHUNK_QUEUE_CACHE_LINE) atomic_uint sleepers; ///< liczba uśpionych wątków
+    pthread_mutex_t lock; ///< muteks zmiennej warunkowej `wake`
+    pthread_cond_t wake; ///< budzi wątek uśpiony w oczekiwaniu na zmianę indeksu
+} ChunkQueue;
+
+
+/**
+ * Tworzy pustą kolejkę.
+ * @param[out] queue     : kolejka
+ * @param[in] capacity   : liczba miejsc na bloki (potęga dwójki)
+ * @param[in] chunk_size : pojemność jednego miejsca w bajtach
+ */
+void ChunkQueueInit(ChunkQueue *queue, unsigned capacity, size_t chunk_size);
+
+/**
+ * Zwalnia pamięć kolejki.
+ * @param[in, out] queue : kolejka
+ */
+void ChunkQueueDestroy(ChunkQueue *queue);
+
+/**
+ * Czeka na wolne miejsce w kolejce i zwraca je producentowi. Blok staje się
+ * widoczny dla konsumenta dopiero po wywołaniu ChunkQueuePublish.
+ * @param[in, out] queue : kolejka
+ * @return miejsce na blok (`chunk_size` bajtów)
+ */
+char* ChunkQueueReserve(ChunkQueue *queue);
+
+/**
+ * Udostępnia konsumentowi blok zapisany w miejscu zwróconym przez
+ * ChunkQueueReserve. Blok pusty oznacza koniec danych.
+ * @param[in, out] queue : kolejka
+ * @param[in] size       : długość bloku
+ */
+void ChunkQueuePublish(ChunkQueue *queue, size_t size);
+
+/**
+ * Dokłada do kolejki dane o długości @p size, dzieląc je w razie potrzeby
+ * na kilka bloków.
+ * @param[in, out] queue : kolejka
+ * @param[in] data       : dane
+ * @param[in] size       : długość danych
+ */
+void ChunkQueuePush(ChunkQueue *queue, const char *data, size_t size);
+
+/**
+ * Czeka na najstarszy blok kolejki i zwraca go konsumentowi. Blok pozostaje
+ * w kolejce do wywołania ChunkQueueRelease.
+ * @param[in, out] queue : kolejka
+ * @param[out] size      : długość bloku (0 oznacza koniec danych)
+ * @return blok
+ */
+const char* ChunkQueueFront(ChunkQueue *queue, size_t *size);
+
+/**
+ * Zdejmuje z kolejki blok zwrócony przez ChunkQueueFront, zwalniając jego
+ * miejsce dla producenta.
+ * @param[in, out] queue : kolejka
+ */
+void ChunkQueueRelease(ChunkQueue *queue);
+
+#endif /* __CHUNK_QUEUE_H__ */
@@ -0,0 +1,351 @@
+/** @file
+   Implementacja pamięci podręcznej wyników działań na wielomianach
+
+   @author agent
+   @date 2026-10-19
+ */
+
+
+#include <assert.h>
+#include <stdlib.h>
+#include "memo_cache.h"
+#include "utils.h"
+
+
+/// Początkowy rozmiar tablicy list wpisów.
+static const size_t MEMO_INITIAL_BUCKETS = 64;
+
+
+/**
+ * Wpis pamięci podręcznej: klucz, kopie argumentów i wynik działania.
+ */
+struct MemoEntry
+{
+    unsigned op; ///< rodzaj działania
+    long arg; ///< argument liczbowy działania
+    poly_hash_t hash; ///< skrót klucza
+    unsigned count; ///< liczba argumentów
+    Poly *operands; ///< kopie argumentów
+    PolyRef *result; ///< wynik działania
+    size_t bytes; ///< przybliżony rozmiar wpisu w bajtach
+    MemoEntry *next_in_bucket; ///< następny wpis tej samej listy
+    MemoEntry *newer; ///< wpis użyty później (NULL dla ostatnio użytego)
+    MemoEntry *older; ///< wpis użyty wcześniej (NULL dla najdawniej użytego)
+};
+
+
+/**
+ * Szacuje rozmiar pamięci zajmowanej przez wielomian - liczbę jednomianów
+ * mnożymy przez rozmiar jednomianu i tablicy stopni względem zmiennych.
+ * @param[in] p : wielomian
+ * @return przybliżony rozmiar w bajtach
+ */
+static size_t MemoPolyBytes(const Poly *p)
+{
+    return sizeof(Poly) + p->size * sizeof(Mono) +
+           (p->size + 1) * p->depth * sizeof(poly_exp_t);
+}
+
+/**
+ * Miesza bity skrótu (krok generatora splitmix64).
+ * @param[in] h : skrót
+ * @return wymieszany skrót
+ */
+static poly_hash_t MemoMix(poly_hash_t h)
+{
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+/**
+ * Oblicza skrót klucza wpisu.
+ * @param[in] op       : rodzaj działania
+ * @param[in] arg      : argument liczbowy działania
+ * @param[in] count    : liczba wielomianów
+ * @param[in] operands : wielomiany
+ * @return skrót klucza
+ */
+static poly_hash_t MemoKeyHash(unsigned op, long arg, unsigned count,
+                               const Poly *const operands[])
+{
+    poly_hash_t h = MemoMix(((poly_hash_t)op << 32) ^ count);
+    h = MemoMix(h ^ (poly_hash_t)arg);
+    for (unsigned i = 0; i < count; ++i)
+    {
+        h = MemoMix(h ^ PolyHash(operands[i]));
+    }
+    return h;
+}
+
+/**
+ * Sprawdza, czy wpis ma dany klucz.
+ * @param[in] entry    : wpis
+ * @param[in] hash     : skrót klucza
+ * @param[in] op       : rodzaj działania
+ * @param[in] arg      : argument liczbowy działania
+ * @param[in] count    : liczba wielomianów
+ * @param[in] operands : wielomiany
+ * @return Czy klucze są równe?
+ */
+static bool MemoEntryMatches(const MemoEntry *entry, poly_hash_t hash,
+                             unsigned op, long arg, unsigned count,
+                             const Poly *const operands[])
+{
+    if (entry->hash != hash || entry->op != op || entry->arg != arg ||
+        entry->count != count)
+    {
+        return false;
+    }
+    for (unsigned i = 0; i < count; ++i)
+    {
+        if (!PolyIsEq(&entry->operands[i], operands[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Wyjmuje wpis z listy LRU.
+ * @param[in, out] cache : pamięć podręczna
+ * @param[in, out] entry : wpis
+ */
+static void MemoUnlink(MemoCache *cache, MemoEntry *entry)
+{
+    if (entry->newer != NULL)
+    {
+        entry->newer->older = entry->older;
+    }
+    else
+    {
+        cache->newest = entry->older;
+    }
+    if (entry->older != NULL)
+    {
+        entry->older->newer = entry->newer;
+    }
+    else
+    {
+        cache->oldest = entry->newer;
+    }
+}
+
+/**
+ * Wstawia wpis na początek listy LRU jako ostatnio użyty.
+ * @param[in, out] cache : pamięć podręczna
+ * @param[in, out] entry : wpis
+ */
+static void MemoLinkNewest(MemoCache *cache, MemoEntry *entry)
+{
+    entry->newer = NULL;
+    entry->older = cache->newest;
+    if (cache->newest != NULL)
+    {
+        cache->newest->newer = entry;
+    }
+    else
+    {
+        cache->oldest = entry;
+    }
+    cache->newest = entry;
+}
+
+/**
+ * Usuwa wpis z pamięci podręcznej i zwalnia jego pamięć.
+ * @param[in, out] cache : pamięć podręczna
+ * @param[in] entry      : wpis
+ */
+static void MemoRemove(MemoCache *cache, MemoEntry *entry)
+{
+    MemoEntry **ptr = &cache->buckets[entry->hash & (cache->bucket_count - 1)];
+    while (*ptr != entry)
+    {
+        ptr = &(*ptr)->next_in_bucket;
+    }
+    *ptr = entry->next_in_bucket;
+    MemoUnlink(cache, entry);
+    for (unsigned i = 0; i < entry->count; ++i)
+    {
+        PolyDestroy(&entry->operands[i]);
+    }
+    free(entry->operands);
+    PolyRefRelease(entry->result);
+    cache->used -= entry->bytes;
+    cache->entry_count -= 1;
+    free(entry);
+}
+
+/**
+ * Usuwa najdawniej użyte wpisy, dopóki ich rozmiar przekracza @p limit.
+ * @param[in, out] cache : pamięć podręczna
+ * @param[in] limit      : dopuszczalny rozmiar wpisów w bajtach
+ */
+static void MemoEvict(MemoCache *cache, size_t limit)
+{
+    while (cache->used > limit)
+    {
+        MemoRemove(cache, cache->oldest);
+        cache->evictions += 1;
+    }
+}
+
+/**
+ * Podwaja rozmiar tablicy list wpisów (lub przydziela ją przy pierwszym
+ * wpisie), rozdzielając wpisy między nowe listy.
+ * @param[in, out] cache : pamięć podręczna
+ */
+static void MemoGrow(MemoCache *cache)
+{
+    size_t bucket_count = cache->bucket_count == 0 ? MEMO_INITIAL_BUCKETS :
+                          2 * cache->bucket_count;
+    MemoEntry **buckets = calloc(bucket_count, sizeof(MemoEntry*));
+    assert(buckets);
+    for (size_t i = 0; i < cache->bucket_count; ++i)
+    {
+        MemoEntry *entry = cache->buckets[i];
+        while (entry != NULL)
+        {
+            MemoEntry *next = entry->next_in_bucket;
+            MemoEntry **bucket = &buckets[entry->hash & (bucket_count - 1)];
+            entry->next_in_bucket = *bucket;
+            *bucket = entry;
+            entry = next;
+        }
+    }
+    free(cache->buckets);
+    cache->buckets = buckets;
+    cache->bucket_count = bucket_count;
+}
+
+/**
+ * @details Implementacja procedury MemoCacheInit udokumentowanej w pliku
+ * memo_cache.h. Tablica list wpisów przydzielana jest przy pierwszym wpisie.
+ * @param[out] cache : pamięć podręczna
+ * @param[in] budget : budżet pamięci w bajtach
+ */
+void MemoCacheInit(MemoCache *cache, size_t budget)
+{
+    *cache = (MemoCache) {.buckets = NULL, .bucket_count = 0,
+                          .entry_count = 0, .newest = NULL, .oldest = NULL,
+                          .budget = budget, .used = 0, .hits = 0,
+                          .misses = 0, .evictions = 0};
+}
+
+/**
+ * @details Implementacja procedury MemoCacheDestroy udokumentowanej w pliku
+ * memo_cache.h.
+ * @param[in, out] cache : pamięć podręczna
+ */
+void MemoCacheDestroy(MemoCache *cache)
+{
+    while (cache->oldest != NULL)
+    {
+        MemoRemove(cache, cache->oldest);
+    }
+    free(cache->buckets);
+    cache->buckets = NULL;
+    cache->bucket_count = 0;
+}
+
+/**
+ * @details Implementacja procedury MemoCacheSetBudget udokumentowanej
+ * w pliku memo_cache.h.
+ * @param[in, out] cache : pamięć podręczna
+ * @param[in] budget     : budżet pamięci w bajtach
+ */
+void MemoCacheSetBudget(MemoCache *cache, size_t budget)
+{
+    cache->budget = budget;
+    MemoEvict(cache, budget);
+}
+
+/**
+ * @details Implementacja procedury MemoCacheFind udokumentowanej w pliku
+ * memo_cache.h.
+ * @param[in, out] cache : pamięć podręczna
+ * @param[in] op         : rodzaj działania
+ * @param[in] arg        : argument liczbowy działania
+ * @param[in] count      : liczba wielomianów
+ * @param[in] operands   : wielomiany
+ * @return nowa referencja do wyniku lub NULL
+ */
+PolyRef* MemoCacheFind(MemoCache *cache, unsigned op, long arg, unsigned count,
+                       const Poly *const operands[])
+{
+    if (cache->budget == 0)
+    {
+        return NULL;
+    }
+    if (cache->bucket_count > 0)
+    {
+        poly_hash_t hash = MemoKeyHash(op, arg, count, operands);
+        MemoEntry *entry = cache->buckets[hash & (cache->bucket_count - 1)];
+        while (entry != NULL &&
+               !MemoEntryMatches(entry, hash, op, arg, count, operands))
+        {
+            entry = entry->next_in_bucket;
+        }
+        if (entry != NULL)
+        {
+            MemoUnlink(cache, entry);
+            MemoLinkNewest(cache, entry);
+            cache->hits += 1;
+            return PolyRefAcquire(entry->result);
+        }
+    }
+    cache->misses += 1;
+    return NULL;
+}
+
+/**
+ * @details Implementacja procedury MemoCacheInsert udokumentowanej w pliku
+ * memo_cache.h. Rozmiar wpisu szacowany jest przed skopiowaniem argumentów.
+ * @param[in, out] cache : pamięć podręczna
+ * @param[in] op         : rodzaj działania
+ * @param[in] arg        : argument liczbowy działania
+ * @param[in] count      : liczba wielomianów
+ * @param[in] operands   : wielomiany
+ * @param[in] result     : referencja do wyniku
+ */
+void MemoCacheInsert(MemoCache *cache, unsigned op, long arg, unsigned count,
+                     const Poly *const operands[], PolyRef *result)
+{
+    size_t bytes = sizeof(MemoEntry) + MemoPolyBytes(PolyRefGet(result));
+    for (unsigned i = 0; i < count; ++i)
+    {
+        bytes += MemoPolyBytes(operands[i]);
+    }
+    if (bytes > cache->budget)
+    {
+        PolyRefRelease(result);
+        return;
+    }
+    MemoEvict(cache, cache->budget - bytes);
+    if (cache->entry_count >= cache->bucket_count)
+    {
+        MemoGrow(cache);
+    }
+    MemoEntry *entry = malloc(sizeof(MemoEntry));
+    assert(entry);
+    *entry = (MemoEntry) {.op = op, .arg = arg,
+                          .hash = MemoKeyHash(op, arg, count, operands),
+                          .count = count,
+                          .operands = malloc(count * sizeof(Poly)),
+                          .result = result, .bytes = bytes};
+    assert(entry->operands || count == 0);
+    for (unsigned i = 0; i < count; ++i)
+    {
+        entry->operands[i] = PolyClone(operands[i]);
+    }
+    MemoEntry **bucket = &cache->buckets[entry->hash &
+                                         (cache->bucket_count - 1)];
+    entry->next_in_bucket = *bucket;
+    *bucket = entry;
+    MemoLinkNewest(cache, entry);
+    cache->used += bytes;
+    cache->entry_count += 1;
+}
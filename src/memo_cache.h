@@ -0,0 +1,91 @@
+/** @file
+   Interfejs pamięci podręcznej wyników działań na wielomianach
+
+   Pamięć podręczna przechowuje wyniki kosztownych działań kalkulatora
+   (np. mnożenia czy składania) razem z kopiami ich argumentów. Kluczem
+   wpisu jest rodzaj działania, jego argument liczbowy i skróty wielomianów
+   (PolyHash), a przy trafieniu argumenty porównywane są dokładnie, więc
+   kolizja skrótów nie może zwrócić błędnego wyniku. Wyniki są współdzielone
+   przez uchwyty PolyRef. Gdy przybliżony rozmiar wpisów przekroczy budżet
+   pamięci, usuwane są najdawniej używane wpisy (LRU).
+
+   @author agent
+   @date 2026-10-19
+ */
+
+#ifndef __MEMO_CACHE_H__
+#define __MEMO_CACHE_H__
+
+#include <stddef.h>
+#include "poly.h"
+
+
+/** Wpis pamięci podręcznej. */
+typedef struct MemoEntry MemoEntry;
+
+/**
+ * Struktura przechowująca stan pamięci podręcznej.
+ */
+typedef struct MemoCache
+{
+    MemoEntry **buckets; ///< tablica list wpisów o tym samym skrócie modulo jej rozmiar
+    size_t bucket_count; ///< rozmiar tablicy list; potęga dwójki lub 0
+    size_t entry_count; ///< liczba wpisów
+    MemoEntry *newest; ///< ostatnio użyty wpis
+    MemoEntry *oldest; ///< najdawniej użyty wpis
+    size_t budget; ///< budżet pamięci w bajtach (0 wyłącza pamięć podręczną)
+    size_t used; ///< przybliżony rozmiar wpisów w bajtach
+    unsigned long long hits; ///< liczba trafień
+    unsigned long long misses; ///< liczba chybień
+    unsigned long long evictions; ///< liczba wpisów usuniętych z braku miejsca
+} MemoCache;
+
+
+/**
+ * Tworzy pustą pamięć podręczną.
+ * @param[out] cache : pamięć podręczna
+ * @param[in] budget : budżet pamięci w bajtach (0 wyłącza pamięć podręczną)
+ */
+void MemoCacheInit(MemoCache *cache, size_t budget);
+
+/**
+ * Zwalnia pamięć wpisów.
+ * @param[in, out] cache : pamięć podręczna
+ */
+void MemoCacheDestroy(MemoCache *cache);
+
+/**
+ * Zmienia budżet pamięci, usuwając w razie potrzeby najdawniej użyte wpisy.
+ * @param[in, out] cache : pamięć podręczna
+ * @param[in] budget     : budżet pamięci w bajtach (0 wyłącza pamięć podręczną)
+ */
+void MemoCacheSetBudget(MemoCache *cache, size_t budget);
+
+/**
+ * Szuka wyniku działania @p op o argumencie liczbowym @p arg na wielomianach
+ * @p operands. Znaleziony wpis staje się ostatnio użytym.
+ * @param[in, out] cache : pamięć podręczna
+ * @param[in] op         : rodzaj działania
+ * @param[in] arg        : argument liczbowy działania
+ * @param[in] count      : liczba wielomianów
+ * @param[in] operands   : wielomiany
+ * @return nowa referencja do wyniku lub NULL, gdy go nie ma
+ */
+PolyRef* MemoCacheFind(MemoCache *cache, unsigned op, long arg, unsigned count,
+                       const Poly *const operands[]);
+
+/**
+ * Zapamiętuje wynik działania @p op o argumencie liczbowym @p arg na
+ * wielomianach @p operands, kopiując je. Wpis, który nie zmieściłby się
+ * w budżecie, nie jest zapamiętywany.
+ * @param[in, out] cache : pamięć podręczna
+ * @param[in] op         : rodzaj działania
+ * @param[in] arg        : argument liczbowy działania
+ * @param[in] count      : liczba wielomianów
+ * @param[in] operands   : wielomiany
+ * @param[in] result     : referencja do wyniku, którą przejmuje pamięć podręczna
+ */
+void MemoCacheInsert(MemoCache *cache, unsigned op, long arg, unsigned count,
+                     const Poly *const operands[], PolyRef *result);
+
+#endif /* __MEMO_CACHE_H__ */
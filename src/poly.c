@@ -8,48 +8,80 @@
 
 
 #include <stdio.h>
+#include <limits.h>
 #include <string.h>
 #include <assert.h>
+#include <pthread.h>
 #include "poly.h"
+#include "printer.h"
+#include "thread_pool.h"
 #include "utils.h"
 
 
 /**
- * Wypisuje wielomian, gdy nazwa jego głównego parametru to @p c.
- * Wypisuje zawartość struktury danego wielomianu na standardowe wyjście.
- * Kolejne zmienne wielomianu sa nazywane kolejnymi literami alfabetu od @p c
- * począwszy.
- * @param[in] p : wielomian
- * @param[in] c : literowa nazwa parametru
+ * @details Implementacja procedury PrinterPutPolyVar udokumentowanej w pliku
+ * poly.h.
+ * Struktura wielomianu przechodzona jest bez rekurencji - na stosie
+ * pamiętane są jednomiany, których współczynniki są właśnie wypisywane.
+ * Głębokość stosu nie przekracza głębokości zagnieżdżenia wielomianu,
+ * a zmienna danego poziomu nazywana jest literą odległą od `a` o ten poziom.
+ * @param[in, out] printer : drukarka
+ * @param[in] p            : wielomian
  */
-static void PrintPolyList(const Poly *p, char c)
+void PrinterPutPolyVar(Printer *printer, const Poly *p)
 {
-    if (p->abs_term > 0)
-    {
-        printf("%ld", p->abs_term);
-    }
-    if (p->abs_term < 0)
+    Mono **stack = NULL;
+    if (p->depth > 0)
     {
-        printf("(%ld)", p->abs_term);
+        stack = malloc(p->depth * sizeof(Mono*));
+        assert(stack);
     }
-    for (Mono *ptr = p->last; ptr != NULL; ptr = ptr->prev)
+    unsigned top = 0;
+    while (true)
     {
-        if (ptr != p->last || p->abs_term != 0)
+        if (p->abs_term > 0)
         {
-            printf("+");
+            PrinterPutLong(printer, p->abs_term);
         }
-        if (PolyIsCoeff(&ptr->p))
+        if (p->abs_term < 0)
         {
-            PrintPolyList(&ptr->p, c + 1);
+            PrinterPutChar(printer, '(');
+            PrinterPutLong(printer, p->abs_term);
+            PrinterPutChar(printer, ')');
         }
-        else
+        Mono *next = p->last;
+        if (next != NULL && p->abs_term != 0)
+        {
+            PrinterPutChar(printer, '+');
+        }
+        while (next == NULL && top > 0)
+        {
+            Mono *mono = stack[--top];
+            if (!PolyIsCoeff(&mono->p))
+            {
+                PrinterPutChar(printer, ')');
+            }
+            PrinterPutChar(printer, 'a' + top);
+            PrinterPutChar(printer, '^');
+            PrinterPutLong(printer, mono->exp);
+            next = mono->prev;
+            if (next != NULL)
+            {
+                PrinterPutChar(printer, '+');
+            }
+        }
+        if (next == NULL)
+        {
+            break;
+        }
+        if (!PolyIsCoeff(&next->p))
         {
-            printf("(");
-            PrintPolyList(&ptr->p, c + 1);
-            printf(")");
+            PrinterPutChar(printer, '(');
         }
-        printf("%c^%d", c, ptr->exp);
+        stack[top++] = next;
+        p = &next->p;
     }
+    free(stack);
 }
 
 /**
@@ -60,48 +92,75 @@ static void PrintPolyList(const Poly *p, char c)
  */
 void PrintPolyVar(const Poly *p)
 {
-    PrintPolyList(p, 'a');
+    Printer printer;
+    PrinterInit(&printer, stdout);
+    PrinterPutPolyVar(&printer, p);
+    PrinterFlush(&printer);
 }
 
-
 /**
- * Wypisuje wielomian, gdy niewypisana jeszcze część jego wyrazu wolnego wynosi @p deg.
- * Wypisuje zawartość struktury danego wielomianu na standardowe wyjście.
- * Wielomian wypisywany jest w formacie akceptowanym przez
- * kalkulator wielomianów.
- * @param[in] p : wielomian
- * @param[in] dep : niewypisana część wyrazu wolnego wielomianu
+ * @details Implementacja procedury PrinterPutPoly udokumentowanej w pliku
+ * poly.h.
+ * Struktura wielomianu przechodzona jest bez rekurencji - na stosie
+ * pamiętane są jednomiany, których współczynniki są właśnie wypisywane.
+ * Wyraz wolny wielomianu, którego najmniejszy wykładnik jest równy zeru,
+ * wypisywany jest jako część współczynnika tego jednomianu - jego
+ * niewypisaną część przechowuje zmienna `dep`.
+ * @param[in, out] printer : drukarka
+ * @param[in] p            : wielomian
  */
-static void PrintPolyWithDep(const Poly *p, poly_coeff_t dep)
+void PrinterPutPoly(Printer *printer, const Poly *p)
 {
-    if (PolyIsCoeff(p))
+    Mono **stack = NULL;
+    if (p->depth > 0)
     {
-        printf("%ld", p->abs_term + dep);
+        stack = malloc(p->depth * sizeof(Mono*));
+        assert(stack);
     }
-    else
+    unsigned top = 0;
+    poly_coeff_t dep = 0;
+    while (true)
     {
-        Mono *ptr = p->last;
-        if (ptr->exp != 0 && p->abs_term + dep != 0)
+        if (!PolyIsCoeff(p))
         {
-            printf("(%ld,0)", p->abs_term + dep);
+            Mono *mono = p->last;
+            PrinterPutChar(printer, '(');
+            if (mono->exp != 0 && p->abs_term + dep != 0)
+            {
+                PrinterPutLong(printer, p->abs_term + dep);
+                PrinterPutString(printer, ",0)+(");
+                dep = 0;
+            }
+            else
+            {
+                dep += p->abs_term;
+            }
+            stack[top++] = mono;
+            p = &mono->p;
+            continue;
         }
-        else
+        PrinterPutLong(printer, p->abs_term + dep);
+        Mono *next = NULL;
+        while (next == NULL && top > 0)
         {
-            printf("(");
-            PrintPolyWithDep(&ptr->p, dep + p->abs_term);
-            printf(",%d)", ptr->exp);
-            ptr = ptr->prev;
+            Mono *mono = stack[--top];
+            PrinterPutChar(printer, ',');
+            PrinterPutLong(printer, mono->exp);
+            PrinterPutChar(printer, ')');
+            next = mono->prev;
         }
-        for (; ptr != NULL; ptr = ptr->prev)
+        if (next == NULL)
         {
-            printf("+(");
-            PrintPoly(&ptr->p);
-            printf(",%d)", ptr->exp);
+            break;
         }
+        PrinterPutString(printer, "+(");
+        stack[top++] = next;
+        p = &next->p;
+        dep = 0;
     }
+    free(stack);
 }
 
-
 /**
  * @details Implementacja procedury PrintPoly udokumentowanej w pliku poly.h.
  * Wielomian wypisywany jest w formacie akceptowanym przez
@@ -110,20 +169,121 @@ static void PrintPolyWithDep(const Poly *p, poly_coeff_t dep)
  */
 void PrintPoly(const Poly *p)
 {
-    PrintPolyWithDep(p, 0);
+    Printer printer;
+    PrinterInit(&printer, stdout);
+    PrinterPutPoly(&printer, p);
+    PrinterFlush(&printer);
+}
+
+/**
+ * Pamięć podręczna zwolnionych jednomianów wątku.
+ * Zwolnione jednomiany tworzą listę połączoną polem `next`. Dzięki niej
+ * wątki wykonujące równocześnie operacje na wielomianach rzadko odwołują się
+ * do wspólnego alokatora.
+ */
+typedef struct MonoCache
+{
+    Mono *free_list; ///< lista zwolnionych jednomianów
+    unsigned size; ///< długość listy
+    bool registered; ///< czy zarejestrowano zwolnienie listy przy końcu wątku
+} MonoCache;
+
+#ifdef UNIT_TESTING
+/// W testach jednostkowych pamięć podręczna jest mała, by często się
+/// zapełniała. Testy zwalniają ją po każdym przypadku, by atrapy funkcji
+/// malloc i free mogły wykrywać wycieki pamięci.
+static const unsigned MONO_CACHE_CAPACITY = 1 << 4;
+#else
+/// Największa liczba jednomianów w pamięci podręcznej wątku.
+static const unsigned MONO_CACHE_CAPACITY = 1 << 12;
+#endif
+
+/** Pamięć podręczna jednomianów bieżącego wątku. */
+static _Thread_local MonoCache mono_cache;
+
+/** Klucz, którego destruktor zwalnia pamięć podręczną kończącego się wątku. */
+static pthread_key_t mono_cache_key;
+
+/** Jednokrotna inicjalizacja klucza mono_cache_key. */
+static pthread_once_t mono_cache_key_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Zwalnia wszystkie jednomiany pamięci podręcznej.
+ * @param[in, out] arg : pamięć podręczna (MonoCache)
+ */
+static void MonoCacheRelease(void *arg)
+{
+    MonoCache *cache = arg;
+    while (cache->free_list != NULL)
+    {
+        Mono *m = cache->free_list;
+        cache->free_list = m->next;
+        free(m);
+    }
+    cache->size = 0;
+}
+
+/**
+ * Tworzy klucz mono_cache_key.
+ */
+static void MonoCacheCreateKey()
+{
+    int status = pthread_key_create(&mono_cache_key, MonoCacheRelease);
+    assert(status == 0);
+    (void)status;
 }
 
 /**
  * Alokuje na stercie (ang - heap) miejsce na strukturę Mono.
+ * W pierwszej kolejności używa jednomianów z pamięci podręcznej wątku.
  * @return wskaźnik na nowy obszar w pamięci
  */
 static inline Mono* MonoMalloc()
 {
-    Mono *out = (Mono*)malloc(sizeof(Mono));
+    Mono *out = mono_cache.free_list;
+    if (out != NULL)
+    {
+        mono_cache.free_list = out->next;
+        --mono_cache.size;
+        return out;
+    }
+    out = (Mono*)malloc(sizeof(Mono));
     assert(out);
     return out;
 }
 
+/**
+ * Zwalnia pamięć zajmowaną przez strukturę Mono, odkładając ją do pamięci
+ * podręcznej wątku, jeżeli ta nie jest pełna.
+ * @param[in] m : jednomian
+ */
+static inline void MonoFree(Mono *m)
+{
+    if (mono_cache.size >= MONO_CACHE_CAPACITY)
+    {
+        free(m);
+        return;
+    }
+    if (!mono_cache.registered)
+    {
+        pthread_once(&mono_cache_key_once, MonoCacheCreateKey);
+        pthread_setspecific(mono_cache_key, &mono_cache);
+        mono_cache.registered = true;
+    }
+    m->next = mono_cache.free_list;
+    mono_cache.free_list = m;
+    ++mono_cache.size;
+}
+
+/**
+ * @details Implementacja procedury PolyReleaseThreadCache udokumentowanej
+ * w pliku poly.h.
+ */
+void PolyReleaseThreadCache()
+{
+    MonoCacheRelease(&mono_cache);
+}
+
 /**
  * Łączy jednomiany @p left i @p right tak, by sąsiadowały ze sobą.
  * Modyfikuje wskaźniki na sąsiadów w danych jednomianach.
@@ -169,7 +329,103 @@ void PolyDestroy(Poly *p)
     for (Mono *ptr = p->first; ptr != NULL; ptr = p->first)
     {
         PolyTruncate(p);
-        free(ptr);
+        MonoFree(ptr);
+    }
+    free(p->deg_by);
+    p->deg_by = NULL;
+    p->deg = 0;
+    p->depth = 0;
+    p->size = 0;
+    p->hash = 0;
+}
+
+/**
+ * Zwraca większy z danych wykładników.
+ * @param[in]  a : wykładnik
+ * @param[in]  b : wykładnik
+ * @return 'max(a, b)'
+ */
+static poly_exp_t MaxExp(poly_exp_t a, poly_exp_t b)
+{
+    if (a < b)
+    {
+        return b;
+    }
+    return a;
+}
+
+/**
+ * Dołącza wartość @p value do skrótu @p hash.
+ * Wynik zależy od kolejności dołączania kolejnych wartości.
+ * @param[in] hash  : skrót
+ * @param[in] value : wartość do dołączenia
+ * @return skrót uwzględniający @p value
+ */
+static inline poly_hash_t HashCombine(poly_hash_t hash, poly_hash_t value)
+{
+    return hash ^ (value + UINT64_C(0x9e3779b97f4a7c15) + (hash << 6) + (hash >> 2));
+}
+
+/**
+ * @details Implementacja procedury PolyHash udokumentowanej w pliku poly.h.
+ * Łączy przechowywany skrót listy jednomianów z wyrazem wolnym.
+ * @param[in] p : wielomian
+ * @return skrót wielomianu @p p
+ */
+poly_hash_t PolyHash(const Poly *p)
+{
+    return HashCombine(p->hash, (poly_hash_t)p->abs_term);
+}
+
+/**
+ * Uwzględnia w metadanych wielomianu @p p nowy jednomian o współczynniku @p coeff
+ * i wykładniku @p exp.
+ * Aktualizuje stopień, stopnie względem kolejnych zmiennych, głębokość,
+ * liczbę jednomianów oraz skrót w czasie proporcjonalnym do głębokości @p coeff.
+ * Jednomiany muszą być uwzględniane w kolejności rosnących wykładników.
+ * @param[in, out] p : wielomian
+ * @param[in] coeff  : współczynnik dołączanego jednomianu
+ * @param[in] exp    : wykładnik dołączanego jednomianu
+ */
+static void PolyMetaAddMono(Poly *p, const Poly *coeff, poly_exp_t exp)
+{
+    if (coeff->depth + 1 > p->depth)
+    {
+        p->deg_by = realloc(p->deg_by, (coeff->depth + 1) * sizeof(poly_exp_t));
+        assert(p->deg_by);
+        for (unsigned i = p->depth; i <= coeff->depth; ++i)
+        {
+            p->deg_by[i] = 0;
+        }
+        p->depth = coeff->depth + 1;
+    }
+    p->deg = MaxExp(p->deg, coeff->deg + exp);
+    p->size += coeff->size + 1;
+    p->hash = HashCombine(HashCombine(p->hash, (poly_hash_t)exp), PolyHash(coeff));
+    p->deg_by[0] = MaxExp(p->deg_by[0], exp);
+    for (unsigned i = 0; i < coeff->depth; ++i)
+    {
+        p->deg_by[i + 1] = MaxExp(p->deg_by[i + 1], coeff->deg_by[i]);
+    }
+}
+
+/**
+ * Oblicza od nowa metadane wielomianu na podstawie metadanych jego
+ * współczynników.
+ * Używane, gdy z listy jednomianów wielomianu zostały usunięte elementy.
+ * @param[in, out] p : wielomian
+ */
+static void PolyMetaRecalculate(Poly *p)
+{
+    free(p->deg_by);
+    p->deg_by = NULL;
+    p->deg = 0;
+    p->depth = 0;
+    p->size = 0;
+    p->hash = 0;
+    for (Mono *ptr = p->last; ptr != NULL; ptr = ptr->prev)
+    {
+        PolyMetaAddMono(p, &ptr->p, ptr->exp);
     }
 }
 
@@ -182,6 +438,7 @@ static void PolyAppendMono(Poly *p, Mono val)
 {
     Mono *m = MonoMalloc();
     *m = val;
+    PolyMetaAddMono(p, &m->p, m->exp);
     LinkMonos(m, p->first);
     LinkMonos(NULL, m);
     p->first = m;
@@ -205,14 +462,212 @@ Poly PolyClone(const Poly *p)
     return out;
 }
 
+/// Najmniejszy szacowany koszt operacji na współczynniku (w liczbie
+/// przetwarzanych jednomianów), od którego wykonywana jest ona jako osobne
+/// zadanie puli wątków.
+static const size_t PARALLEL_COEFF_THRESHOLD = 1 << 10;
+
+/** Operacja na współczynniku wykonywana przez CoeffJob. */
+typedef Poly (*CoeffOperation)(const Poly *p, const void *arg);
+
+/**
+ * Obliczenie współczynnika jednomianu wyniku, wykonywane od razu lub jako
+ * zadanie puli wątków.
+ */
+typedef struct CoeffJob
+{
+    CoeffOperation operation; ///< operacja wyznaczająca współczynnik
+    const Poly *p; ///< pierwszy argument operacji
+    const void *arg; ///< drugi argument operacji
+    poly_exp_t exp; ///< wykładnik jednomianu wyniku
+    Poly out; ///< wyznaczony współczynnik
+    PoolTask *task; ///< zadanie puli lub NULL, gdy wynik jest już obliczony
+} CoeffJob;
+
+/**
+ * Sprawdza, czy operacja o danym szacowanym koszcie powinna być dzielona
+ * na zadania puli wątków.
+ * @param[in] estimate : szacowany koszt operacji
+ * @return Czy dzielić operację na zadania?
+ */
+static bool CoeffJobsEnabled(size_t estimate)
+{
+    return PoolThreadCount() > 1 && estimate >= PARALLEL_COEFF_THRESHOLD;
+}
+
+/**
+ * Wykonuje operację obliczenia współczynnika.
+ * @param[in, out] arg : obliczenie (CoeffJob)
+ */
+static void RunCoeffJob(void *arg)
+{
+    CoeffJob *job = arg;
+    job->out = job->operation(job->p, job->arg);
+}
+
+/**
+ * Rozpoczyna obliczenie współczynnika. Gdy szacowany koszt jest duży,
+ * operacja zlecana jest puli wątków, w przeciwnym razie wykonywana od razu.
+ * Struktura @p job nie może zmienić położenia w pamięci do czasu wywołania
+ * CoeffJobFinish.
+ * @param[out] job      : obliczenie
+ * @param[in] exp       : wykładnik jednomianu wyniku
+ * @param[in] operation : operacja
+ * @param[in] p         : pierwszy argument operacji
+ * @param[in] arg       : drugi argument operacji
+ * @param[in] estimate  : szacowany koszt operacji
+ */
+static void CoeffJobStart(CoeffJob *job, poly_exp_t exp,
+                          CoeffOperation operation, const Poly *p,
+                          const void *arg, size_t estimate)
+{
+    *job = (CoeffJob) {.operation = operation, .p = p, .arg = arg,
+        .exp = exp, .task = NULL};
+    if (CoeffJobsEnabled(estimate))
+    {
+        job->task = PoolSpawn(RunCoeffJob, job);
+    }
+    else
+    {
+        RunCoeffJob(job);
+    }
+}
+
+/**
+ * Czeka na zakończenie obliczenia współczynnika.
+ * @param[in, out] job : obliczenie
+ * @return wyznaczony współczynnik
+ */
+static Poly CoeffJobFinish(CoeffJob *job)
+{
+    if (job->task != NULL)
+    {
+        PoolWait(job->task);
+        job->task = NULL;
+    }
+    return job->out;
+}
+
+/**
+ * Tworzy wielomian z wyników obliczeń współczynników, pomijając zerowe.
+ * Obliczenia muszą być uporządkowane rosnąco względem wykładników.
+ * @param[in] abs_term : wyraz wolny wielomianu
+ * @param[in] count    : liczba obliczeń
+ * @param[in] jobs     : obliczenia
+ * @return wielomian
+ */
+static Poly PolyFromCoeffJobs(poly_coeff_t abs_term, unsigned count,
+                              CoeffJob jobs[])
+{
+    Poly out = PolyFromCoeff(abs_term);
+    for (unsigned i = 0; i < count; ++i)
+    {
+        Poly coeff = CoeffJobFinish(&jobs[i]);
+        if (PolyIsZero(&coeff))
+        {
+            PolyDestroy(&coeff);
+        }
+        else
+        {
+            PolyAppendMono(&out, MonoFromPoly(&coeff, jobs[i].exp));
+        }
+    }
+    return out;
+}
+
+/**
+ * Liczy jednomiany głównej zmiennej wielomianu.
+ * @param[in] p : wielomian
+ * @return liczba jednomianów
+ */
+static unsigned PolyMonoCount(const Poly *p)
+{
+    unsigned count = 0;
+    for (Mono *ptr = p->first; ptr != NULL; ptr = ptr->next)
+    {
+        ++count;
+    }
+    return count;
+}
+
+/**
+ * Operacja PolyAdd w postaci CoeffOperation.
+ * @param[in] p   : wielomian
+ * @param[in] arg : wielomian
+ * @return `p + arg`
+ */
+static Poly AddOperation(const Poly *p, const void *arg)
+{
+    return PolyAdd(p, arg);
+}
+
+/**
+ * Operacja PolyClone w postaci CoeffOperation.
+ * @param[in] p   : wielomian
+ * @param[in] arg : nieużywany
+ * @return kopia @p p
+ */
+static Poly CloneOperation(const Poly *p, const void *arg)
+{
+    (void)arg;
+    return PolyClone(p);
+}
+
+/**
+ * Dodaje dwa wielomiany, wyznaczając współczynniki o dużych rozmiarach
+ * w zadaniach puli wątków.
+ * @param[in] p : wielomian
+ * @param[in] q : wielomian
+ * @return `p + q`
+ */
+static Poly PolyAddParallel(const Poly *p, const Poly *q)
+{
+    CoeffJob *jobs = malloc((PolyMonoCount(p) + PolyMonoCount(q)) *
+                            sizeof(CoeffJob));
+    assert(jobs);
+    unsigned count = 0;
+    Mono *p_ptr = p->last, *q_ptr = q->last;
+    while (p_ptr != NULL || q_ptr != NULL)
+    {
+        if (p_ptr != NULL && q_ptr != NULL && p_ptr->exp == q_ptr->exp)
+        {
+            CoeffJobStart(&jobs[count++], p_ptr->exp, AddOperation, &p_ptr->p,
+                          &q_ptr->p, p_ptr->p.size + q_ptr->p.size);
+            p_ptr = p_ptr->prev;
+            q_ptr = q_ptr->prev;
+        }
+        else if (q_ptr == NULL || (p_ptr != NULL && p_ptr->exp < q_ptr->exp))
+        {
+            CoeffJobStart(&jobs[count++], p_ptr->exp, CloneOperation,
+                          &p_ptr->p, NULL, p_ptr->p.size);
+            p_ptr = p_ptr->prev;
+        }
+        else
+        {
+            CoeffJobStart(&jobs[count++], q_ptr->exp, CloneOperation,
+                          &q_ptr->p, NULL, q_ptr->p.size);
+            q_ptr = q_ptr->prev;
+        }
+    }
+    Poly out = PolyFromCoeffJobs(p->abs_term + q->abs_term, count, jobs);
+    free(jobs);
+    return out;
+}
+
 /**
  * @details Implementacja procedury PolyAdd udokumentowanej w pliku poly.h.
+ * Duże współczynniki wielomianów wielu zmiennych wyznaczane są równolegle
+ * przez PolyAddParallel.
  * @param[in] p : wielomian
  * @param[in] q : wielomian
  * @return `p + q`
  */
 Poly PolyAdd(const Poly *p, const Poly *q)
 {
+    if ((p->depth > 1 || q->depth > 1) && CoeffJobsEnabled(p->size + q->size))
+    {
+        return PolyAddParallel(p, q);
+    }
     Poly out = PolyFromCoeff(p->abs_term + q->abs_term);
     Mono *p_ptr = p->last, *q_ptr = q->last;
     Mono buf;
@@ -253,448 +708,2592 @@ Poly PolyAdd(const Poly *p, const Poly *q)
     return out;
 }
 
+/// Najmniejsza liczba jednomianów, od której PolyAddMonos sortuje je
+/// i scala równolegle.
+static const unsigned PARALLEL_SORT_THRESHOLD = 1 << 14;
+
+/// Liczba bitów wykładnika przetwarzanych w jednym przebiegu sortowania
+/// pozycyjnego.
+#define RADIX_BITS 8
+
+/// Liczba kubełków jednego przebiegu sortowania pozycyjnego.
+#define RADIX_SIZE (1 << RADIX_BITS)
+
+/// Liczba przebiegów sortowania pozycyjnego.
+#define RADIX_PASSES ((int)(sizeof(poly_exp_t) * 8 / RADIX_BITS))
+
 /**
- * Porównuje wykładniki dwóch jednomianów.
- * Procedura wykorzystywana do posortowania tablicy jednomianów w PolyAddMonos.
- * @param[in] a : pierwszy jednomian
- * @param[in] b : drugi jednomian
- * @return    0 gdy jednomiany są ustawione w kolejności malejącej względem
- * wykładników \n
- * 1 w przeciwnym wypadku
+ * Zwraca klucz sortowania jednomianu - wykładnik przekształcony tak,
+ * by porządek liczb bez znaku był zgodny z porządkiem wykładników.
+ * @param[in] m : jednomian
+ * @return klucz sortowania
  */
-static int CompareMonos(const void *a, const void *b)
+static inline uint32_t MonoSortKey(const Mono *m)
 {
-    return ((Mono*)a)->exp < ((Mono*)b)->exp;
+    return (uint32_t)m->exp ^ UINT32_C(0x80000000);
 }
 
 /**
- * @details Implementacja procedury PolyAddMonos udokumentowanej w pliku poly.h.
- * Przejmuje na własność zawartość tablicy @p monos.
- * @param[in] count : liczba jednomianów
- * @param[in] monos : tablica jednomianów
- * @return wielomian będący sumą jednomianów
+ * Sortuje stabilnie jednomiany rosnąco względem wykładników w czasie
+ * liniowym (sortowanie pozycyjne). Pomija przebiegi, w których wszystkie
+ * jednomiany mają tę samą cyfrę klucza.
+ * @param[in, out] arr : tablica jednomianów
+ * @param[in] buffer   : pomocnicza tablica o rozmiarze @p count
+ * @param[in] count    : liczba jednomianów
  */
-Poly PolyAddMonos(unsigned count, const Mono monos[])
+static void RadixSortMonos(Mono arr[], Mono buffer[], unsigned count)
 {
-//kopia tablicy wskaźników
-    Mono *arr = calloc(count, sizeof(Mono));
+    unsigned histogram[RADIX_PASSES][RADIX_SIZE];
+    memset(histogram, 0, sizeof(histogram));
     for (unsigned i = 0; i < count; ++i)
     {
-        arr[i] = monos[i];
+        uint32_t key = MonoSortKey(&arr[i]);
+        for (int pass = 0; pass < RADIX_PASSES; ++pass)
+        {
+            ++histogram[pass][(key >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1)];
+        }
     }
-//ustawiam tablicę arr[] w kolejności malejącej względem wykładników
-    qsort(arr, count, sizeof(Mono), CompareMonos);
-    Poly out = PolyZero(), aux;
-    Mono buf = arr[count - 1];
-    for (int i = count - 2; i >= 0; --i)
+    Mono *from = arr, *to = buffer;
+    for (int pass = 0; pass < RADIX_PASSES; ++pass)
     {
-        if (arr[i].exp == buf.exp)
+        unsigned shift = pass * RADIX_BITS;
+        if (histogram[pass][(MonoSortKey(&arr[0]) >> shift) & (RADIX_SIZE - 1)]
+            == count)
         {
-
-            aux = PolyAdd(&buf.p, &arr[i].p);
-            PolyDestroy(&buf.p);
-            PolyDestroy(&arr[i].p);
-            buf.p = aux;
+            continue;
         }
-
-        if (arr[i].exp > buf.exp)
+        unsigned offset = 0;
+        for (unsigned digit = 0; digit < RADIX_SIZE; ++digit)
         {
-            if (!PolyIsZero(&buf.p))
-            {
-                PolyAppendMono(&out, buf);
-            }
-            buf = arr[i];
+            unsigned size = histogram[pass][digit];
+            histogram[pass][digit] = offset;
+            offset += size;
         }
-        if (arr[i].exp < buf.exp)
+        for (unsigned i = 0; i < count; ++i)
         {
-            assert(false);
+            unsigned digit = (MonoSortKey(&from[i]) >> shift) & (RADIX_SIZE - 1);
+            to[histogram[pass][digit]++] = from[i];
         }
+        Mono *aux = from;
+        from = to;
+        to = aux;
     }
-
-    PolyAppendMono(&out, buf);
-    free(arr);
-
-
-    if (out.last->exp == 0)
-    {
-        out.abs_term = out.last->p.abs_term;
-        out.last->p.abs_term = 0;
-    }
-//gdy właśnie wyzerowaliśmy najmniejszy z jednomianów
-    if (PolyIsZero(&out.last->p))
+    if (from != arr)
     {
-        Mono *ptr = out.last->prev;
-        MonoDestroy(out.last);
-        free(out.last);
-        out.last = ptr;
-        if (out.last == NULL)
-        {
-            out.first = NULL;
-        }
-        LinkMonos(out.last, NULL);
+        memcpy(arr, from, count * sizeof(Mono));
     }
-
-    return out;
 }
 
 /**
- * @details Implementacja procedury PolyCoeffMul udokumentowanej w pliku poly.h.
- * @param[in]  p : wielomian
- * @param[in]  x : stała
- * @return 'p * x'
+ * Scala dwie posortowane rosnąco tablice jednomianów.
+ * @param[in] left        : pierwsza tablica
+ * @param[in] left_count  : długość pierwszej tablicy
+ * @param[in] right       : druga tablica
+ * @param[in] right_count : długość drugiej tablicy
+ * @param[out] out        : tablica wynikowa
  */
-Poly PolyCoeffMul(const Poly *p, poly_coeff_t x)
+static void MergeSortedMonos(const Mono left[], unsigned left_count,
+                             const Mono right[], unsigned right_count,
+                             Mono out[])
 {
-    Poly out = PolyFromCoeff(p->abs_term * x);
-    Mono buf;
-    for (Mono *p_ptr = p->last; p_ptr != NULL; p_ptr = p_ptr->prev)
+    unsigned i = 0, j = 0, k = 0;
+    while (i < left_count && j < right_count)
     {
-        buf.exp = p_ptr->exp;
-        buf.p = PolyCoeffMul(&p_ptr->p, x);
-        if (PolyIsZero(&buf.p))
+        if (right[j].exp < left[i].exp)
         {
-            PolyDestroy(&buf.p);
+            out[k++] = right[j++];
         }
         else
         {
-            PolyAppendMono(&out, buf);
+            out[k++] = left[i++];
         }
     }
-    return out;
+    memcpy(out + k, left + i, (left_count - i) * sizeof(Mono));
+    memcpy(out + k + left_count - i, right + j, (right_count - j) * sizeof(Mono));
 }
 
 /**
- * @details Implementacja procedury PolyMul udokumentowanej w pliku poly.h.
- * @param[in] p : wielomian
- * @param[in] q : wielomian
- * @return `p * q`
+ * Tablica jednomianów podzielona na fragmenty sortowane i scalane
+ * równolegle.
  */
-Poly PolyMul(const Poly *p, const Poly *q)
+typedef struct MonoSortJob
 {
-    Poly aux = PolyCoeffMul(q, p->abs_term);
-    Poly buffer = PolyCoeffMul(p, q->abs_term);
-    Poly out = PolyAdd(&aux, &buffer);
-    out.abs_term /= 2;
-    PolyDestroy(&aux);
-    PolyDestroy(&buffer);
-    Mono buf;
-    for (Mono *p_ptr = p->last; p_ptr != NULL; p_ptr = p_ptr->prev)
-    {
-        buffer = PolyZero();
-        for (Mono *q_ptr = q->last; q_ptr != NULL; q_ptr = q_ptr->prev)
-        {
-            buf.exp = p_ptr->exp + q_ptr->exp;
-            buf.p = PolyMul(&p_ptr->p, &q_ptr->p);
-            PolyAppendMono(&buffer, buf);
-        }
-        aux = PolyAdd(&out, &buffer);
-        PolyDestroy(&out);
-        out = aux;
-        PolyDestroy(&buffer);
-    }
-    return out;
-}
+    Mono *from; ///< tablica z posortowanymi fragmentami
+    Mono *to; ///< tablica pomocnicza
+    unsigned count; ///< liczba jednomianów
+    unsigned chunk; ///< długość sortowanych (scalanych) fragmentów
+} MonoSortJob;
 
 /**
- * @details Implementacja procedury PolyNeg udokumentowanej w pliku poly.h.
- * @param[in] p : wielomian
- * @return `-p`
+ * Sortuje fragment o indeksie @p idx.
+ * @param[in, out] arg : tablica (MonoSortJob)
+ * @param[in] idx      : indeks fragmentu
  */
-Poly PolyNeg(const Poly *p)
+static void SortMonoChunk(void *arg, unsigned idx)
 {
-    Poly out = PolyFromCoeff(-p->abs_term);
-    Mono buf;
-    for (Mono *ptr = p->last; ptr != NULL; ptr = ptr->prev)
-    {
-        buf.p = PolyNeg(&ptr->p);
-        buf.exp = ptr->exp;
-        PolyAppendMono(&out, buf);
-    }
-    return out;
+    MonoSortJob *job = arg;
+    unsigned begin = idx * job->chunk;
+    unsigned end = begin + job->chunk < job->count ? begin + job->chunk
+                                                   : job->count;
+    RadixSortMonos(job->from + begin, job->to + begin, end - begin);
 }
 
 /**
- * @details Implementacja procedury PolySub udokumentowanej w pliku poly.h.
- * @param[in] p : wielomian
- * @param[in] q : wielomian
- * @return `p - q`
+ * Scala parę sąsiednich fragmentów o indeksie @p idx do tablicy pomocniczej.
+ * @param[in, out] arg : tablica (MonoSortJob)
+ * @param[in] idx      : indeks pary fragmentów
  */
-Poly PolySub(const Poly *p, const Poly *q)
+static void MergeMonoChunks(void *arg, unsigned idx)
 {
-    Poly neg = PolyNeg(q);
-    Poly out = PolyAdd(p, &neg);
-    PolyDestroy(&neg);
-    return out;
+    MonoSortJob *job = arg;
+    unsigned begin = 2 * idx * job->chunk;
+    unsigned middle = begin + job->chunk < job->count ? begin + job->chunk
+                                                      : job->count;
+    unsigned end = middle + job->chunk < job->count ? middle + job->chunk
+                                                    : job->count;
+    MergeSortedMonos(job->from + begin, middle - begin, job->from + middle,
+                     end - middle, job->to + begin);
 }
 
 /**
- * Zwraca większy z danych wykładników.
- * @param[in]  a : wykładnik
- * @param[in]  b : wykładnik
- * @return 'max(a, b)'
+ * Sortuje stabilnie jednomiany rosnąco względem wykładników równolegle:
+ * fragmenty tablicy sortowane są pozycyjnie w osobnych zadaniach,
+ * a następnie scalane parami.
+ * @param[in, out] arr : tablica jednomianów
+ * @param[in] buffer   : pomocnicza tablica o rozmiarze @p count
+ * @param[in] count    : liczba jednomianów
  */
-static poly_exp_t MaxExp(poly_exp_t a, poly_exp_t b)
+static void ParallelSortMonos(Mono arr[], Mono buffer[], unsigned count)
 {
-    if (a < b)
+    unsigned chunks = PoolThreadCount();
+    MonoSortJob job = {.from = arr, .to = buffer, .count = count,
+        .chunk = (count + chunks - 1) / chunks};
+    PoolParallelFor(chunks, SortMonoChunk, &job);
+    for (; job.chunk < count; job.chunk *= 2)
     {
-        return b;
+        PoolParallelFor((count + 2 * job.chunk - 1) / (2 * job.chunk),
+                        MergeMonoChunks, &job);
+        Mono *aux = job.from;
+        job.from = job.to;
+        job.to = aux;
+    }
+    if (job.from != arr)
+    {
+        memcpy(arr, job.from, count * sizeof(Mono));
     }
-    return a;
 }
 
 /**
- * Zwraca  - zależnie od parametrów - stopień wielomianu ze względu na zadaną
- * zmienną albo stopień całego wielomianu. Dla ujemnych wartości parametru
- * @p var_idx oblicza stopień całego wielomianu wedle specyfikacji PolyDeg.
- * W przeciwnym przypadku oblicza stopień wielomianu dla n-tej z kolei zmiennej
- * wielomianu (dla n = var_idx + 1) według specyfikacji PolyDegBy.
- * @param[in] p       : wielomian
- * @param[in] var_idx : parametr pomocniczy określający działanie procedury
- * @return stopień wielomianu - dla ujemnych @p var_idx \n
- * stopień wielomianu ze względu na zmienną o numerze @p var_idx - w przeciwnym
- * przypadku
+ * Sortuje jednomiany rosnąco względem wykładników. Tablice już posortowane
+ * (rosnąco lub malejąco) rozpoznawane są w czasie liniowym.
+ * @param[in, out] arr : tablica jednomianów
+ * @param[in] count    : liczba jednomianów
  */
-static poly_exp_t PolyDegEvaluate(const Poly *p, long var_idx)
+static void SortMonos(Mono arr[], unsigned count)
 {
-    if (PolyIsZero(p))
+    bool ascending = true, descending = true;
+    for (unsigned i = 1; i < count && (ascending || descending); ++i)
     {
-        return -1;
+        ascending &= arr[i - 1].exp <= arr[i].exp;
+        descending &= arr[i - 1].exp >= arr[i].exp;
     }
-    if (PolyIsCoeff(p))
+    if (ascending)
     {
-        return 0;
+        return;
+    }
+    if (descending)
+    {
+        for (unsigned i = 0, j = count - 1; i < j; ++i, --j)
+        {
+            Mono aux = arr[i];
+            arr[i] = arr[j];
+            arr[j] = aux;
+        }
+        return;
     }
-    if (var_idx == 0)
+    Mono *buffer = malloc(count * sizeof(Mono));
+    assert(buffer);
+    if (PoolThreadCount() > 1 && count >= PARALLEL_SORT_THRESHOLD)
     {
-        return p->first->exp;
+        ParallelSortMonos(arr, buffer, count);
     }
-    poly_exp_t out = 0;
-    for (Mono *ptr = p->last; ptr != NULL; ptr = ptr->prev)
+    else
     {
-        if (var_idx < 0)
+        RadixSortMonos(arr, buffer, count);
+    }
+    free(buffer);
+}
+
+/**
+ * Sumuje jednomiany o równych wykładnikach w posortowanym rosnąco fragmencie
+ * tablicy i pomija jednomiany zerowe. Wynik zapisywany jest na początku
+ * fragmentu.
+ * @param[in, out] arr : fragment tablicy jednomianów
+ * @param[in] count    : długość fragmentu
+ * @return liczba jednomianów wyniku
+ */
+static unsigned MergeEqualMonos(Mono arr[], unsigned count)
+{
+    unsigned out = 0;
+    for (unsigned i = 0; i < count;)
+    {
+        Mono buf = arr[i++];
+        for (; i < count && arr[i].exp == buf.exp; ++i)
+        {
+            Poly aux = PolyAdd(&buf.p, &arr[i].p);
+            PolyDestroy(&buf.p);
+            PolyDestroy(&arr[i].p);
+            buf.p = aux;
+        }
+        if (PolyIsZero(&buf.p))
         {
-            out = MaxExp(out, PolyDegEvaluate(&ptr->p, var_idx) + ptr->exp);
+            PolyDestroy(&buf.p);
         }
         else
         {
-            out = MaxExp(out, PolyDegEvaluate(&ptr->p, var_idx - 1));
+            arr[out++] = buf;
         }
     }
     return out;
 }
 
 /**
- * @details Implementacja procedury PolyDegBy udokumentowanej w pliku poly.h.
- * Zmienne indeksowane są od 0.
- * Zmienna o indeksie 0 oznacza zmienną główną tego wielomianu.
- * Większe indeksy oznaczają zmienne wielomianów znajdujących się
- * we współczynnikach.
- * @param[in] p : wielomian
- * @param[in] var_idx : indeks zmiennej
- * @return stopień wielomianu @p p z względu na zmienną o indeksie @p var_idx
- */
-poly_exp_t PolyDegBy(const Poly *p, unsigned var_idx)
-{
-    return (PolyDegEvaluate(p, var_idx));
-}
-
-///Ujemna liczba podawana przez PolyDeg do PolyDegEvaluate
-///jako alternatywne @p var_idx w celu zliczenia stopnia całego wielomianu
-static const int EVALUATE_DEG = -1;
-
-/**
- * @details Implementacja procedury PolyDeg udokumentowanej w pliku poly.h.
- * @param[in] p : wielomian
- * @return stopień wielomianu @p p
+ * Posortowana tablica jednomianów podzielona na fragmenty scalane równolegle.
+ * Granice fragmentów nie rozdzielają jednomianów o równych wykładnikach.
  */
-poly_exp_t PolyDeg(const Poly *p)
+typedef struct MonoMergeJob
 {
-    return PolyDegEvaluate(p, EVALUATE_DEG);
-}
+    Mono *arr; ///< tablica jednomianów
+    unsigned *bounds; ///< granice fragmentów
+    unsigned *counts; ///< liczby jednomianów fragmentów po scaleniu
+} MonoMergeJob;
 
 /**
- * Sprawdza równość dwóch jednomianów.
- * @param[in] a : jednomian
- * @param[in] b : jednomian
- * @return `a = b`
+ * Scala jednomiany o równych wykładnikach we fragmencie o indeksie @p idx.
+ * @param[in, out] arg : tablica (MonoMergeJob)
+ * @param[in] idx      : indeks fragmentu
  */
-static bool MonoIsEq(const Mono *a, const Mono *b)
+static void MergeEqualMonosChunk(void *arg, unsigned idx)
 {
-    if (a->exp != b->exp)
-    {
-        return false;
-    }
-    return PolyIsEq(&a->p, &b->p);
+    MonoMergeJob *job = arg;
+    job->counts[idx] = MergeEqualMonos(job->arr + job->bounds[idx],
+                                       job->bounds[idx + 1] - job->bounds[idx]);
 }
 
 /**
- * @details Implementacja procedury PolyIsEq udokumentowanej w pliku poly.h.
- * @param[in] p : wielomian
- * @param[in] q : wielomian
- * @return `p = q`
+ * Równolegle sumuje jednomiany o równych wykładnikach w posortowanej rosnąco
+ * tablicy i pomija jednomiany zerowe. Wynik zapisywany jest na początku
+ * tablicy.
+ * @param[in, out] arr : tablica jednomianów
+ * @param[in] count    : liczba jednomianów
+ * @return liczba jednomianów wyniku
  */
-bool PolyIsEq(const Poly *p, const Poly *q)
+static unsigned ParallelMergeEqualMonos(Mono arr[], unsigned count)
 {
-    Mono *p_ptr = p->last, *q_ptr = q->last;
-    while (p_ptr != NULL && q_ptr != NULL)
+    unsigned chunks = PoolThreadCount();
+    unsigned *bounds = malloc((chunks + 1) * sizeof(unsigned));
+    unsigned *counts = malloc(chunks * sizeof(unsigned));
+    assert(bounds && counts);
+    bounds[0] = 0;
+    for (unsigned i = 1; i <= chunks; ++i)
     {
-        if (!MonoIsEq(p_ptr, q_ptr))
+        unsigned bound = i < chunks ? (unsigned)((uint64_t)count * i / chunks)
+                                    : count;
+        if (bound < bounds[i - 1])
         {
-            return false;
+            bound = bounds[i - 1];
         }
-        p_ptr = p_ptr->prev;
-        q_ptr = q_ptr->prev;
+        while (bound > 0 && bound < count && arr[bound].exp == arr[bound - 1].exp)
+        {
+            ++bound;
+        }
+        bounds[i] = bound;
     }
-    if (p_ptr != q_ptr)
+    MonoMergeJob job = {.arr = arr, .bounds = bounds, .counts = counts};
+    PoolParallelFor(chunks, MergeEqualMonosChunk, &job);
+    unsigned out = 0;
+    for (unsigned i = 0; i < chunks; ++i)
     {
-        return false;
+        memmove(arr + out, arr + bounds[i], counts[i] * sizeof(Mono));
+        out += counts[i];
     }
-    return p->abs_term == q->abs_term;
+    free(bounds);
+    free(counts);
+    return out;
 }
 
 /**
- * Oblicza w logarytmicznym czasie wartość liczby @f$x^e@f$.
- * @param[in]  x : liczba do spotęgowania
- * @param[in]  e : wykładnik docelowej potęgi
- * @return @f$x^e@f$
+ * @details Implementacja procedury PolyAddMonosInPlace udokumentowanej w pliku
+ * poly.h. Jednomiany sortowane są w czasie liniowym, a dla dużych tablic
+ * sortowanie i sumowanie jednomianów o równych wykładnikach wykonywane są
+ * równolegle.
+ * @param[in] count      : liczba jednomianów
+ * @param[in, out] monos : tablica jednomianów
+ * @return wielomian będący sumą jednomianów
  */
-static poly_coeff_t FastPower(poly_coeff_t x, poly_exp_t e)
+Poly PolyAddMonosInPlace(unsigned count, Mono monos[])
 {
-    if (e == 0)
+    if (count == 0)
     {
-        return 1;
+        return PolyZero();
     }
-    poly_coeff_t m;
-    if (e % 2 == 0)
+//ustawiam tablicę monos[] w kolejności rosnącej względem wykładników
+    SortMonos(monos, count);
+    if (PoolThreadCount() > 1 && count >= PARALLEL_SORT_THRESHOLD)
     {
-        m = FastPower(x, e / 2);
-        return m * m;
+        count = ParallelMergeEqualMonos(monos, count);
     }
     else
     {
-        return x * FastPower(x, e - 1);
+        count = MergeEqualMonos(monos, count);
+    }
+    Poly out = PolyZero();
+    for (unsigned i = 0; i < count; ++i)
+    {
+        PolyAppendMono(&out, monos[i]);
+    }
+
+    if (out.last == NULL)
+    {
+        return out;
+    }
+    if (out.last->exp == 0)
+    {
+        out.abs_term = out.last->p.abs_term;
+        out.last->p.abs_term = 0;
+    }
+//gdy właśnie wyzerowaliśmy najmniejszy z jednomianów
+    if (PolyIsZero(&out.last->p))
+    {
+        Mono *ptr = out.last->prev;
+        MonoDestroy(out.last);
+        MonoFree(out.last);
+        out.last = ptr;
+        if (out.last == NULL)
+        {
+            out.first = NULL;
+        }
+        LinkMonos(out.last, NULL);
     }
+    PolyMetaRecalculate(&out);
+
+    return out;
 }
 
 /**
- * @details Implementacja procedury PolyAt udokumentowanej w pliku poly.h.
- * Wstawia pod pierwszą zmienną wielomianu wartość @p x.
- * W wyniku może powstać wielomian, jeśli współczynniki są wielomianem
- * i zmniejszane są indeksy zmiennych w takim wielomianie o jeden.
- * Formalnie dla wielomianu @f$p(x_0, x_1, x_2, \ldots)@f$ wynikiem jest
- * wielomian @f$p(x, x_0, x_1, \ldots)@f$.
- * @param[in] p : wielomian
- * @param[in] x : wartość pierwszej ze zmiennych
- * @return @f$p(x, x_0, x_1, \ldots)@f$
+ * @details Implementacja procedury PolyAddMonos udokumentowanej w pliku poly.h.
+ * Przejmuje na własność zawartość tablicy @p monos.
+ * @param[in] count : liczba jednomianów
+ * @param[in] monos : tablica jednomianów
+ * @return wielomian będący sumą jednomianów
  */
-Poly PolyAt(const Poly *p, poly_coeff_t x)
+Poly PolyAddMonos(unsigned count, const Mono monos[])
 {
-    Poly out = PolyFromCoeff(p->abs_term);
-    Poly buffer, aux;
-    poly_coeff_t a = 1, e = 0;
-    for (Mono *ptr = p->last; ptr != NULL; ptr = ptr->prev)
+    if (count == 0)
     {
-        buffer = PolyCoeffMul(&ptr->p, a * FastPower(x, ptr->exp - e));
-        aux = PolyAdd(&buffer, &out);
-        PolyDestroy(&buffer);
-        PolyDestroy(&out);
-        out = aux;
+        return PolyZero();
     }
+//kopia tablicy wskaźników
+    Mono *arr = malloc(count * sizeof(Mono));
+    assert(arr);
+    memcpy(arr, monos, count * sizeof(Mono));
+    Poly out = PolyAddMonosInPlace(count, arr);
+    free(arr);
     return out;
 }
 
 /**
- * Wykonuje dwuargumentową operację i jej wynik zapisuje w pierwszym z wielomianów.
- * Celem tej implementacji jest odzwierciedlenie działania operatorów takich jak np. '+='.
- * @param[in,out] p         : wielomian na którym wykonamy operację
- * @param[in]     operation : operacja do wykonania
- * @param[in]     arg       : argument operacji
+ * Operacja PolyCoeffMul w postaci CoeffOperation.
+ * @param[in] p   : wielomian
+ * @param[in] arg : wskaźnik na stałą
+ * @return `p * (*arg)`
  */
-static void ExecuteBinaryOnPoly(Poly *p, Poly (*operation)(const Poly *a, const Poly *b), const Poly *arg)
+static Poly CoeffMulOperation(const Poly *p, const void *arg)
 {
-    Poly buffer = operation(p, arg);
-    PolyDestroy(p);
-    *p = buffer;
+    return PolyCoeffMul(p, *(const poly_coeff_t*)arg);
+}
+
+/**
+ * Przemnaża wielomian przez stałą, wyznaczając współczynniki o dużych
+ * rozmiarach w zadaniach puli wątków.
+ * @param[in]  p : wielomian
+ * @param[in]  x : stała
+ * @return 'p * x'
+ */
+static Poly PolyCoeffMulParallel(const Poly *p, poly_coeff_t x)
+{
+    CoeffJob *jobs = malloc(PolyMonoCount(p) * sizeof(CoeffJob));
+    assert(jobs);
+    unsigned count = 0;
+    for (Mono *p_ptr = p->last; p_ptr != NULL; p_ptr = p_ptr->prev)
+    {
+        CoeffJobStart(&jobs[count++], p_ptr->exp, CoeffMulOperation, &p_ptr->p,
+                      &x, p_ptr->p.size);
+    }
+    Poly out = PolyFromCoeffJobs(p->abs_term * x, count, jobs);
+    free(jobs);
+    return out;
 }
 
 /**
- * Zwraca wielomian @p p podniesiony do @p exp_left -tej potęgi
- * @param[in]  p        : wielomian do spotęgowania
- * @param[in]  exp_left : potęga, do której podniesiemy wielomian @p p
- * @return          @f$ p ^ \verb|exp_left| @f$
+ * @details Implementacja procedury PolyCoeffMul udokumentowanej w pliku poly.h.
+ * Duże współczynniki wielomianów wielu zmiennych wyznaczane są równolegle
+ * przez PolyCoeffMulParallel.
+ * @param[in]  p : wielomian
+ * @param[in]  x : stała
+ * @return 'p * x'
  */
-static Poly PolyPower(const Poly *p, unsigned exp_left)
+Poly PolyCoeffMul(const Poly *p, poly_coeff_t x)
 {
-    Poly square = PolyClone(p);
-    Poly out = PolyFromCoeff(1);
-    for (unsigned current_power = 1; current_power <= exp_left; current_power *= 2)
+    if (p->depth > 1 && CoeffJobsEnabled(p->size))
+    {
+        return PolyCoeffMulParallel(p, x);
+    }
+    Poly out = PolyFromCoeff(p->abs_term * x);
+    Mono buf;
+    for (Mono *p_ptr = p->last; p_ptr != NULL; p_ptr = p_ptr->prev)
     {
-        if (exp_left % (2 * current_power) != 0)
+        buf.exp = p_ptr->exp;
+        buf.p = PolyCoeffMul(&p_ptr->p, x);
+        if (PolyIsZero(&buf.p))
         {
-            ExecuteBinaryOnPoly(&out, PolyMul, &square);
-            exp_left -= current_power;
+            PolyDestroy(&buf.p);
+        }
+        else
+        {
+            PolyAppendMono(&out, buf);
         }
-        ExecuteBinaryOnPoly(&square, PolyMul, &square);
     }
-    PolyDestroy(&square);
     return out;
 }
 
-static Poly PolySubstitute(const Poly *p, unsigned count, const Poly x[], unsigned level);
+/// Najmniejszy iloczyn rozmiarów czynników, od którego PolyMul dzieli pracę
+/// między wątki puli.
+static const size_t PARALLEL_MUL_THRESHOLD = 1 << 12;
+
+/// Liczba fragmentów pierwszego czynnika przypadających na wątek puli
+/// w równoległym PolyMul.
+static const unsigned PARALLEL_MUL_CHUNKS_PER_THREAD = 4;
 
 /**
- * Podstawia wielomiany pod dany jednomian zgodne z opisem PolyCompose, gdy
- * jest on zależny od zmiennej o numerze @p count.
- * @param[in]  m     : jednomian, pod którego zmienne podstawimy wielomiany
- * @param[in]  count : liczba wielomianów do podstawienia pod zmienne @p p
- * @param[in]  x     : tablica wielomianów do podstawienia pod zmienne @p p
- * @param[in]  level : numer zmiennej od której zależą jednomiany @p p
- * @param[in]  to_substitute : wielomian do podstawienia za zmienną jednomianu @p m
- * @return     wielomian otrzymany w wyniku wykonania operacji podstawiania opisanej w PolyCompose
+ * Operacja PolyMul w postaci CoeffOperation.
+ * @param[in] p   : wielomian
+ * @param[in] arg : wielomian
+ * @return `p * arg`
  */
-static Poly MonoSubstitute(const Mono *m, unsigned count, const Poly x[], unsigned level, const Poly *to_substitute)
+static Poly MulOperation(const Poly *p, const void *arg)
 {
-    Poly out = PolySubstitute(&m->p, count, x, level + 1);
-    ExecuteBinaryOnPoly(&out, PolyMul, to_substitute);
-    return out;
+    return PolyMul(p, arg);
 }
 
 /**
- * Podstawia wielomiany pod dany wielomian zgodne z opisem PolyCompose, gdy
- * jednomiany danego wielomianu są zależne od zmiennej o numerze @p count.
- * @param[in]  p     : wielomian, pod którego zmienne podstawimy wielomiany
- * @param[in]  count : liczba wielomianów do podstawienia pod zmienne @p p
- * @param[in]  x     : tablica wielomianów do podstawienia pod zmienne @p p
- * @param[in]  level : numer zmiennej od której zależą jednomiany @p p
- * @return       wielomian @p p po wykonaniu operacji podstawiania opisanej w PolyCompose
+ * Mnoży wielomian @p q bez wyrazu wolnego przez jednomian @p m.
+ * Gdy współczynniki są wielomianami, ich duże iloczyny wyznaczane są
+ * w zadaniach puli wątków.
+ * @param[in] m : jednomian
+ * @param[in] q : wielomian
+ * @return `m * (q - q->abs_term)`
  */
-static Poly PolySubstitute(const Poly *p, unsigned count, const Poly x[], unsigned level)
+static Poly MulMonoRow(const Mono *m, const Poly *q)
 {
-    Poly sum = PolyFromCoeff(p->abs_term);
-    if (level >= count)
+    if ((m->p.depth > 0 || q->depth > 1) &&
+        CoeffJobsEnabled((m->p.size + 1) * (q->size + 1)))
     {
-        return sum;
+        CoeffJob *jobs = malloc(PolyMonoCount(q) * sizeof(CoeffJob));
+        assert(jobs);
+        unsigned count = 0;
+        for (Mono *q_ptr = q->last; q_ptr != NULL; q_ptr = q_ptr->prev)
+        {
+            CoeffJobStart(&jobs[count++], m->exp + q_ptr->exp, MulOperation,
+                          &m->p, &q_ptr->p,
+                          (m->p.size + 1) * (q_ptr->p.size + 1));
+        }
+        Poly out = PolyFromCoeffJobs(0, count, jobs);
+        free(jobs);
+        return out;
+    }
+    Poly out = PolyZero();
+    Mono buf;
+    for (Mono *q_ptr = q->last; q_ptr != NULL; q_ptr = q_ptr->prev)
+    {
+        buf.exp = m->exp + q_ptr->exp;
+        buf.p = PolyMul(&m->p, &q_ptr->p);
+        PolyAppendMono(&out, buf);
+    }
+    return out;
+}
+
+/**
+ * Mnoży wielomian @p q przez sumę kolejnych jednomianów listy - od @p from
+ * (włącznie) w stronę większych wykładników aż do @p to (wyłącznie).
+ * Wyrazy wolne czynników nie są uwzględniane.
+ * @param[in] from : jednomian rozpoczynający zakres
+ * @param[in] to   : jednomian za końcem zakresu lub NULL
+ * @param[in] q    : wielomian
+ * @return `(from + … ) * (q - q->abs_term)`
+ */
+static Poly MulMonoRange(const Mono *from, const Mono *to, const Poly *q)
+{
+    Poly out = PolyZero(), buffer, aux;
+    for (const Mono *p_ptr = from; p_ptr != to; p_ptr = p_ptr->prev)
+    {
+        buffer = MulMonoRow(p_ptr, q);
+        aux = PolyAdd(&out, &buffer);
+        PolyDestroy(&out);
+        out = aux;
+        PolyDestroy(&buffer);
+    }
+    return out;
+}
+
+/**
+ * Tablica wielomianów sumowanych parami przez PolySumParallel.
+ */
+typedef struct PolySumLevel
+{
+    Poly *parts; ///< sumowane wielomiany
+    unsigned step; ///< odległość sumowanych par w tablicy
+} PolySumLevel;
+
+/**
+ * Dodaje do wielomianu o indeksie `2 * step * idx` wielomian odległy
+ * o `step` i niszczy ten drugi.
+ * @param[in, out] arg : poziom sumowania (PolySumLevel)
+ * @param[in] idx      : indeks pary
+ */
+static void AddPartsPair(void *arg, unsigned idx)
+{
+    PolySumLevel *level = arg;
+    Poly *left = &level->parts[2 * level->step * idx];
+    Poly *right = left + level->step;
+    Poly sum = PolyAdd(left, right);
+    PolyDestroy(left);
+    PolyDestroy(right);
+    *left = sum;
+}
+
+/**
+ * Sumuje wielomiany równolegle, w drzewie dodawań parami.
+ * Przejmuje na własność zawartość tablicy @p parts.
+ * @param[in] count : liczba wielomianów, dodatnia
+ * @param[in] parts : tablica wielomianów
+ * @return suma wielomianów
+ */
+static Poly PolySumParallel(unsigned count, Poly parts[])
+{
+    for (unsigned step = 1; step < count; step *= 2)
+    {
+        PolySumLevel level = {.parts = parts, .step = step};
+        PoolParallelFor((count - step + 2 * step - 1) / (2 * step),
+                        AddPartsPair, &level);
+    }
+    return parts[0];
+}
+
+/**
+ * Fragmenty jednomianów pierwszego czynnika mnożone równolegle.
+ */
+typedef struct MulChunks
+{
+    const Mono **bounds; ///< granice fragmentów dla MulMonoRange
+    const Poly *q; ///< drugi czynnik
+    Poly *parts; ///< iloczyny fragmentów (od indeksu 1)
+} MulChunks;
+
+/**
+ * Mnoży fragment o indeksie @p idx przez drugi czynnik.
+ * @param[in, out] arg : fragmenty (MulChunks)
+ * @param[in] idx      : indeks fragmentu
+ */
+static void MulChunk(void *arg, unsigned idx)
+{
+    MulChunks *chunks = arg;
+    chunks->parts[idx + 1] = MulMonoRange(chunks->bounds[idx],
+                                          chunks->bounds[idx + 1], chunks->q);
+}
+
+/**
+ * Dzieli jednomiany @p p na fragmenty o zbliżonej łącznej liczbie
+ * jednomianów, po kilka na wątek puli. Granice fragmentów zapisywane są
+ * w nowo zaalokowanej tablicy zakończonej wartością NULL.
+ * @param[in] p       : wielomian o co najmniej dwóch jednomianach
+ * @param[out] bounds : granice fragmentów (od najmniejszego wykładnika)
+ * @return liczba fragmentów
+ */
+static unsigned ParallelChunkBounds(const Poly *p, const Mono ***bounds)
+{
+    unsigned max_chunks = PARALLEL_MUL_CHUNKS_PER_THREAD * PoolThreadCount();
+    size_t chunk_size = p->size / max_chunks + 1, weight = 0;
+    *bounds = malloc((max_chunks + 1) * sizeof(Mono*));
+    assert(*bounds);
+    unsigned count = 0;
+    (*bounds)[count++] = p->last;
+    for (const Mono *ptr = p->last; ptr->prev != NULL; ptr = ptr->prev)
+    {
+        weight += ptr->p.size + 1;
+        if (weight >= chunk_size && count < max_chunks)
+        {
+            (*bounds)[count++] = ptr->prev;
+            weight = 0;
+        }
+    }
+    (*bounds)[count] = NULL;
+    return count;
+}
+
+/**
+ * Mnoży wielomiany, dzieląc jednomiany @p p na fragmenty o zbliżonej łącznej
+ * liczbie jednomianów, mnożone przez @p q w osobnych zadaniach puli.
+ * Iloczyny fragmentów sumowane są równolegle w drzewie dodawań. Dodawanie
+ * jest łączne i przemienne, a wynik ma postać kanoniczną, więc jest
+ * identyczny z wynikiem mnożenia sekwencyjnego.
+ * @param[in] p    : wielomian o co najmniej dwóch jednomianach
+ * @param[in] q    : wielomian
+ * @param[in] base : iloczyn części zależnych od wyrazów wolnych
+ * @return `p * q`
+ */
+static Poly PolyMulParallel(const Poly *p, const Poly *q, Poly base)
+{
+    const Mono **bounds;
+    unsigned count = ParallelChunkBounds(p, &bounds);
+    Poly *parts = malloc((count + 1) * sizeof(Poly));
+    assert(parts);
+    parts[0] = base;
+    MulChunks chunks = {.bounds = bounds, .q = q, .parts = parts};
+    PoolParallelFor(count, MulChunk, &chunks);
+    Poly out = PolySumParallel(count + 1, parts);
+    free(parts);
+    free(bounds);
+    return out;
+}
+
+/**
+ * Mnoży wielomiany i dodaje do iloczynu wielomian @p r. Składnik @p r dodawany
+ * jest do iloczynu części zależnych od wyrazów wolnych, od którego zaczyna się
+ * sumowanie iloczynów jednomianów, więc pełny iloczyn nie jest kopiowany
+ * drugi raz przy dodawaniu.
+ * Dla dużych czynników, gdy pula ma więcej niż jeden wątek, mnożenie
+ * wykonywane jest równolegle przez PolyMulParallel.
+ * @param[in] p : wielomian
+ * @param[in] q : wielomian
+ * @param[in] r : wielomian lub NULL
+ * @return `p * q + r`
+ */
+static Poly PolyMulPlus(const Poly *p, const Poly *q, const Poly *r)
+{
+    Poly aux = PolyCoeffMul(q, p->abs_term);
+    Poly buffer = PolyCoeffMul(p, q->abs_term);
+    Poly out = PolyAdd(&aux, &buffer);
+    out.abs_term = p->abs_term * q->abs_term;
+    PolyDestroy(&aux);
+    PolyDestroy(&buffer);
+    if (r != NULL)
+    {
+        aux = PolyAdd(&out, r);
+        PolyDestroy(&out);
+        out = aux;
+    }
+    if (PoolThreadCount() > 1 && p->first != p->last &&
+        (p->size + 1) * (q->size + 1) >= PARALLEL_MUL_THRESHOLD)
+    {
+        return PolyMulParallel(p, q, out);
+    }
+    buffer = MulMonoRange(p->last, NULL, q);
+    aux = PolyAdd(&out, &buffer);
+    PolyDestroy(&out);
+    PolyDestroy(&buffer);
+    return aux;
+}
+
+/**
+ * @details Implementacja procedury PolyMul udokumentowanej w pliku poly.h.
+ * @param[in] p : wielomian
+ * @param[in] q : wielomian
+ * @return `p * q`
+ */
+Poly PolyMul(const Poly *p, const Poly *q)
+{
+    return PolyMulPlus(p, q, NULL);
+}
+
+/**
+ * @details Implementacja procedury PolyMulAdd udokumentowanej w pliku poly.h.
+ * @param[in] p : wielomian
+ * @param[in] q : wielomian
+ * @param[in] r : wielomian
+ * @return `p * q + r`
+ */
+Poly PolyMulAdd(const Poly *p, const Poly *q, const Poly *r)
+{
+    return PolyMulPlus(p, q, r);
+}
+
+/**
+ * @details Implementacja procedury PolyNeg udokumentowanej w pliku poly.h.
+ * @param[in] p : wielomian
+ * @return `-p`
+ */
+Poly PolyNeg(const Poly *p)
+{
+    Poly out = PolyFromCoeff(-p->abs_term);
+    Mono buf;
+    for (Mono *ptr = p->last; ptr != NULL; ptr = ptr->prev)
+    {
+        buf.p = PolyNeg(&ptr->p);
+        buf.exp = ptr->exp;
+        PolyAppendMono(&out, buf);
+    }
+    return out;
+}
+
+/**
+ * @details Implementacja procedury PolySub udokumentowanej w pliku poly.h.
+ * @param[in] p : wielomian
+ * @param[in] q : wielomian
+ * @return `p - q`
+ */
+Poly PolySub(const Poly *p, const Poly *q)
+{
+    Poly neg = PolyNeg(q);
+    Poly out = PolyAdd(p, &neg);
+    PolyDestroy(&neg);
+    return out;
+}
+
+/**
+ * @details Implementacja procedury PolyDegBy udokumentowanej w pliku poly.h.
+ * Zmienne indeksowane są od 0.
+ * Zmienna o indeksie 0 oznacza zmienną główną tego wielomianu.
+ * Większe indeksy oznaczają zmienne wielomianów znajdujących się
+ * we współczynnikach. Stopień odczytywany jest z metadanych wielomianu.
+ * @param[in] p : wielomian
+ * @param[in] var_idx : indeks zmiennej
+ * @return stopień wielomianu @p p z względu na zmienną o indeksie @p var_idx
+ */
+poly_exp_t PolyDegBy(const Poly *p, unsigned var_idx)
+{
+    if (PolyIsZero(p))
+    {
+        return -1;
+    }
+    if (var_idx >= p->depth)
+    {
+        return 0;
+    }
+    return p->deg_by[var_idx];
+}
+
+/**
+ * @details Implementacja procedury PolyDeg udokumentowanej w pliku poly.h.
+ * Stopień odczytywany jest z metadanych wielomianu.
+ * @param[in] p : wielomian
+ * @return stopień wielomianu @p p
+ */
+poly_exp_t PolyDeg(const Poly *p)
+{
+    if (PolyIsZero(p))
+    {
+        return -1;
+    }
+    return p->deg;
+}
+
+/**
+ * Sprawdza równość dwóch jednomianów.
+ * @param[in] a : jednomian
+ * @param[in] b : jednomian
+ * @return `a = b`
+ */
+static bool MonoIsEq(const Mono *a, const Mono *b)
+{
+    if (a->exp != b->exp)
+    {
+        return false;
+    }
+    return PolyIsEq(&a->p, &b->p);
+}
+
+/**
+ * @details Implementacja procedury PolyIsEq udokumentowanej w pliku poly.h.
+ * Wielomiany o różnych wyrazach wolnych, rozmiarach lub skrótach są odrzucane
+ * w czasie stałym. Pełne porównanie struktur wykonywane jest jedynie przy
+ * zgodności skrótów.
+ * @param[in] p : wielomian
+ * @param[in] q : wielomian
+ * @return `p = q`
+ */
+bool PolyIsEq(const Poly *p, const Poly *q)
+{
+    if (p->abs_term != q->abs_term || p->size != q->size || p->hash != q->hash)
+    {
+        return false;
+    }
+    Mono *p_ptr = p->last, *q_ptr = q->last;
+    while (p_ptr != NULL && q_ptr != NULL)
+    {
+        if (!MonoIsEq(p_ptr, q_ptr))
+        {
+            return false;
+        }
+        p_ptr = p_ptr->prev;
+        q_ptr = q_ptr->prev;
+    }
+    if (p_ptr != q_ptr)
+    {
+        return false;
+    }
+    return p->abs_term == q->abs_term;
+}
+
+/**
+ * Oblicza w logarytmicznym czasie wartość liczby @f$x^e@f$.
+ * @param[in]  x : liczba do spotęgowania
+ * @param[in]  e : wykładnik docelowej potęgi
+ * @return @f$x^e@f$
+ */
+static poly_coeff_t FastPower(poly_coeff_t x, poly_exp_t e)
+{
+    if (e == 0)
+    {
+        return 1;
+    }
+    poly_coeff_t m;
+    if (e % 2 == 0)
+    {
+        m = FastPower(x, e / 2);
+        return m * m;
+    }
+    else
+    {
+        return x * FastPower(x, e - 1);
+    }
+}
+
+/**
+ * @details Implementacja procedury PolyAt udokumentowanej w pliku poly.h.
+ * Wstawia pod pierwszą zmienną wielomianu wartość @p x.
+ * W wyniku może powstać wielomian, jeśli współczynniki są wielomianem
+ * i zmniejszane są indeksy zmiennych w takim wielomianie o jeden.
+ * Formalnie dla wielomianu @f$p(x_0, x_1, x_2, \ldots)@f$ wynikiem jest
+ * wielomian @f$p(x, x_0, x_1, \ldots)@f$.
+ * @param[in] p : wielomian
+ * @param[in] x : wartość pierwszej ze zmiennych
+ * @return @f$p(x, x_0, x_1, \ldots)@f$
+ */
+Poly PolyAt(const Poly *p, poly_coeff_t x)
+{
+    Poly out = PolyFromCoeff(p->abs_term);
+    Poly buffer, aux;
+    poly_coeff_t a = 1, e = 0;
+    for (Mono *ptr = p->last; ptr != NULL; ptr = ptr->prev)
+    {
+        buffer = PolyCoeffMul(&ptr->p, a * FastPower(x, ptr->exp - e));
+        aux = PolyAdd(&buffer, &out);
+        PolyDestroy(&buffer);
+        PolyDestroy(&out);
+        out = aux;
+    }
+    return out;
+}
+
+/**
+ * Wykonuje dwuargumentową operację i jej wynik zapisuje w pierwszym z wielomianów.
+ * Celem tej implementacji jest odzwierciedlenie działania operatorów takich jak np. '+='.
+ * @param[in,out] p         : wielomian na którym wykonamy operację
+ * @param[in]     operation : operacja do wykonania
+ * @param[in]     arg       : argument operacji
+ */
+static void ExecuteBinaryOnPoly(Poly *p, Poly (*operation)(const Poly *a, const Poly *b), const Poly *arg)
+{
+    Poly buffer = operation(p, arg);
+    PolyDestroy(p);
+    *p = buffer;
+}
+
+static Poly PolySubstitute(const Poly *p, unsigned count, const Poly x[], unsigned level);
+
+/**
+ * Podstawia wielomiany pod dany jednomian zgodne z opisem PolyCompose, gdy
+ * jest on zależny od zmiennej o numerze @p count.
+ * @param[in]  m     : jednomian, pod którego zmienne podstawimy wielomiany
+ * @param[in]  count : liczba wielomianów do podstawienia pod zmienne @p p
+ * @param[in]  x     : tablica wielomianów do podstawienia pod zmienne @p p
+ * @param[in]  level : numer zmiennej od której zależą jednomiany @p p
+ * @param[in]  to_substitute : wielomian do podstawienia za zmienną jednomianu @p m
+ * @return     wielomian otrzymany w wyniku wykonania operacji podstawiania opisanej w PolyCompose
+ */
+static Poly MonoSubstitute(const Mono *m, unsigned count, const Poly x[], unsigned level, const Poly *to_substitute)
+{
+    Poly out = PolySubstitute(&m->p, count, x, level + 1);
+    ExecuteBinaryOnPoly(&out, PolyMul, to_substitute);
+    return out;
+}
+
+/**
+ * Podstawia wielomiany pod dany wielomian zgodne z opisem PolyCompose, gdy
+ * jednomiany danego wielomianu są zależne od zmiennej o numerze @p count.
+ * Procedura nie dzieli pracy na zadania CoeffJob: PolyCompose wywołuje ją
+ * tylko wtedy, gdy pula ma jeden wątek lub złożenie jest zbyt małe, by
+ * dzielić je na zadania. W pozostałych przypadkach podstawianie wykonuje
+ * PolyComposeParallel, którego zadania ComposeTerm zagnieżdżają się
+ * w kolejnych poziomach tak jak obliczenia współczynników w PolyAdd i PolyMul.
+ * @param[in]  p     : wielomian, pod którego zmienne podstawimy wielomiany
+ * @param[in]  count : liczba wielomianów do podstawienia pod zmienne @p p
+ * @param[in]  x     : tablica wielomianów do podstawienia pod zmienne @p p
+ * @param[in]  level : numer zmiennej od której zależą jednomiany @p p
+ * @return       wielomian @p p po wykonaniu operacji podstawiania opisanej w PolyCompose
+ */
+static Poly PolySubstitute(const Poly *p, unsigned count, const Poly x[], unsigned level)
+{
+    Poly sum = PolyFromCoeff(p->abs_term);
+    if (level >= count)
+    {
+        return sum;
+    }
+    Poly to_substitute = PolyFromCoeff(1);
+    Poly substitution = x[level];
+    unsigned to_substitute_exp = 0;
+    for (Mono *ptr = p->last; ptr != NULL; ptr = ptr->prev)
+    {
+        assert((int)ptr->exp - (int)to_substitute_exp >= 0);
+        Poly pwr = PolyPow(&substitution, ptr->exp - to_substitute_exp);
+        ExecuteBinaryOnPoly(&to_substitute, PolyMul, &pwr);
+        to_substitute_exp = ptr->exp;
+        PolyDestroy(&pwr);
+
+        Poly result = MonoSubstitute(ptr, count, x, level, &to_substitute);
+        ExecuteBinaryOnPoly(&sum, PolyAdd, &result);
+        PolyDestroy(&result);
+    }
+    PolyDestroy(&to_substitute);
+    return sum;
+}
+
+/**
+ * Potęgi wielomianów podstawianych w równoległym PolyCompose.
+ * Dla każdej zmiennej wyznaczane są tylko potęgi o wykładnikach występujących
+ * w jednomianach złożenia zależnych od tej zmiennej. Tablice potęg wyznaczane
+ * są przed rozpoczęciem podstawiania i są współdzielone (tylko do odczytu)
+ * przez wszystkie jego zadania.
+ */
+typedef struct ComposeContext
+{
+    unsigned count; ///< liczba wielomianów do podstawienia
+    const Poly *x; ///< tablica wielomianów do podstawienia
+    poly_exp_t **exps; ///< `exps[l]` - rosnące, różne wykładniki zmiennej `l`
+    Poly **powers; ///< `powers[l][i]` to @f$x_l^{exps[l][i]}@f$
+    unsigned *power_count; ///< długości tablic `exps[l]` i `powers[l]`
+    unsigned *capacity; ///< rozmiary buforów `exps[l]` podczas zbierania
+} ComposeContext;
+
+/**
+ * Podstawienie w jednomianach jednego wielomianu, wykonywane równolegle.
+ */
+typedef struct ComposeLevel
+{
+    const ComposeContext *ctx; ///< potęgi podstawianych wielomianów
+    const Mono **monos; ///< jednomiany wielomianu
+    unsigned level; ///< numer zmiennej, od której zależą jednomiany
+    Poly *parts; ///< wyniki podstawienia (`parts[i + 1]` dla `monos[i]`)
+} ComposeLevel;
+
+/**
+ * Zbiera wykładniki jednomianów wielomianu @p p i jego współczynników
+ * względem kolejnych zmiennych, dla których podstawiane są wielomiany.
+ * @param[in, out] ctx : kontekst złożenia
+ * @param[in] p        : wielomian
+ * @param[in] level    : numer zmiennej, od której zależą jednomiany @p p
+ */
+static void ComposeCollectExps(ComposeContext *ctx, const Poly *p,
+                               unsigned level)
+{
+    if (level >= ctx->count)
+    {
+        return;
+    }
+    for (Mono *ptr = p->last; ptr != NULL; ptr = ptr->prev)
+    {
+        if (ctx->power_count[level] == ctx->capacity[level])
+        {
+            ctx->capacity[level] = 2 * ctx->capacity[level] + 16;
+            ctx->exps[level] = realloc(ctx->exps[level], ctx->capacity[level] *
+                                                         sizeof(poly_exp_t));
+            assert(ctx->exps[level]);
+        }
+        ctx->exps[level][ctx->power_count[level]++] = ptr->exp;
+        ComposeCollectExps(ctx, &ptr->p, level + 1);
+    }
+}
+
+/**
+ * Porównuje wykładniki dla qsort.
+ * @param[in] a : wskaźnik na wykładnik
+ * @param[in] b : wskaźnik na wykładnik
+ * @return liczba ujemna, zero lub dodatnia, gdy @p a jest odpowiednio
+ * mniejszy, równy lub większy od @p b
+ */
+static int CompareExps(const void *a, const void *b)
+{
+    poly_exp_t x = *(const poly_exp_t*)a, y = *(const poly_exp_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Wyznacza potęgi wielomianu podstawianego za zmienną @p level o zebranych
+ * wykładnikach. Kolejne potęgi, tak jak w PolySubstitute, są iloczynami
+ * poprzednich i potęg o wykładniku równym różnicy wykładników.
+ * @param[in, out] arg : kontekst złożenia (ComposeContext)
+ * @param[in] level    : numer zmiennej
+ */
+static void ComposePowers(void *arg, unsigned level)
+{
+    ComposeContext *ctx = arg;
+    poly_exp_t *exps = ctx->exps[level];
+    unsigned count = ctx->power_count[level];
+    if (count == 0)
+    {
+        return;
+    }
+    qsort(exps, count, sizeof(poly_exp_t), CompareExps);
+    unsigned unique = 1;
+    for (unsigned i = 1; i < count; ++i)
+    {
+        if (exps[i] != exps[unique - 1])
+        {
+            exps[unique++] = exps[i];
+        }
+    }
+    ctx->power_count[level] = unique;
+    ctx->powers[level] = malloc(unique * sizeof(Poly));
+    assert(ctx->powers[level]);
+    const Poly *x = &ctx->x[level];
+    ctx->powers[level][0] = PolyPow(x, exps[0]);
+    for (unsigned i = 1; i < unique; ++i)
+    {
+        Poly pwr = PolyPow(x, exps[i] - exps[i - 1]);
+        ctx->powers[level][i] = PolyMul(&ctx->powers[level][i - 1], &pwr);
+        PolyDestroy(&pwr);
+    }
+}
+
+/**
+ * Odnajduje wyznaczoną wcześniej potęgę podstawianego wielomianu.
+ * @param[in] ctx   : potęgi podstawianych wielomianów
+ * @param[in] level : numer podstawianego wielomianu
+ * @param[in] exp   : wykładnik, zebrany przez ComposeCollectExps
+ * @return @f$x_{level}^{exp}@f$
+ */
+static const Poly* ComposePower(const ComposeContext *ctx, unsigned level,
+                                poly_exp_t exp)
+{
+    const poly_exp_t *exps = ctx->exps[level];
+    unsigned low = 0, high = ctx->power_count[level];
+    while (high - low > 1)
+    {
+        unsigned middle = low + (high - low) / 2;
+        if (exps[middle] <= exp)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    assert(exps[low] == exp);
+    return &ctx->powers[level][low];
+}
+
+static Poly ComposeShared(const Poly *p, const ComposeContext *ctx,
+                          unsigned level);
+
+/**
+ * Podstawia wielomiany pod jednomian o indeksie @p idx.
+ * @param[in, out] arg : podstawienie (ComposeLevel)
+ * @param[in] idx      : indeks jednomianu
+ */
+static void ComposeTerm(void *arg, unsigned idx)
+{
+    ComposeLevel *job = arg;
+    const Mono *m = job->monos[idx];
+    Poly out = ComposeShared(&m->p, job->ctx, job->level + 1);
+    ExecuteBinaryOnPoly(&out, PolyMul,
+                        ComposePower(job->ctx, job->level, m->exp));
+    job->parts[idx + 1] = out;
+}
+
+/**
+ * Podstawia wielomiany pod wielomian, korzystając ze współdzielonych potęg.
+ * Dla dużych wielomianów podstawienia w kolejnych jednomianach wykonywane są
+ * w osobnych zadaniach puli wątków, a ich wyniki sumowane równolegle.
+ * @param[in] p     : wielomian
+ * @param[in] ctx   : potęgi podstawianych wielomianów
+ * @param[in] level : numer zmiennej, od której zależą jednomiany @p p
+ * @return wielomian @p p po podstawieniu
+ */
+static Poly ComposeShared(const Poly *p, const ComposeContext *ctx,
+                          unsigned level)
+{
+    if (level >= ctx->count || PolyIsCoeff(p))
+    {
+        return PolyFromCoeff(p->abs_term);
+    }
+    unsigned count = PolyMonoCount(p);
+    const Mono **monos = malloc(count * sizeof(Mono*));
+    Poly *parts = malloc((count + 1) * sizeof(Poly));
+    assert(monos && parts);
+    unsigned idx = 0;
+    for (Mono *ptr = p->last; ptr != NULL; ptr = ptr->prev)
+    {
+        monos[idx++] = ptr;
+    }
+    parts[0] = PolyFromCoeff(p->abs_term);
+    ComposeLevel job = {.ctx = ctx, .monos = monos, .level = level,
+        .parts = parts};
+    Poly out;
+    if (CoeffJobsEnabled((p->size + 1) * (ctx->x[level].size + 1)))
+    {
+        PoolParallelFor(count, ComposeTerm, &job);
+        out = PolySumParallel(count + 1, parts);
+    }
+    else
+    {
+        out = parts[0];
+        for (unsigned i = 0; i < count; ++i)
+        {
+            ComposeTerm(&job, i);
+            ExecuteBinaryOnPoly(&out, PolyAdd, &parts[i + 1]);
+            PolyDestroy(&parts[i + 1]);
+        }
+    }
+    free(monos);
+    free(parts);
+    return out;
+}
+
+/**
+ * Wykonuje PolyCompose równolegle. Najpierw zbiera wykładniki jednomianów
+ * @p p względem kolejnych zmiennych i wyznacza (równolegle dla różnych
+ * zmiennych) potęgi podstawianych wielomianów o tych wykładnikach, a
+ * następnie podstawia je w jednomianach @p p w zadaniach puli wątków.
+ * Każda potęga wyznaczana jest raz, więc mnożeń nie jest więcej niż
+ * w PolySubstitute, które wyznacza potęgi od nowa dla każdego współczynnika.
+ * @param[in] p     : wielomian
+ * @param[in] count : liczba wielomianów do podstawienia
+ * @param[in] x     : tablica wielomianów do podstawienia
+ * @return wynik złożenia
+ */
+static Poly PolyComposeParallel(const Poly *p, unsigned count, const Poly x[])
+{
+    unsigned levels = count < p->depth ? count : p->depth;
+    ComposeContext ctx = {.count = levels, .x = x,
+        .exps = calloc(levels + 1, sizeof(poly_exp_t*)),
+        .powers = calloc(levels + 1, sizeof(Poly*)),
+        .power_count = calloc(levels + 1, sizeof(unsigned)),
+        .capacity = calloc(levels + 1, sizeof(unsigned))};
+    assert(ctx.exps && ctx.powers && ctx.power_count && ctx.capacity);
+    ComposeCollectExps(&ctx, p, 0);
+    PoolParallelFor(levels, ComposePowers, &ctx);
+    Poly out = ComposeShared(p, &ctx, 0);
+    for (unsigned l = 0; l < levels; ++l)
+    {
+        for (unsigned i = 0; ctx.powers[l] != NULL && i < ctx.power_count[l];
+             ++i)
+        {
+            PolyDestroy(&ctx.powers[l][i]);
+        }
+        free(ctx.powers[l]);
+        free(ctx.exps[l]);
+    }
+    free(ctx.exps);
+    free(ctx.powers);
+    free(ctx.power_count);
+    free(ctx.capacity);
+    return out;
+}
+
+/**
+ * Szacuje koszt złożenia jako iloczyn rozmiaru wielomianu i największego
+ * z rozmiarów wielomianów podstawianych za jego zmienne.
+ * @param[in] p     : wielomian
+ * @param[in] count : liczba wielomianów do podstawienia
+ * @param[in] x     : tablica wielomianów do podstawienia
+ * @return szacowany koszt złożenia
+ */
+static size_t ComposeEstimate(const Poly *p, unsigned count, const Poly x[])
+{
+    size_t largest = 0;
+    for (unsigned l = 0; l < count && l < p->depth; ++l)
+    {
+        if (x[l].size > largest)
+        {
+            largest = x[l].size;
+        }
+    }
+    return (p->size + 1) * (largest + 1);
+}
+
+/**
+ * @details Implementacja procedury PolyCompose udokumentowanej w pliku poly.h.
+ * Gdy pula ma więcej niż jeden wątek, a złożenie jest dostatecznie duże,
+ * wykonywane jest ono przez PolyComposeParallel.
+ * @param[in] p     : wielomian
+ * @param[in] count : liczba wielomianów do podstawienia
+ * @param[in] x     : tablica wielomianów do podstawienia
+ * @return wynik złożenia
+ */
+Poly PolyCompose(const Poly *p, unsigned count, const Poly x[])
+{
+    if (CoeffJobsEnabled(ComposeEstimate(p, count, x)))
+    {
+        return PolyComposeParallel(p, count, x);
+    }
+    return PolySubstitute(p, count, x, 0);
+}
+
+/**
+ * Zapisuje w tablicy @p terms kolejne składniki wielomianu względem głównej
+ * zmiennej w kolejności malejących wykładników.
+ * Wyraz wolny jest dołączany do współczynnika przy zerowym wykładniku.
+ * Zapisane współczynniki są jedynie widokami na pamięć wielomianu @p p -
+ * nie należy ich niszczyć. Tablica @p terms musi mieć miejsce na
+ * `p->size + 1` elementów.
+ * @param[in]  p     : wielomian
+ * @param[out] terms : tablica składników
+ * @return liczba zapisanych składników
+ */
+static unsigned PolyTermsView(const Poly *p, Mono terms[])
+{
+    unsigned count = 0;
+    for (Mono *ptr = p->first; ptr != NULL; ptr = ptr->next)
+    {
+        terms[count] = *ptr;
+        if (ptr->exp == 0)
+        {
+            terms[count].p.abs_term += p->abs_term;
+        }
+        ++count;
+    }
+    if (p->abs_term != 0 && (p->last == NULL || p->last->exp != 0))
+    {
+        Poly coeff = PolyFromCoeff(p->abs_term);
+        terms[count++] = MonoFromPoly(&coeff, 0);
+    }
+    return count;
+}
+
+/**
+ * Tworzy wielomian ze składników uporządkowanych malejąco względem wykładników.
+ * Odwrotność PolyTermsView: współczynnik przy zerowym wykładniku oddaje swój
+ * wyraz wolny wielomianowi wynikowemu, a zerowe współczynniki są pomijane.
+ * Przejmuje na własność współczynniki z tablicy @p terms.
+ * @param[in] count : liczba składników
+ * @param[in] terms : tablica składników o ściśle malejących wykładnikach
+ * @return wielomian będący sumą składników
+ */
+static Poly PolyFromDescendingTerms(unsigned count, Mono terms[])
+{
+    Poly out = PolyZero();
+    for (unsigned i = count; i-- > 0;)
+    {
+        if (terms[i].exp == 0)
+        {
+            out.abs_term = terms[i].p.abs_term;
+            terms[i].p.abs_term = 0;
+        }
+        if (PolyIsZero(&terms[i].p))
+        {
+            PolyDestroy(&terms[i].p);
+        }
+        else
+        {
+            PolyAppendMono(&out, MonoFromPoly(&terms[i].p, terms[i].exp));
+        }
+    }
+    return out;
+}
+
+/// Ograniczenie liczb w rekurencji Millera, przy którym nie ma przepełnień.
+static const double MILLER_COEFF_BOUND = (double)(1ULL << 62);
+
+/**
+ * Dodaje do wiersza kwadratu składnik @p c * x^@p exp o wykładniku większym
+ * od wykładników składników już w nim obecnych. Zerowy składnik jest
+ * pomijany, a stały składnik o zerowym wykładniku trafia do wyrazu wolnego.
+ * Przejmuje na własność zawartość struktury wskazywanej przez @p c.
+ * @param[in, out] row : wiersz kwadratu
+ * @param[in] c        : współczynnik
+ * @param[in] exp      : wykładnik
+ */
+static void SquareRowAppend(Poly *row, Poly *c, poly_exp_t exp)
+{
+    if (exp == 0 && PolyIsCoeff(c))
+    {
+        row->abs_term += c->abs_term;
+        return;
+    }
+    if (PolyIsZero(c))
+    {
+        return;
+    }
+    PolyAppendMono(row, MonoFromPoly(c, exp));
+}
+
+static Poly PolySquare(const Poly *p);
+
+/**
+ * Wyznacza wiersz kwadratu wielomianu dla jednomianu @f$c_i x^{e_i}@f$:
+ * @f$c_i^2 x^{2e_i} + \sum_{e_j > e_i} 2c_i c_j x^{e_i + e_j}@f$.
+ * @param[in] m : jednomian
+ * @return wiersz kwadratu
+ */
+static Poly SquareRow(const Mono *m)
+{
+    Poly row = PolyZero();
+    Poly c = PolySquare(&m->p);
+    SquareRowAppend(&row, &c, 2 * m->exp);
+    Poly twice = PolyCoeffMul(&m->p, 2);
+    for (const Mono *ptr = m->prev; ptr != NULL; ptr = ptr->prev)
+    {
+        c = PolyMul(&twice, &ptr->p);
+        SquareRowAppend(&row, &c, m->exp + ptr->exp);
+    }
+    PolyDestroy(&twice);
+    return row;
+}
+
+/**
+ * Sumuje wiersze kwadratu dla kolejnych jednomianów listy - od @p from
+ * (włącznie) w stronę większych wykładników aż do @p to (wyłącznie).
+ * @param[in] from : jednomian rozpoczynający zakres
+ * @param[in] to   : jednomian za końcem zakresu lub NULL
+ * @return suma wierszy kwadratu
+ */
+static Poly SquareRowRange(const Mono *from, const Mono *to)
+{
+    Poly out = PolyZero();
+    for (const Mono *ptr = from; ptr != to; ptr = ptr->prev)
+    {
+        Poly row = SquareRow(ptr);
+        ExecuteBinaryOnPoly(&out, PolyAdd, &row);
+        PolyDestroy(&row);
+    }
+    return out;
+}
+
+/**
+ * Fragmenty jednomianów wielomianu podnoszonego do kwadratu równolegle.
+ */
+typedef struct SquareChunks
+{
+    const Mono **bounds; ///< granice fragmentów dla SquareRowRange
+    Poly *parts; ///< sumy wierszy fragmentów (od indeksu 1)
+} SquareChunks;
+
+/**
+ * Sumuje wiersze kwadratu fragmentu o indeksie @p idx.
+ * @param[in, out] arg : fragmenty (SquareChunks)
+ * @param[in] idx      : indeks fragmentu
+ */
+static void SquareChunk(void *arg, unsigned idx)
+{
+    SquareChunks *chunks = arg;
+    chunks->parts[idx + 1] = SquareRowRange(chunks->bounds[idx],
+                                            chunks->bounds[idx + 1]);
+}
+
+/**
+ * Podnosi wielomian do kwadratu. Dla jednomianów
+ * @f$c_i x^{e_i}@f$ wyznaczane są tylko kwadraty @f$c_i^2@f$ (rekurencyjnie)
+ * i iloczyny @f$2c_i \cdot c_j@f$ dla @f$e_i < e_j@f$, więc mnożeń
+ * współczynników jest o połowę mniej niż w PolyMul. Dla dużych wielomianów,
+ * gdy pula ma więcej niż jeden wątek, wiersze kwadratu wyznaczane są we
+ * fragmentach, tak jak w PolyMulParallel, a wynik nie zależy od liczby wątków.
+ * @param[in] p : wielomian
+ * @return @f$p^2@f$
+ */
+static Poly PolySquare(const Poly *p)
+{
+    if (PolyIsCoeff(p))
+    {
+        return PolyFromCoeff(p->abs_term * p->abs_term);
+    }
+    Poly base = PolyCoeffMul(p, 2 * p->abs_term);
+    base.abs_term = p->abs_term * p->abs_term;
+    if (PoolThreadCount() > 1 && p->first != p->last &&
+        (p->size + 1) * (p->size + 1) >= PARALLEL_MUL_THRESHOLD)
+    {
+        const Mono **bounds;
+        unsigned count = ParallelChunkBounds(p, &bounds);
+        Poly *parts = malloc((count + 1) * sizeof(Poly));
+        assert(parts);
+        parts[0] = base;
+        SquareChunks chunks = {.bounds = bounds, .parts = parts};
+        PoolParallelFor(count, SquareChunk, &chunks);
+        Poly out = PolySumParallel(count + 1, parts);
+        free(parts);
+        free(bounds);
+        return out;
+    }
+    Poly rows = SquareRowRange(p->last, NULL);
+    ExecuteBinaryOnPoly(&base, PolyAdd, &rows);
+    PolyDestroy(&rows);
+    return base;
+}
+
+/**
+ * Potęguje wielomian metodą szybkiego potęgowania, podnosząc kolejne
+ * potęgi do kwadratu przez PolySquare.
+ * @param[in] p   : wielomian
+ * @param[in] exp : dodatni wykładnik
+ * @return @f$p^{exp}@f$
+ */
+static Poly PolyPowBinary(const Poly *p, poly_exp_t exp)
+{
+    Poly square = PolyClone(p), aux;
+    for (; exp % 2 == 0; exp /= 2)
+    {
+        aux = PolySquare(&square);
+        PolyDestroy(&square);
+        square = aux;
+    }
+    Poly out = PolyClone(&square);
+    while ((exp /= 2) > 0)
+    {
+        aux = PolySquare(&square);
+        PolyDestroy(&square);
+        square = aux;
+        if (exp % 2 != 0)
+        {
+            ExecuteBinaryOnPoly(&out, PolyMul, &square);
+        }
+    }
+    PolyDestroy(&square);
+    return out;
+}
+
+/**
+ * Rozkłada dodatnią liczbę na potęgę dwójki i czynnik nieparzysty.
+ * @param[in] x     : liczba
+ * @param[out] odd  : czynnik nieparzysty
+ * @return wykładnik potęgi dwójki
+ */
+static unsigned SplitPowerOfTwo(uint64_t x, uint64_t *odd)
+{
+    unsigned twos = 0;
+    for (; x % 2 == 0; x /= 2)
+    {
+        ++twos;
+    }
+    *odd = x;
+    return twos;
+}
+
+/**
+ * Wyznacza odwrotność liczby nieparzystej modulo @f$2^{64}@f$ metodą Newtona
+ * - każdy krok podwaja liczbę poprawnych bitów, a @p x jest swoją
+ * odwrotnością modulo 8.
+ * @param[in] x : liczba nieparzysta
+ * @return @f$x^{-1} \bmod 2^{64}@f$
+ */
+static uint64_t OddInverse(uint64_t x)
+{
+    uint64_t inv = x;
+    for (unsigned i = 0; i < 5; ++i)
+    {
+        inv *= 2 - x * inv;
+    }
+    return inv;
+}
+
+/**
+ * Potęguje wielomian o jednym lub dwóch składnikach względem głównej
+ * zmiennej. Potęgą składnika @f$c x^e@f$ jest @f$c^n x^{en}@f$, a potęgę
+ * dwumianu @f$H x^a + L x^b@f$ wyznacza wzór dwumianowy Newtona: składniki
+ * @f$\binom{n}{k} H^k L^{n-k} x^{ka + (n-k)b}@f$ mają różne wykładniki,
+ * więc nie trzeba ich sumować. Symbol Newtona liczony jest modulo
+ * @f$2^{64}@f$ jako iloczyn potęgi dwójki i części nieparzystej, którą można
+ * dzielić przez odwrotność.
+ * @param[in] terms : składniki wielomianu w kolejności malejących wykładników
+ * @param[in] count : liczba składników (1 lub 2)
+ * @param[in] exp   : wykładnik, co najmniej 2
+ * @return @f$p^{exp}@f$
+ */
+static Poly PolyPowBinomial(const Mono terms[], unsigned count, poly_exp_t exp)
+{
+    if (count == 1)
+    {
+        Mono term = {.p = PolyPow(&terms[0].p, exp), .exp = terms[0].exp * exp};
+        return PolyFromDescendingTerms(1, &term);
+    }
+    size_t length = (size_t)exp + 1;
+    Poly *low_powers = malloc(length * sizeof(Poly));
+    Mono *out_terms = malloc(length * sizeof(Mono));
+    assert(low_powers && out_terms);
+    low_powers[0] = PolyFromCoeff(1);
+    for (size_t k = 1; k < length; ++k)
+    {
+        low_powers[k] = PolyMul(&low_powers[k - 1], &terms[1].p);
+    }
+    Poly high_power = PolyFromCoeff(1);
+    uint64_t odd = 1;
+    unsigned twos = 0;
+    for (size_t k = 0; k < length; ++k)
+    {
+        size_t low = (size_t)exp - k;
+        if (k > 0)
+        {
+            uint64_t factor;
+            twos += SplitPowerOfTwo(low + 1, &factor);
+            odd *= factor;
+            twos -= SplitPowerOfTwo(k, &factor);
+            odd *= OddInverse(factor);
+            ExecuteBinaryOnPoly(&high_power, PolyMul, &terms[0].p);
+        }
+        poly_coeff_t binomial = twos >= 64 ? 0 : (poly_coeff_t)(odd << twos);
+        Poly product = PolyMul(&high_power, &low_powers[low]);
+        out_terms[low].p = PolyCoeffMul(&product, binomial);
+        out_terms[low].exp = (poly_exp_t)k * terms[0].exp +
+                             (poly_exp_t)low * terms[1].exp;
+        PolyDestroy(&product);
+        PolyDestroy(&low_powers[low]);
+    }
+    PolyDestroy(&high_power);
+    Poly out = PolyFromDescendingTerms(length, out_terms);
+    free(out_terms);
+    free(low_powers);
+    return out;
+}
+
+/**
+ * Sprawdza, czy potęgę gęstego wielomianu jednej zmiennej można wyznaczyć
+ * rekurencją Millera (PolyPowMiller): wielomian musi mieć stałe
+ * współczynniki i co najmniej połowę niezerowych, a liczby w rekurencji
+ * nie mogą przekroczyć zakresu poly_coeff_t. Współczynniki potęgi są
+ * ograniczone przez @f$\|a\|_1^n@f$, a liczniki rekurencji - przez
+ * @f$(n + 1) d \|a\|_1^{n + 1}@f$, gdzie @f$\|a\|_1@f$ to suma modułów
+ * współczynników.
+ * @param[in] p     : wielomian
+ * @param[in] terms : składniki wielomianu w kolejności malejących wykładników
+ * @param[in] count : liczba składników, co najmniej 3
+ * @param[in] exp   : wykładnik
+ * @return Czy można użyć rekurencji Millera?
+ */
+static bool MillerApplies(const Poly *p, const Mono terms[], unsigned count,
+                          poly_exp_t exp)
+{
+    poly_exp_t width = terms[0].exp - terms[count - 1].exp;
+    if (p->depth != 1 || 2 * count <= (unsigned)width)
+    {
+        return false;
+    }
+    double norm = 0;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        double c = terms[i].p.abs_term;
+        norm += c < 0 ? -c : c;
+    }
+    double bound = ((double)exp + 1) * width;
+    for (poly_exp_t i = 0; i <= exp && bound <= MILLER_COEFF_BOUND; ++i)
+    {
+        bound *= norm;
+    }
+    return bound <= MILLER_COEFF_BOUND;
+}
+
+/**
+ * Potęguje wielomian jednej zmiennej rekurencją J.C.P. Millera. Dla
+ * @f$a = x^s \sum_{i=0}^{d} a_i x^i@f$, gdzie @f$a_0 \neq 0@f$, współczynniki
+ * @f$b_k@f$ potęgi @f$a^n = x^{sn} \sum_k b_k x^k@f$ spełniają
+ * @f$b_0 = a_0^n@f$ oraz
+ * @f$b_k = \frac{1}{k a_0} \sum_{i=1}^{\min(k,d)} ((n + 1) i - k) a_i b_{k-i}@f$,
+ * więc każdy z @f$nd + 1@f$ współczynników wymaga co najwyżej tylu mnożeń,
+ * ile niezerowych współczynników ma @f$a@f$. Wymaga MillerApplies - wtedy
+ * dzielenie jest dokładne, a obliczenia nie przepełniają się.
+ * @param[in] terms : składniki wielomianu w kolejności malejących wykładników
+ * @param[in] count : liczba składników
+ * @param[in] exp   : wykładnik
+ * @return @f$p^{exp}@f$
+ */
+static Poly PolyPowMiller(const Mono terms[], unsigned count, poly_exp_t exp)
+{
+    poly_exp_t shift = terms[count - 1].exp;
+    poly_exp_t width = terms[0].exp - shift;
+    poly_exp_t length = width * exp + 1;
+    poly_coeff_t low = terms[count - 1].p.abs_term;
+    poly_coeff_t *b = malloc(length * sizeof(poly_coeff_t));
+    Mono *out_terms = malloc(length * sizeof(Mono));
+    assert(b && out_terms);
+    b[0] = FastPower(low, exp);
+    for (poly_exp_t k = 1; k < length; ++k)
+    {
+        poly_coeff_t sum = 0;
+        for (unsigned t = count - 1; t-- > 0;)
+        {
+            poly_exp_t i = terms[t].exp - shift;
+            if (i > k)
+            {
+                break;
+            }
+            sum += ((poly_coeff_t)(exp + 1) * i - k) * terms[t].p.abs_term *
+                   b[k - i];
+        }
+        b[k] = sum / (k * low);
+    }
+    for (poly_exp_t k = 0; k < length; ++k)
+    {
+        out_terms[length - 1 - k] = (Mono) {.p = PolyFromCoeff(b[k]),
+                                            .exp = shift * exp + k};
+    }
+    Poly out = PolyFromDescendingTerms(length, out_terms);
+    free(out_terms);
+    free(b);
+    return out;
+}
+
+/**
+ * @details Implementacja procedury PolyPow udokumentowanej w pliku poly.h.
+ * Wielomiany o jednym lub dwóch składnikach względem głównej zmiennej
+ * potęgowane są przez PolyPowBinomial, gęste wielomiany jednej zmiennej
+ * o niewielkich współczynnikach - przez PolyPowMiller, a pozostałe - przez
+ * PolyPowBinary.
+ * @param[in] p   : wielomian
+ * @param[in] exp : wykładnik
+ * @return @f$p^{exp}@f$
+ */
+Poly PolyPow(const Poly *p, poly_exp_t exp)
+{
+    assert(exp >= 0);
+    if (PolyIsCoeff(p))
+    {
+        return PolyFromCoeff(FastPower(p->abs_term, exp));
+    }
+    if (exp <= 1)
+    {
+        return exp == 0 ? PolyFromCoeff(1) : PolyClone(p);
+    }
+    Mono *terms = malloc((PolyMonoCount(p) + 1) * sizeof(Mono));
+    assert(terms);
+    unsigned count = PolyTermsView(p, terms);
+    Poly out;
+    if (count <= 2)
+    {
+        out = PolyPowBinomial(terms, count, exp);
+    }
+    else if (MillerApplies(p, terms, count, exp))
+    {
+        out = PolyPowMiller(terms, count, exp);
+    }
+    else
+    {
+        out = PolyPowBinary(p, exp);
+    }
+    free(terms);
+    return out;
+}
+
+/**
+ * Dzieli wszystkie współczynniki wielomianu przez stałą @p x.
+ * Wynik jest określony, gdy @p x dzieli każdy ze współczynników.
+ * @param[in] p : wielomian
+ * @param[in] x : niezerowa stała
+ * @return `p / x`
+ */
+static Poly PolyCoeffDivExact(const Poly *p, poly_coeff_t x)
+{
+    Poly out = PolyFromCoeff(p->abs_term / x);
+    Mono buf;
+    for (Mono *p_ptr = p->last; p_ptr != NULL; p_ptr = p_ptr->prev)
+    {
+        buf.exp = p_ptr->exp;
+        buf.p = PolyCoeffDivExact(&p_ptr->p, x);
+        if (PolyIsZero(&buf.p))
+        {
+            PolyDestroy(&buf.p);
+        }
+        else
+        {
+            PolyAppendMono(&out, buf);
+        }
+    }
+    return out;
+}
+
+/**
+ * Zwraca widok na współczynnik wiodący wielomianu względem głównej zmiennej.
+ * Zwróconego wielomianu nie należy niszczyć.
+ * @param[in] p : wielomian
+ * @return współczynnik przy największej potędze głównej zmiennej
+ */
+static Poly PolyLeadingCoeffView(const Poly *p)
+{
+    if (PolyIsCoeff(p))
+    {
+        return *p;
+    }
+    Poly out = p->first->p;
+    if (p->first->exp == 0)
+    {
+        out.abs_term += p->abs_term;
+    }
+    return out;
+}
+
+/**
+ * Dzieli wielomian @p c przez współczynnik wiodący dzielnika.
+ * Dla stałego @p lead dzieli współczynniki, w przeciwnym wypadku wykonuje
+ * dokładne dzielenie względem kolejnej zmiennej.
+ * @param[in] c    : dzielna
+ * @param[in] lead : niezerowy dzielnik, dzielący @p c bez reszty
+ * @return `c / lead`
+ */
+static Poly CoeffDivExact(const Poly *c, const Poly *lead)
+{
+    if (PolyIsCoeff(lead))
+    {
+        return PolyCoeffDivExact(c, lead->abs_term);
+    }
+    return PolyDivExact(c, lead);
+}
+
+/**
+ * Rosnąca tablica składników (jednomianów bez powiązań listowych).
+ */
+typedef struct TermArray
+{
+    Mono *terms; ///< składniki
+    unsigned count; ///< liczba składników
+    unsigned capacity; ///< liczba elementów, na które zaalokowano pamięć
+} TermArray;
+
+/**
+ * Dopisuje składnik na koniec tablicy, w razie potrzeby ją powiększając.
+ * Przejmuje na własność współczynnik @p coeff.
+ * @param[in, out] arr : tablica składników
+ * @param[in] coeff    : współczynnik
+ * @param[in] exp      : wykładnik
+ */
+static void TermArrayPush(TermArray *arr, Poly *coeff, poly_exp_t exp)
+{
+    if (arr->count == arr->capacity)
+    {
+        arr->capacity = 2 * arr->capacity + 4;
+        arr->terms = realloc(arr->terms, arr->capacity * sizeof(Mono));
+        assert(arr->terms);
+    }
+    arr->terms[arr->count++] = MonoFromPoly(coeff, exp);
+}
+
+/**
+ * Element kopca iloczynów używanego przy dzieleniu wielomianów.
+ * Reprezentuje iloczyn składnika ilorazu i składnika dzielnika.
+ */
+typedef struct DivHeapEntry
+{
+    poly_exp_t exp; ///< wykładnik iloczynu
+    unsigned quot_idx; ///< indeks składnika ilorazu
+    unsigned div_idx; ///< indeks składnika dzielnika
+} DivHeapEntry;
+
+/**
+ * Kopiec iloczynów uporządkowany malejąco względem wykładników.
+ */
+typedef struct DivHeap
+{
+    DivHeapEntry *entries; ///< elementy kopca
+    unsigned size; ///< liczba elementów kopca
+    unsigned capacity; ///< liczba elementów, na które zaalokowano pamięć
+} DivHeap;
+
+/**
+ * Wstawia element do kopca iloczynów.
+ * @param[in, out] heap : kopiec
+ * @param[in] entry     : element do wstawienia
+ */
+static void DivHeapPush(DivHeap *heap, DivHeapEntry entry)
+{
+    if (heap->size == heap->capacity)
+    {
+        heap->capacity = 2 * heap->capacity + 4;
+        heap->entries = realloc(heap->entries,
+                                heap->capacity * sizeof(DivHeapEntry));
+        assert(heap->entries);
+    }
+    unsigned idx = heap->size++;
+    while (idx > 0 && heap->entries[(idx - 1) / 2].exp < entry.exp)
+    {
+        heap->entries[idx] = heap->entries[(idx - 1) / 2];
+        idx = (idx - 1) / 2;
+    }
+    heap->entries[idx] = entry;
+}
+
+/**
+ * Usuwa z kopca iloczynów element o największym wykładniku.
+ * @param[in, out] heap : niepusty kopiec
+ * @return usunięty element
+ */
+static DivHeapEntry DivHeapPop(DivHeap *heap)
+{
+    DivHeapEntry out = heap->entries[0];
+    DivHeapEntry moved = heap->entries[--heap->size];
+    unsigned idx = 0;
+    while (2 * idx + 1 < heap->size)
+    {
+        unsigned child = 2 * idx + 1;
+        if (child + 1 < heap->size &&
+            heap->entries[child + 1].exp > heap->entries[child].exp)
+        {
+            ++child;
+        }
+        if (heap->entries[child].exp <= moved.exp)
+        {
+            break;
+        }
+        heap->entries[idx] = heap->entries[child];
+        idx = child;
     }
-    Poly to_substitute = PolyFromCoeff(1);
-    Poly substitution = x[level];
-    unsigned to_substitute_exp = 0;
+    heap->entries[idx] = moved;
+    return out;
+}
+
+/**
+ * Dzieli wielomian @p p przez @p q względem głównej zmiennej algorytmem
+ * kopcowym Johnsona.
+ * Kolejne składniki reszty wyznaczane są w kolejności malejących wykładników
+ * jako różnica składnika @p p i iloczynów o tym samym wykładniku, pobieranych
+ * z kopca. Każdy składnik ilorazu jest tworzony dokładnie raz. Współczynniki
+ * ilorazu są wyznaczane dzieleniem dokładnym przez współczynnik wiodący @p q.
+ * @param[in]  p    : dzielna
+ * @param[in]  q    : niezerowy dzielnik
+ * @param[out] quot : iloraz
+ * @param[out] rem  : reszta
+ */
+static void PolyDivideHeap(const Poly *p, const Poly *q, Poly *quot, Poly *rem)
+{
+    Mono *p_terms = malloc((p->size + 1) * sizeof(Mono));
+    Mono *q_terms = malloc((q->size + 1) * sizeof(Mono));
+    assert(p_terms && q_terms);
+    unsigned p_count = PolyTermsView(p, p_terms);
+    unsigned q_count = PolyTermsView(q, q_terms);
+    TermArray quot_terms = {NULL, 0, 0}, rem_terms = {NULL, 0, 0};
+    DivHeap heap = {NULL, 0, 0};
+    unsigned p_idx = 0;
+    while (p_idx < p_count || heap.size > 0)
+    {
+        poly_exp_t exp;
+        Poly c;
+        if (heap.size == 0 ||
+            (p_idx < p_count && p_terms[p_idx].exp >= heap.entries[0].exp))
+        {
+            exp = p_terms[p_idx].exp;
+            c = PolyClone(&p_terms[p_idx++].p);
+        }
+        else
+        {
+            exp = heap.entries[0].exp;
+            c = PolyZero();
+        }
+        while (heap.size > 0 && heap.entries[0].exp == exp)
+        {
+            DivHeapEntry entry = DivHeapPop(&heap);
+            Poly product = PolyMul(&quot_terms.terms[entry.quot_idx].p,
+                                   &q_terms[entry.div_idx].p);
+            ExecuteBinaryOnPoly(&c, PolySub, &product);
+            PolyDestroy(&product);
+            if (++entry.div_idx < q_count)
+            {
+                entry.exp = quot_terms.terms[entry.quot_idx].exp +
+                            q_terms[entry.div_idx].exp;
+                DivHeapPush(&heap, entry);
+            }
+        }
+        if (PolyIsZero(&c))
+        {
+            continue;
+        }
+        if (exp >= q_terms[0].exp)
+        {
+            Poly factor = CoeffDivExact(&c, &q_terms[0].p);
+            PolyDestroy(&c);
+            TermArrayPush(&quot_terms, &factor, exp - q_terms[0].exp);
+            if (q_count > 1)
+            {
+                DivHeapPush(&heap, (DivHeapEntry) {
+                    .exp = exp - q_terms[0].exp + q_terms[1].exp,
+                    .quot_idx = quot_terms.count - 1, .div_idx = 1});
+            }
+        }
+        else
+        {
+            TermArrayPush(&rem_terms, &c, exp);
+        }
+    }
+    *quot = PolyFromDescendingTerms(quot_terms.count, quot_terms.terms);
+    *rem = PolyFromDescendingTerms(rem_terms.count, rem_terms.terms);
+    free(quot_terms.terms);
+    free(rem_terms.terms);
+    free(heap.entries);
+    free(p_terms);
+    free(q_terms);
+}
+
+/// Dzielna o stałych współczynnikach jest dzielona na tablicach, gdy jej
+/// stopień jest mniejszy niż tyle razy liczba jej niezerowych składników.
+static const size_t DENSE_DIVISION_RATIO = 2;
+
+/// Długość, od której iloczyn tablic współczynników liczony jest metodą
+/// Karatsuby.
+static const size_t KARATSUBA_THRESHOLD = 32;
+
+/// Najmniejsza liczba składników dzielnika i współczynników ilorazu, od
+/// której dzielenie na tablicach korzysta z odwrotności wyznaczanej metodą
+/// Newtona.
+static const size_t NEWTON_DIVISION_THRESHOLD = 64;
+
+/**
+ * Tworzy wielomian jednej zmiennej z tablicy współczynników.
+ * @param[in] coeffs : tablica współczynników; @p coeffs[i] stoi przy @f$x^i@f$
+ * @param[in] deg    : największy wykładnik w tablicy
+ * @return wielomian o współczynnikach @p coeffs
+ */
+static Poly PolyFromDenseArray(const poly_coeff_t coeffs[], poly_exp_t deg)
+{
+    Poly out = PolyFromCoeff(deg >= 0 ? coeffs[0] : 0);
+    for (poly_exp_t e = 1; e <= deg; ++e)
+    {
+        if (coeffs[e] != 0)
+        {
+            Poly coeff = PolyFromCoeff(coeffs[e]);
+            PolyAppendMono(&out, MonoFromPoly(&coeff, e));
+        }
+    }
+    return out;
+}
+
+/**
+ * Mnoży tablice współczynników o długości @p n szkolną metodą. Obliczenia
+ * wykonywane są modulo @f$2^{64}@f$.
+ * @param[in] a    : tablica współczynników
+ * @param[in] b    : tablica współczynników
+ * @param[in] n    : długość tablic
+ * @param[out] out : iloczyn (@f$2n - 1@f$ współczynników)
+ */
+static void DenseMulSchoolbook(const uint64_t a[], const uint64_t b[], size_t n,
+                               uint64_t out[])
+{
+    memset(out, 0, (2 * n - 1) * sizeof(uint64_t));
+    for (size_t i = 0; i < n; ++i)
+    {
+        for (size_t j = 0; j < n; ++j)
+        {
+            out[i + j] += a[i] * b[j];
+        }
+    }
+}
+
+/**
+ * Mnoży tablice współczynników o długości @p n metodą Karatsuby: iloczyn
+ * połówek @f$(a_0 + a_1 x^h)(b_0 + b_1 x^h)@f$ wymaga trzech mnożeń
+ * - @f$a_0 b_0@f$, @f$a_1 b_1@f$ i @f$(a_0 + a_1)(b_0 + b_1)@f$. Obliczenia
+ * wykonywane są modulo @f$2^{64}@f$, więc wynik jest równy szkolnemu.
+ * @param[in] a    : tablica współczynników
+ * @param[in] b    : tablica współczynników
+ * @param[in] n    : długość tablic
+ * @param[out] out : iloczyn (@f$2n - 1@f$ współczynników)
+ */
+static void DenseMulKaratsuba(const uint64_t a[], const uint64_t b[], size_t n,
+                              uint64_t out[])
+{
+    if (n < KARATSUBA_THRESHOLD)
+    {
+        DenseMulSchoolbook(a, b, n, out);
+        return;
+    }
+    size_t low = n / 2, high = n - low;
+    uint64_t *buffer = malloc((4 * high - 1) * sizeof(uint64_t));
+    assert(buffer);
+    uint64_t *a_sum = buffer, *b_sum = buffer + high, *middle = buffer + 2 * high;
+    for (size_t i = 0; i < high; ++i)
+    {
+        a_sum[i] = a[low + i] + (i < low ? a[i] : 0);
+        b_sum[i] = b[low + i] + (i < low ? b[i] : 0);
+    }
+    memset(out, 0, (2 * n - 1) * sizeof(uint64_t));
+    DenseMulKaratsuba(a, b, low, out);
+    DenseMulKaratsuba(a + low, b + low, high, out + 2 * low);
+    DenseMulKaratsuba(a_sum, b_sum, high, middle);
+    for (size_t i = 0; i < 2 * low - 1; ++i)
+    {
+        middle[i] -= out[i];
+    }
+    for (size_t i = 0; i < 2 * high - 1; ++i)
+    {
+        middle[i] -= out[2 * low + i];
+    }
+    for (size_t i = 0; i < 2 * high - 1; ++i)
+    {
+        out[low + i] += middle[i];
+    }
+    free(buffer);
+}
+
+/**
+ * Wyznacza @p count najniższych współczynników iloczynu tablic. Krótsze
+ * z tablic są uzupełniane zerami do wspólnej długości.
+ * @param[in] a       : tablica współczynników
+ * @param[in] a_count : długość tablicy @p a
+ * @param[in] b       : tablica współczynników
+ * @param[in] b_count : długość tablicy @p b
+ * @param[in] count   : liczba wyznaczanych współczynników
+ * @param[out] out    : najniższe współczynniki iloczynu
+ */
+static void DenseMulLow(const uint64_t a[], size_t a_count,
+                        const uint64_t b[], size_t b_count, size_t count,
+                        uint64_t out[])
+{
+    size_t n = a_count > b_count ? a_count : b_count;
+    uint64_t *buffer = calloc(4 * n, sizeof(uint64_t));
+    assert(buffer);
+    memcpy(buffer, a, a_count * sizeof(uint64_t));
+    memcpy(buffer + n, b, b_count * sizeof(uint64_t));
+    DenseMulKaratsuba(buffer, buffer + n, n, buffer + 2 * n);
+    for (size_t i = 0; i < count; ++i)
+    {
+        out[i] = i < 2 * n - 1 ? buffer[2 * n + i] : 0;
+    }
+    free(buffer);
+}
+
+/**
+ * Wyznacza odwrotność szeregu potęgowego @p f modulo @f$x^n@f$ metodą
+ * Newtona: przybliżenie @f$g@f$ modulo @f$x^k@f$ przechodzi w
+ * @f$g (2 - f g)@f$ modulo @f$x^{2k}@f$. Wyraz wolny @p f musi być równy
+ * 1 lub -1 - wtedy odwrotność jest dokładna modulo @f$2^{64}@f$.
+ * @param[in] f  : współczynniki szeregu (co najmniej @p n)
+ * @param[in] n  : liczba wyznaczanych współczynników
+ * @param[out] g : współczynniki odwrotności
+ */
+static void DenseSeriesInverse(const uint64_t f[], size_t n, uint64_t g[])
+{
+    uint64_t *product = malloc(n * sizeof(uint64_t));
+    assert(product);
+    g[0] = f[0];
+    for (size_t known = 1; known < n;)
+    {
+        size_t next = 2 * known < n ? 2 * known : n;
+        DenseMulLow(f, next, g, known, next, product);
+        for (size_t i = 0; i < next; ++i)
+        {
+            product[i] = -product[i];
+        }
+        product[0] += 2;
+        DenseMulLow(g, known, product, next, next, g);
+        known = next;
+    }
+    free(product);
+}
+
+/**
+ * Dzieli dzielną zapisaną w tablicy przez dzielnik o współczynniku wiodącym
+ * 1 lub -1, mnożąc odwróconą dzielną przez odwrotność odwróconego dzielnika
+ * (DenseSeriesInverse). Iloraz wyznaczany jest w czasie mnożenia tablic,
+ * a nie w czasie proporcjonalnym do iloczynu ich długości.
+ * @param[in, out] rest : współczynniki dzielnej; na wyjściu reszta (tylko
+ *                        współczynniki przy wykładnikach mniejszych niż
+ *                        stopień dzielnika)
+ * @param[in] p_deg      : stopień dzielnej
+ * @param[in] q_terms    : składniki dzielnika w kolejności malejących wykładników
+ * @param[in] q_count    : liczba składników dzielnika
+ * @param[out] quotient  : współczynniki ilorazu
+ */
+static void DenseDivideNewton(poly_coeff_t rest[], poly_exp_t p_deg,
+                              const Mono q_terms[], unsigned q_count,
+                              poly_coeff_t quotient[])
+{
+    poly_exp_t q_deg = q_terms[0].exp;
+    size_t length = p_deg - q_deg + 1;
+    uint64_t *reversed_q = calloc(length, sizeof(uint64_t));
+    uint64_t *inverse = malloc(length * sizeof(uint64_t));
+    uint64_t *reversed_p = calloc(length, sizeof(uint64_t));
+    uint64_t *q_coeffs = calloc(q_deg + 1, sizeof(uint64_t));
+    size_t product_length = length > (size_t)q_deg ? length : (size_t)q_deg;
+    uint64_t *product = malloc(product_length * sizeof(uint64_t));
+    assert(reversed_q && inverse && reversed_p && q_coeffs && product);
+    for (unsigned i = 0; i < q_count; ++i)
+    {
+        q_coeffs[q_terms[i].exp] = q_terms[i].p.abs_term;
+        if ((size_t)(q_deg - q_terms[i].exp) < length)
+        {
+            reversed_q[q_deg - q_terms[i].exp] = q_terms[i].p.abs_term;
+        }
+    }
+    for (size_t i = 0; i < length; ++i)
+    {
+        reversed_p[i] = rest[p_deg - i];
+    }
+    DenseSeriesInverse(reversed_q, length, inverse);
+    DenseMulLow(reversed_p, length, inverse, length, length, product);
+    for (size_t i = 0; i < length; ++i)
+    {
+        inverse[i] = product[length - 1 - i];
+        quotient[i] = inverse[i];
+    }
+    DenseMulLow(q_coeffs, q_deg + 1, inverse, length, q_deg, product);
+    for (poly_exp_t e = 0; e < q_deg; ++e)
+    {
+        rest[e] = (uint64_t)rest[e] - product[e];
+    }
+    free(product);
+    free(q_coeffs);
+    free(reversed_p);
+    free(inverse);
+    free(reversed_q);
+}
+
+/**
+ * Dzieli wielomian @p p przez @p q, gdy oba mają stałe współczynniki,
+ * a @p p jest gęsty.
+ * Gdy współczynnik wiodący @p q jest równy 1 lub -1, a dzielnik i iloraz są
+ * długie, iloraz wyznaczany jest przez DenseDivideNewton. W pozostałych
+ * przypadkach dzielenie wykonywane jest w miejscu na tablicy współczynników
+ * @p p, bez tworzenia pośrednich wielomianów.
+ * @param[in]  p    : dzielna stopnia nie mniejszego niż stopień @p q
+ * @param[in]  q    : niezerowy dzielnik
+ * @param[out] quot : iloraz
+ * @param[out] rem  : reszta
+ */
+static void PolyDivideDense(const Poly *p, const Poly *q, Poly *quot, Poly *rem)
+{
+    poly_exp_t p_deg = PolyDegBy(p, 0), q_deg = PolyDegBy(q, 0);
+    poly_coeff_t *rest = calloc(p_deg + 1, sizeof(poly_coeff_t));
+    poly_coeff_t *quotient = calloc(p_deg - q_deg + 1, sizeof(poly_coeff_t));
+    Mono *q_terms = malloc((q->size + 1) * sizeof(Mono));
+    assert(rest && quotient && q_terms);
+    rest[0] = p->abs_term;
     for (Mono *ptr = p->last; ptr != NULL; ptr = ptr->prev)
     {
-        assert((int)ptr->exp - (int)to_substitute_exp >= 0);
-        Poly pwr = PolyPower(&substitution, ptr->exp - to_substitute_exp);
-        ExecuteBinaryOnPoly(&to_substitute, PolyMul, &pwr);
-        to_substitute_exp = ptr->exp;
-        PolyDestroy(&pwr);
+        rest[ptr->exp] += ptr->p.abs_term;
+    }
+    unsigned q_count = PolyTermsView(q, q_terms);
+    poly_coeff_t lead = q_terms[0].p.abs_term;
+    if ((lead == 1 || lead == -1) && q_count >= NEWTON_DIVISION_THRESHOLD &&
+        (size_t)(p_deg - q_deg) >= NEWTON_DIVISION_THRESHOLD)
+    {
+        DenseDivideNewton(rest, p_deg, q_terms, q_count, quotient);
+    }
+    else
+    {
+        for (poly_exp_t e = p_deg; e >= q_deg; --e)
+        {
+            if (rest[e] == 0)
+            {
+                continue;
+            }
+            poly_coeff_t factor = rest[e] / lead;
+            quotient[e - q_deg] = factor;
+            for (unsigned i = 1; i < q_count; ++i)
+            {
+                rest[e - q_deg + q_terms[i].exp] -=
+                    factor * q_terms[i].p.abs_term;
+            }
+            rest[e] = 0;
+        }
+    }
+    *quot = PolyFromDenseArray(quotient, p_deg - q_deg);
+    *rem = PolyFromDenseArray(rest, q_deg - 1);
+    free(rest);
+    free(quotient);
+    free(q_terms);
+}
 
-        Poly result = MonoSubstitute(ptr, count, x, level, &to_substitute);
-        ExecuteBinaryOnPoly(&sum, PolyAdd, &result);
-        PolyDestroy(&result);
+/**
+ * Dzieli wielomian @p p przez @p q względem głównej zmiennej, wyznaczając
+ * współczynniki ilorazu dzieleniem dokładnym przez współczynnik wiodący @p q.
+ * Wybiera dzielenie na tablicach dla gęstych wielomianów jednej zmiennej
+ * i dzielenie kopcowe w pozostałych przypadkach.
+ * @param[in]  p    : dzielna
+ * @param[in]  q    : niezerowy dzielnik
+ * @param[out] quot : iloraz
+ * @param[out] rem  : reszta
+ */
+static void PolyDivide(const Poly *p, const Poly *q, Poly *quot, Poly *rem)
+{
+    if (PolyDegBy(p, 0) < PolyDegBy(q, 0))
+    {
+        *quot = PolyZero();
+        *rem = PolyClone(p);
+    }
+    else if (p->depth <= 1 && q->depth <= 1 &&
+             (size_t)PolyDegBy(p, 0) < DENSE_DIVISION_RATIO * (p->size + 1))
+    {
+        PolyDivideDense(p, q, quot, rem);
+    }
+    else
+    {
+        PolyDivideHeap(p, q, quot, rem);
     }
-    PolyDestroy(&to_substitute);
-    return sum;
 }
 
-Poly PolyCompose(const Poly *p, unsigned count, const Poly x[])
+/**
+ * @details Implementacja procedury PolyDivRem udokumentowanej w pliku poly.h.
+ * Dla współczynnika wiodącego różnego od 1 i -1 dzielna jest najpierw
+ * mnożona przez jego odpowiednią potęgę, dzięki czemu wszystkie dzielenia
+ * współczynników w trakcie dzielenia są dokładne.
+ * @param[in]  p    : dzielna
+ * @param[in]  q    : dzielnik
+ * @param[out] quot : iloraz
+ * @param[out] rem  : reszta
+ */
+void PolyDivRem(const Poly *p, const Poly *q, Poly *quot, Poly *rem)
 {
-    return PolySubstitute(p, count, x, 0);
+    assert(!PolyIsZero(q));
+    Poly lead = PolyLeadingCoeffView(q);
+    if (PolyIsCoeff(&lead) && (lead.abs_term == 1 || lead.abs_term == -1))
+    {
+        PolyDivide(p, q, quot, rem);
+        return;
+    }
+    poly_exp_t steps = PolyDegBy(p, 0) - PolyDegBy(q, 0) + 1;
+    if (steps <= 0)
+    {
+        *quot = PolyZero();
+        *rem = PolyClone(p);
+        return;
+    }
+    Poly power = PolyPow(&lead, steps);
+    Mono factor_term = MonoFromPoly(&power, 0);
+    Poly factor = PolyFromDescendingTerms(1, &factor_term);
+    Poly scaled = PolyMul(p, &factor);
+    PolyDivide(&scaled, q, quot, rem);
+    PolyDestroy(&scaled);
+    PolyDestroy(&factor);
+}
+
+/**
+ * @details Implementacja procedury PolyDivExact udokumentowanej w pliku poly.h.
+ * @param[in] p : dzielna
+ * @param[in] q : dzielnik
+ * @return `p / q`
+ */
+Poly PolyDivExact(const Poly *p, const Poly *q)
+{
+    assert(!PolyIsZero(q));
+    Poly quot, rem;
+    PolyDivide(p, q, &quot, &rem);
+    PolyDestroy(&rem);
+    return quot;
+}
+
+/**
+ * @details Implementacja procedury PolySetThreadCount udokumentowanej w pliku
+ * poly.h.
+ * @param[in] count : liczba wątków
+ */
+void PolySetThreadCount(unsigned count)
+{
+    PoolSetThreadCount(count);
+}
+
+/**
+ * Bufor zapisu binarnego wypełniany od końca. Zapisane bajty zajmują
+ * ostatnie `size` bajtów tablicy, więc długość zapisu współczynnika jest
+ * znana, zanim trzeba ją zapisać przed nim.
+ */
+typedef struct SerialBuffer
+{
+    unsigned char *data; ///< tablica
+    size_t capacity; ///< rozmiar tablicy
+    size_t size; ///< liczba zapisanych bajtów
+} SerialBuffer;
+
+/**
+ * Zapewnia w buforze miejsce na @p count kolejnych bajtów.
+ * @param[in, out] buffer : bufor
+ * @param[in] count       : liczba bajtów
+ */
+static void SerialBufferReserve(SerialBuffer *buffer, size_t count)
+{
+    if (buffer->capacity - buffer->size >= count)
+    {
+        return;
+    }
+    size_t capacity = 2 * buffer->capacity + count;
+    unsigned char *data = malloc(capacity);
+    assert(data);
+    if (buffer->size > 0)
+    {
+        memcpy(data + capacity - buffer->size,
+               buffer->data + buffer->capacity - buffer->size, buffer->size);
+    }
+    free(buffer->data);
+    buffer->data = data;
+    buffer->capacity = capacity;
+}
+
+/**
+ * Dopisuje na początek zapisu liczbę w kodowaniu o zmiennej długości.
+ * @param[in, out] buffer : bufor
+ * @param[in] value       : liczba
+ */
+static void SerialPrependVarint(SerialBuffer *buffer, uint64_t value)
+{
+    unsigned char bytes[10];
+    unsigned length = 0;
+    do
+    {
+        bytes[length++] = (value & 0x7f) | 0x80;
+        value >>= 7;
+    } while (value != 0);
+    bytes[length - 1] &= 0x7f;
+    SerialBufferReserve(buffer, length);
+    buffer->size += length;
+    memcpy(buffer->data + buffer->capacity - buffer->size, bytes, length);
+}
+
+/**
+ * Odwzorowuje współczynnik na liczbę bez znaku tak, by liczby o małej
+ * wartości bezwzględnej miały małe obrazy (0, -1, 1, -2, ... na 0, 1, 2, 3,
+ * ...).
+ * @param[in] value : współczynnik
+ * @return obraz współczynnika
+ */
+static inline uint64_t ZigZagEncode(poly_coeff_t value)
+{
+    return ((uint64_t)value << 1) ^ -(uint64_t)(value < 0);
+}
+
+/**
+ * Odwraca odwzorowanie ZigZagEncode.
+ * @param[in] value : obraz współczynnika
+ * @return współczynnik
+ */
+static inline poly_coeff_t ZigZagDecode(uint64_t value)
+{
+    return (poly_coeff_t)((value >> 1) ^ -(value & 1));
+}
+
+/**
+ * Stan zapisu wielomianu, którego jednomiany są właśnie zapisywane.
+ */
+typedef struct SerialFrame
+{
+    const Poly *poly; ///< zapisywany wielomian
+    const Mono *mono; ///< jednomian, którego współczynnik jest zapisywany
+    size_t end; ///< długość zapisu przed rozpoczęciem sekcji jednomianów
+    unsigned count; ///< liczba zapisanych jednomianów
+} SerialFrame;
+
+/**
+ * @details Implementacja procedury PolySerialize udokumentowanej w pliku
+ * poly.h.
+ * Zapis tworzony jest od końca - jednomiany przechodzone są w kolejności
+ * malejących wykładników, a nagłówek wielomianu zapisywany jest po jego
+ * jednomianach, gdy długość ich sekcji jest już znana. Struktura wielomianu
+ * przechodzona jest bez rekurencji, ze stosem o głębokości nieprzekraczającej
+ * głębokości zagnieżdżenia wielomianu.
+ * @param[in] p     : wielomian
+ * @param[out] size : długość zapisu w bajtach
+ * @return zapis
+ */
+void* PolySerialize(const Poly *p, size_t *size)
+{
+    SerialBuffer buffer = {.data = NULL, .capacity = 0, .size = 0};
+    SerialBufferReserve(&buffer, 4 * p->size + 16);
+    SerialFrame *frames = NULL;
+    if (p->depth > 0)
+    {
+        frames = malloc(p->depth * sizeof(SerialFrame));
+        assert(frames);
+    }
+    unsigned top = 0;
+    const Poly *current = p;
+    while (current != NULL)
+    {
+        if (!PolyIsCoeff(current))
+        {
+            frames[top++] = (SerialFrame) {.poly = current,
+                                           .mono = current->first,
+                                           .end = buffer.size, .count = 0};
+            current = &current->first->p;
+            continue;
+        }
+        SerialPrependVarint(&buffer, 0);
+        SerialPrependVarint(&buffer, ZigZagEncode(current->abs_term));
+        //zamykamy jednomiany, których współczynniki zostały zapisane
+        current = NULL;
+        while (current == NULL && top > 0)
+        {
+            SerialFrame *frame = &frames[top - 1];
+            const Mono *mono = frame->mono;
+            poly_exp_t below = mono->next != NULL ? mono->next->exp : 0;
+            SerialPrependVarint(&buffer, mono->exp - below);
+            frame->count += 1;
+            if (mono->next != NULL)
+            {
+                frame->mono = mono->next;
+                current = &mono->next->p;
+                break;
+            }
+            SerialPrependVarint(&buffer, buffer.size - frame->end);
+            SerialPrependVarint(&buffer, frame->count);
+            SerialPrependVarint(&buffer, ZigZagEncode(frame->poly->abs_term));
+            --top;
+        }
+    }
+    free(frames);
+    memmove(buffer.data, buffer.data + buffer.capacity - buffer.size,
+            buffer.size);
+    *size = buffer.size;
+    return buffer.data;
+}
+
+/**
+ * Wczytuje liczbę zapisaną w kodowaniu o zmiennej długości.
+ * @param[in, out] ptr : pozycja w zapisie
+ * @param[in] end      : koniec zapisu
+ * @param[out] out     : liczba
+ * @return Czy udało się wczytać liczbę?
+ */
+static inline bool SerialReadVarint(const unsigned char **ptr,
+                                    const unsigned char *end, uint64_t *out)
+{
+    if (*ptr < end && **ptr < 0x80)
+    {
+        *out = *(*ptr)++;
+        return true;
+    }
+    uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64 && *ptr < end; shift += 7)
+    {
+        unsigned char c = *(*ptr)++;
+        value |= (uint64_t)(c & 0x7f) << shift;
+        if (c < 0x80)
+        {
+            *out = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Stan odtwarzania wielomianu, którego jednomiany są właśnie wczytywane.
+ */
+typedef struct DeserialFrame
+{
+    Poly poly; ///< odtwarzany wielomian
+    uint64_t remaining; ///< liczba jednomianów do wczytania
+    long exp; ///< wykładnik wczytywanego jednomianu lub -1 przed pierwszym
+    const unsigned char *section_end; ///< koniec sekcji jednomianów
+} DeserialFrame;
+
+/**
+ * Wczytuje wykładnik kolejnego jednomianu wielomianu.
+ * Wykładniki muszą rosnąć i mieścić się w typie poly_exp_t.
+ * @param[in, out] frame : stan odtwarzanego wielomianu
+ * @param[in, out] ptr   : pozycja w zapisie
+ * @return Czy udało się wczytać wykładnik?
+ */
+static bool DeserialReadExp(DeserialFrame *frame, const unsigned char **ptr)
+{
+    uint64_t delta;
+    if (!SerialReadVarint(ptr, frame->section_end, &delta) ||
+        delta > INT_MAX || (frame->exp >= 0 && delta == 0) ||
+        (frame->exp >= 0 && delta > (uint64_t)(INT_MAX - frame->exp)))
+    {
+        return false;
+    }
+    frame->exp = frame->exp < 0 ? (long)delta : frame->exp + (long)delta;
+    return true;
+}
+
+/**
+ * @details Implementacja procedury PolyDeserialize udokumentowanej w pliku
+ * poly.h.
+ * Jednomiany zapisane są w kolejności rosnących wykładników, więc wielomian
+ * budowany jest bezpośrednio, bez sortowania i sumowania jednomianów.
+ * Zapis musi być postacią kanoniczną wielomianu: współczynniki jednomianów
+ * są niezerowe, a współczynnik jednomianu o wykładniku 0 nie jest stały
+ * i ma zerowy wyraz wolny. Zagnieżdżenie współczynników obsługiwane jest bez
+ * rekurencji.
+ * @param[in] data : bufor z zapisem
+ * @param[in] size : długość bufora
+ * @param[out] out : wielomian
+ * @return długość odczytanego zapisu lub 0
+ */
+size_t PolyDeserialize(const void *data, size_t size, Poly *out)
+{
+    const unsigned char *ptr = data, *end = ptr + size;
+    DeserialFrame *frames = NULL;
+    unsigned top = 0, capacity = 0;
+    bool ok = true;
+    while (ok)
+    {
+        const unsigned char *limit = top > 0 ? frames[top - 1].section_end : end;
+        uint64_t abs_term, count, length;
+        if (!SerialReadVarint(&ptr, limit, &abs_term) ||
+            !SerialReadVarint(&ptr, limit, &count))
+        {
+            break;
+        }
+        if (count > 0)
+        {
+            if (!SerialReadVarint(&ptr, limit, &length) ||
+                length > (uint64_t)(limit - ptr))
+            {
+                break;
+            }
+            if (top == capacity)
+            {
+                capacity = 2 * capacity + 8;
+                frames = realloc(frames, capacity * sizeof(DeserialFrame));
+                assert(frames);
+            }
+            DeserialFrame *frame = &frames[top++];
+            *frame = (DeserialFrame) {
+                .poly = PolyFromCoeff(ZigZagDecode(abs_term)),
+                .remaining = count, .exp = -1, .section_end = ptr + length};
+            ok = DeserialReadExp(frame, &ptr);
+            continue;
+        }
+        Poly current = PolyFromCoeff(ZigZagDecode(abs_term));
+        //dokładamy jednomiany, których współczynniki zostały odtworzone
+        while (top > 0)
+        {
+            DeserialFrame *frame = &frames[top - 1];
+            if (PolyIsZero(&current) || (frame->exp == 0 &&
+                (PolyIsCoeff(&current) || current.abs_term != 0)))
+            {
+                PolyDestroy(&current);
+                ok = false;
+                break;
+            }
+            PolyAppendMono(&frame->poly, MonoFromPoly(&current, frame->exp));
+            if (--frame->remaining > 0)
+            {
+                ok = DeserialReadExp(frame, &ptr);
+                break;
+            }
+            if (ptr != frame->section_end)
+            {
+                ok = false;
+                break;
+            }
+            current = frame->poly;
+            --top;
+        }
+        if (ok && top == 0)
+        {
+            free(frames);
+            *out = current;
+            return ptr - (const unsigned char*)data;
+        }
+    }
+    for (unsigned i = 0; i < top; ++i)
+    {
+        PolyDestroy(&frames[i].poly);
+    }
+    free(frames);
+    return 0;
 }
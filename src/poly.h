@@ -1,6 +1,13 @@
 /** @file
    Interfejs klasy wielomianów
 
+   Funkcje biblioteki mogą być wywoływane równocześnie z wielu wątków, o ile
+   żaden wielomian nie jest w tym czasie modyfikowany ani niszczony przez jeden
+   wątek i jednocześnie używany przez inny. Wielomiany przekazywane jako
+   argumenty tylko do odczytu (`const`) mogą być współdzielone. Wyjątkiem jest
+   PolySetThreadCount, która nie może być wywoływana równocześnie z innymi
+   funkcjami biblioteki.
+
    @author Jakub Pawlewicz <pan@mimuw.edu.pl>,\n
    Michał Balcerzak <mb385130@students.mimuw.edu.pl>
    @copyright Uniwersytet Warszawski
@@ -12,6 +19,7 @@
 #define __POLY_H__
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 
@@ -21,8 +29,14 @@ typedef long poly_coeff_t;
 /** Typ wykładników wielomianu */
 typedef int poly_exp_t;
 
+/** Typ skrótu (ang. hash) struktury wielomianu */
+typedef uint64_t poly_hash_t;
+
 typedef struct Mono Mono;
 
+/** Drukarka buforująca wypisywany tekst (zob. printer.h). */
+typedef struct Printer Printer;
+
 /**
  * Struktura przechowująca wielomian.
  * Wielomian ma postać @f$(m_1 + m_2 + … + m_n) + b@f$ gdzie @f$m_1…m_n@f$
@@ -34,12 +48,23 @@ typedef struct Mono Mono;
  * jest listą pustą. W takim przypadku oba wskaźniki na skrajne elementy listy
  * wskazują na NULL. Wszelkie składniki stałe (niezależne od zmiennych)
  * są pamiętane w wyrazie wolnym.
+ * Struktura przechowuje ponadto obliczone podczas jej budowy metadane:
+ * stopień, stopnie względem kolejnych zmiennych, głębokość zagnieżdżenia
+ * oraz liczbę jednomianów. Dzięki nim PolyDeg i PolyDegBy działają w czasie
+ * stałym. Przechowywany jest również skrót struktury listy jednomianów,
+ * pozwalający PolyIsEq odrzucać różne wielomiany w czasie stałym.
+ * Wyzerowana struktura z wyrazem wolnym `c` jest poprawnym wielomianem stałym.
  */
 typedef struct Poly
 {
     Mono *first; ///< pierwszy element listy jednomianów (największy wykładnik)
     Mono *last; ///< ostatni element listy jednomianów (najmniejszy wykładnik)
     poly_coeff_t abs_term; ///< wartość wyrazu wolnego
+    poly_exp_t deg; ///< stopień wielomianu (0 dla wielomianu stałego)
+    poly_exp_t *deg_by; ///< stopnie względem kolejnych zmiennych (tablica o długości `depth`)
+    unsigned depth; ///< głębokość zagnieżdżenia - liczba zmiennych wielomianu
+    size_t size; ///< łączna liczba jednomianów w strukturze wielomianu
+    poly_hash_t hash; ///< skrót listy jednomianów (bez wyrazu wolnego)
 } Poly;
 
 
@@ -71,7 +96,8 @@ typedef struct Mono
  */
 static inline Poly PolyFromCoeff(poly_coeff_t c)
 {
-    return (Poly) {.first = NULL, .last = NULL, .abs_term = c};
+    return (Poly) {.first = NULL, .last = NULL, .abs_term = c,
+        .deg = 0, .deg_by = NULL, .depth = 0, .size = 0, .hash = 0};
 }
 
 /**
@@ -105,6 +131,17 @@ static inline Mono MonoFromPoly(const Poly *p, poly_exp_t e)
  */
 Poly PolyAddMonos(unsigned count, const Mono monos[]);
 
+/**
+ * Sumuje listę jednomianów i tworzy z nich wielomian, tak jak PolyAddMonos,
+ * ale bez kopiowania tablicy - kolejność jej elementów może się zmienić.
+ * Jednomiany podane w kolejności rosnących lub malejących wykładników nie
+ * są sortowane. Przejmuje na własność zawartość tablicy @p monos.
+ * @param[in] count      : liczba jednomianów
+ * @param[in, out] monos : tablica jednomianów
+ * @return wielomian będący sumą jednomianów
+ */
+Poly PolyAddMonosInPlace(unsigned count, Mono monos[]);
+
 /*}@**/
 
 
@@ -180,6 +217,29 @@ Poly PolyCoeffMul(const Poly *p, poly_coeff_t x);
  */
 Poly PolyMul(const Poly *p, const Poly *q);
 
+/**
+ * Mnoży dwa wielomiany i dodaje do iloczynu trzeci. Wynik jest równy
+ * `PolyAdd(PolyMul(p, q), r)`, ale iloczyn nie jest budowany osobno.
+ * @param[in] p : wielomian
+ * @param[in] q : wielomian
+ * @param[in] r : wielomian
+ * @return `p * q + r`
+ */
+Poly PolyMulAdd(const Poly *p, const Poly *q, const Poly *r);
+
+/**
+ * Podnosi wielomian do potęgi. Metoda obliczeń zależy od postaci
+ * wielomianu: dwumiany rozwijane są wzorem Newtona, gęste wielomiany jednej
+ * zmiennej o niewielkich współczynnikach - rekurencją Millera, a pozostałe -
+ * szybkim potęgowaniem z osobną procedurą podnoszenia do kwadratu. Wynik
+ * jest równy iloczynowi @p exp kopii wielomianu @p p obliczanemu przez
+ * PolyMul, o ile współczynniki nie przekraczają zakresu poly_coeff_t.
+ * @param[in] p   : wielomian
+ * @param[in] exp : nieujemny wykładnik
+ * @return `p^exp`
+ */
+Poly PolyPow(const Poly *p, poly_exp_t exp);
+
 /**
  * Zwraca przeciwny wielomian.
  * @param[in] p : wielomian
@@ -195,6 +255,48 @@ Poly PolyNeg(const Poly *p);
  */
 Poly PolySub(const Poly *p, const Poly *q);
 
+/**
+ * Dzieli wielomian z resztą względem głównej zmiennej.
+ * Jeżeli współczynnik wiodący @p q jest stałą równą 1 lub -1, wyznacza
+ * iloraz @p quot i resztę @p rem takie, że `p = quot * q + rem`, a stopień
+ * reszty względem głównej zmiennej jest mniejszy niż stopień @p q.
+ * W przeciwnym wypadku wykonuje dzielenie pseudo: dla @f$c@f$ będącego
+ * współczynnikiem wiodącym @p q oraz @f$k = \max(0, \deg p - \deg q + 1)@f$
+ * (stopnie względem głównej zmiennej) zachodzi
+ * @f$c^k p = \verb|quot| \cdot q + \verb|rem|@f$.
+ * Wielomian @p q nie może być tożsamościowo równy zeru.
+ * @param[in]  p    : dzielna
+ * @param[in]  q    : dzielnik
+ * @param[out] quot : iloraz
+ * @param[out] rem  : reszta
+ */
+void PolyDivRem(const Poly *p, const Poly *q, Poly *quot, Poly *rem);
+
+/**
+ * Dzieli wielomian przez wielomian, który jest jego dzielnikiem.
+ * Wynik jest określony jedynie wtedy, gdy @p q dzieli @p p bez reszty
+ * w pierścieniu wielomianów o współczynnikach całkowitych.
+ * Wielomian @p q nie może być tożsamościowo równy zeru.
+ * @param[in] p : dzielna
+ * @param[in] q : dzielnik
+ * @return `p / q`
+ */
+Poly PolyDivExact(const Poly *p, const Poly *q);
+
+/**
+ * Wyznacza największy wspólny dzielnik dwóch wielomianów.
+ * Wynik jest określony z dokładnością do znaku - zwracany jest wielomian,
+ * którego współczynnik przy największym (leksykograficznie, zgodnie
+ * z zagnieżdżeniem zmiennych) jednomianie jest dodatni. NWD dwóch wielomianów
+ * zerowych jest wielomianem zerowym. Wymaga, by współczynniki NWD pomnożonego
+ * przez NWD całkowitych współczynników wiodących @p p i @p q mieściły się
+ * w typie poly_coeff_t.
+ * @param[in] p : wielomian
+ * @param[in] q : wielomian
+ * @return `gcd(p, q)`
+ */
+Poly PolyGcd(const Poly *p, const Poly *q);
+
 /*}@**/
 
 
@@ -229,6 +331,15 @@ static inline bool PolyIsZero(const Poly *p)
  */
 bool PolyIsEq(const Poly *p, const Poly *q);
 
+/**
+ * Zwraca skrót struktury wielomianu.
+ * Równe wielomiany mają równe skróty. Skrót obliczany jest w czasie stałym
+ * na podstawie metadanych wielomianu.
+ * @param[in] p : wielomian
+ * @return skrót wielomianu @p p
+ */
+poly_hash_t PolyHash(const Poly *p);
+
 /*}@**/
 
 
@@ -308,6 +419,317 @@ void PrintPolyVar(const Poly *p);
  */
 void PrintPoly(const Poly *p);
 
+
+/**
+ * Dopisuje do bufora drukarki zawartość struktury wielomianu w formacie
+ * funkcji PrintPolyVar.
+ * @param[in, out] printer : drukarka
+ * @param[in] p            : wielomian
+ */
+void PrinterPutPolyVar(Printer *printer, const Poly *p);
+
+
+/**
+ * Dopisuje do bufora drukarki zawartość struktury wielomianu w formacie
+ * akceptowanym przez kalkulator wielomianów.
+ * Pozwala wypisać wiele wielomianów bez opróżniania bufora po każdym z nich.
+ * @param[in, out] printer : drukarka
+ * @param[in] p            : wielomian
+ */
+void PrinterPutPoly(Printer *printer, const Poly *p);
+
+/*}@**/
+
+
+/**@name Wielomiany współdzielone
+   Uchwyt PolyRef pozwala wielu wątkom korzystać z jednego egzemplarza
+   wielomianu zamiast z osobnych kopii. Wielomian uchwytu jest niezmienny,
+   więc można go równocześnie przekazywać jako argument `const` (np. do
+   PolyAt, PolyIsEq, PolyDeg czy PrintPoly). Licznik referencji jest atomowy,
+   a wielomian jest niszczony przy zwolnieniu ostatniej referencji.
+   @{*/
+
+/** Współdzielony wielomian ze zliczaniem referencji. */
+typedef struct PolyRef PolyRef;
+
+/**
+ * Tworzy uchwyt z jedną referencją, przejmując na własność wielomian @p p.
+ * Po wywołaniu @p p jest wielomianem zerowym.
+ * @param[in, out] p : wielomian
+ * @return uchwyt
+ */
+PolyRef* PolyRefCreate(Poly *p);
+
+/**
+ * Dodaje referencję do uchwytu.
+ * @param[in] ref : uchwyt
+ * @return `ref`
+ */
+PolyRef* PolyRefAcquire(PolyRef *ref);
+
+/**
+ * Zwalnia referencję do uchwytu. Zwolnienie ostatniej referencji niszczy
+ * wielomian i uchwyt. Dla `NULL` nic nie robi.
+ * @param[in] ref : uchwyt
+ */
+void PolyRefRelease(PolyRef *ref);
+
+/**
+ * Zwraca wielomian uchwytu. Wskaźnik jest ważny, dopóki wywołujący posiada
+ * referencję.
+ * @param[in] ref : uchwyt
+ * @return wielomian
+ */
+const Poly* PolyRefGet(const PolyRef *ref);
+
+/**
+ * Zwraca bieżącą liczbę referencji uchwytu. Przy równoczesnym użyciu przez
+ * wiele wątków wynik może być nieaktualny.
+ * @param[in] ref : uchwyt
+ * @return liczba referencji
+ */
+unsigned PolyRefCount(PolyRef *ref);
+
+/*}@**/
+
+/**@name Wyrażenia leniwe
+   Wyrażenie PolyExpr opisuje wielomian, który nie musi być jeszcze
+   obliczony: węzły grafu wyrażenia to działania, a liście - wielomiany.
+   Wyrażenia budowane przez PolyExprAdd, PolyExprMul, PolyExprNeg, PolyExprSub
+   i PolyExprAt są od razu przekształcane: suma, której składnikiem jest
+   nieobliczony iloczyn, staje się jednym mnożeniem z dodawaniem (PolyMulAdd),
+   a wartość w punkcie sumy lub iloczynu - sumą lub iloczynem wartości
+   składników, więc iloczyn nie musi zostać rozwinięty. PolyExprDeg,
+   PolyExprIsZero i PolyExprIsCoeff w miarę możliwości odpowiadają bez
+   obliczania wyrażenia, a dopiero PolyExprEval wyznacza wielomian.
+   Wyniki są identyczne jak przy wykonaniu działań od razu, o ile
+   współczynniki wyników pośrednich nie przekraczają zakresu poly_coeff_t.
+   Funkcje budujące przejmują referencje do argumentów i zwracają nową
+   referencję. Licznik referencji nie jest atomowy - jednego grafu wyrażeń
+   powinien używać jeden wątek.
+   @{*/
+
+/** Wyrażenie o wartości wielomianowej ze zliczaniem referencji. */
+typedef struct PolyExpr PolyExpr;
+
+/**
+ * Tworzy wyrażenie z jedną referencją, przejmując na własność wielomian @p p.
+ * Po wywołaniu @p p jest wielomianem zerowym.
+ * @param[in, out] p : wielomian
+ * @return wyrażenie
+ */
+PolyExpr* PolyExprCreate(Poly *p);
+
+/**
+ * Dodaje referencję do wyrażenia.
+ * @param[in] e : wyrażenie
+ * @return `e`
+ */
+PolyExpr* PolyExprAcquire(PolyExpr *e);
+
+/**
+ * Zwalnia referencję do wyrażenia. Zwolnienie ostatniej referencji niszczy
+ * wyrażenie i zwalnia referencje do jego argumentów. Dla `NULL` nic nie robi.
+ * @param[in] e : wyrażenie
+ */
+void PolyExprRelease(PolyExpr *e);
+
+/**
+ * Tworzy wyrażenie - sumę dwóch wyrażeń.
+ * @param[in] p : wyrażenie
+ * @param[in] q : wyrażenie
+ * @return `p + q`
+ */
+PolyExpr* PolyExprAdd(PolyExpr *p, PolyExpr *q);
+
+/**
+ * Tworzy wyrażenie - iloczyn dwóch wyrażeń.
+ * @param[in] p : wyrażenie
+ * @param[in] q : wyrażenie
+ * @return `p * q`
+ */
+PolyExpr* PolyExprMul(PolyExpr *p, PolyExpr *q);
+
+/**
+ * Tworzy wyrażenie przeciwne.
+ * @param[in] p : wyrażenie
+ * @return `-p`
+ */
+PolyExpr* PolyExprNeg(PolyExpr *p);
+
+/**
+ * Tworzy wyrażenie - różnicę dwóch wyrażeń.
+ * @param[in] p : wyrażenie
+ * @param[in] q : wyrażenie
+ * @return `p - q`
+ */
+PolyExpr* PolyExprSub(PolyExpr *p, PolyExpr *q);
+
+/**
+ * Tworzy wyrażenie - wartość wyrażenia dla pierwszej zmiennej równej @p x
+ * (zob. PolyAt).
+ * @param[in] p : wyrażenie
+ * @param[in] x : wartość pierwszej ze zmiennych
+ * @return @f$p(x, x_0, x_1, \ldots)@f$
+ */
+PolyExpr* PolyExprAt(PolyExpr *p, poly_coeff_t x);
+
+/**
+ * Oblicza wyrażenie. Obliczony wielomian zastępuje w grafie wyrażenie, więc
+ * kolejne wywołania nie powtarzają obliczeń.
+ * @param[in, out] e : wyrażenie
+ * @return wielomian ważny, dopóki wywołujący posiada referencję
+ */
+const Poly* PolyExprEval(PolyExpr *e);
+
+/**
+ * Oblicza wyrażenie i zwalnia referencję do niego. Gdy była to jedyna
+ * referencja, wielomian jest przenoszony bez kopiowania.
+ * @param[in] e : wyrażenie
+ * @return wielomian
+ */
+Poly PolyExprTake(PolyExpr *e);
+
+/**
+ * Zwraca stopień wyrażenia (zob. PolyDeg). Stopień iloczynu i sumy
+ * wyznaczany jest, gdy to możliwe, ze stopni argumentów.
+ * @param[in, out] e : wyrażenie
+ * @return stopień wyrażenia (-1 dla wyrażenia równego zeru)
+ */
+poly_exp_t PolyExprDeg(PolyExpr *e);
+
+/**
+ * Sprawdza, czy wyrażenie jest tożsamościowo równe zeru.
+ * @param[in, out] e : wyrażenie
+ * @return Czy wyrażenie jest równe zeru?
+ */
+bool PolyExprIsZero(PolyExpr *e);
+
+/**
+ * Sprawdza, czy wyrażenie jest współczynnikiem (wielomianem stałym).
+ * @param[in, out] e : wyrażenie
+ * @return Czy wyrażenie jest współczynnikiem?
+ */
+bool PolyExprIsCoeff(PolyExpr *e);
+
+/*}@**/
+
+/**@name Serializacja
+   Zapis binarny wielomianu ma postać: wyraz wolny, liczba jednomianów
+   i - gdy jest ona dodatnia - długość w bajtach sekcji jednomianów, po której
+   następują jednomiany w kolejności rosnących wykładników. Jednomian to
+   różnica jego wykładnika i wykładnika poprzedniego jednomianu (dla
+   pierwszego - sam wykładnik), po której następuje zapis współczynnika.
+   Liczby zapisywane są w kodowaniu o zmiennej długości (po 7 bitów
+   w bajcie), a wyrazy wolne dodatkowo w kodowaniu zygzakowatym, przez co
+   liczby o małej wartości bezwzględnej zajmują jeden bajt. Dzięki długości
+   sekcji zapis współczynnika można pominąć bez jego dekodowania.
+   @{*/
+
+/**
+ * Zapisuje wielomian w postaci binarnej.
+ * @param[in] p     : wielomian
+ * @param[out] size : długość zapisu w bajtach
+ * @return zapis zaalokowany funkcją malloc; zwalnia go wywołujący
+ */
+void* PolySerialize(const Poly *p, size_t *size);
+
+/**
+ * Odtwarza wielomian z zapisu binarnego utworzonego przez PolySerialize.
+ * Zapis może być początkiem dłuższego bufora - wtedy kolejny zapis zaczyna
+ * się pod zwróconym przesunięciem. Poprawność zapisu jest sprawdzana.
+ * @param[in] data  : bufor z zapisem
+ * @param[in] size  : długość bufora w bajtach
+ * @param[out] out  : wielomian
+ * @return długość odczytanego zapisu lub 0, gdy zapis jest niepoprawny
+ */
+size_t PolyDeserialize(const void *data, size_t size, Poly *out);
+
+/*}@**/
+
+
+/**@name Operacje asynchroniczne
+   Operacje asynchroniczne wykonywane są na kopiach argumentów, więc argumenty
+   można zniszczyć zaraz po wywołaniu. Operacje podejmowane są w kolejności
+   rozpoczęcia przez bezczynne wątki puli biblioteki, więc przy kilku wątkach
+   (zob. PolySetThreadCount) kilka operacji może być wykonywanych
+   jednocześnie. Przy jednym wątku operacje wykonuje kolejno własny wątek tła
+   biblioteki, więc wywołujący nie czeka na wynik. Każdy uchwyt musi zostać
+   przekazany dokładnie raz do PolyWait albo PolyCancel.
+   @{*/
+
+/** Uchwyt operacji asynchronicznej. */
+typedef struct PolyOperation PolyOperation;
+
+/**
+ * Rozpoczyna asynchroniczne mnożenie wielomianów `p * q`.
+ * @param[in] p       : wielomian
+ * @param[in] q       : wielomian
+ * @param[out] handle : uchwyt operacji
+ */
+void PolyMulAsync(const Poly *p, const Poly *q, PolyOperation **handle);
+
+/**
+ * Rozpoczyna asynchroniczne złożenie wielomianów (zob. PolyCompose).
+ * @param[in] p       : wielomian
+ * @param[in] count   : liczba wielomianów podstawianych za zmienne
+ * @param[in] x       : wielomiany podstawiane za zmienne
+ * @param[out] handle : uchwyt operacji
+ */
+void PolyComposeAsync(const Poly *p, unsigned count, const Poly x[],
+                      PolyOperation **handle);
+
+/**
+ * Sprawdza bez oczekiwania, czy operacja została zakończona.
+ * @param[in] handle : uchwyt operacji
+ * @return Czy wynik jest gotowy?
+ */
+bool PolyPoll(PolyOperation *handle);
+
+/**
+ * Czeka na zakończenie operacji, wykonując w tym czasie zadania puli,
+ * i zwalnia jej uchwyt.
+ * @param[in] handle : uchwyt operacji
+ * @return wynik operacji
+ */
+Poly PolyWait(PolyOperation *handle);
+
+/**
+ * Porzuca operację i zwalnia jej uchwyt bez oczekiwania. Anulowanie działa
+ * tylko przed rozpoczęciem operacji: operacja, która jeszcze się nie
+ * rozpoczęła, nie zostanie wykonana. Operacja w toku nie jest przerywana -
+ * zajmuje wątek puli aż do zakończenia, a jej wynik jest wtedy niszczony.
+ * Dla `NULL` nic nie robi.
+ * @param[in] handle : uchwyt operacji
+ */
+void PolyCancel(PolyOperation *handle);
+
+/*}@**/
+
+
+/**@name Konfiguracja
+   @{*/
+
+/**
+ * Ustawia liczbę wątków, z których korzystają operacje na wielomianach.
+ * Dla wartości 0 lub 1 (domyślnie) wszystkie operacje poza asynchronicznymi
+ * wykonywane są sekwencyjnie w wątku wywołującym. Wyniki nie zależą od liczby
+ * wątków. Przed zmianą czeka na zakończenie porzuconych operacji
+ * asynchronicznych i kończy wątek tła. Nie może być wywołana w trakcie
+ * wykonywania operacji na wielomianach.
+ * @param[in] count : liczba wątków
+ */
+void PolySetThreadCount(unsigned count);
+
+/**
+ * Zwalnia pamięć podręczną jednomianów bieżącego wątku.
+ * Każdy wątek przechowuje ograniczoną liczbę zwolnionych jednomianów, by
+ * ponownie użyć ich bez odwoływania się do wspólnego alokatora. Pamięć ta jest
+ * zwalniana automatycznie przy zakończeniu wątku - poza wątkiem głównym,
+ * który powinien wywołać tę funkcję przed zakończeniem programu.
+ */
+void PolyReleaseThreadCache();
+
 /*}@**/
 
 #endif /* __POLY_H__ */
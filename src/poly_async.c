@@ -0,0 +1,188 @@
+/** @file
+   Implementacja asynchronicznych operacji na wielomianach
+
+   Operacja asynchroniczna wykonywana jest jako odłączone zadanie puli wątków
+   na kopiach argumentów. Uchwyt operacji współdzielony jest przez zadanie
+   i wywołującego - każde z nich posiada jedną referencję, a zwolnienie
+   ostatniej niszczy argumenty, wynik i sam uchwyt. Dzięki temu anulowanie
+   operacji w toku nie wymaga oczekiwania na jej zakończenie.
+
+   @author agent
+   @date 2026-10-19
+ */
+
+
+#include <assert.h>
+#include <stdatomic.h>
+#include "poly.h"
+#include "thread_pool.h"
+#include "utils.h"
+
+
+/** Rodzaj operacji asynchronicznej. */
+typedef enum PolyOperationKind
+{
+    POLY_OPERATION_MUL, ///< mnożenie wielomianów
+    POLY_OPERATION_COMPOSE ///< złożenie wielomianów
+} PolyOperationKind;
+
+/**
+ * Uchwyt operacji asynchronicznej.
+ */
+struct PolyOperation
+{
+    PolyOperationKind kind; ///< rodzaj operacji
+    Poly p; ///< kopia pierwszego argumentu
+    Poly q; ///< kopia drugiego argumentu mnożenia
+    unsigned count; ///< liczba wielomianów podstawianych przy złożeniu
+    Poly *x; ///< kopie wielomianów podstawianych przy złożeniu
+    Poly result; ///< wynik operacji
+    atomic_bool done; ///< czy wynik jest gotowy
+    atomic_bool cancelled; ///< czy operacja została anulowana
+    atomic_uint refs; ///< liczba referencji (wywołujący i zadanie)
+};
+
+/**
+ * Tworzy uchwyt operacji z dwiema referencjami.
+ * @param[in] kind : rodzaj operacji
+ * @param[in] p    : pierwszy argument
+ * @return uchwyt
+ */
+static PolyOperation* PolyOperationCreate(PolyOperationKind kind, const Poly *p)
+{
+    PolyOperation *op = malloc(sizeof(PolyOperation));
+    assert(op);
+    op->kind = kind;
+    op->p = PolyClone(p);
+    op->q = PolyZero();
+    op->count = 0;
+    op->x = NULL;
+    op->result = PolyZero();
+    atomic_init(&op->done, false);
+    atomic_init(&op->cancelled, false);
+    atomic_init(&op->refs, 2);
+    return op;
+}
+
+/**
+ * Zwalnia referencję do uchwytu, a przy ostatniej - niszczy go.
+ * @param[in] op : uchwyt
+ */
+static void PolyOperationRelease(PolyOperation *op)
+{
+    if (atomic_fetch_sub_explicit(&op->refs, 1, memory_order_acq_rel) != 1)
+    {
+        return;
+    }
+    PolyDestroy(&op->p);
+    PolyDestroy(&op->q);
+    for (unsigned i = 0; i < op->count; ++i)
+    {
+        PolyDestroy(&op->x[i]);
+    }
+    free(op->x);
+    PolyDestroy(&op->result);
+    free(op);
+}
+
+/**
+ * Wykonuje operację, o ile nie została anulowana przed rozpoczęciem.
+ * Anulowanie w trakcie obliczeń nie przerywa ich.
+ * @param[in, out] arg : uchwyt operacji (PolyOperation)
+ */
+static void RunPolyOperation(void *arg)
+{
+    PolyOperation *op = arg;
+    if (!atomic_load(&op->cancelled))
+    {
+        switch (op->kind)
+        {
+            case POLY_OPERATION_MUL:
+                op->result = PolyMul(&op->p, &op->q);
+                break;
+            case POLY_OPERATION_COMPOSE:
+                op->result = PolyCompose(&op->p, op->count, op->x);
+                break;
+        }
+    }
+    atomic_store(&op->done, true);
+    PolyOperationRelease(op);
+}
+
+/**
+ * @details Implementacja procedury PolyMulAsync udokumentowanej w pliku poly.h.
+ * @param[in] p       : wielomian
+ * @param[in] q       : wielomian
+ * @param[out] handle : uchwyt operacji
+ */
+void PolyMulAsync(const Poly *p, const Poly *q, PolyOperation **handle)
+{
+    PolyOperation *op = PolyOperationCreate(POLY_OPERATION_MUL, p);
+    op->q = PolyClone(q);
+    *handle = op;
+    PoolSpawnDetached(RunPolyOperation, op);
+}
+
+/**
+ * @details Implementacja procedury PolyComposeAsync udokumentowanej w pliku
+ * poly.h.
+ * @param[in] p       : wielomian
+ * @param[in] count   : liczba wielomianów podstawianych za zmienne
+ * @param[in] x       : wielomiany podstawiane za zmienne
+ * @param[out] handle : uchwyt operacji
+ */
+void PolyComposeAsync(const Poly *p, unsigned count, const Poly x[],
+                      PolyOperation **handle)
+{
+    PolyOperation *op = PolyOperationCreate(POLY_OPERATION_COMPOSE, p);
+    if (count > 0)
+    {
+        op->x = malloc(count * sizeof(Poly));
+        assert(op->x);
+    }
+    for (unsigned i = 0; i < count; ++i)
+    {
+        op->x[i] = PolyClone(&x[i]);
+    }
+    op->count = count;
+    *handle = op;
+    PoolSpawnDetached(RunPolyOperation, op);
+}
+
+/**
+ * @details Implementacja procedury PolyPoll udokumentowanej w pliku poly.h.
+ * @param[in] handle : uchwyt operacji
+ * @return Czy wynik jest gotowy?
+ */
+bool PolyPoll(PolyOperation *handle)
+{
+    return atomic_load(&handle->done);
+}
+
+/**
+ * @details Implementacja procedury PolyWait udokumentowanej w pliku poly.h.
+ * @param[in] handle : uchwyt operacji
+ * @return wynik operacji
+ */
+Poly PolyWait(PolyOperation *handle)
+{
+    PoolHelpUntil(&handle->done);
+    Poly out = handle->result;
+    handle->result = PolyZero();
+    PolyOperationRelease(handle);
+    return out;
+}
+
+/**
+ * @details Implementacja procedury PolyCancel udokumentowanej w pliku poly.h.
+ * @param[in] handle : uchwyt operacji
+ */
+void PolyCancel(PolyOperation *handle)
+{
+    if (handle == NULL)
+    {
+        return;
+    }
+    atomic_store(&handle->cancelled, true);
+    PolyOperationRelease(handle);
+}
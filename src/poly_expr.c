@@ -0,0 +1,518 @@
+/** @file
+   Implementacja leniwych wyrażeń wielomianowych
+
+   Węzeł grafu wyrażenia jest działaniem na swoich argumentach lub - po
+   obliczeniu - wielomianem. Obliczenie węzła zastępuje go wynikiem
+   i zwalnia referencje do argumentów, więc obliczone części grafu nie
+   zajmują pamięci, a współdzielone węzły obliczane są jeden raz.
+   Wysokość grafu jest ograniczona - węzeł, który przekroczyłby limit, jest
+   obliczany od razu - więc rekurencja po grafie ma ograniczoną głębokość.
+
+   Stopień iloczynu jest sumą stopni czynników, o ile iloczyn ich składników
+   najwyższego stopnia nie jest zerem. Współczynniki są liczbami modulo
+   @f$2^{64}@f$, więc iloczyn niezerowych wielomianów może być zerem - nie
+   jest nim jednak, gdy oba składniki najwyższego stopnia mają nieparzysty
+   współczynnik (wtedy iloczyn jest niezerowy modulo 2). Tylko wtedy stopień
+   iloczynu wyznaczany jest bez obliczania go.
+
+   @author agent
+   @date 2026-10-19
+ */
+
+
+#include <assert.h>
+#include "poly.h"
+#include "utils.h"
+
+
+/** Rodzaje węzłów grafu wyrażenia. */
+typedef enum PolyExprKind
+{
+    EXPR_VALUE, ///< obliczony wielomian
+    EXPR_ADD, ///< suma dwóch argumentów
+    EXPR_MUL, ///< iloczyn dwóch argumentów
+    EXPR_MUL_ADD, ///< iloczyn dwóch pierwszych argumentów plus trzeci
+    EXPR_NEG, ///< wyrażenie przeciwne do argumentu
+    EXPR_AT ///< wartość argumentu w punkcie
+} PolyExprKind;
+
+/** Największa liczba argumentów węzła. */
+#define EXPR_MAX_ARGS 3
+
+/** Największa wysokość nieobliczonej części grafu wyrażenia. */
+static const unsigned EXPR_MAX_HEIGHT = 32;
+
+/**
+ * Węzeł grafu wyrażenia.
+ */
+struct PolyExpr
+{
+    PolyExprKind kind; ///< rodzaj węzła
+    unsigned refs; ///< liczba referencji
+    unsigned height; ///< wysokość grafu węzła (0 dla obliczonego)
+    PolyExpr *args[EXPR_MAX_ARGS]; ///< argumenty działania (NULL, gdy brak)
+    poly_coeff_t x; ///< punkt, w którym obliczana jest wartość (EXPR_AT)
+    Poly value; ///< wielomian obliczonego węzła
+    bool deg_known; ///< czy stopień wyrażenia jest już wyznaczony
+    poly_exp_t deg; ///< stopień wyrażenia
+    signed char top_odd; ///< czy składnik najwyższego stopnia ma nieparzysty współczynnik (-1: nie wiadomo)
+};
+
+
+/**
+ * Sprawdza, czy składnik najwyższego stopnia wielomianu ma współczynnik
+ * nieparzysty.
+ * @param[in] p   : wielomian
+ * @param[in] deg : stopień, którego jednomiany sprawdzamy
+ * @return Czy jednomian stopnia @p deg ma nieparzysty współczynnik?
+ */
+static bool PolyTopIsOdd(const Poly *p, poly_exp_t deg)
+{
+    if (deg == 0 && (p->abs_term & 1) != 0)
+    {
+        return true;
+    }
+    for (const Mono *ptr = p->first; ptr != NULL; ptr = ptr->next)
+    {
+        if (ptr->exp + PolyDeg(&ptr->p) == deg &&
+            PolyTopIsOdd(&ptr->p, deg - ptr->exp))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Oblicza węzeł, zastępując go wielomianem i zwalniając jego argumenty.
+ * @param[in, out] e : wyrażenie
+ */
+static void ExprEvaluate(PolyExpr *e)
+{
+    if (e->kind == EXPR_VALUE)
+    {
+        return;
+    }
+    for (unsigned i = 0; i < EXPR_MAX_ARGS && e->args[i] != NULL; ++i)
+    {
+        ExprEvaluate(e->args[i]);
+    }
+    const Poly *a = &e->args[0]->value;
+    switch (e->kind)
+    {
+        case EXPR_ADD:
+            e->value = PolyAdd(a, &e->args[1]->value);
+            break;
+        case EXPR_MUL:
+            e->value = PolyMul(a, &e->args[1]->value);
+            break;
+        case EXPR_MUL_ADD:
+            e->value = PolyMulAdd(a, &e->args[1]->value, &e->args[2]->value);
+            break;
+        case EXPR_NEG:
+            e->value = PolyNeg(a);
+            break;
+        default:
+            assert(e->kind == EXPR_AT);
+            e->value = PolyAt(a, e->x);
+    }
+    for (unsigned i = 0; i < EXPR_MAX_ARGS; ++i)
+    {
+        PolyExprRelease(e->args[i]);
+        e->args[i] = NULL;
+    }
+    e->kind = EXPR_VALUE;
+    e->height = 0;
+}
+
+/**
+ * Tworzy węzeł działania, przejmując referencje do argumentów. Węzeł, którego
+ * wysokość przekroczyłaby limit, jest od razu obliczany.
+ * @param[in] kind : rodzaj działania
+ * @param[in] a    : pierwszy argument
+ * @param[in] b    : drugi argument lub NULL
+ * @param[in] c    : trzeci argument lub NULL
+ * @param[in] x    : punkt (dla EXPR_AT)
+ * @return wyrażenie
+ */
+static PolyExpr* ExprNew(PolyExprKind kind, PolyExpr *a, PolyExpr *b,
+                         PolyExpr *c, poly_coeff_t x)
+{
+    PolyExpr *e = malloc(sizeof(PolyExpr));
+    assert(e);
+    *e = (PolyExpr) {.kind = kind, .refs = 1, .args = {a, b, c}, .x = x,
+                     .value = PolyZero(), .deg_known = false, .top_odd = -1};
+    for (unsigned i = 0; i < EXPR_MAX_ARGS && e->args[i] != NULL; ++i)
+    {
+        if (e->args[i]->height + 1 > e->height)
+        {
+            e->height = e->args[i]->height + 1;
+        }
+    }
+    if (e->height > EXPR_MAX_HEIGHT)
+    {
+        ExprEvaluate(e);
+    }
+    return e;
+}
+
+/**
+ * Sprawdza, czy węzeł jest nieobliczonym działaniem danego rodzaju, do którego
+ * nie ma innych referencji, więc można go przekształcić.
+ * @param[in] e    : wyrażenie
+ * @param[in] kind : rodzaj działania
+ * @return Czy węzeł można przekształcić?
+ */
+static bool ExprIsPrivate(const PolyExpr *e, PolyExprKind kind)
+{
+    return e->kind == kind && e->refs == 1;
+}
+
+/**
+ * Zwalnia pamięć węzła bez zwalniania referencji do argumentów - przejmuje
+ * je wywołujący.
+ * @param[in] e : nieobliczony węzeł z jedną referencją
+ */
+static void ExprDetach(PolyExpr *e)
+{
+    assert(e->kind != EXPR_VALUE && e->refs == 1);
+    free(e);
+}
+
+/**
+ * @details Implementacja procedury PolyExprCreate udokumentowanej w pliku
+ * poly.h.
+ * @param[in, out] p : wielomian
+ * @return wyrażenie
+ */
+PolyExpr* PolyExprCreate(Poly *p)
+{
+    PolyExpr *e = malloc(sizeof(PolyExpr));
+    assert(e);
+    *e = (PolyExpr) {.kind = EXPR_VALUE, .refs = 1, .height = 0,
+                     .args = {NULL, NULL, NULL}, .value = *p,
+                     .deg_known = false, .top_odd = -1};
+    *p = PolyZero();
+    return e;
+}
+
+/**
+ * @details Implementacja procedury PolyExprAcquire udokumentowanej w pliku
+ * poly.h.
+ * @param[in] e : wyrażenie
+ * @return `e`
+ */
+PolyExpr* PolyExprAcquire(PolyExpr *e)
+{
+    ++e->refs;
+    return e;
+}
+
+/**
+ * @details Implementacja procedury PolyExprRelease udokumentowanej w pliku
+ * poly.h.
+ * @param[in] e : wyrażenie
+ */
+void PolyExprRelease(PolyExpr *e)
+{
+    if (e == NULL || --e->refs > 0)
+    {
+        return;
+    }
+    for (unsigned i = 0; i < EXPR_MAX_ARGS; ++i)
+    {
+        PolyExprRelease(e->args[i]);
+    }
+    PolyDestroy(&e->value);
+    free(e);
+}
+
+/**
+ * @details Implementacja procedury PolyExprAdd udokumentowanej w pliku poly.h.
+ * Składnik będący nieobliczonym iloczynem, do którego nie ma innych
+ * referencji, łączony jest z sumą w jedno działanie EXPR_MUL_ADD.
+ * @param[in] p : wyrażenie
+ * @param[in] q : wyrażenie
+ * @return `p + q`
+ */
+PolyExpr* PolyExprAdd(PolyExpr *p, PolyExpr *q)
+{
+    if (!ExprIsPrivate(p, EXPR_MUL) && ExprIsPrivate(q, EXPR_MUL))
+    {
+        PolyExpr *aux = p;
+        p = q;
+        q = aux;
+    }
+    if (ExprIsPrivate(p, EXPR_MUL))
+    {
+        PolyExpr *a = p->args[0], *b = p->args[1];
+        ExprDetach(p);
+        return ExprNew(EXPR_MUL_ADD, a, b, q, 0);
+    }
+    return ExprNew(EXPR_ADD, p, q, NULL, 0);
+}
+
+/**
+ * @details Implementacja procedury PolyExprMul udokumentowanej w pliku poly.h.
+ * @param[in] p : wyrażenie
+ * @param[in] q : wyrażenie
+ * @return `p * q`
+ */
+PolyExpr* PolyExprMul(PolyExpr *p, PolyExpr *q)
+{
+    return ExprNew(EXPR_MUL, p, q, NULL, 0);
+}
+
+/**
+ * @details Implementacja procedury PolyExprNeg udokumentowanej w pliku poly.h.
+ * Wyrażenie przeciwne do przeciwnego jest zastępowane argumentem.
+ * @param[in] p : wyrażenie
+ * @return `-p`
+ */
+PolyExpr* PolyExprNeg(PolyExpr *p)
+{
+    if (p->kind == EXPR_NEG)
+    {
+        PolyExpr *out = PolyExprAcquire(p->args[0]);
+        PolyExprRelease(p);
+        return out;
+    }
+    return ExprNew(EXPR_NEG, p, NULL, NULL, 0);
+}
+
+/**
+ * @details Implementacja procedury PolyExprSub udokumentowanej w pliku poly.h.
+ * Tak jak PolySub, różnica jest sumą z wyrażeniem przeciwnym.
+ * @param[in] p : wyrażenie
+ * @param[in] q : wyrażenie
+ * @return `p - q`
+ */
+PolyExpr* PolyExprSub(PolyExpr *p, PolyExpr *q)
+{
+    return PolyExprAdd(p, PolyExprNeg(q));
+}
+
+/**
+ * @details Implementacja procedury PolyExprAt udokumentowanej w pliku poly.h.
+ * Obliczanie wartości w punkcie zachowuje dodawanie i mnożenie, więc wartość
+ * nieobliczonej sumy, iloczynu lub wyrażenia przeciwnego, do którego nie ma
+ * innych referencji, zastępowana jest działaniem na wartościach argumentów.
+ * Iloczyn wartości ma mniej zmiennych i jest dużo mniejszy od iloczynu.
+ * @param[in] p : wyrażenie
+ * @param[in] x : wartość pierwszej ze zmiennych
+ * @return @f$p(x, x_0, x_1, \ldots)@f$
+ */
+PolyExpr* PolyExprAt(PolyExpr *p, poly_coeff_t x)
+{
+    if (p->kind == EXPR_VALUE || p->kind == EXPR_AT || p->refs > 1)
+    {
+        return ExprNew(EXPR_AT, p, NULL, NULL, x);
+    }
+    PolyExprKind kind = p->kind;
+    PolyExpr *a = p->args[0], *b = p->args[1], *c = p->args[2];
+    ExprDetach(p);
+    switch (kind)
+    {
+        case EXPR_ADD:
+            a = PolyExprAt(a, x);
+            return PolyExprAdd(a, PolyExprAt(b, x));
+        case EXPR_MUL:
+            a = PolyExprAt(a, x);
+            return PolyExprMul(a, PolyExprAt(b, x));
+        case EXPR_MUL_ADD:
+            a = PolyExprAt(a, x);
+            a = PolyExprMul(a, PolyExprAt(b, x));
+            return PolyExprAdd(a, PolyExprAt(c, x));
+        default:
+            assert(kind == EXPR_NEG);
+            return PolyExprNeg(PolyExprAt(a, x));
+    }
+}
+
+/**
+ * @details Implementacja procedury PolyExprEval udokumentowanej w pliku
+ * poly.h.
+ * @param[in, out] e : wyrażenie
+ * @return wielomian
+ */
+const Poly* PolyExprEval(PolyExpr *e)
+{
+    ExprEvaluate(e);
+    return &e->value;
+}
+
+/**
+ * @details Implementacja procedury PolyExprTake udokumentowanej w pliku
+ * poly.h.
+ * @param[in] e : wyrażenie
+ * @return wielomian
+ */
+Poly PolyExprTake(PolyExpr *e)
+{
+    ExprEvaluate(e);
+    Poly out;
+    if (e->refs == 1)
+    {
+        out = e->value;
+        e->value = PolyZero();
+    }
+    else
+    {
+        out = PolyClone(&e->value);
+    }
+    PolyExprRelease(e);
+    return out;
+}
+
+static bool ExprProductDeg(PolyExpr *a, PolyExpr *b, poly_exp_t *deg);
+
+/**
+ * Sprawdza, czy składnik najwyższego stopnia wyrażenia ma nieparzysty
+ * współczynnik. Wynik zapamiętywany jest w węźle.
+ * @param[in, out] e : wyrażenie
+ * @return Czy składnik najwyższego stopnia ma nieparzysty współczynnik?
+ */
+static bool ExprTopIsOdd(PolyExpr *e)
+{
+    if (e->top_odd >= 0)
+    {
+        return e->top_odd;
+    }
+    poly_exp_t deg = PolyExprDeg(e), part = -1;
+    bool odd;
+    if (deg < 0)
+    {
+        odd = false;
+    }
+    else if (e->kind == EXPR_NEG)
+    {
+        odd = ExprTopIsOdd(e->args[0]);
+    }
+    else if (e->kind == EXPR_MUL)
+    {
+        odd = true; //stopień został wyznaczony z nieparzystych czynników
+    }
+    else if (e->kind == EXPR_ADD)
+    {
+        odd = ExprTopIsOdd(e->args[PolyExprDeg(e->args[0]) == deg ? 0 : 1]);
+    }
+    else if (e->kind == EXPR_MUL_ADD)
+    {
+        ExprProductDeg(e->args[0], e->args[1], &part);
+        odd = part == deg ? true : ExprTopIsOdd(e->args[2]);
+    }
+    else
+    {
+        ExprEvaluate(e);
+        odd = PolyTopIsOdd(&e->value, deg);
+    }
+    e->top_odd = odd;
+    return odd;
+}
+
+/**
+ * Wyznacza stopień iloczynu dwóch wyrażeń bez obliczania go, gdy to możliwe.
+ * @param[in, out] a : wyrażenie
+ * @param[in, out] b : wyrażenie
+ * @param[out] deg   : stopień iloczynu
+ * @return Czy udało się wyznaczyć stopień?
+ */
+static bool ExprProductDeg(PolyExpr *a, PolyExpr *b, poly_exp_t *deg)
+{
+    poly_exp_t deg_a = PolyExprDeg(a), deg_b = PolyExprDeg(b);
+    if (deg_a < 0 || deg_b < 0)
+    {
+        *deg = -1;
+        return true;
+    }
+    if (ExprTopIsOdd(a) && ExprTopIsOdd(b))
+    {
+        *deg = deg_a + deg_b;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Wyznacza stopień wyrażenia, a gdy nie da się go wyznaczyć ze stopni
+ * argumentów - oblicza wyrażenie.
+ * @param[in, out] e : wyrażenie
+ * @return stopień wyrażenia
+ */
+static poly_exp_t ExprDegree(PolyExpr *e)
+{
+    poly_exp_t deg, other;
+    switch (e->kind)
+    {
+        case EXPR_NEG:
+            return PolyExprDeg(e->args[0]);
+        case EXPR_MUL:
+            if (ExprProductDeg(e->args[0], e->args[1], &deg))
+            {
+                return deg;
+            }
+            break;
+        case EXPR_ADD:
+            deg = PolyExprDeg(e->args[0]);
+            other = PolyExprDeg(e->args[1]);
+            if (deg != other)
+            {
+                return deg > other ? deg : other;
+            }
+            break;
+        case EXPR_MUL_ADD:
+            if (ExprProductDeg(e->args[0], e->args[1], &deg) &&
+                deg != (other = PolyExprDeg(e->args[2])))
+            {
+                return deg > other ? deg : other;
+            }
+            break;
+        default:
+            break;
+    }
+    ExprEvaluate(e);
+    return PolyDeg(&e->value);
+}
+
+/**
+ * @details Implementacja procedury PolyExprDeg udokumentowanej w pliku poly.h.
+ * Wynik zapamiętywany jest w węźle.
+ * @param[in, out] e : wyrażenie
+ * @return stopień wyrażenia
+ */
+poly_exp_t PolyExprDeg(PolyExpr *e)
+{
+    if (!e->deg_known)
+    {
+        e->deg = ExprDegree(e);
+        e->deg_known = true;
+    }
+    return e->deg;
+}
+
+/**
+ * @details Implementacja procedury PolyExprIsZero udokumentowanej w pliku
+ * poly.h.
+ * @param[in, out] e : wyrażenie
+ * @return Czy wyrażenie jest równe zeru?
+ */
+bool PolyExprIsZero(PolyExpr *e)
+{
+    return PolyExprDeg(e) < 0;
+}
+
+/**
+ * @details Implementacja procedury PolyExprIsCoeff udokumentowanej w pliku
+ * poly.h. Wielomian stopnia 0 jest obliczany, by sprawdzić jego postać.
+ * @param[in, out] e : wyrażenie
+ * @return Czy wyrażenie jest współczynnikiem?
+ */
+bool PolyExprIsCoeff(PolyExpr *e)
+{
+    poly_exp_t deg = PolyExprDeg(e);
+    if (deg != 0)
+    {
+        return deg < 0;
+    }
+    return PolyIsCoeff(PolyExprEval(e));
+}
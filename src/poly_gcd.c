@@ -0,0 +1,1278 @@
+/** @file
+   Implementacja największego wspólnego dzielnika wielomianów
+
+   NWD wyznaczany jest algorytmem modularnym Browna. Wielomiany są
+   sprowadzane do obrazów modulo duże liczby pierwsze, w których kolejne
+   zmienne (od najgłębiej zagnieżdżonej) są eliminowane przez wartościowanie,
+   a wynik odtwarzany jest interpolacją Newtona. Obrazy dla kolejnych liczb
+   pierwszych łączone są chińskim twierdzeniem o resztach, dopóki
+   odtworzony kandydat się zmienia, a ustalony kandydat sprawdzany jest
+   dzieleniem.
+
+   @author agent
+   @date 2026-10-19
+ */
+
+
+#include <assert.h>
+#include "poly.h"
+#include "utils.h"
+
+
+/** Typ elementów ciała reszt modulo liczba pierwsza */
+typedef uint64_t mod_t;
+
+/// Liczby pierwsze używane do obrazów są mniejsze od tej wartości, dzięki
+/// czemu iloczyn dwóch reszt mieści się w typie mod_t.
+static const mod_t GCD_PRIME_LIMIT = (mod_t)1 << 31;
+
+/// Największa liczba obrazów łączonych chińskim twierdzeniem o resztach.
+/// Trzy liczby pierwsze wystarczają do odtworzenia każdej wartości typu
+/// poly_coeff_t, a kolejna potwierdza, że kandydat się ustalił.
+#define GCD_MAX_IMAGES 6
+
+/**
+ * Struktura przechowująca obraz wielomianu modulo liczba pierwsza.
+ * Wielomian poziomu 0 jest stałą zapisaną w polu `value`. Wielomian poziomu
+ * @f$L > 0@f$ jest listą niezerowych wyrazów o ściśle malejących wykładnikach,
+ * których współczynniki są wielomianami poziomu @f$L - 1@f$. Dla wielomianu
+ * @f$n@f$ zmiennych poziom @f$L@f$ odpowiada zmiennej o indeksie @f$n - L@f$,
+ * czyli poziom 1 to zmienna zagnieżdżona najgłębiej.
+ * Wyzerowana struktura jest wielomianem zerowym dowolnego poziomu.
+ */
+typedef struct ModPoly
+{
+    mod_t value; ///< wartość wielomianu stałego (poziom 0)
+    unsigned count; ///< liczba wyrazów (poziomy dodatnie)
+    unsigned capacity; ///< liczba wyrazów, na które zaalokowano pamięć
+    poly_exp_t *exps; ///< wykładniki wyrazów w kolejności malejącej
+    struct ModPoly *coeffs; ///< współczynniki wyrazów
+} ModPoly;
+
+/**
+ * Liczby pierwsze, modulo które wyznaczono obrazy łączone chińskim
+ * twierdzeniem o resztach, wraz z odwrotnościami potrzebnymi we wzorze
+ * Garnera.
+ */
+typedef struct CrtBasis
+{
+    unsigned count; ///< liczba liczb pierwszych
+    mod_t primes[GCD_MAX_IMAGES]; ///< liczby pierwsze
+    /// `inverses[i][j]` jest odwrotnością `primes[j]` modulo `primes[i]`
+    /// dla `j < i`
+    mod_t inverses[GCD_MAX_IMAGES][GCD_MAX_IMAGES];
+} CrtBasis;
+
+/**
+ * Operacja na dwóch wielomianach jednej zmiennej modulo liczba pierwsza.
+ */
+typedef ModPoly (*UniOperation)(const ModPoly *a, const ModPoly *b, mod_t prime);
+
+
+/**
+ * Dodaje reszty modulo @p prime.
+ * @param[in] a     : reszta
+ * @param[in] b     : reszta
+ * @param[in] prime : moduł
+ * @return `a + b mod prime`
+ */
+static inline mod_t ModAdd(mod_t a, mod_t b, mod_t prime)
+{
+    mod_t out = a + b;
+    return out >= prime ? out - prime : out;
+}
+
+/**
+ * Odejmuje reszty modulo @p prime.
+ * @param[in] a     : reszta
+ * @param[in] b     : reszta
+ * @param[in] prime : moduł
+ * @return `a - b mod prime`
+ */
+static inline mod_t ModSub(mod_t a, mod_t b, mod_t prime)
+{
+    return a >= b ? a - b : a + prime - b;
+}
+
+/**
+ * Mnoży reszty modulo @p prime.
+ * @param[in] a     : reszta
+ * @param[in] b     : reszta
+ * @param[in] prime : moduł
+ * @return `a * b mod prime`
+ */
+static inline mod_t ModMul(mod_t a, mod_t b, mod_t prime)
+{
+    return a * b % prime;
+}
+
+/**
+ * Podnosi resztę do potęgi modulo @p prime.
+ * @param[in] x     : reszta
+ * @param[in] e     : nieujemny wykładnik
+ * @param[in] prime : moduł
+ * @return @f$x^e \bmod prime@f$
+ */
+static mod_t ModPow(mod_t x, poly_exp_t e, mod_t prime)
+{
+    mod_t out = 1;
+    for (; e > 0; e /= 2)
+    {
+        if (e % 2 == 1)
+        {
+            out = ModMul(out, x, prime);
+        }
+        x = ModMul(x, x, prime);
+    }
+    return out;
+}
+
+/**
+ * Wyznacza odwrotność reszty modulo liczba pierwsza z małego twierdzenia
+ * Fermata.
+ * @param[in] x     : niezerowa reszta
+ * @param[in] prime : liczba pierwsza
+ * @return @f$x^{-1} \bmod prime@f$
+ */
+static mod_t ModInv(mod_t x, mod_t prime)
+{
+    assert(x != 0);
+    return ModPow(x, prime - 2, prime);
+}
+
+/**
+ * Sprowadza współczynnik wielomianu do reszty modulo @p prime.
+ * @param[in] c     : współczynnik
+ * @param[in] prime : moduł
+ * @return `c mod prime` z przedziału `[0, prime)`
+ */
+static mod_t ModFromCoeff(poly_coeff_t c, mod_t prime)
+{
+    poly_coeff_t out = c % (poly_coeff_t)prime;
+    return out < 0 ? (mod_t)(out + (poly_coeff_t)prime) : (mod_t)out;
+}
+
+/**
+ * Sprawdza, czy liczba jest pierwsza.
+ * @param[in] n : liczba
+ * @return Czy @p n jest liczbą pierwszą?
+ */
+static bool IsPrime(mod_t n)
+{
+    if (n < 2)
+    {
+        return false;
+    }
+    for (mod_t d = 2; d * d <= n; ++d)
+    {
+        if (n % d == 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Zwraca największą liczbę pierwszą mniejszą od @p n.
+ * @param[in] n : liczba większa niż 2
+ * @return największa liczba pierwsza mniejsza od @p n
+ */
+static mod_t PrevPrime(mod_t n)
+{
+    do
+    {
+        --n;
+    } while (!IsPrime(n));
+    return n;
+}
+
+/**
+ * Losuje kolejny punkt wartościowania z przedziału `[1, prime)`.
+ * @param[in, out] seed : stan generatora liczb pseudolosowych
+ * @param[in] prime     : moduł
+ * @return punkt wartościowania
+ */
+static mod_t NextEvaluationPoint(uint64_t *seed, mod_t prime)
+{
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 7;
+    *seed ^= *seed << 17;
+    return 1 + *seed % (prime - 1);
+}
+
+/**
+ * Wyznacza największy wspólny dzielnik liczb całkowitych.
+ * @param[in] a : liczba
+ * @param[in] b : liczba
+ * @return nieujemny NWD @p a i @p b
+ */
+static poly_coeff_t CoeffGcd(poly_coeff_t a, poly_coeff_t b)
+{
+    while (b != 0)
+    {
+        poly_coeff_t r = a % b;
+        a = b;
+        b = r;
+    }
+    return a < 0 ? -a : a;
+}
+
+/**
+ * Tworzy zerowy obraz wielomianu.
+ * @return wielomian zerowy dowolnego poziomu
+ */
+static inline ModPoly MpZero()
+{
+    return (ModPoly) {.value = 0, .count = 0, .capacity = 0,
+        .exps = NULL, .coeffs = NULL};
+}
+
+/**
+ * Sprawdza, czy obraz wielomianu jest zerowy.
+ * @param[in] m     : obraz wielomianu
+ * @param[in] level : poziom @p m
+ * @return Czy @p m jest wielomianem zerowym?
+ */
+static inline bool MpIsZero(const ModPoly *m, unsigned level)
+{
+    return level == 0 ? m->value == 0 : m->count == 0;
+}
+
+/**
+ * Usuwa obraz wielomianu z pamięci.
+ * @param[in] m     : obraz wielomianu
+ * @param[in] level : poziom @p m
+ */
+static void MpDestroy(ModPoly *m, unsigned level)
+{
+    if (level > 1)
+    {
+        for (unsigned i = 0; i < m->count; ++i)
+        {
+            MpDestroy(&m->coeffs[i], level - 1);
+        }
+    }
+    free(m->exps);
+    free(m->coeffs);
+    *m = MpZero();
+}
+
+/**
+ * Dopisuje wyraz na koniec listy wyrazów wielomianu @p m.
+ * Przejmuje na własność współczynnik @p coeff. Zerowe współczynniki są
+ * pomijane. Wykładnik musi być mniejszy od wykładników dotychczasowych wyrazów.
+ * @param[in, out] m : obraz wielomianu
+ * @param[in] exp    : wykładnik
+ * @param[in] coeff  : współczynnik
+ * @param[in] level  : poziom @p m
+ */
+static void MpPush(ModPoly *m, poly_exp_t exp, ModPoly coeff, unsigned level)
+{
+    if (MpIsZero(&coeff, level - 1))
+    {
+        MpDestroy(&coeff, level - 1);
+        return;
+    }
+    if (m->count == m->capacity)
+    {
+        m->capacity = 2 * m->capacity + 2;
+        m->exps = realloc(m->exps, m->capacity * sizeof(poly_exp_t));
+        m->coeffs = realloc(m->coeffs, m->capacity * sizeof(ModPoly));
+        assert(m->exps && m->coeffs);
+    }
+    m->exps[m->count] = exp;
+    m->coeffs[m->count++] = coeff;
+}
+
+/**
+ * Tworzy obraz wielomianu stałego.
+ * @param[in] value : wartość
+ * @param[in] level : poziom tworzonego wielomianu
+ * @return wielomian stały @p value poziomu @p level
+ */
+static ModPoly MpConst(mod_t value, unsigned level)
+{
+    ModPoly out = MpZero();
+    if (level == 0)
+    {
+        out.value = value;
+    }
+    else
+    {
+        MpPush(&out, 0, MpConst(value, level - 1), level);
+    }
+    return out;
+}
+
+/**
+ * Mnoży obraz wielomianu przez stałą.
+ * @param[in] m     : obraz wielomianu
+ * @param[in] level : poziom @p m
+ * @param[in] x     : stała
+ * @param[in] prime : moduł
+ * @return `m * x`
+ */
+static ModPoly MpMulScalar(const ModPoly *m, unsigned level, mod_t x, mod_t prime)
+{
+    if (level == 0)
+    {
+        return MpConst(ModMul(m->value, x, prime), 0);
+    }
+    ModPoly out = MpZero();
+    for (unsigned i = 0; i < m->count; ++i)
+    {
+        MpPush(&out, m->exps[i], MpMulScalar(&m->coeffs[i], level - 1, x, prime),
+               level);
+    }
+    return out;
+}
+
+/**
+ * Robi pełną kopię obrazu wielomianu.
+ * @param[in] m     : obraz wielomianu
+ * @param[in] level : poziom @p m
+ * @return kopia @p m
+ */
+static ModPoly MpClone(const ModPoly *m, unsigned level)
+{
+    if (level == 0)
+    {
+        return *m;
+    }
+    ModPoly out = MpZero();
+    for (unsigned i = 0; i < m->count; ++i)
+    {
+        MpPush(&out, m->exps[i], MpClone(&m->coeffs[i], level - 1), level);
+    }
+    return out;
+}
+
+/**
+ * Zwraca współczynnik liczbowy przy największym (leksykograficznie)
+ * jednomianie.
+ * @param[in] m     : niezerowy obraz wielomianu
+ * @param[in] level : poziom @p m
+ * @return współczynnik wiodący
+ */
+static mod_t MpLeadValue(const ModPoly *m, unsigned level)
+{
+    for (; level > 0; --level)
+    {
+        m = &m->coeffs[0];
+    }
+    return m->value;
+}
+
+/**
+ * Normuje obraz wielomianu tak, by jego współczynnik wiodący był równy 1.
+ * @param[in] m     : obraz wielomianu
+ * @param[in] level : poziom @p m
+ * @param[in] prime : moduł
+ * @return unormowana kopia @p m (wielomian zerowy dla zerowego @p m)
+ */
+static ModPoly MpMonic(const ModPoly *m, unsigned level, mod_t prime)
+{
+    if (MpIsZero(m, level))
+    {
+        return MpZero();
+    }
+    return MpMulScalar(m, level, ModInv(MpLeadValue(m, level), prime), prime);
+}
+
+/**
+ * Sprawdza, czy niezerowy obraz wielomianu jest stałą.
+ * @param[in] m     : niezerowy obraz wielomianu
+ * @param[in] level : poziom @p m
+ * @return Czy @p m jest stałą?
+ */
+static bool MpIsConstant(const ModPoly *m, unsigned level)
+{
+    for (; level > 0; --level)
+    {
+        if (m->exps[0] != 0)
+        {
+            return false;
+        }
+        m = &m->coeffs[0];
+    }
+    return true;
+}
+
+/**
+ * Porównuje leksykograficznie największe jednomiany dwóch obrazów wielomianów
+ * na @p levels najwyższych poziomach.
+ * @param[in] a      : niezerowy obraz wielomianu
+ * @param[in] b      : niezerowy obraz wielomianu
+ * @param[in] levels : liczba porównywanych poziomów
+ * @return liczba ujemna, zero lub dodatnia, gdy jednomian wiodący @p a jest
+ * odpowiednio mniejszy, równy lub większy od jednomianu wiodącego @p b
+ */
+static int MpCompareLead(const ModPoly *a, const ModPoly *b, unsigned levels)
+{
+    for (; levels > 0; --levels)
+    {
+        if (a->exps[0] != b->exps[0])
+        {
+            return a->exps[0] < b->exps[0] ? -1 : 1;
+        }
+        a = &a->coeffs[0];
+        b = &b->coeffs[0];
+    }
+    return 0;
+}
+
+/**
+ * Wybiera kolejny wykładnik przy równoczesnym przeglądaniu list wyrazów
+ * dwóch wielomianów w kolejności malejących wykładników.
+ * Współczynnik wielomianu, w którym brak wyrazu o wybranym wykładniku,
+ * zastępowany jest wielomianem @p zero.
+ * @param[in] a            : obraz wielomianu
+ * @param[in, out] a_idx   : indeks kolejnego wyrazu @p a
+ * @param[in] b            : obraz wielomianu
+ * @param[in, out] b_idx   : indeks kolejnego wyrazu @p b
+ * @param[in] zero         : wielomian zerowy
+ * @param[out] a_coeff     : współczynnik @p a przy wybranym wykładniku
+ * @param[out] b_coeff     : współczynnik @p b przy wybranym wykładniku
+ * @return wybrany wykładnik
+ */
+static poly_exp_t MpMergeNext(const ModPoly *a, unsigned *a_idx,
+                              const ModPoly *b, unsigned *b_idx,
+                              const ModPoly *zero, const ModPoly **a_coeff,
+                              const ModPoly **b_coeff)
+{
+    bool take_a = *a_idx < a->count &&
+                  (*b_idx == b->count || a->exps[*a_idx] >= b->exps[*b_idx]);
+    bool take_b = *b_idx < b->count &&
+                  (*a_idx == a->count || b->exps[*b_idx] >= a->exps[*a_idx]);
+    poly_exp_t exp = take_a ? a->exps[*a_idx] : b->exps[*b_idx];
+    *a_coeff = take_a ? &a->coeffs[(*a_idx)++] : zero;
+    *b_coeff = take_b ? &b->coeffs[(*b_idx)++] : zero;
+    return exp;
+}
+
+/**
+ * Tworzy obraz wielomianu modulo @p prime.
+ * Wielomian jest uzupełniany o zerowe wykładniki, tak by wszystkie jego
+ * współczynniki liczbowe znalazły się na poziomie 0.
+ * @param[in] p     : wielomian o liczbie zmiennych nie większej niż @p level
+ * @param[in] level : poziom tworzonego obrazu
+ * @param[in] extra : reszta dodawana do wyrazu wolnego @p p
+ * @param[in] prime : moduł
+ * @return obraz `p + extra` modulo @p prime
+ */
+static ModPoly MpFromPoly(const Poly *p, unsigned level, mod_t extra, mod_t prime)
+{
+    mod_t abs_term = ModAdd(ModFromCoeff(p->abs_term, prime), extra, prime);
+    if (level == 0)
+    {
+        assert(PolyIsCoeff(p));
+        return MpConst(abs_term, 0);
+    }
+    ModPoly out = MpZero();
+    bool abs_term_used = false;
+    for (Mono *ptr = p->first; ptr != NULL; ptr = ptr->next)
+    {
+        mod_t term_extra = 0;
+        if (ptr->exp == 0)
+        {
+            term_extra = abs_term;
+            abs_term_used = true;
+        }
+        MpPush(&out, ptr->exp, MpFromPoly(&ptr->p, level - 1, term_extra, prime),
+               level);
+    }
+    if (!abs_term_used)
+    {
+        MpPush(&out, 0, MpConst(abs_term, level - 1), level);
+    }
+    return out;
+}
+
+/**
+ * Dodaje liczbę pierwszą do bazy chińskiego twierdzenia o resztach.
+ * @param[in, out] basis : baza
+ * @param[in] prime      : liczba pierwsza różna od liczb w bazie
+ */
+static void CrtBasisAdd(CrtBasis *basis, mod_t prime)
+{
+    assert(basis->count < GCD_MAX_IMAGES);
+    for (unsigned j = 0; j < basis->count; ++j)
+    {
+        basis->inverses[basis->count][j] = ModInv(basis->primes[j] % prime,
+                                                  prime);
+    }
+    basis->primes[basis->count++] = prime;
+}
+
+/**
+ * Odtwarza liczbę całkowitą z reszt modulo liczby pierwsze bazy wzorem
+ * Garnera. Wyznacza cyfry @f$d_i@f$ zapisu
+ * @f$v = d_0 + p_0 (d_1 + p_1 (d_2 + \dots))@f$ liczby
+ * @f$0 \le v < M = \prod p_i@f$, a następnie wybiera reprezentanta
+ * symetrycznego: @f$v@f$ lub @f$v - M@f$, gdy @f$v > (M - 1) / 2@f$.
+ * Cyfry liczby @f$(M - 1) / 2@f$ są równe @f$(p_i - 1) / 2@f$, więc
+ * porównanie nie wymaga arytmetyki wielkich liczb, a wynik liczony jest
+ * modulo @f$2^{64}@f$ - jest dokładny, gdy mieści się w typie poly_coeff_t.
+ * @param[in] residues : reszty modulo kolejne liczby pierwsze bazy
+ * @param[in] basis    : baza
+ * @return reprezentant symetryczny
+ */
+static poly_coeff_t CrtCoeff(const mod_t residues[], const CrtBasis *basis)
+{
+    mod_t digits[GCD_MAX_IMAGES];
+    for (unsigned i = 0; i < basis->count; ++i)
+    {
+        mod_t prime = basis->primes[i], digit = residues[i];
+        for (unsigned j = 0; j < i; ++j)
+        {
+            digit = ModMul(ModSub(digit, digits[j] % prime, prime),
+                           basis->inverses[i][j], prime);
+        }
+        digits[i] = digit;
+    }
+    bool negative = false;
+    for (unsigned i = basis->count; i-- > 0;)
+    {
+        mod_t half = (basis->primes[i] - 1) / 2;
+        if (digits[i] != half)
+        {
+            negative = digits[i] > half;
+            break;
+        }
+    }
+    uint64_t value = 0, modulus = 1;
+    for (unsigned i = 0; i < basis->count; ++i)
+    {
+        value += digits[i] * modulus;
+        modulus *= basis->primes[i];
+    }
+    return (poly_coeff_t)(negative ? value - modulus : value);
+}
+
+/**
+ * Odtwarza wielomian z jego obrazów modulo liczby pierwsze bazy, łącząc
+ * reszty każdego współczynnika przez CrtCoeff.
+ * @param[in] images : obrazy modulo kolejne liczby pierwsze bazy
+ * @param[in] basis  : baza
+ * @param[in] level  : poziom obrazów
+ * @return wielomian o współczynnikach będących reprezentantami symetrycznymi
+ */
+static Poly MpCrtToPoly(const ModPoly *const images[], const CrtBasis *basis,
+                        unsigned level)
+{
+    if (level == 0)
+    {
+        mod_t residues[GCD_MAX_IMAGES];
+        for (unsigned i = 0; i < basis->count; ++i)
+        {
+            residues[i] = images[i]->value;
+        }
+        return PolyFromCoeff(CrtCoeff(residues, basis));
+    }
+    unsigned total = 0, indices[GCD_MAX_IMAGES] = {0};
+    for (unsigned i = 0; i < basis->count; ++i)
+    {
+        total += images[i]->count;
+    }
+    Mono *monos = calloc(total, sizeof(Mono));
+    assert(total == 0 || monos);
+    unsigned count = 0;
+    ModPoly zero = MpZero();
+    const ModPoly *coeffs[GCD_MAX_IMAGES];
+    while (true)
+    {
+        bool found = false;
+        poly_exp_t exp = 0;
+        for (unsigned i = 0; i < basis->count; ++i)
+        {
+            if (indices[i] < images[i]->count &&
+                (!found || images[i]->exps[indices[i]] > exp))
+            {
+                exp = images[i]->exps[indices[i]];
+                found = true;
+            }
+        }
+        if (!found)
+        {
+            break;
+        }
+        for (unsigned i = 0; i < basis->count; ++i)
+        {
+            bool present = indices[i] < images[i]->count &&
+                           images[i]->exps[indices[i]] == exp;
+            coeffs[i] = present ? &images[i]->coeffs[indices[i]++] : &zero;
+        }
+        Poly coeff = MpCrtToPoly(coeffs, basis, level - 1);
+        monos[count++] = MonoFromPoly(&coeff, exp);
+    }
+    Poly out = PolyAddMonos(count, monos);
+    free(monos);
+    return out;
+}
+
+/**@name Wielomiany jednej zmiennej
+   Obrazy poziomu 1, czyli wielomiany jednej zmiennej o współczynnikach
+   z ciała reszt.
+   @{*/
+
+/**
+ * Wylicza wartość wielomianu jednej zmiennej w punkcie (schemat Hornera).
+ * @param[in] a     : wielomian poziomu 1
+ * @param[in] x     : punkt
+ * @param[in] prime : moduł
+ * @return `a(x)`
+ */
+static mod_t UniEval(const ModPoly *a, mod_t x, mod_t prime)
+{
+    mod_t out = 0;
+    for (unsigned i = 0; i < a->count; ++i)
+    {
+        poly_exp_t gap = a->exps[i] - (i + 1 < a->count ? a->exps[i + 1] : 0);
+        out = ModMul(ModAdd(out, a->coeffs[i].value, prime),
+                     ModPow(x, gap, prime), prime);
+    }
+    return out;
+}
+
+/**
+ * Wylicza @f$a + x \cdot t^{shift} \cdot b@f$ dla wielomianów jednej
+ * zmiennej @f$t@f$.
+ * @param[in] a     : wielomian poziomu 1
+ * @param[in] b     : wielomian poziomu 1
+ * @param[in] x     : stała
+ * @param[in] shift : nieujemne przesunięcie wykładników @p b
+ * @param[in] prime : moduł
+ * @return wynik działania
+ */
+static ModPoly UniAddScaled(const ModPoly *a, const ModPoly *b, mod_t x,
+                            poly_exp_t shift, mod_t prime)
+{
+    ModPoly out = MpZero();
+    unsigned a_idx = 0, b_idx = 0;
+    while (a_idx < a->count || b_idx < b->count)
+    {
+        mod_t value = 0;
+        poly_exp_t exp;
+        if (b_idx == b->count ||
+            (a_idx < a->count && a->exps[a_idx] >= b->exps[b_idx] + shift))
+        {
+            exp = a->exps[a_idx];
+            value = a->coeffs[a_idx++].value;
+        }
+        else
+        {
+            exp = b->exps[b_idx] + shift;
+        }
+        if (b_idx < b->count && b->exps[b_idx] + shift == exp)
+        {
+            value = ModAdd(value, ModMul(x, b->coeffs[b_idx++].value, prime),
+                           prime);
+        }
+        MpPush(&out, exp, MpConst(value, 0), 1);
+    }
+    return out;
+}
+
+/**
+ * Dzieli wielomiany jednej zmiennej z resztą.
+ * @param[in]  a     : dzielna
+ * @param[in]  b     : niezerowy dzielnik
+ * @param[out] quot  : iloraz lub NULL, gdy iloraz nie jest potrzebny
+ * @param[out] rem   : reszta
+ * @param[in]  prime : moduł
+ */
+static void UniDivRem(const ModPoly *a, const ModPoly *b, ModPoly *quot,
+                      ModPoly *rem, mod_t prime)
+{
+    mod_t lead_inv = ModInv(b->coeffs[0].value, prime);
+    ModPoly out = MpZero();
+    *rem = MpClone(a, 1);
+    while (rem->count > 0 && rem->exps[0] >= b->exps[0])
+    {
+        mod_t factor = ModMul(rem->coeffs[0].value, lead_inv, prime);
+        poly_exp_t shift = rem->exps[0] - b->exps[0];
+        if (quot != NULL)
+        {
+            MpPush(&out, shift, MpConst(factor, 0), 1);
+        }
+        ModPoly next = UniAddScaled(rem, b, prime - factor, shift, prime);
+        MpDestroy(rem, 1);
+        *rem = next;
+    }
+    if (quot != NULL)
+    {
+        *quot = out;
+    }
+}
+
+/**
+ * Dzieli wielomian jednej zmiennej przez jego dzielnik.
+ * @param[in] a     : dzielna
+ * @param[in] b     : niezerowy dzielnik @p a
+ * @param[in] prime : moduł
+ * @return `a / b`
+ */
+static ModPoly UniDivExact(const ModPoly *a, const ModPoly *b, mod_t prime)
+{
+    if (b->count == 1 && b->exps[0] == 0)
+    {
+        return MpMulScalar(a, 1, ModInv(b->coeffs[0].value, prime), prime);
+    }
+    ModPoly quot, rem;
+    UniDivRem(a, b, &quot, &rem, prime);
+    assert(rem.count == 0);
+    MpDestroy(&rem, 1);
+    return quot;
+}
+
+/**
+ * Mnoży wielomiany jednej zmiennej.
+ * @param[in] a     : wielomian poziomu 1
+ * @param[in] b     : wielomian poziomu 1
+ * @param[in] prime : moduł
+ * @return `a * b`
+ */
+static ModPoly UniMul(const ModPoly *a, const ModPoly *b, mod_t prime)
+{
+    if (b->count == 1 && b->exps[0] == 0)
+    {
+        return MpMulScalar(a, 1, b->coeffs[0].value, prime);
+    }
+    ModPoly out = MpZero();
+    for (unsigned i = 0; i < a->count; ++i)
+    {
+        ModPoly next = UniAddScaled(&out, b, a->coeffs[i].value, a->exps[i], prime);
+        MpDestroy(&out, 1);
+        out = next;
+    }
+    return out;
+}
+
+/**
+ * Wyznacza unormowany NWD wielomianów jednej zmiennej algorytmem Euklidesa.
+ * @param[in] a     : wielomian poziomu 1
+ * @param[in] b     : wielomian poziomu 1
+ * @param[in] prime : moduł
+ * @return unormowany NWD @p a i @p b
+ */
+static ModPoly UniGcd(const ModPoly *a, const ModPoly *b, mod_t prime)
+{
+    ModPoly prev = MpClone(a, 1), cur = MpClone(b, 1);
+    while (cur.count > 0)
+    {
+        ModPoly rem;
+        UniDivRem(&prev, &cur, NULL, &rem, prime);
+        MpDestroy(&prev, 1);
+        prev = cur;
+        cur = rem;
+    }
+    ModPoly out = MpMonic(&prev, 1, prime);
+    MpDestroy(&prev, 1);
+    return out;
+}
+
+/*}@**/
+
+
+/**@name Wielomiany o współczynnikach z pierścienia wielomianów jednej zmiennej
+   Obraz poziomu @f$L > 1@f$ traktowany jest jako wielomian zmiennych
+   poziomów @f$L, \ldots, 2@f$, którego współczynnikami (liśćmi) są wielomiany
+   poziomu 1.
+   @{*/
+
+/**
+ * Wykonuje na każdym liściu obrazu operację z wielomianem @p u.
+ * @param[in] m         : obraz wielomianu
+ * @param[in] level     : poziom @p m, dodatni
+ * @param[in] u         : wielomian poziomu 1
+ * @param[in] operation : operacja
+ * @param[in] prime     : moduł
+ * @return obraz, w którym każdy liść @f$c@f$ zastąpiono przez
+ * `operation(c, u)`
+ */
+static ModPoly MpMapLeaves(const ModPoly *m, unsigned level, const ModPoly *u,
+                           UniOperation operation, mod_t prime)
+{
+    if (level == 1)
+    {
+        return operation(m, u, prime);
+    }
+    ModPoly out = MpZero();
+    for (unsigned i = 0; i < m->count; ++i)
+    {
+        MpPush(&out, m->exps[i],
+               MpMapLeaves(&m->coeffs[i], level - 1, u, operation, prime), level);
+    }
+    return out;
+}
+
+/**
+ * Tworzy obraz poziomu @p level o jednym liściu @p leaf przy zerowych
+ * wykładnikach.
+ * @param[in] leaf  : wielomian poziomu 1
+ * @param[in] level : poziom tworzonego obrazu, dodatni
+ * @return obraz równy @p leaf
+ */
+static ModPoly MpLiftLeaf(const ModPoly *leaf, unsigned level)
+{
+    if (level == 1)
+    {
+        return MpClone(leaf, 1);
+    }
+    ModPoly out = MpZero();
+    MpPush(&out, 0, MpLiftLeaf(leaf, level - 1), level);
+    return out;
+}
+
+/**
+ * Zwraca liść przy leksykograficznie największym jednomianie.
+ * @param[in] m     : niezerowy obraz wielomianu
+ * @param[in] level : poziom @p m, dodatni
+ * @return widok na wiodący liść @p m
+ */
+static const ModPoly* MpLeadLeaf(const ModPoly *m, unsigned level)
+{
+    for (; level > 1; --level)
+    {
+        m = &m->coeffs[0];
+    }
+    return m;
+}
+
+/**
+ * Zwraca stopień obrazu względem zmiennej poziomu 1.
+ * @param[in] m     : niezerowy obraz wielomianu
+ * @param[in] level : poziom @p m, dodatni
+ * @return największy stopień liścia
+ */
+static poly_exp_t MpLeafDeg(const ModPoly *m, unsigned level)
+{
+    if (level == 1)
+    {
+        return m->exps[0];
+    }
+    poly_exp_t out = 0;
+    for (unsigned i = 0; i < m->count; ++i)
+    {
+        poly_exp_t deg = MpLeafDeg(&m->coeffs[i], level - 1);
+        out = deg > out ? deg : out;
+    }
+    return out;
+}
+
+/**
+ * Wyznacza zawartość obrazu - unormowany NWD wszystkich jego liści.
+ * @param[in] m     : obraz wielomianu
+ * @param[in] level : poziom @p m, dodatni
+ * @param[in] prime : moduł
+ * @return zawartość @p m
+ */
+static ModPoly MpContent(const ModPoly *m, unsigned level, mod_t prime)
+{
+    if (level == 1)
+    {
+        return MpMonic(m, 1, prime);
+    }
+    ModPoly out = MpZero();
+    for (unsigned i = 0; i < m->count && (out.count == 0 || out.exps[0] > 0); ++i)
+    {
+        ModPoly content = MpContent(&m->coeffs[i], level - 1, prime);
+        ModPoly next = UniGcd(&out, &content, prime);
+        MpDestroy(&content, 1);
+        MpDestroy(&out, 1);
+        out = next;
+    }
+    return out;
+}
+
+/**
+ * Wartościuje zmienną poziomu 1 obrazu w punkcie @p x.
+ * @param[in] m     : obraz wielomianu
+ * @param[in] level : poziom @p m, dodatni
+ * @param[in] x     : punkt
+ * @param[in] prime : moduł
+ * @return obraz poziomu `level - 1`
+ */
+static ModPoly MpEval(const ModPoly *m, unsigned level, mod_t x, mod_t prime)
+{
+    if (level == 1)
+    {
+        return MpConst(UniEval(m, x, prime), 0);
+    }
+    ModPoly out = MpZero();
+    for (unsigned i = 0; i < m->count; ++i)
+    {
+        MpPush(&out, m->exps[i], MpEval(&m->coeffs[i], level - 1, x, prime),
+               level - 1);
+    }
+    return out;
+}
+
+/**
+ * Wykonuje krok interpolacji Newtona względem zmiennej poziomu 1.
+ * Dla obrazu @p h zgodnego z szukanym wielomianem w punktach będących
+ * pierwiastkami @p modulus wyznacza obraz zgodny z nim także w punkcie @p x,
+ * w którym szukany wielomian ma wartość @p v:
+ * @f$h + (v - h(x)) \cdot w \cdot modulus@f$.
+ * @param[in] h       : obraz poziomu @p level
+ * @param[in] v       : obraz poziomu `level - 1`
+ * @param[in] level   : poziom @p h, dodatni
+ * @param[in] modulus : iloczyn czynników liniowych dotychczasowych punktów
+ * @param[in] x       : nowy punkt
+ * @param[in] w       : odwrotność `modulus(x)`
+ * @param[in] prime   : moduł
+ * @return obraz po interpolacji
+ */
+static ModPoly MpInterpolate(const ModPoly *h, const ModPoly *v, unsigned level,
+                             const ModPoly *modulus, mod_t x, mod_t w, mod_t prime)
+{
+    if (level == 1)
+    {
+        mod_t delta = ModMul(ModSub(v->value, UniEval(h, x, prime), prime), w, prime);
+        return UniAddScaled(h, modulus, delta, 0, prime);
+    }
+    ModPoly out = MpZero(), zero = MpZero();
+    unsigned h_idx = 0, v_idx = 0;
+    while (h_idx < h->count || v_idx < v->count)
+    {
+        const ModPoly *h_coeff, *v_coeff;
+        poly_exp_t exp = MpMergeNext(h, &h_idx, v, &v_idx, &zero,
+                                     &h_coeff, &v_coeff);
+        MpPush(&out, exp, MpInterpolate(h_coeff, v_coeff, level - 1, modulus,
+                                        x, w, prime), level);
+    }
+    return out;
+}
+
+/*}@**/
+
+
+/**
+ * Wyznacza unormowany NWD obrazów wielomianów algorytmem Browna.
+ * Na poziomie 1 stosuje algorytm Euklidesa. Na wyższych poziomach usuwa
+ * zawartości, wartościuje zmienną poziomu 1 w kolejnych losowych punktach,
+ * rekurencyjnie wyznacza NWD obrazów, przemnaża je przez wartość NWD
+ * współczynników wiodących i odtwarza wynik interpolacją Newtona.
+ * Obrazy o zbyt dużym jednomianie wiodącym (pechowe punkty) są pomijane,
+ * a mniejszy jednomian wiodący rozpoczyna interpolację od nowa.
+ * Interpolacja kończy się, gdy liczba punktów przekroczy ograniczenie
+ * stopnia wyniku względem zmiennej poziomu 1.
+ * @param[in] a         : obraz wielomianu
+ * @param[in] b         : obraz wielomianu
+ * @param[in] level     : poziom @p a i @p b, dodatni
+ * @param[in] prime     : moduł
+ * @param[in, out] seed : stan generatora punktów wartościowania
+ * @return unormowany NWD @p a i @p b
+ */
+static ModPoly MpGcd(const ModPoly *a, const ModPoly *b, unsigned level,
+                     mod_t prime, uint64_t *seed)
+{
+    if (MpIsZero(a, level) || MpIsZero(b, level))
+    {
+        return MpMonic(MpIsZero(a, level) ? b : a, level, prime);
+    }
+    if (level == 1)
+    {
+        return UniGcd(a, b, prime);
+    }
+    ModPoly a_content = MpContent(a, level, prime);
+    ModPoly b_content = MpContent(b, level, prime);
+    ModPoly content = UniGcd(&a_content, &b_content, prime);
+    ModPoly a_prim = MpMapLeaves(a, level, &a_content, UniDivExact, prime);
+    ModPoly b_prim = MpMapLeaves(b, level, &b_content, UniDivExact, prime);
+    const ModPoly *a_lead = MpLeadLeaf(&a_prim, level);
+    const ModPoly *b_lead = MpLeadLeaf(&b_prim, level);
+    ModPoly lead_gcd = UniGcd(a_lead, b_lead, prime);
+    poly_exp_t a_deg = MpLeafDeg(&a_prim, level), b_deg = MpLeafDeg(&b_prim, level);
+    poly_exp_t bound = lead_gcd.exps[0] + (a_deg < b_deg ? a_deg : b_deg);
+
+    ModPoly interp = MpZero(), modulus = MpConst(1, 1), out;
+    poly_exp_t points = 0;
+    while (true)
+    {
+        mod_t x = NextEvaluationPoint(seed, prime);
+        mod_t modulus_at = UniEval(&modulus, x, prime);
+        if (modulus_at == 0 || UniEval(a_lead, x, prime) == 0 ||
+            UniEval(b_lead, x, prime) == 0)
+        {
+            continue;
+        }
+        ModPoly a_image = MpEval(&a_prim, level, x, prime);
+        ModPoly b_image = MpEval(&b_prim, level, x, prime);
+        ModPoly gcd_image = MpGcd(&a_image, &b_image, level - 1, prime, seed);
+        MpDestroy(&a_image, level - 1);
+        MpDestroy(&b_image, level - 1);
+        if (MpIsConstant(&gcd_image, level - 1))
+        {
+            MpDestroy(&gcd_image, level - 1);
+            out = MpLiftLeaf(&content, level);
+            break;
+        }
+        ModPoly image = MpMulScalar(&gcd_image, level - 1,
+                                    UniEval(&lead_gcd, x, prime), prime);
+        MpDestroy(&gcd_image, level - 1);
+        int cmp = points == 0 ? -1 : MpCompareLead(&image, &interp, level - 1);
+        if (cmp > 0)
+        {
+            MpDestroy(&image, level - 1);
+            continue;
+        }
+        if (cmp < 0)
+        {
+            MpDestroy(&interp, level);
+            MpDestroy(&modulus, 1);
+            modulus = MpConst(1, 1);
+            modulus_at = 1;
+            points = 0;
+        }
+        ModPoly next = MpInterpolate(&interp, &image, level, &modulus, x,
+                                     ModInv(modulus_at, prime), prime);
+        MpDestroy(&interp, level);
+        MpDestroy(&image, level - 1);
+        interp = next;
+        ModPoly linear = MpZero();
+        MpPush(&linear, 1, MpConst(1, 0), 1);
+        MpPush(&linear, 0, MpConst(prime - x, 0), 1);
+        next = UniMul(&modulus, &linear, prime);
+        MpDestroy(&linear, 1);
+        MpDestroy(&modulus, 1);
+        modulus = next;
+        if (++points > bound)
+        {
+            ModPoly interp_content = MpContent(&interp, level, prime);
+            ModPoly prim = MpMapLeaves(&interp, level, &interp_content,
+                                       UniDivExact, prime);
+            ModPoly full = MpMapLeaves(&prim, level, &content, UniMul, prime);
+            out = MpMonic(&full, level, prime);
+            MpDestroy(&interp_content, 1);
+            MpDestroy(&prim, level);
+            MpDestroy(&full, level);
+            break;
+        }
+    }
+    MpDestroy(&interp, level);
+    MpDestroy(&modulus, 1);
+    MpDestroy(&lead_gcd, 1);
+    MpDestroy(&a_prim, level);
+    MpDestroy(&b_prim, level);
+    MpDestroy(&content, 1);
+    MpDestroy(&a_content, 1);
+    MpDestroy(&b_content, 1);
+    return out;
+}
+
+/**
+ * Wyznacza NWD wartości bezwzględnych współczynników wielomianu.
+ * @param[in] p : wielomian
+ * @return zawartość całkowitoliczbowa @p p
+ */
+static poly_coeff_t PolyIntegerContent(const Poly *p)
+{
+    poly_coeff_t out = CoeffGcd(p->abs_term, 0);
+    for (Mono *ptr = p->first; ptr != NULL && out != 1; ptr = ptr->next)
+    {
+        out = CoeffGcd(out, PolyIntegerContent(&ptr->p));
+    }
+    return out;
+}
+
+/**
+ * Zwraca współczynnik liczbowy przy największym (leksykograficznie)
+ * jednomianie wielomianu.
+ * @param[in] p : wielomian
+ * @return współczynnik wiodący
+ */
+static poly_coeff_t PolyLeadingInteger(const Poly *p)
+{
+    while (!PolyIsCoeff(p))
+    {
+        p = &p->first->p;
+    }
+    return p->abs_term;
+}
+
+/**
+ * Zwraca kopię wielomianu pomnożoną przez -1, jeżeli jego współczynnik
+ * wiodący jest ujemny.
+ * @param[in] p : wielomian
+ * @return `p` lub `-p`
+ */
+static Poly PolyNormalizeSign(const Poly *p)
+{
+    return PolyLeadingInteger(p) < 0 ? PolyNeg(p) : PolyClone(p);
+}
+
+/**
+ * Sprawdza, czy wielomian @p d dzieli wielomian @p p.
+ * @param[in] d : niezerowy wielomian
+ * @param[in] p : wielomian
+ * @return Czy @p d dzieli @p p?
+ */
+static bool PolyDivides(const Poly *d, const Poly *p)
+{
+    Poly quot = PolyDivExact(p, d);
+    Poly product = PolyMul(&quot, d);
+    bool out = PolyIsEq(&product, p);
+    PolyDestroy(&quot);
+    PolyDestroy(&product);
+    return out;
+}
+
+/**
+ * Dzieli wszystkie współczynniki liczbowe wielomianu przez @p divisor.
+ * @param[in] p       : wielomian
+ * @param[in] divisor : niezerowy dzielnik wszystkich współczynników @p p
+ * @return wielomian o współczynnikach podzielonych przez @p divisor
+ */
+static Poly PolyDivideIntegers(const Poly *p, poly_coeff_t divisor)
+{
+    if (PolyIsCoeff(p))
+    {
+        return PolyFromCoeff(p->abs_term / divisor);
+    }
+    unsigned count = 0;
+    Mono *monos = malloc((p->size + 1) * sizeof(Mono));
+    assert(monos);
+    for (Mono *ptr = p->first; ptr != NULL; ptr = ptr->next)
+    {
+        Poly coeff = PolyDivideIntegers(&ptr->p, divisor);
+        monos[count++] = MonoFromPoly(&coeff, ptr->exp);
+    }
+    Poly abs_term = PolyFromCoeff(p->abs_term / divisor);
+    monos[count++] = MonoFromPoly(&abs_term, 0);
+    Poly out = PolyAddMonos(count, monos);
+    free(monos);
+    return out;
+}
+
+/**
+ * Odtwarza kandydata na NWD z obrazów: łączy je chińskim twierdzeniem
+ * o resztach i dzieli przez zawartość całkowitoliczbową, tak by
+ * współczynnik wiodący był dodatni.
+ * @param[in] images : obrazy modulo kolejne liczby pierwsze bazy
+ * @param[in] basis  : baza
+ * @param[in] level  : poziom obrazów
+ * @return kandydat na NWD
+ */
+static Poly GcdCandidate(const ModPoly images[], const CrtBasis *basis,
+                         unsigned level)
+{
+    const ModPoly *views[GCD_MAX_IMAGES];
+    for (unsigned i = 0; i < basis->count; ++i)
+    {
+        views[i] = &images[i];
+    }
+    Poly combined = MpCrtToPoly(views, basis, level);
+    poly_coeff_t divisor = PolyIntegerContent(&combined);
+    if (PolyLeadingInteger(&combined) < 0)
+    {
+        divisor = -divisor;
+    }
+    if (divisor == 1 || divisor == 0)
+    {
+        return combined;
+    }
+    Poly out = PolyDivideIntegers(&combined, divisor);
+    PolyDestroy(&combined);
+    return out;
+}
+
+/**
+ * @details Implementacja procedury PolyGcd udokumentowanej w pliku poly.h.
+ * Dla kolejnych liczb pierwszych @f$p@f$ wyznacza unormowany NWD obrazów
+ * modulo @f$p@f$ i mnoży go przez NWD całkowitych współczynników wiodących.
+ * Obrazy o równych jednomianach wiodących łączy chińskim twierdzeniem
+ * o resztach (obraz o mniejszym jednomianie wiodącym odrzuca wcześniejsze,
+ * wyznaczone dla pechowych liczb pierwszych). Gdy dołożenie kolejnego
+ * obrazu nie zmienia kandydata, sprawdza go dzieleniem. Pechowych liczb
+ * pierwszych jest skończenie wiele, a trzy obrazy wyznaczają każdy
+ * współczynnik typu poly_coeff_t, więc przy spełnionych założeniach pętla
+ * kończy się zweryfikowanym wynikiem. Kandydat, który nie przeszedł
+ * sprawdzenia po GCD_MAX_IMAGES obrazach, jest porzucany.
+ * @param[in] p : wielomian
+ * @param[in] q : wielomian
+ * @return NWD @p p i @p q
+ */
+Poly PolyGcd(const Poly *p, const Poly *q)
+{
+    if (PolyIsZero(p) || PolyIsZero(q))
+    {
+        return PolyNormalizeSign(PolyIsZero(p) ? q : p);
+    }
+    poly_coeff_t p_content = PolyIntegerContent(p);
+    poly_coeff_t q_content = PolyIntegerContent(q);
+    poly_coeff_t content = CoeffGcd(p_content, q_content);
+    if (PolyIsCoeff(p) || PolyIsCoeff(q))
+    {
+        return PolyFromCoeff(content);
+    }
+    unsigned level = p->depth > q->depth ? p->depth : q->depth;
+    poly_coeff_t p_lead = PolyLeadingInteger(p), q_lead = PolyLeadingInteger(q);
+    poly_coeff_t lead_gcd = CoeffGcd(p_lead / p_content, q_lead / q_content);
+    uint64_t seed = PolyHash(p) ^ (PolyHash(q) << 1) ^ UINT64_C(0x9e3779b97f4a7c15);
+    seed |= 1;
+
+    ModPoly images[GCD_MAX_IMAGES];
+    CrtBasis basis = {.count = 0};
+    Poly candidate = PolyZero(), out;
+    mod_t prime = GCD_PRIME_LIMIT;
+    while (true)
+    {
+        prime = PrevPrime(prime);
+        if (ModFromCoeff(p_lead, prime) == 0 || ModFromCoeff(q_lead, prime) == 0)
+        {
+            continue;
+        }
+        ModPoly a = MpFromPoly(p, level, 0, prime);
+        ModPoly b = MpFromPoly(q, level, 0, prime);
+        ModPoly gcd = MpGcd(&a, &b, level, prime, &seed);
+        ModPoly image = MpMulScalar(&gcd, level, ModFromCoeff(lead_gcd, prime), prime);
+        MpDestroy(&a, level);
+        MpDestroy(&b, level);
+        MpDestroy(&gcd, level);
+        if (MpIsConstant(&image, level))
+        {
+            MpDestroy(&image, level);
+            out = PolyFromCoeff(content);
+            break;
+        }
+        int cmp = basis.count == 0 ? -1 : MpCompareLead(&image, &images[0], level);
+        if (cmp > 0)
+        {
+            MpDestroy(&image, level);
+            continue;
+        }
+        if (cmp < 0 || basis.count == GCD_MAX_IMAGES)
+        {
+            for (unsigned i = 0; i < basis.count; ++i)
+            {
+                MpDestroy(&images[i], level);
+            }
+            basis.count = 0;
+            PolyDestroy(&candidate);
+            candidate = PolyZero();
+        }
+        images[basis.count] = image;
+        CrtBasisAdd(&basis, prime);
+        if (basis.count < 2)
+        {
+            continue;
+        }
+        Poly next = GcdCandidate(images, &basis, level);
+        bool stable = PolyIsEq(&next, &candidate);
+        PolyDestroy(&candidate);
+        candidate = next;
+        if (stable && PolyDivides(&candidate, p) && PolyDivides(&candidate, q))
+        {
+            out = PolyCoeffMul(&candidate, content);
+            break;
+        }
+    }
+    for (unsigned i = 0; i < basis.count; ++i)
+    {
+        MpDestroy(&images[i], level);
+    }
+    PolyDestroy(&candidate);
+    return out;
+}
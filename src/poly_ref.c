@@ -0,0 +1,95 @@
+/** @file
+   Implementacja współdzielonych wielomianów ze zliczaniem referencji
+
+   Uchwyt przechowuje wielomian razem z atomowym licznikiem referencji.
+   Wielomiana nie można zmienić po utworzeniu uchwytu, więc wątki mogą
+   jednocześnie go odczytywać bez dodatkowej synchronizacji. Zwolnienie
+   ostatniej referencji niszczy wielomian - zmniejszanie licznika z porządkiem
+   acquire-release zapewnia, że następuje to po wszystkich wcześniejszych
+   odczytach w pozostałych wątkach.
+
+   @author agent
+   @date 2026-10-19
+ */
+
+
+#include <assert.h>
+#include <stdatomic.h>
+#include "poly.h"
+#include "utils.h"
+
+
+/**
+ * Współdzielony, niezmienny wielomian.
+ */
+struct PolyRef
+{
+    Poly poly; ///< wielomian
+    atomic_uint refs; ///< liczba referencji
+};
+
+/**
+ * @details Implementacja procedury PolyRefCreate udokumentowanej w pliku
+ * poly.h.
+ * @param[in, out] p : wielomian
+ * @return uchwyt
+ */
+PolyRef* PolyRefCreate(Poly *p)
+{
+    PolyRef *ref = malloc(sizeof(PolyRef));
+    assert(ref);
+    ref->poly = *p;
+    atomic_init(&ref->refs, 1);
+    *p = PolyZero();
+    return ref;
+}
+
+/**
+ * @details Implementacja procedury PolyRefAcquire udokumentowanej w pliku
+ * poly.h.
+ * @param[in] ref : uchwyt
+ * @return `ref`
+ */
+PolyRef* PolyRefAcquire(PolyRef *ref)
+{
+    atomic_fetch_add_explicit(&ref->refs, 1, memory_order_relaxed);
+    return ref;
+}
+
+/**
+ * @details Implementacja procedury PolyRefRelease udokumentowanej w pliku
+ * poly.h.
+ * @param[in] ref : uchwyt
+ */
+void PolyRefRelease(PolyRef *ref)
+{
+    if (ref == NULL)
+    {
+        return;
+    }
+    if (atomic_fetch_sub_explicit(&ref->refs, 1, memory_order_acq_rel) == 1)
+    {
+        PolyDestroy(&ref->poly);
+        free(ref);
+    }
+}
+
+/**
+ * @details Implementacja procedury PolyRefGet udokumentowanej w pliku poly.h.
+ * @param[in] ref : uchwyt
+ * @return wielomian
+ */
+const Poly* PolyRefGet(const PolyRef *ref)
+{
+    return &ref->poly;
+}
+
+/**
+ * @details Implementacja procedury PolyRefCount udokumentowanej w pliku poly.h.
+ * @param[in] ref : uchwyt
+ * @return liczba referencji
+ */
+unsigned PolyRefCount(PolyRef *ref)
+{
+    return atomic_load_explicit(&ref->refs, memory_order_relaxed);
+}
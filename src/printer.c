@@ -0,0 +1,155 @@
+/** @file
+   Implementacja buforowanego wypisywania
+
+   @author agent
+   @date 2026-10-19
+ */
+
+
+#include <string.h>
+#include "printer.h"
+#include "utils.h"
+
+
+/// Zapisy dziesiętne liczb od 00 do 99; pozwalają zamieniać po dwie cyfry.
+static const char DIGIT_PAIRS[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/// Największa długość zapisu dziesiętnego liczby typu long wraz ze znakiem.
+#define LONG_DIGITS 21
+
+
+/**
+ * @details Implementacja procedury PrinterInit udokumentowanej w pliku
+ * printer.h.
+ * @param[out] printer : drukarka
+ * @param[in] file     : plik
+ */
+void PrinterInit(Printer *printer, FILE *file)
+{
+    printer->file = file;
+    printer->sink = NULL;
+    printer->sink_arg = NULL;
+    printer->size = 0;
+}
+
+/**
+ * @details Implementacja procedury PrinterInitSink udokumentowanej w pliku
+ * printer.h.
+ * @param[out] printer : drukarka
+ * @param[in] sink     : funkcja odbierająca tekst
+ * @param[in] arg      : argument funkcji
+ */
+void PrinterInitSink(Printer *printer, PrinterSink sink, void *arg)
+{
+    printer->file = NULL;
+    printer->sink = sink;
+    printer->sink_arg = arg;
+    printer->size = 0;
+}
+
+/**
+ * @details Implementacja procedury PrinterFlush udokumentowanej w pliku
+ * printer.h.
+ * @param[in, out] printer : drukarka
+ */
+void PrinterFlush(Printer *printer)
+{
+    if (printer->size > 0)
+    {
+        if (printer->sink != NULL)
+        {
+            printer->sink(printer->sink_arg, printer->buffer, printer->size);
+        }
+        else
+        {
+            fwrite(printer->buffer, 1, printer->size, printer->file);
+        }
+        printer->size = 0;
+    }
+}
+
+/**
+ * Wypisuje @p length znaków z tablicy @p s.
+ * Tekst dłuższy od wolnego miejsca w buforze jest dzielony na części.
+ * @param[in, out] printer : drukarka
+ * @param[in] s            : znaki
+ * @param[in] length       : liczba znaków
+ */
+static void PrinterPutChars(Printer *printer, const char *s, size_t length)
+{
+    while (length > 0)
+    {
+        if (printer->size == PRINTER_BUFFER_SIZE)
+        {
+            PrinterFlush(printer);
+        }
+        size_t part = PRINTER_BUFFER_SIZE - printer->size;
+        if (part > length)
+        {
+            part = length;
+        }
+        memcpy(printer->buffer + printer->size, s, part);
+        printer->size += part;
+        s += part;
+        length -= part;
+    }
+}
+
+/**
+ * @details Implementacja procedury PrinterPutString udokumentowanej w pliku
+ * printer.h.
+ * @param[in, out] printer : drukarka
+ * @param[in] s            : napis
+ */
+void PrinterPutString(Printer *printer, const char *s)
+{
+    PrinterPutChars(printer, s, strlen(s));
+}
+
+/**
+ * @details Implementacja procedury PrinterPutLong udokumentowanej w pliku
+ * printer.h.
+ * Cyfry wyznaczane są od końca, po dwie naraz, w pomocniczej tablicy.
+ * Wartość bezwzględna liczona jest na typie bez znaku, więc poprawnie
+ * wypisywana jest też najmniejsza liczba typu long.
+ * @param[in, out] printer : drukarka
+ * @param[in] value        : liczba
+ */
+void PrinterPutLong(Printer *printer, long value)
+{
+    char digits[LONG_DIGITS];
+    char *begin = digits + LONG_DIGITS;
+    unsigned long rest = value < 0 ? -(unsigned long)value
+                                   : (unsigned long)value;
+    while (rest >= 100)
+    {
+        unsigned pair = rest % 100;
+        rest /= 100;
+        begin -= 2;
+        memcpy(begin, DIGIT_PAIRS + 2 * pair, 2);
+    }
+    if (rest >= 10)
+    {
+        begin -= 2;
+        memcpy(begin, DIGIT_PAIRS + 2 * rest, 2);
+    }
+    else
+    {
+        *--begin = '0' + rest;
+    }
+    if (value < 0)
+    {
+        *--begin = '-';
+    }
+    PrinterPutChars(printer, begin, digits + LONG_DIGITS - begin);
+}
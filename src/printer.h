@@ -0,0 +1,93 @@
+/** @file
+   Interfejs buforowanego wypisywania
+
+   Drukarka gromadzi wypisywany tekst w dużym buforze i przekazuje go do
+   pliku jednym wywołaniem fwrite (lub do funkcji odbierającej tekst)
+   dopiero po zapełnieniu bufora lub na żądanie. Liczby całkowite zamieniane
+   są na zapis dziesiętny bez korzystania z funkcji rodziny printf.
+
+   @author agent
+   @date 2026-10-19
+ */
+
+#ifndef __PRINTER_H__
+#define __PRINTER_H__
+
+#include <stdio.h>
+
+
+#ifdef UNIT_TESTING
+/// W testach jednostkowych bufor jest krótki, by sprawdzić jego opróżnianie.
+#define PRINTER_BUFFER_SIZE 8
+#else
+/// Rozmiar bufora drukarki.
+#define PRINTER_BUFFER_SIZE (1 << 14)
+#endif
+
+/** Funkcja odbierająca tekst z bufora drukarki zamiast pliku. */
+typedef void (*PrinterSink)(void *arg, const char *data, size_t size);
+
+/**
+ * Struktura przechowująca stan drukarki.
+ */
+typedef struct Printer
+{
+    FILE *file; ///< plik, do którego trafia wypisywany tekst
+    PrinterSink sink; ///< funkcja odbierająca tekst zamiast pliku lub NULL
+    void *sink_arg; ///< argument funkcji odbierającej tekst
+    size_t size; ///< liczba znaków w buforze
+    char buffer[PRINTER_BUFFER_SIZE]; ///< bufor wypisywanego tekstu
+} Printer;
+
+
+/**
+ * Przygotowuje drukarkę piszącą do pliku @p file.
+ * @param[out] printer : drukarka
+ * @param[in] file     : plik
+ */
+void PrinterInit(Printer *printer, FILE *file);
+
+/**
+ * Przygotowuje drukarkę przekazującą tekst z bufora do funkcji @p sink.
+ * @param[out] printer : drukarka
+ * @param[in] sink     : funkcja odbierająca tekst
+ * @param[in] arg      : pierwszy argument funkcji @p sink
+ */
+void PrinterInitSink(Printer *printer, PrinterSink sink, void *arg);
+
+/**
+ * Przekazuje do pliku (lub funkcji odbierającej tekst) zawartość bufora
+ * drukarki i opróżnia bufor.
+ * @param[in, out] printer : drukarka
+ */
+void PrinterFlush(Printer *printer);
+
+/**
+ * Wypisuje znak.
+ * @param[in, out] printer : drukarka
+ * @param[in] c            : znak
+ */
+static inline void PrinterPutChar(Printer *printer, char c)
+{
+    if (printer->size == PRINTER_BUFFER_SIZE)
+    {
+        PrinterFlush(printer);
+    }
+    printer->buffer[printer->size++] = c;
+}
+
+/**
+ * Wypisuje napis.
+ * @param[in, out] printer : drukarka
+ * @param[in] s            : napis zakończony bajtem o wartości 0
+ */
+void PrinterPutString(Printer *printer, const char *s);
+
+/**
+ * Wypisuje liczbę w zapisie dziesiętnym.
+ * @param[in, out] printer : drukarka
+ * @param[in] value        : liczba
+ */
+void PrinterPutLong(Printer *printer, long value);
+
+#endif /* __PRINTER_H__ */
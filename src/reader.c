@@ -0,0 +1,315 @@
+/** @file
+   Implementacja blokowego czytnika wejścia
+
+   @author agent
+   @date 2026-10-19
+ */
+
+
+#define _DEFAULT_SOURCE
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "reader.h"
+#include "utils.h"
+
+
+#ifdef UNIT_TESTING
+/// W testach jednostkowych bloki są krótkie, by sprawdzić ich łączenie.
+static const size_t READER_BLOCK_SIZE = 7;
+#else
+/// Rozmiar bloku wczytywanego jednym wywołaniem fread.
+static const size_t READER_BLOCK_SIZE = 1 << 16;
+#endif
+
+/// Rozmiar okna odwzorowanego pliku; musi być wielokrotnością rozmiaru strony.
+static const size_t READER_WINDOW_SIZE = 1 << 22;
+
+
+/**
+ * @details Implementacja procedury ReaderInitFile udokumentowanej w pliku
+ * reader.h.
+ * @param[out] reader : czytnik
+ * @param[in] file    : plik
+ */
+void ReaderInitFile(Reader *reader, FILE *file)
+{
+    reader->file = file;
+    reader->source = NULL;
+    reader->source_arg = NULL;
+    reader->mapping = NULL;
+    reader->mapping_size = 0;
+    reader->input_size = 0;
+    reader->capacity = READER_BLOCK_SIZE;
+    reader->buffer = malloc(reader->capacity);
+    assert(reader->buffer);
+    reader->data = reader->buffer;
+    reader->size = 0;
+    reader->pos = 0;
+    reader->block_offset = 0;
+    reader->at_eof = false;
+    reader->counted = 0;
+    reader->line = 0;
+    reader->line_start = 0;
+}
+
+/**
+ * @details Implementacja procedury ReaderInitSource udokumentowanej w pliku
+ * reader.h. Bloki nie są kopiowane do bufora czytnika.
+ * @param[out] reader : czytnik
+ * @param[in] source  : funkcja dostarczająca bloki
+ * @param[in] arg     : argument funkcji
+ */
+void ReaderInitSource(Reader *reader, ReaderSource source, void *arg)
+{
+    reader->file = NULL;
+    reader->source = source;
+    reader->source_arg = arg;
+    reader->mapping = NULL;
+    reader->mapping_size = 0;
+    reader->input_size = 0;
+    reader->buffer = NULL;
+    reader->capacity = 0;
+    reader->data = "";
+    reader->size = 0;
+    reader->pos = 0;
+    reader->block_offset = 0;
+    reader->at_eof = false;
+    reader->counted = 0;
+    reader->line = 0;
+    reader->line_start = 0;
+}
+
+/**
+ * @details Implementacja procedury ReaderInitMapped udokumentowanej w pliku
+ * reader.h.
+ * @param[out] reader : czytnik
+ * @param[in] path    : ścieżka pliku
+ * @return Czy udało się odwzorować plik?
+ */
+bool ReaderInitMapped(Reader *reader, const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode))
+    {
+        close(fd);
+        return false;
+    }
+    char *mapping = NULL;
+    if (info.st_size > 0)
+    {
+        mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            close(fd);
+            return false;
+        }
+        madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+    }
+    close(fd);
+    reader->file = NULL;
+    reader->source = NULL;
+    reader->source_arg = NULL;
+    reader->mapping = mapping;
+    reader->mapping_size = info.st_size;
+    reader->input_size = info.st_size;
+    reader->buffer = NULL;
+    reader->capacity = READER_WINDOW_SIZE;
+    reader->data = mapping;
+    reader->size = 0;
+    reader->pos = 0;
+    reader->block_offset = 0;
+    reader->at_eof = mapping == NULL;
+    reader->counted = 0;
+    reader->line = 0;
+    reader->line_start = 0;
+    return true;
+}
+
+/**
+ * @details Implementacja procedury ReaderDestroy udokumentowanej w pliku
+ * reader.h.
+ * @param[in, out] reader : czytnik
+ */
+void ReaderDestroy(Reader *reader)
+{
+    if (reader->mapping != NULL)
+    {
+        munmap(reader->mapping, reader->mapping_size);
+        reader->mapping = NULL;
+    }
+    free(reader->buffer);
+    reader->buffer = NULL;
+    reader->data = NULL;
+    reader->size = 0;
+    reader->pos = 0;
+}
+
+/**
+ * Zlicza znaki nowego wiersza bieżącego bloku między indeksem `counted`
+ * a @p end.
+ * @param[in, out] reader : czytnik
+ * @param[in] end         : indeks w bloku, do którego zliczamy (bez niego)
+ */
+static void ReaderCountLines(Reader *reader, size_t end)
+{
+    const char *ptr = reader->data + reader->counted;
+    const char *stop = reader->data + end;
+    while (ptr < stop && (ptr = memchr(ptr, '\n', stop - ptr)) != NULL)
+    {
+        ++ptr;
+        reader->line += 1;
+        reader->line_start = reader->block_offset + (ptr - reader->data);
+    }
+    reader->counted = end;
+}
+
+/**
+ * Przechodzi do kolejnego okna odwzorowanego pliku, zwalniając strony
+ * poprzedniego okna.
+ * @param[in, out] reader : czytnik
+ */
+static void ReaderNextWindow(Reader *reader)
+{
+    if (reader->size > 0)
+    {
+        madvise(reader->mapping + reader->block_offset, reader->size,
+                MADV_DONTNEED);
+    }
+    reader->block_offset += reader->size;
+    reader->data = reader->mapping + reader->block_offset;
+    reader->size = reader->input_size - reader->block_offset;
+    if (reader->size > reader->capacity)
+    {
+        reader->size = reader->capacity;
+    }
+}
+
+/**
+ * @details Implementacja procedury ReaderRefill udokumentowanej w pliku
+ * reader.h.
+ * @param[in, out] reader : czytnik
+ * @return znak lub EOF
+ */
+int ReaderRefill(Reader *reader)
+{
+    if (reader->at_eof)
+    {
+        return EOF;
+    }
+    ReaderCountLines(reader, reader->size);
+    if (reader->mapping != NULL)
+    {
+        ReaderNextWindow(reader);
+    }
+    else if (reader->source != NULL)
+    {
+        reader->block_offset += reader->size;
+        reader->data = reader->source(reader->source_arg, &reader->size);
+    }
+    else
+    {
+        reader->block_offset += reader->size;
+        reader->size = fread(reader->buffer, 1, reader->capacity, reader->file);
+    }
+    reader->pos = 0;
+    reader->counted = 0;
+    if (reader->size == 0)
+    {
+        reader->at_eof = true;
+        return EOF;
+    }
+    return (unsigned char)reader->data[reader->pos++];
+}
+
+/**
+ * @details Implementacja procedury ReaderSkipLine udokumentowanej w pliku
+ * reader.h.
+ * @param[in, out] reader : czytnik
+ * @return `'\n'` lub EOF
+ */
+int ReaderSkipLine(Reader *reader)
+{
+    while (true)
+    {
+        const char *ptr = memchr(reader->data + reader->pos, '\n',
+                                 reader->size - reader->pos);
+        if (ptr != NULL)
+        {
+            reader->pos = ptr - reader->data + 1;
+            return '\n';
+        }
+        reader->pos = reader->size;
+        int c = ReaderRefill(reader);
+        if (c == EOF || c == '\n')
+        {
+            return c;
+        }
+    }
+}
+
+/**
+ * @details Implementacja procedury ReaderDetachLastLine udokumentowanej
+ * w pliku reader.h.
+ * @param[in, out] reader : czytnik
+ * @param[out] length     : długość wiersza
+ * @return początek wiersza
+ */
+const char* ReaderDetachLastLine(Reader *reader, size_t *length)
+{
+    *length = 0;
+    if (reader->mapping == NULL)
+    {
+        return "";
+    }
+    size_t begin = reader->block_offset + reader->pos;
+    size_t end = reader->input_size;
+    if (end > begin && reader->mapping[end - 1] == '\n')
+    {
+        --end;
+    }
+    size_t start = end;
+    while (start > begin && reader->mapping[start - 1] != '\n')
+    {
+        --start;
+    }
+    reader->input_size = start;
+    if (reader->block_offset + reader->size > start)
+    {
+        reader->size = start - reader->block_offset;
+    }
+    *length = end - start;
+    return reader->mapping + start;
+}
+
+/**
+ * @details Implementacja procedury ReaderLocate udokumentowanej w pliku
+ * reader.h.
+ * @param[in, out] reader : czytnik
+ * @param[out] line       : numer wiersza
+ * @param[out] column     : numer kolumny
+ */
+void ReaderLocate(Reader *reader, unsigned *line, unsigned *column)
+{
+    size_t current = reader->pos;
+    if (!reader->at_eof && current > 0)
+    {
+        --current;
+    }
+    if (current > reader->counted)
+    {
+        ReaderCountLines(reader, current);
+    }
+    *line = reader->line + 1;
+    *column = reader->block_offset + current - reader->line_start + 1;
+}
@@ -0,0 +1,153 @@
+/** @file
+   Interfejs blokowego czytnika wejścia
+
+   Czytnik wczytuje wejście dużymi blokami i udostępnia kursor przesuwający
+   się po bloku w pamięci, dzięki czemu pobranie kolejnego znaku nie wymaga
+   wywołania funkcji biblioteki standardowej. Numer wiersza i kolumny
+   bieżącego znaku nie są aktualizowane przy każdym znaku - wyznaczane są
+   dopiero na żądanie, przez zliczenie znaków nowego wiersza w przeczytanej
+   od poprzedniego żądania części wejścia.
+
+   Bloki mogą też pochodzić z funkcji dostarczającej je kolejno, np. z kolejki
+   wypełnianej przez inny wątek.
+
+   Plik może też zostać odwzorowany w pamięci - wtedy bloki są kolejnymi
+   oknami odwzorowania i znaki pobierane są bezpośrednio z niego, bez
+   kopiowania. Strony okien, które kursor już minął, są zwalniane, więc
+   czytany plik może być większy od pamięci operacyjnej.
+
+   @author agent
+   @date 2026-10-19
+ */
+
+#ifndef __READER_H__
+#define __READER_H__
+
+#include <stdbool.h>
+#include <stdio.h>
+
+
+/**
+ * Funkcja dostarczająca czytnikowi kolejny blok wejścia. Blok pozostaje ważny
+ * do kolejnego wywołania funkcji; blok pusty oznacza koniec wejścia.
+ */
+typedef const char* (*ReaderSource)(void *arg, size_t *size);
+
+/**
+ * Struktura przechowująca stan czytnika.
+ * Pola struktury nie powinny być używane bezpośrednio poza implementacją
+ * czytnika i funkcją ReaderNext.
+ */
+typedef struct Reader
+{
+    FILE *file; ///< plik, z którego wczytywane są bloki
+    ReaderSource source; ///< funkcja dostarczająca bloki zamiast pliku lub NULL
+    void *source_arg; ///< argument funkcji dostarczającej bloki
+    char *mapping; ///< odwzorowanie pliku w pamięci lub NULL
+    size_t mapping_size; ///< długość odwzorowanego pliku
+    size_t input_size; ///< długość czytanej części odwzorowanego pliku
+    char *buffer; ///< bufor na bloki wejścia
+    size_t capacity; ///< rozmiar bufora
+    const char *data; ///< bieżący blok
+    size_t size; ///< długość bieżącego bloku
+    size_t pos; ///< indeks następnego znaku w bieżącym bloku
+    size_t block_offset; ///< przesunięcie początku bloku względem początku wejścia
+    bool at_eof; ///< czy zwrócono już koniec wejścia
+    size_t counted; ///< indeks w bloku, do którego zliczono znaki nowego wiersza
+    unsigned line; ///< liczba znaków nowego wiersza przed `counted`
+    size_t line_start; ///< przesunięcie początku wiersza zawierającego `counted`
+} Reader;
+
+
+/**
+ * Przygotowuje czytnik wczytujący blokami plik @p file.
+ * @param[out] reader : czytnik
+ * @param[in] file    : plik
+ */
+void ReaderInitFile(Reader *reader, FILE *file);
+
+/**
+ * Przygotowuje czytnik pobierający kolejne bloki z funkcji @p source.
+ * @param[out] reader : czytnik
+ * @param[in] source  : funkcja dostarczająca bloki
+ * @param[in] arg     : pierwszy argument funkcji @p source
+ */
+void ReaderInitSource(Reader *reader, ReaderSource source, void *arg);
+
+/**
+ * Przygotowuje czytnik pobierający znaki bezpośrednio z odwzorowania pliku
+ * o ścieżce @p path w pamięci.
+ * @param[out] reader : czytnik
+ * @param[in] path    : ścieżka pliku
+ * @return Czy udało się odwzorować plik?
+ */
+bool ReaderInitMapped(Reader *reader, const char *path);
+
+/**
+ * Zwalnia pamięć czytnika. Nie zamyka pliku przekazanego do ReaderInitFile.
+ * @param[in, out] reader : czytnik
+ */
+void ReaderDestroy(Reader *reader);
+
+/**
+ * Wczytuje kolejny blok wejścia i zwraca jego pierwszy znak.
+ * Wywoływana przez ReaderNext po wyczerpaniu bieżącego bloku.
+ * @param[in, out] reader : czytnik
+ * @return znak lub EOF
+ */
+int ReaderRefill(Reader *reader);
+
+/**
+ * Pobiera kolejny znak wejścia.
+ * @param[in, out] reader : czytnik
+ * @return znak (jako `unsigned char`) lub EOF
+ */
+static inline int ReaderNext(Reader *reader)
+{
+    if (reader->pos < reader->size)
+    {
+        return (unsigned char)reader->data[reader->pos++];
+    }
+    return ReaderRefill(reader);
+}
+
+/**
+ * Sprawdza, czy pobrano już wszystkie znaki bieżącego bloku, czyli czy
+ * pobranie kolejnego znaku może wymagać oczekiwania na dane wejściowe.
+ * @param[in] reader : czytnik
+ * @return Czy bieżący blok został wyczerpany?
+ */
+static inline bool ReaderBlockConsumed(const Reader *reader)
+{
+    return reader->pos == reader->size;
+}
+
+/**
+ * Pomija znaki do najbliższego znaku nowego wiersza włącznie lub do końca
+ * wejścia.
+ * @param[in, out] reader : czytnik
+ * @return ostatni pominięty znak: `'\n'` lub EOF
+ */
+int ReaderSkipLine(Reader *reader);
+
+/**
+ * Wyłącza z wejścia czytnika odwzorowanego pliku jego ostatni wiersz, który
+ * nie będzie już pobierany przez ReaderNext, i zwraca jego treść. Znak nowego
+ * wiersza kończący plik nie rozpoczyna nowego wiersza. Pod uwagę brane są
+ * tylko znaki, których jeszcze nie pobrano.
+ * @param[in, out] reader : czytnik utworzony przez ReaderInitMapped
+ * @param[out] length     : długość wiersza bez znaku nowego wiersza
+ * @return początek wiersza w odwzorowaniu (ważny do wywołania ReaderDestroy)
+ */
+const char* ReaderDetachLastLine(Reader *reader, size_t *length);
+
+/**
+ * Wyznacza numer wiersza i kolumny (liczone od 1) ostatnio pobranego znaku.
+ * Koniec wejścia traktowany jest jak znak następujący po ostatnim znaku.
+ * @param[in, out] reader : czytnik
+ * @param[out] line       : numer wiersza
+ * @param[out] column     : numer kolumny
+ */
+void ReaderLocate(Reader *reader, unsigned *line, unsigned *column);
+
+#endif /* __READER_H__ */
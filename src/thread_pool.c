@@ -0,0 +1,572 @@
+/** @file
+   Implementacja puli wątków z podkradaniem zadań
+
+   @author agent
+   @date 2026-10-19
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "thread_pool.h"
+#include "utils.h"
+
+
+/**
+ * Struktura przechowująca zadanie zlecone puli.
+ */
+struct PoolTask
+{
+    PoolFunction function; ///< funkcja do wykonania
+    void *arg; ///< argument funkcji
+    atomic_bool done; ///< czy zadanie zostało wykonane
+    bool detached; ///< czy pamięć zadania zwalniana jest po jego wykonaniu
+};
+
+/**
+ * Kolejka dwustronna zadań chroniona muteksem.
+ * Zadania przechowywane są w buforze cyklicznym. Właściciel kolejki dokłada
+ * i zdejmuje zadania z jej końca, pozostałe wątki podkradają je z początku.
+ */
+typedef struct TaskDeque
+{
+    pthread_mutex_t lock; ///< muteks chroniący kolejkę
+    PoolTask **tasks; ///< bufor cykliczny zadań
+    unsigned head; ///< indeks najstarszego zadania
+    unsigned size; ///< liczba zadań w kolejce
+    unsigned capacity; ///< rozmiar bufora
+} TaskDeque;
+
+/**
+ * Struktura przechowująca stan puli wątków.
+ * Kolejki o indeksach `0, …, thread_count - 2` należą do wątków roboczych,
+ * ostatnia kolejka przyjmuje zadania zlecane spoza puli. Zadania odłączone
+ * trafiają do osobnej kolejki, modyfikowanej tylko pod muteksem `lock`,
+ * z której zdejmują je bezczynne wątki robocze, a gdy pula nie ma wątków
+ * roboczych - wątek tła.
+ */
+typedef struct ThreadPool
+{
+    unsigned thread_count; ///< łączna liczba wątków, wraz z wątkiem wywołującym
+    pthread_t *workers; ///< wątki robocze
+    TaskDeque *deques; ///< kolejki zadań
+    pthread_mutex_t lock; ///< muteks chroniący usypianie i budzenie wątków
+    pthread_cond_t wake; ///< budzi wątki po zleceniu lub wykonaniu zadania
+    /**
+     * Liczba zadań czekających w kolejkach. Zlecający zwiększa ją dopiero po
+     * włożeniu zadania do kolejki, więc może ona chwilowo być ujemna, gdy
+     * inny wątek zdejmie zadanie wcześniej.
+     */
+    atomic_int pending;
+    bool stopping; ///< czy wątki robocze mają zakończyć działanie
+    TaskDeque background; ///< kolejka zadań odłączonych
+    unsigned detached_count; ///< liczba zleconych i niewykonanych zadań odłączonych
+    pthread_t background_worker; ///< wątek tła wykonujący zadania odłączone
+    pthread_cond_t background_wake; ///< budzi wątek tła po zleceniu zadania
+    bool background_running; ///< czy wątek tła został uruchomiony
+    bool background_stopping; ///< czy wątek tła ma zakończyć działanie
+} ThreadPool;
+
+/** Pula wątków biblioteki. */
+static ThreadPool global_pool = {
+    .thread_count = 1, .workers = NULL, .deques = NULL,
+    .lock = PTHREAD_MUTEX_INITIALIZER, .wake = PTHREAD_COND_INITIALIZER,
+    .pending = 0, .stopping = false,
+    .background = {.lock = PTHREAD_MUTEX_INITIALIZER}, .detached_count = 0,
+    .background_wake = PTHREAD_COND_INITIALIZER,
+    .background_running = false, .background_stopping = false};
+
+/** Indeks kolejki bieżącego wątku roboczego lub -1 poza pulą. */
+static _Thread_local int pool_worker_idx = -1;
+
+
+/**
+ * Dokłada zadanie na koniec kolejki, w razie potrzeby ją powiększając.
+ * @param[in, out] deque : kolejka
+ * @param[in] task       : zadanie
+ */
+static void DequePushBack(TaskDeque *deque, PoolTask *task)
+{
+    pthread_mutex_lock(&deque->lock);
+    if (deque->size == deque->capacity)
+    {
+        unsigned capacity = 2 * deque->capacity + 8;
+        PoolTask **tasks = malloc(capacity * sizeof(PoolTask*));
+        assert(tasks);
+        for (unsigned i = 0; i < deque->size; ++i)
+        {
+            tasks[i] = deque->tasks[(deque->head + i) % deque->capacity];
+        }
+        free(deque->tasks);
+        deque->tasks = tasks;
+        deque->head = 0;
+        deque->capacity = capacity;
+    }
+    deque->tasks[(deque->head + deque->size++) % deque->capacity] = task;
+    pthread_mutex_unlock(&deque->lock);
+}
+
+/**
+ * Zdejmuje zadanie z końca (najnowsze) lub z początku (najstarsze) kolejki.
+ * @param[in, out] deque : kolejka
+ * @param[in] newest     : czy zdjąć najnowsze zadanie
+ * @return zadanie lub NULL dla pustej kolejki
+ */
+static PoolTask* DequePop(TaskDeque *deque, bool newest)
+{
+    PoolTask *out = NULL;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->size > 0)
+    {
+        if (newest)
+        {
+            out = deque->tasks[(deque->head + deque->size - 1) % deque->capacity];
+        }
+        else
+        {
+            out = deque->tasks[deque->head];
+            deque->head = (deque->head + 1) % deque->capacity;
+        }
+        --deque->size;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return out;
+}
+
+/**
+ * Szuka zadania do wykonania.
+ * Wątek roboczy najpierw zdejmuje najnowsze zadanie z własnej kolejki,
+ * a następnie podkrada najstarsze zadania z kolejnych kolejek.
+ * @return zadanie lub NULL, gdy wszystkie kolejki są puste
+ */
+static PoolTask* PoolFindTask()
+{
+    unsigned count = global_pool.thread_count;
+    PoolTask *out = NULL;
+    if (count <= 1)
+    {
+        return NULL;
+    }
+    unsigned start = 0;
+    if (pool_worker_idx >= 0)
+    {
+        out = DequePop(&global_pool.deques[pool_worker_idx], true);
+        start = pool_worker_idx + 1;
+    }
+    for (unsigned i = 0; out == NULL && i < count; ++i)
+    {
+        out = DequePop(&global_pool.deques[(start + i) % count], false);
+    }
+    if (out != NULL)
+    {
+        atomic_fetch_sub(&global_pool.pending, 1);
+    }
+    return out;
+}
+
+/**
+ * Wykonuje zadanie, oznacza je jako wykonane (lub zwalnia zadanie odłączone)
+ * i budzi oczekujące wątki.
+ * @param[in] task : zadanie
+ */
+static void PoolRunTask(PoolTask *task)
+{
+    task->function(task->arg);
+    bool detached = task->detached;
+    if (detached)
+    {
+        free(task);
+    }
+    else
+    {
+        atomic_store(&task->done, true);
+    }
+    pthread_mutex_lock(&global_pool.lock);
+    if (detached)
+    {
+        --global_pool.detached_count;
+    }
+    pthread_cond_broadcast(&global_pool.wake);
+    pthread_mutex_unlock(&global_pool.lock);
+}
+
+/**
+ * Zdejmuje najstarsze zadanie odłączone.
+ * @return zadanie lub NULL, gdy nie ma zleconych zadań odłączonych
+ */
+static PoolTask* PoolTakeDetached()
+{
+    pthread_mutex_lock(&global_pool.lock);
+    PoolTask *out = DequePop(&global_pool.background, false);
+    pthread_mutex_unlock(&global_pool.lock);
+    return out;
+}
+
+/**
+ * Główna pętla wątku roboczego.
+ * Zadania odłączone wątek podejmuje tylko wtedy, gdy w kolejkach nie ma
+ * innych zadań - nigdy w trakcie oczekiwania w PoolHelpUntil, by długa
+ * operacja odłączona nie opóźniała zadania, na które czeka inny wątek.
+ * @param[in] arg : indeks kolejki wątku
+ * @return NULL
+ */
+static void* PoolWorkerMain(void *arg)
+{
+    pool_worker_idx = (int)(intptr_t)arg;
+    while (true)
+    {
+        PoolTask *task = PoolFindTask();
+        if (task == NULL)
+        {
+            task = PoolTakeDetached();
+        }
+        if (task != NULL)
+        {
+            PoolRunTask(task);
+            continue;
+        }
+        pthread_mutex_lock(&global_pool.lock);
+        while (!global_pool.stopping && atomic_load(&global_pool.pending) <= 0 &&
+               global_pool.background.size == 0)
+        {
+            pthread_cond_wait(&global_pool.wake, &global_pool.lock);
+        }
+        bool stopping = global_pool.stopping;
+        pthread_mutex_unlock(&global_pool.lock);
+        if (stopping)
+        {
+            break;
+        }
+    }
+    pool_worker_idx = -1;
+    return NULL;
+}
+
+/**
+ * Główna pętla wątku tła: wykonuje zadania odłączone w kolejności zlecenia,
+ * a po zleceniu zatrzymania kończy działanie, gdy kolejka jest pusta.
+ * @param[in] arg : nieużywany
+ * @return NULL
+ */
+static void* PoolBackgroundMain(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&global_pool.lock);
+    while (true)
+    {
+        PoolTask *task = DequePop(&global_pool.background, false);
+        if (task != NULL)
+        {
+            pthread_mutex_unlock(&global_pool.lock);
+            PoolRunTask(task);
+            pthread_mutex_lock(&global_pool.lock);
+            continue;
+        }
+        if (global_pool.background_stopping)
+        {
+            break;
+        }
+        pthread_cond_wait(&global_pool.background_wake, &global_pool.lock);
+    }
+    pthread_mutex_unlock(&global_pool.lock);
+    return NULL;
+}
+
+/**
+ * Zleca zadanie odłączone wątkom roboczym, a gdy pula ich nie ma - wątkowi
+ * tła, uruchamiając go przy pierwszym zleceniu.
+ * @param[in] task : zadanie
+ */
+static void PoolSubmitBackground(PoolTask *task)
+{
+    pthread_mutex_lock(&global_pool.lock);
+    DequePushBack(&global_pool.background, task);
+    ++global_pool.detached_count;
+    if (global_pool.thread_count > 1)
+    {
+        pthread_cond_broadcast(&global_pool.wake);
+        pthread_mutex_unlock(&global_pool.lock);
+        return;
+    }
+    if (!global_pool.background_running)
+    {
+        int status = pthread_create(&global_pool.background_worker, NULL,
+                                    PoolBackgroundMain, NULL);
+        assert(status == 0);
+        (void)status;
+        global_pool.background_running = true;
+    }
+    pthread_cond_signal(&global_pool.background_wake);
+    pthread_mutex_unlock(&global_pool.lock);
+}
+
+/**
+ * Czeka na wykonanie zleconych zadań odłączonych i kończy wątek tła.
+ */
+static void PoolStopBackground()
+{
+    pthread_mutex_lock(&global_pool.lock);
+    while (global_pool.detached_count > 0)
+    {
+        pthread_cond_wait(&global_pool.wake, &global_pool.lock);
+    }
+    bool running = global_pool.background_running;
+    global_pool.background_stopping = true;
+    pthread_cond_signal(&global_pool.background_wake);
+    pthread_mutex_unlock(&global_pool.lock);
+    if (running)
+    {
+        pthread_join(global_pool.background_worker, NULL);
+    }
+    assert(global_pool.background.size == 0);
+    free(global_pool.background.tasks);
+    global_pool.background.tasks = NULL;
+    global_pool.background.head = 0;
+    global_pool.background.capacity = 0;
+    global_pool.background_running = false;
+    global_pool.background_stopping = false;
+}
+
+/**
+ * Kończy działanie wątków roboczych i zwalnia kolejki zadań.
+ */
+static void PoolShutdown()
+{
+    unsigned count = global_pool.thread_count;
+    if (count <= 1)
+    {
+        return;
+    }
+    pthread_mutex_lock(&global_pool.lock);
+    global_pool.stopping = true;
+    pthread_cond_broadcast(&global_pool.wake);
+    pthread_mutex_unlock(&global_pool.lock);
+    for (unsigned i = 0; i + 1 < count; ++i)
+    {
+        pthread_join(global_pool.workers[i], NULL);
+    }
+    for (unsigned i = 0; i < count; ++i)
+    {
+        assert(global_pool.deques[i].size == 0);
+        pthread_mutex_destroy(&global_pool.deques[i].lock);
+        free(global_pool.deques[i].tasks);
+    }
+    free(global_pool.workers);
+    free(global_pool.deques);
+    global_pool.workers = NULL;
+    global_pool.deques = NULL;
+    global_pool.stopping = false;
+    global_pool.thread_count = 1;
+}
+
+/**
+ * @details Implementacja procedury PoolSetThreadCount udokumentowanej w pliku
+ * thread_pool.h.
+ * @param[in] count : liczba wątków
+ */
+void PoolSetThreadCount(unsigned count)
+{
+    PoolStopBackground();
+    if (count == 0)
+    {
+        count = 1;
+    }
+    if (count == global_pool.thread_count)
+    {
+        return;
+    }
+    PoolShutdown();
+    if (count == 1)
+    {
+        return;
+    }
+    global_pool.deques = calloc(count, sizeof(TaskDeque));
+    global_pool.workers = calloc(count - 1, sizeof(pthread_t));
+    assert(global_pool.deques && global_pool.workers);
+    for (unsigned i = 0; i < count; ++i)
+    {
+        pthread_mutex_init(&global_pool.deques[i].lock, NULL);
+    }
+    global_pool.thread_count = count;
+    for (unsigned i = 0; i + 1 < count; ++i)
+    {
+        int status = pthread_create(&global_pool.workers[i], NULL,
+                                    PoolWorkerMain, (void*)(intptr_t)i);
+        assert(status == 0);
+        (void)status;
+    }
+}
+
+/**
+ * @details Implementacja procedury PoolThreadCount udokumentowanej w pliku
+ * thread_pool.h.
+ * @return liczba wątków
+ */
+unsigned PoolThreadCount()
+{
+    return global_pool.thread_count;
+}
+
+/**
+ * Tworzy zadanie i zleca je puli, a gdy pula nie ma wątków roboczych -
+ * wykonuje je natychmiast. Zadania odłączone zleca PoolSubmitBackground.
+ * @param[in] function : funkcja do wykonania
+ * @param[in] arg      : argument funkcji
+ * @param[in] detached : czy zwolnić zadanie po jego wykonaniu
+ * @return zadanie lub NULL dla zadania odłączonego
+ */
+static PoolTask* PoolSubmit(PoolFunction function, void *arg, bool detached)
+{
+    PoolTask *task = malloc(sizeof(PoolTask));
+    assert(task);
+    task->function = function;
+    task->arg = arg;
+    task->detached = detached;
+    atomic_init(&task->done, false);
+    if (detached)
+    {
+        PoolSubmitBackground(task);
+        return NULL;
+    }
+    if (global_pool.thread_count <= 1)
+    {
+        function(arg);
+        atomic_store(&task->done, true);
+        return task;
+    }
+    unsigned idx = pool_worker_idx >= 0 ? (unsigned)pool_worker_idx
+                                        : global_pool.thread_count - 1;
+    DequePushBack(&global_pool.deques[idx], task);
+    pthread_mutex_lock(&global_pool.lock);
+    atomic_fetch_add(&global_pool.pending, 1);
+    pthread_cond_signal(&global_pool.wake);
+    pthread_mutex_unlock(&global_pool.lock);
+    return task;
+}
+
+/**
+ * @details Implementacja procedury PoolSpawn udokumentowanej w pliku
+ * thread_pool.h.
+ * @param[in] function : funkcja do wykonania
+ * @param[in] arg      : argument funkcji
+ * @return zadanie
+ */
+PoolTask* PoolSpawn(PoolFunction function, void *arg)
+{
+    return PoolSubmit(function, arg, false);
+}
+
+/**
+ * @details Implementacja procedury PoolSpawnDetached udokumentowanej w pliku
+ * thread_pool.h.
+ * @param[in] function : funkcja do wykonania
+ * @param[in] arg      : argument funkcji
+ */
+void PoolSpawnDetached(PoolFunction function, void *arg)
+{
+    PoolSubmit(function, arg, true);
+}
+
+/**
+ * @details Implementacja procedury PoolTaskIsDone udokumentowanej w pliku
+ * thread_pool.h.
+ * @param[in] task : zadanie
+ * @return Czy zadanie zostało wykonane?
+ */
+bool PoolTaskIsDone(PoolTask *task)
+{
+    return atomic_load(&task->done);
+}
+
+/**
+ * @details Implementacja procedury PoolHelpUntil udokumentowanej w pliku
+ * thread_pool.h.
+ * @param[in] flag : flaga
+ */
+void PoolHelpUntil(atomic_bool *flag)
+{
+    while (!atomic_load(flag))
+    {
+        PoolTask *other = PoolFindTask();
+        if (other != NULL)
+        {
+            PoolRunTask(other);
+            continue;
+        }
+        pthread_mutex_lock(&global_pool.lock);
+        while (!atomic_load(flag) && atomic_load(&global_pool.pending) <= 0)
+        {
+            pthread_cond_wait(&global_pool.wake, &global_pool.lock);
+        }
+        pthread_mutex_unlock(&global_pool.lock);
+    }
+}
+
+/**
+ * @details Implementacja procedury PoolWait udokumentowanej w pliku
+ * thread_pool.h.
+ * @param[in] task : zadanie
+ */
+void PoolWait(PoolTask *task)
+{
+    PoolHelpUntil(&task->done);
+    free(task);
+}
+
+/**
+ * Pojedyncze wywołanie funkcji zleconej przez PoolParallelFor.
+ */
+typedef struct RangeCall
+{
+    PoolRangeFunction function; ///< funkcja do wykonania
+    void *arg; ///< wspólny argument wywołań
+    unsigned idx; ///< indeks wywołania
+} RangeCall;
+
+/**
+ * Wykonuje pojedyncze wywołanie zlecone przez PoolParallelFor.
+ * @param[in] arg : wywołanie (RangeCall)
+ */
+static void RunRangeCall(void *arg)
+{
+    RangeCall *call = arg;
+    call->function(call->arg, call->idx);
+}
+
+/**
+ * @details Implementacja procedury PoolParallelFor udokumentowanej w pliku
+ * thread_pool.h. Wywołanie o indeksie 0 wykonywane jest w bieżącym wątku.
+ * @param[in] count    : liczba wywołań
+ * @param[in] function : funkcja do wykonania
+ * @param[in] arg      : wspólny argument wywołań
+ */
+void PoolParallelFor(unsigned count, PoolRangeFunction function, void *arg)
+{
+    if (global_pool.thread_count <= 1 || count <= 1)
+    {
+        for (unsigned i = 0; i < count; ++i)
+        {
+            function(arg, i);
+        }
+        return;
+    }
+    RangeCall *calls = malloc(count * sizeof(RangeCall));
+    PoolTask **tasks = malloc(count * sizeof(PoolTask*));
+    assert(calls && tasks);
+    for (unsigned i = 1; i < count; ++i)
+    {
+        calls[i] = (RangeCall) {.function = function, .arg = arg, .idx = i};
+        tasks[i] = PoolSpawn(RunRangeCall, &calls[i]);
+    }
+    function(arg, 0);
+    for (unsigned i = 1; i < count; ++i)
+    {
+        PoolWait(tasks[i]);
+    }
+    free(calls);
+    free(tasks);
+}
@@ -0,0 +1,104 @@
+/** @file
+   Interfejs puli wątków z podkradaniem zadań
+
+   Pula składa się z wątków roboczych, z których każdy ma własną kolejkę
+   dwustronną zadań. Wątek roboczy zdejmuje zadania ze swojej kolejki
+   w kolejności LIFO, a gdy jest ona pusta - podkrada najstarsze zadania
+   z kolejek pozostałych wątków. Zadania zlecane spoza puli trafiają do
+   wspólnej kolejki. Wątek oczekujący na zakończenie zadania sam wykonuje
+   w tym czasie oczekujące zadania, dzięki czemu zadania mogą bezpiecznie
+   zlecać i oczekiwać na zadania zagnieżdżone. Zadania odłączone podejmują,
+   w kolejności zlecenia, bezczynne wątki robocze, więc kilka takich zadań
+   może być wykonywanych jednocześnie. Gdy pula nie ma wątków roboczych,
+   zadania odłączone wykonuje kolejno osobny wątek tła, uruchamiany przy
+   pierwszym takim zadaniu.
+
+   @author agent
+   @date 2026-10-19
+ */
+
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+
+/** Zadanie zlecone puli wątków. */
+typedef struct PoolTask PoolTask;
+
+/** Funkcja wykonywana jako zadanie. */
+typedef void (*PoolFunction)(void *arg);
+
+/** Funkcja wykonywana dla kolejnych indeksów przez PoolParallelFor. */
+typedef void (*PoolRangeFunction)(void *arg, unsigned idx);
+
+
+/**
+ * Ustawia łączną liczbę wątków wykonujących zadania (wraz z wątkiem
+ * wywołującym). Dla wartości 0 lub 1 pula nie ma wątków roboczych, a zadania
+ * wykonywane są natychmiast w wątku, który je zleca. Wcześniej czeka na
+ * wykonanie zleconych zadań odłączonych i kończy wątek tła.
+ * Nie może być wywołana, gdy jakiekolwiek zadanie jest w toku.
+ * @param[in] count : liczba wątków
+ */
+void PoolSetThreadCount(unsigned count);
+
+/**
+ * Zwraca łączną liczbę wątków wykonujących zadania.
+ * @return liczba wątków (co najmniej 1)
+ */
+unsigned PoolThreadCount();
+
+/**
+ * Zleca wykonanie funkcji @p function z argumentem @p arg.
+ * Każde zlecone zadanie musi zostać przekazane do PoolWait, które zwalnia
+ * jego pamięć.
+ * @param[in] function : funkcja do wykonania
+ * @param[in] arg      : argument funkcji
+ * @return zadanie
+ */
+PoolTask* PoolSpawn(PoolFunction function, void *arg);
+
+/**
+ * Zleca wykonanie funkcji @p function z argumentem @p arg jako zadania
+ * odłączonego, bez możliwości oczekiwania na nie przez PoolWait - pamięć
+ * zadania zwalniana jest zaraz po jego wykonaniu. Zadanie nigdy nie jest
+ * wykonywane w wątku zlecającym ani przez wątek oczekujący w PoolHelpUntil. O zakończeniu zadania funkcja może powiadomić, ustawiając
+ * flagę przekazaną do PoolHelpUntil.
+ * @param[in] function : funkcja do wykonania
+ * @param[in] arg      : argument funkcji
+ */
+void PoolSpawnDetached(PoolFunction function, void *arg);
+
+/**
+ * Sprawdza, czy zadanie zostało już wykonane.
+ * @param[in] task : zadanie
+ * @return Czy zadanie zostało wykonane?
+ */
+bool PoolTaskIsDone(PoolTask *task);
+
+/**
+ * Czeka na zakończenie zadania, wykonując w tym czasie inne oczekujące
+ * zadania, i zwalnia jego pamięć.
+ * @param[in] task : zadanie
+ */
+void PoolWait(PoolTask *task);
+
+/**
+ * Czeka, aż flaga @p flag zostanie ustawiona przez zadanie puli, wykonując
+ * w tym czasie inne oczekujące zadania.
+ * @param[in] flag : flaga
+ */
+void PoolHelpUntil(atomic_bool *flag);
+
+/**
+ * Wykonuje równolegle `function(arg, idx)` dla `idx = 0, …, count - 1`
+ * i czeka na zakończenie wszystkich wywołań.
+ * @param[in] count    : liczba wywołań
+ * @param[in] function : funkcja do wykonania
+ * @param[in] arg      : wspólny argument wywołań
+ */
+void PoolParallelFor(unsigned count, PoolRangeFunction function, void *arg);
+
+#endif /* __THREAD_POOL_H__ */
@@ -5,20 +5,26 @@
 #include <string.h>
 #include <limits.h>
 #include <setjmp.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/stat.h>
 #include "cmocka.h"
+#include "chunk_queue.h"
+#include "memo_cache.h"
 #include "poly.h"
 
 
 static jmp_buf jmp_at_exit;
 static int exit_status;
 
-extern int calc_poly_main();
+extern int calc_poly_main(int argc, char **argv);
 
 int mock_main()
 {
+    char *argv[] = {"calc_poly", NULL};
     if (!setjmp(jmp_at_exit))
     {
-        return calc_poly_main();
+        return calc_poly_main(1, argv);
     }
     return exit_status;
 }
@@ -37,13 +43,20 @@ static int printf_position = 0;
 
 /**
  * Atrapa funkcji fprintf sprawdzająca poprawność wypisywania na stderr.
+ * Wypisywanie do innych plików przekazywane jest do funkcji vfprintf.
  */
 int mock_fprintf(FILE*const file, const char *format, ...)
 {
     int return_value;
     va_list args;
 
-    assert_true(file == stderr);
+    if (file != stderr)
+    {
+        va_start(args, format);
+        return_value = vfprintf(file, format, args);
+        va_end(args);
+        return return_value;
+    }
     /* Poniższa asercja sprawdza też, czy fprintf_position jest nieujemne.
        W buforze musi zmieścić się kończący bajt o wartości 0. */
     assert_true((size_t)fprintf_position < sizeof(fprintf_buffer));
@@ -84,6 +97,55 @@ int mock_printf(const char *format, ...)
     return return_value;
 }
 
+/**
+ * Blokada szeregująca wywołania funkcji alokujących cmocka, które nie są
+ * bezpieczne przy wywołaniach z wielu wątków.
+ */
+static pthread_mutex_t allocation_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Atrapa funkcji calloc wywołująca _test_calloc pod blokadą.
+ */
+void* mock_calloc(size_t number_of_elements, size_t size, const char* file, int line)
+{
+    pthread_mutex_lock(&allocation_lock);
+    void *out = _test_calloc(number_of_elements, size, file, line);
+    pthread_mutex_unlock(&allocation_lock);
+    return out;
+}
+
+/**
+ * Atrapa funkcji malloc wywołująca _test_malloc pod blokadą.
+ */
+void* mock_malloc(size_t size, char* const file, int line)
+{
+    pthread_mutex_lock(&allocation_lock);
+    void *out = _test_malloc(size, file, line);
+    pthread_mutex_unlock(&allocation_lock);
+    return out;
+}
+
+/**
+ * Atrapa funkcji realloc wywołująca _test_realloc pod blokadą.
+ */
+void* mock_realloc(void* const ptr, size_t size, char* const file, int line)
+{
+    pthread_mutex_lock(&allocation_lock);
+    void *out = _test_realloc(ptr, size, file, line);
+    pthread_mutex_unlock(&allocation_lock);
+    return out;
+}
+
+/**
+ * Atrapa funkcji free wywołująca _test_free pod blokadą.
+ */
+void mock_free(void* const ptr, char* const file, const int line)
+{
+    pthread_mutex_lock(&allocation_lock);
+    _test_free(ptr, file, line);
+    pthread_mutex_unlock(&allocation_lock);
+}
+
 /**
  *  Pomocniczy bufor, z którego korzystają atrapy funkcji operujących na stdin.
  */
@@ -135,6 +197,44 @@ int mock_getchar()
     }
 }
 
+/**
+ * Atrapa funkcji fread używana do przechwycenia czytania z stdin blokami.
+ * Czytanie z innych strumieni przekazywane jest do prawdziwej funkcji fread.
+ */
+size_t mock_fread(void *ptr, size_t size, size_t count, FILE *stream)
+{
+    if (stream != stdin)
+    {
+        return fread(ptr, size, count, stream);
+    }
+    size_t available = (input_stream_end - input_stream_position) / size;
+    if (count > available)
+    {
+        count = available;
+    }
+    memcpy(ptr, input_stream_buffer + input_stream_position, count * size);
+    input_stream_position += count * size;
+    return count;
+}
+
+/**
+ * Atrapa funkcji fwrite dopisująca tekst wypisywany na standardowe wyjście
+ * do bufora atrapy funkcji printf. Zapis do innych plików nie jest zmieniany.
+ */
+size_t mock_fwrite(const void *ptr, size_t size, size_t count, FILE *stream)
+{
+    if (stream != stdout)
+    {
+        return fwrite(ptr, size, count, stream);
+    }
+    /* W buforze musi zmieścić się kończący bajt o wartości 0. */
+    assert_true(printf_position + size * count < sizeof(printf_buffer));
+    memcpy(printf_buffer + printf_position, ptr, size * count);
+    printf_position += size * count;
+    printf_buffer[printf_position] = '\0';
+    return count;
+}
+
 /**
  * Atrapa funkcji ungetc.
  * Obsługiwane jest tylko standardowe wejście.
@@ -187,6 +287,7 @@ static int pc_test_teardown(void **state)
     {
         printf("linear on linear only \n");
     }
+    PolyReleaseThreadCache();
 
     /* Zwrócenie zera oznacza sukces. */
     return 0;
@@ -334,6 +435,20 @@ static int count_test_setup(void **state)
     return 0;
 }
 
+/**
+ * Funkcja wołana po każdym teście. Zwalnia pamięć podręczną jednomianów
+ * wątku głównego, by zachowane w niej jednomiany nie były uznane za wyciek.
+ */
+static int release_cache_teardown(void **state)
+{
+    (void)state;
+
+    PolyReleaseThreadCache();
+
+    /* Zwrócenie zera oznacza sukces. */
+    return 0;
+}
+
 static void NullCountArgTest(void **state)
 {
     (void)state;
@@ -429,34 +544,1630 @@ static void RandomLettersAndNumbersCountArgTest(void **state)
     assert_string_equal(fprintf_buffer, "ERROR 1 WRONG COUNT\n");
 }
 
+static void ThreadCountComposeArgTest(void **state)
+{
+    (void)state;
+
+    init_input_stream("(1,0)+(1,1)\n(1,2)\nCOMPOSE 1 1\nPRINT");
 
-int main(void)
+    mock_main();
+    assert_string_equal(printf_buffer, "(1,0)+(2,1)+(1,2)\n");
+    assert_string_equal(fprintf_buffer, "");
+}
+
+static void WrongThreadCountComposeArgTest(void **state)
 {
-    srand(time(NULL));
-    const struct CMUnitTest poly_compose_tests[] = {
-        cmocka_unit_test_setup_teardown(ZeroPolyNullComposeTest, pc_test_setup, pc_test_teardown),
-        cmocka_unit_test_setup_teardown(ZeroPolyCoeffComposeTest, pc_test_setup, pc_test_teardown),
-        cmocka_unit_test_setup_teardown(CoeffPolyNullComposeTest, pc_test_setup, pc_test_teardown),
-        cmocka_unit_test_setup_teardown(CoeffPolyCoeffComposeTest, pc_test_setup, pc_test_teardown),
-        cmocka_unit_test_setup_teardown(LinearPolyNullComposeTest, pc_test_setup, pc_test_teardown),
-        cmocka_unit_test_setup_teardown(LinearPolyCoeffComposeTest, pc_test_setup, pc_test_teardown),
-        cmocka_unit_test_setup_teardown(LinearPolyLinearComposeTest, pc_test_setup, pc_test_teardown),
-    };
-    const struct CMUnitTest count_calc_tests[] = {
-        cmocka_unit_test_setup(NullCountArgTest, count_test_setup),
-        cmocka_unit_test_setup(ZeroCountArgTest, count_test_setup),
-        cmocka_unit_test_setup(UINT_MAXCountArgTest, count_test_setup),
-        cmocka_unit_test_setup(NegativeCountArgTest, count_test_setup),
-        cmocka_unit_test_setup(UINT_MAXPlusOneCountArgTest, count_test_setup),
-        cmocka_unit_test_setup(VeryBigCountArgTest, count_test_setup),
-        cmocka_unit_test_setup(RandomLettersCountArgTest, count_test_setup),
-        cmocka_unit_test_setup(RandomLettersAndNumbersCountArgTest, count_test_setup),
+    (void)state;
+
+    init_input_stream("(1,2)\nCOMPOSE 0 0\nCOMPOSE 0 257\nCOMPOSE 0 2x\n"
+                      "COMPOSE 0 \nCOMPOSE 0x 2\nPRINT");
+
+    mock_main();
+    assert_string_equal(printf_buffer, "(1,2)\n");
+    assert_string_equal(fprintf_buffer, "ERROR 2 WRONG THREAD COUNT\n"
+                        "ERROR 3 WRONG THREAD COUNT\n"
+                        "ERROR 4 WRONG COUNT\n"
+                        "ERROR 5 WRONG COUNT\n"
+                        "ERROR 6 WRONG COUNT\n");
+}
+
+static void NonNumericThreadCountComposeArgTest(void **state)
+{
+    (void)state;
+
+    init_input_stream("(1,2)\nCOMPOSE 1 abc\nCOMPOSE 1 \nCOMPOSE 1 -\n"
+                      "COMPOSE 1 2 3\nCOMPOSE 1 -2\nCOMPOSE 1 99999999999999999999\n"
+                      "PRINT");
+
+    mock_main();
+    assert_string_equal(printf_buffer, "(1,2)\n");
+    assert_string_equal(fprintf_buffer, "ERROR 2 WRONG COUNT\n"
+                        "ERROR 3 WRONG COUNT\n"
+                        "ERROR 4 WRONG COUNT\n"
+                        "ERROR 5 WRONG COUNT\n"
+                        "ERROR 6 WRONG THREAD COUNT\n"
+                        "ERROR 7 WRONG THREAD COUNT\n");
+}
+
+static void DegCacheAfterCancellationTest(void **state)
+{
+    (void)state;
+    Poly cf;
+    Poly inner;
+    Mono monos[2];
+
+    cf = PolyFromCoeff(1);
+    monos[0] = MonoFromPoly(&cf, 2);
+    inner = PolyAddMonos(1, monos);
+    monos[0] = MonoFromPoly(&inner, 1);
+    monos[1] = MonoFromPoly(&cf, 3);
+
+    poly_arg_1 = PolyAddMonos(2, monos);
+    assert_int_equal(PolyDeg(&poly_arg_1), 3);
+    assert_int_equal(PolyDegBy(&poly_arg_1, 0), 3);
+    assert_int_equal(PolyDegBy(&poly_arg_1, 1), 2);
+    assert_int_equal(PolyDegBy(&poly_arg_1, 7), 0);
+    assert_int_equal(poly_arg_1.depth, 2);
+    assert_int_equal(poly_arg_1.size, 3);
+
+    cf = PolyFromCoeff(-1);
+    monos[0] = MonoFromPoly(&cf, 3);
+    poly_arg_2 = PolyAddMonos(1, monos);
+    result = PolyAdd(&poly_arg_1, &poly_arg_2);
+    assert_int_equal(PolyDeg(&result), 3);
+    assert_int_equal(PolyDegBy(&result, 0), 1);
+    assert_int_equal(PolyDegBy(&result, 1), 2);
+    assert_int_equal(result.size, 2);
+
+    PolyDestroy(&result);
+    PolyDestroy(&poly_arg_1);
+    PolyDestroy(&poly_arg_2);
+}
+
+static void DegCacheZeroAndCoeffTest(void **state)
+{
+    (void)state;
+    Poly zero = PolyZero();
+    Poly coeff = PolyFromCoeff(5);
+
+    assert_int_equal(PolyDeg(&zero), -1);
+    assert_int_equal(PolyDegBy(&zero, 3), -1);
+    assert_int_equal(PolyDeg(&coeff), 0);
+    assert_int_equal(PolyDegBy(&coeff, 0), 0);
+    assert_int_equal(coeff.size, 0);
+}
+
+/**
+ * Tworzy tablicę jednomianów o współczynnikach stałych.
+ */
+static void FillMonos(Mono monos[], unsigned count, const poly_coeff_t coeffs[],
+                      const poly_exp_t exps[])
+{
+    for (unsigned i = 0; i < count; ++i)
+    {
+        Poly cf = PolyFromCoeff(coeffs[i]);
+        monos[i] = MonoFromPoly(&cf, exps[i]);
+    }
+}
+
+static void AddMonosOrderTest(void **state)
+{
+    (void)state;
+    const poly_coeff_t coeffs[] = {3, 1, 4, -1, -3, 2, 7};
+    const poly_exp_t exps[] = {5, 300, 0, 70000, 5, 300, 2};
+    const poly_coeff_t sorted_coeffs[] = {4, 7, 1, 2, 2, -3};
+    const poly_exp_t ascending_exps[] = {0, 2, 300, 300, 70000, 70000};
+    const poly_coeff_t descending_coeffs[] = {-1, 2, 1, 7, 4};
+    const poly_exp_t descending_exps[] = {70000, 300, 300, 2, 0};
+    Mono monos[7];
+
+    FillMonos(monos, 7, coeffs, exps);
+    result = PolyAddMonos(7, monos);
+    assert_int_equal(result.abs_term, 4);
+    assert_int_equal(result.size, 3);
+    assert_int_equal(PolyDeg(&result), 70000);
+
+    FillMonos(monos, 6, sorted_coeffs, ascending_exps);
+    poly_arg_1 = PolyAddMonos(6, monos);
+    assert_true(PolyIsEq(&result, &poly_arg_1));
+    PolyDestroy(&poly_arg_1);
+
+    FillMonos(monos, 5, descending_coeffs, descending_exps);
+    poly_arg_1 = PolyAddMonos(5, monos);
+    poly_arg_2 = PolySub(&poly_arg_1, &result);
+    assert_true(PolyIsZero(&poly_arg_2));
+    assert_int_equal(PolyDeg(&poly_arg_2), -1);
+
+    PolyDestroy(&poly_arg_1);
+    PolyDestroy(&poly_arg_2);
+    PolyDestroy(&result);
+}
+
+static void AddMonosCancellationTest(void **state)
+{
+    (void)state;
+    const poly_coeff_t coeffs[] = {2, -5, -2, 5, 9, -9};
+    const poly_exp_t exps[] = {1 << 20, 0, 1 << 20, 0, 17, 17};
+    Mono monos[6];
+
+    FillMonos(monos, 6, coeffs, exps);
+    result = PolyAddMonos(6, monos);
+    assert_true(PolyIsZero(&result));
+    assert_int_equal(result.size, 0);
+    PolyDestroy(&result);
+}
+
+static void HashOfEqualPolysTest(void **state)
+{
+    (void)state;
+    Poly cf;
+    Mono monos[3];
+
+    cf = PolyFromCoeff(2);
+    monos[0] = MonoFromPoly(&cf, 4);
+    cf = PolyFromCoeff(3);
+    monos[1] = MonoFromPoly(&cf, 1);
+    cf = PolyFromCoeff(7);
+    monos[2] = MonoFromPoly(&cf, 0);
+    poly_arg_1 = PolyAddMonos(3, monos);
+
+    poly_arg_2 = PolyClone(&poly_arg_1);
+    result = PolyMul(&poly_arg_1, &poly_arg_2);
+    expected = PolyMul(&poly_arg_2, &poly_arg_1);
+    assert_true(PolyHash(&result) == PolyHash(&expected));
+    assert_true(PolyIsEq(&result, &expected));
+
+    PolyDestroy(&expected);
+    expected = PolyAdd(&result, &poly_arg_1);
+    assert_true(PolyHash(&result) != PolyHash(&expected));
+    assert_false(PolyIsEq(&result, &expected));
+
+    PolyDestroy(&result);
+    PolyDestroy(&expected);
+    PolyDestroy(&poly_arg_1);
+    PolyDestroy(&poly_arg_2);
+}
+
+static void SerializeRoundTripTest(void **state)
+{
+    (void)state;
+    Poly cf;
+    Mono monos[3];
+
+    cf = PolyFromCoeff(-5);
+    monos[0] = MonoFromPoly(&cf, 0);
+    cf = PolyFromCoeff(LONG_MIN);
+    monos[1] = MonoFromPoly(&cf, 3);
+    poly_arg_1 = PolyAddMonos(2, monos);
+    cf = PolyFromCoeff(7);
+    monos[0] = MonoFromPoly(&cf, 2);
+    monos[1] = MonoFromPoly(&poly_arg_1, 0);
+    cf = PolyFromCoeff(1);
+    monos[2] = MonoFromPoly(&cf, 300);
+    poly_arg_2 = PolyAddMonos(3, monos);
+
+    size_t size;
+    unsigned char *data = PolySerialize(&poly_arg_2, &size);
+    assert_int_equal(PolyDeserialize(data, size, &result), size);
+    assert_true(PolyIsEq(&result, &poly_arg_2));
+    assert_true(PolyHash(&result) == PolyHash(&poly_arg_2));
+    for (size_t length = 0; length < size; ++length)
+    {
+        assert_int_equal(PolyDeserialize(data, length, &expected), 0);
+    }
+    data[size - 1] ^= 1; //uszkodzony zapis ostatniego współczynnika
+    assert_int_equal(PolyDeserialize(data, size, &expected), 0);
+    test_free(data);
+
+    PolyDestroy(&result);
+    PolyDestroy(&poly_arg_2);
+}
+
+static void SaveLoadCommandTest(void **state)
+{
+    (void)state;
+    const char *path = "unit_tests_poly_save.bin";
+
+    init_input_stream("((1,2)+(3,4),5)+(-7,0)\nSAVE unit_tests_poly_save.bin\n"
+                      "CLONE\nADD\nLOAD unit_tests_poly_save.bin\nPRINT\n"
+                      "SUB\nPRINT\nLOAD missing_unit_tests_poly_save.bin\n"
+                      "SAVE\nPOP\nSAVE unit_tests_poly_save.bin\n");
+    mock_main();
+    remove(path);
+    assert_string_equal(printf_buffer, "(-7,0)+((1,2)+(3,4),5)\n"
+                        "(7,0)+((-1,2)+(-3,4),5)\n");
+    assert_string_equal(fprintf_buffer, "ERROR 9 WRONG FILE\n"
+                        "ERROR 10 WRONG FILE\n"
+                        "ERROR 12 STACK UNDERFLOW\n");
+}
+
+static void ChunkQueueTest(void **state)
+{
+    (void)state;
+    ChunkQueue queue;
+    size_t size;
+    const char *chunk;
+
+    ChunkQueueInit(&queue, 2, 4);
+    ChunkQueuePush(&queue, "abcdef", 6);
+    chunk = ChunkQueueFront(&queue, &size);
+    assert_int_equal(size, 4);
+    assert_memory_equal(chunk, "abcd", 4);
+    ChunkQueueRelease(&queue);
+    memcpy(ChunkQueueReserve(&queue), "xyz", 3); //miejsce zwolnionego bloku
+    ChunkQueuePublish(&queue, 3);
+    chunk = ChunkQueueFront(&queue, &size);
+    assert_int_equal(size, 2);
+    assert_memory_equal(chunk, "ef", 2);
+    ChunkQueueRelease(&queue);
+    chunk = ChunkQueueFront(&queue, &size);
+    assert_int_equal(size, 3);
+    assert_memory_equal(chunk, "xyz", 3);
+    ChunkQueueRelease(&queue);
+    ChunkQueueReserve(&queue);
+    ChunkQueuePublish(&queue, 0);
+    ChunkQueueFront(&queue, &size);
+    assert_int_equal(size, 0);
+    ChunkQueueRelease(&queue);
+    ChunkQueueDestroy(&queue);
+}
+
+static void MemoCacheTest(void **state)
+{
+    (void)state;
+    MemoCache cache;
+    Poly a = PolyFromCoeff(3), b = PolyFromCoeff(5), c = PolyFromCoeff(15);
+    Poly d = PolyFromCoeff(8);
+    const Poly *operands[] = {&a, &b};
+    PolyRef *ref;
+
+    MemoCacheInit(&cache, 1 << 20);
+    assert_null(MemoCacheFind(&cache, 0, 0, 2, operands));
+    MemoCacheInsert(&cache, 0, 0, 2, operands, PolyRefCreate(&c));
+    MemoCacheInsert(&cache, 1, 0, 2, operands, PolyRefCreate(&d));
+    ref = MemoCacheFind(&cache, 0, 0, 2, operands);
+    assert_non_null(ref);
+    assert_int_equal(PolyRefGet(ref)->abs_term, 15);
+    PolyRefRelease(ref);
+    assert_null(MemoCacheFind(&cache, 0, 1, 2, operands));
+    assert_null(MemoCacheFind(&cache, 0, 0, 1, operands));
+    assert_int_equal(cache.hits, 1);
+    assert_int_equal(cache.misses, 3);
+
+    MemoCacheSetBudget(&cache, cache.used - 1); //usuwa najdawniej użyty wpis
+    assert_int_equal(cache.evictions, 1);
+    assert_null(MemoCacheFind(&cache, 1, 0, 2, operands));
+    ref = MemoCacheFind(&cache, 0, 0, 2, operands);
+    assert_non_null(ref);
+    PolyRefRelease(ref);
+    MemoCacheSetBudget(&cache, 1);
+    assert_int_equal(cache.entry_count, 0);
+    MemoCacheDestroy(&cache);
+}
+
+static void SharedPolyRefTest(void **state)
+{
+    (void)state;
+    Poly cf = PolyFromCoeff(2);
+    Mono mono = MonoFromPoly(&cf, 3);
+
+    poly_arg_1 = PolyAddMonos(1, &mono);
+    PolyRef *ref = PolyRefCreate(&poly_arg_1);
+    assert_true(PolyIsZero(&poly_arg_1));
+    assert_int_equal(PolyRefCount(ref), 1);
+
+    PolyRef *other = PolyRefAcquire(ref);
+    assert_ptr_equal(other, ref);
+    assert_int_equal(PolyRefCount(ref), 2);
+    PolyRefRelease(ref);
+    assert_int_equal(PolyRefCount(other), 1);
+
+    result = PolyAt(PolyRefGet(other), 2);
+    assert_int_equal(PolyDeg(PolyRefGet(other)), 3);
+    assert_true(PolyIsCoeff(&result));
+    assert_int_equal(result.abs_term, 16);
+    PolyRefRelease(other);
+    PolyRefRelease(NULL);
+    PolyDestroy(&result);
+}
+
+static void AsyncMulTest(void **state)
+{
+    (void)state;
+    Poly cf = PolyFromCoeff(3);
+    Mono monos[2] = {MonoFromPoly(&cf, 1), MonoFromPoly(&cf, 0)};
+    PolyOperation *handle;
+
+    poly_arg_1 = PolyAddMonos(2, monos);
+    poly_arg_2 = PolyClone(&poly_arg_1);
+    PolyMulAsync(&poly_arg_1, &poly_arg_2, &handle);
+    Poly expected = PolyMul(&poly_arg_1, &poly_arg_2);
+    PolyDestroy(&poly_arg_1);
+    PolyDestroy(&poly_arg_2);
+
+    while (!PolyPoll(handle))
+    {
+        sched_yield();
+    }
+    result = PolyWait(handle);
+    PolySetThreadCount(1);
+    assert_true(PolyIsEq(&result, &expected));
+    PolyDestroy(&result);
+    PolyDestroy(&expected);
+}
+
+static void AsyncComposeCancelTest(void **state)
+{
+    (void)state;
+    Poly cf = PolyFromCoeff(1);
+    Mono mono = MonoFromPoly(&cf, 2);
+    Poly x[2] = {PolyFromCoeff(3), PolyFromCoeff(5)};
+    PolyOperation *handle;
+
+    poly_arg_1 = PolyAddMonos(1, &mono);
+    PolyComposeAsync(&poly_arg_1, 2, x, &handle);
+    result = PolyWait(handle);
+    assert_true(PolyIsCoeff(&result));
+    assert_int_equal(result.abs_term, 9);
+
+    PolyComposeAsync(&poly_arg_1, 2, x, &handle);
+    PolyCancel(handle);
+    PolyMulAsync(&poly_arg_1, &result, &handle);
+    PolyCancel(handle);
+    PolyCancel(NULL);
+    PolySetThreadCount(1);
+    PolyDestroy(&poly_arg_1);
+    PolyDestroy(&result);
+}
+
+static void UnsortedAndNestedLiteralTest(void **state)
+{
+    (void)state;
+
+    init_input_stream("(3,2)+(2,1)+(1,0)+(5,2)\nPRINT\n"
+                      "((1,2)+(3,4),5)+((1,1)+(2,x),3)\n"
+                      "((1,0),1)+((2,1)+(3,0),0)\nPRINT");
+    mock_main();
+    assert_string_equal(printf_buffer, "(1,0)+(2,1)+(8,2)\n"
+                        "((3,0)+(2,1),0)+(1,1)\n");
+    assert_string_equal(fprintf_buffer, "ERROR 3 27\n");
+}
+
+static void BufferedPrintTest(void **state)
+{
+    (void)state;
+
+    init_input_stream("-9223372036854775808\nPRINT\n"
+                      "(((-1,0),0)+(7,3),0)+(9223372036854775807,12)\nPRINT\n"
+                      "DEG\n3\nPRINT\nZERO\nPRINT\n");
+    mock_main();
+    assert_string_equal(printf_buffer, "-9223372036854775808\n"
+                        "((-1,0)+(7,3),0)+(9223372036854775807,12)\n"
+                        "12\n3\n0\n");
+    assert_string_equal(fprintf_buffer, "");
+}
+
+static void CommandDispatchTest(void **state)
+{
+    (void)state;
+
+    init_input_stream("(1,2)\nAD\nADDD\nDEG 1\nDEG_BY\nD\nIS_ZER0\n"
+                      "AT 1 2\nDIV\nZERO\n(1,1)\nREM\nDEG_BY 0\n");
+    mock_main();
+    assert_string_equal(printf_buffer, "1\n");
+    assert_string_equal(fprintf_buffer, "ERROR 2 WRONG COMMAND\n"
+                        "ERROR 3 WRONG COMMAND\n"
+                        "ERROR 4 WRONG COMMAND\n"
+                        "ERROR 5 WRONG VARIABLE\n"
+                        "ERROR 6 WRONG COMMAND\n"
+                        "ERROR 7 WRONG COMMAND\n"
+                        "ERROR 8 WRONG VALUE\n"
+                        "ERROR 9 STACK UNDERFLOW\n"
+                        "ERROR 12 DIVISION BY ZERO\n");
+}
+
+static void DeeplyNestedLiteralTest(void **state)
+{
+    (void)state;
+    char input[256];
+    unsigned depth = 40, length = 0;
+
+    for (unsigned i = 0; i < depth; ++i)
+    {
+        input[length++] = '(';
+    }
+    input[length++] = '1';
+    for (unsigned i = 0; i < depth; ++i)
+    {
+        memcpy(input + length, ",1)", 3);
+        length += 3;
+    }
+    strcpy(input + length, "\nDEG\n((1,1),1)+(2,x)");
+
+    init_input_stream(input);
+    mock_main();
+    assert_string_equal(printf_buffer, "40\n");
+    assert_string_equal(fprintf_buffer, "ERROR 3 14\n");
+}
+
+static void ErrorPositionAcrossBlocksTest(void **state)
+{
+    (void)state;
+
+    init_input_stream("(1,2)\nPRINT\n  \n((1,2),3)+(2,x)\nD EG\nPRINT");
+    mock_main();
+    assert_string_equal(printf_buffer, "(1,2)\n(1,2)\n");
+    assert_string_equal(fprintf_buffer, "ERROR 3 1\n"
+                        "ERROR 4 14\n"
+                        "ERROR 5 WRONG COMMAND\n");
+}
+
+static void ZeroMonoDegTest(void **state)
+{
+    (void)state;
+
+    init_input_stream("(0,3)+(1,1)\nDEG\nPRINT");
+    mock_main();
+    assert_string_equal(printf_buffer, "1\n(1,1)\n");
+    assert_string_equal(fprintf_buffer, "");
+}
+
+static void ExactUnivariateDivRemTest(void **state)
+{
+    (void)state;
+    Poly cf;
+    Mono monos[2];
+    Poly quot, rem;
+
+    cf = PolyFromCoeff(-1);
+    monos[0] = MonoFromPoly(&cf, 0);
+    cf = PolyFromCoeff(1);
+    monos[1] = MonoFromPoly(&cf, 2);
+    poly_arg_1 = PolyAddMonos(2, monos); // x^2 - 1
+    cf = PolyFromCoeff(-1);
+    monos[0] = MonoFromPoly(&cf, 0);
+    cf = PolyFromCoeff(1);
+    monos[1] = MonoFromPoly(&cf, 1);
+    poly_arg_2 = PolyAddMonos(2, monos); // x - 1
+
+    PolyDivRem(&poly_arg_1, &poly_arg_2, &quot, &rem);
+    cf = PolyFromCoeff(1);
+    monos[0] = MonoFromPoly(&cf, 0);
+    cf = PolyFromCoeff(1);
+    monos[1] = MonoFromPoly(&cf, 1);
+    expected = PolyAddMonos(2, monos); // x + 1
+    assert_true(PolyIsEq(&quot, &expected));
+    assert_true(PolyIsZero(&rem));
+
+    PolyDestroy(&quot);
+    PolyDestroy(&rem);
+    PolyDestroy(&expected);
+    PolyDestroy(&poly_arg_1);
+    PolyDestroy(&poly_arg_2);
+}
+
+static void PseudoDivRemTest(void **state)
+{
+    (void)state;
+    Poly cf;
+    Mono monos[2];
+    Poly quot, rem;
+
+    cf = PolyFromCoeff(1);
+    monos[0] = MonoFromPoly(&cf, 0);
+    cf = PolyFromCoeff(1);
+    monos[1] = MonoFromPoly(&cf, 2);
+    poly_arg_1 = PolyAddMonos(2, monos); // x^2 + 1
+    cf = PolyFromCoeff(2);
+    monos[0] = MonoFromPoly(&cf, 1);
+    poly_arg_2 = PolyAddMonos(1, monos); // 2x
+
+    PolyDivRem(&poly_arg_1, &poly_arg_2, &quot, &rem); // 4x^2 + 4 = 2x * 2x + 4
+    cf = PolyFromCoeff(2);
+    monos[0] = MonoFromPoly(&cf, 1);
+    expected = PolyAddMonos(1, monos);
+    assert_true(PolyIsEq(&quot, &expected));
+    assert_true(PolyIsCoeff(&rem));
+    assert_int_equal(rem.abs_term, 4);
+
+    PolyDestroy(&quot);
+    PolyDestroy(&rem);
+    PolyDestroy(&expected);
+    PolyDestroy(&poly_arg_1);
+    PolyDestroy(&poly_arg_2);
+}
+
+/**
+ * Tworzy gęsty wielomian jednej zmiennej o pseudolosowych współczynnikach.
+ * @param[in] deg  : stopień
+ * @param[in] lead : współczynnik wiodący
+ * @param[in] seed : ziarno współczynników
+ * @return wielomian
+ */
+static Poly DenseTestPoly(poly_exp_t deg, poly_coeff_t lead, unsigned seed)
+{
+    Mono *monos = malloc((deg + 1) * sizeof(Mono));
+    assert_non_null(monos);
+    for (poly_exp_t e = 0; e <= deg; ++e)
+    {
+        seed = seed * 1103515245 + 12345;
+        Poly cf = PolyFromCoeff(e == deg ? lead : (long)(seed >> 16) % 19 - 9);
+        monos[e] = MonoFromPoly(&cf, e);
+    }
+    Poly out = PolyAddMonos(deg + 1, monos);
+    free(monos);
+    return out;
+}
+
+static void DenseNewtonDivRemTest(void **state)
+{
+    (void)state;
+    Poly quot, rem;
+    Poly divisor = DenseTestPoly(150, -1, 1);
+    Poly quotient = DenseTestPoly(300, 7, 2);
+    Poly remainder = DenseTestPoly(149, 3, 3);
+
+    Poly product = PolyMul(&divisor, &quotient);
+    poly_arg_1 = PolyAdd(&product, &remainder);
+    PolyDivRem(&poly_arg_1, &divisor, &quot, &rem);
+    assert_true(PolyIsEq(&quot, &quotient));
+    assert_true(PolyIsEq(&rem, &remainder));
+
+    PolyDestroy(&quot);
+    PolyDestroy(&rem);
+    PolyDestroy(&product);
+    PolyDestroy(&poly_arg_1);
+    PolyDestroy(&remainder);
+    PolyDestroy(&quotient);
+    PolyDestroy(&divisor);
+}
+
+/**
+ * Tworzy wielomian @p depth zmiennych, w którym każdy niestały wielomian ma
+ * jednomiany o wykładnikach od 0 do @p width - 1 z pseudolosowymi
+ * współczynnikami.
+ * @param[in] depth : liczba zmiennych
+ * @param[in] width : liczba jednomianów na każdym poziomie
+ * @param[in, out] seed : stan generatora
+ * @return wielomian
+ */
+static Poly NestedTestPoly(unsigned depth, unsigned width, unsigned *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    if (depth == 0)
+    {
+        return PolyFromCoeff((long)(*seed >> 16) % 19 - 9);
+    }
+    Mono *monos = malloc(width * sizeof(Mono));
+    assert_non_null(monos);
+    for (unsigned i = 0; i < width; ++i)
+    {
+        Poly cf = NestedTestPoly(depth - 1, width, seed);
+        monos[i] = MonoFromPoly(&cf, i);
+    }
+    Poly out = PolyAddMonos(width, monos);
+    free(monos);
+    return out;
+}
+
+static void ParallelMulTest(void **state)
+{
+    (void)state;
+    unsigned seed = 1;
+    poly_arg_1 = NestedTestPoly(3, 8, &seed);
+    poly_arg_2 = NestedTestPoly(3, 8, &seed);
+
+    expected = PolyMul(&poly_arg_1, &poly_arg_2);
+    PolySetThreadCount(4);
+    result = PolyMul(&poly_arg_1, &poly_arg_2);
+    PolySetThreadCount(1);
+    assert_true(PolyIsEq(&result, &expected));
+
+    PolyDestroy(&result);
+    PolyDestroy(&expected);
+    PolyDestroy(&poly_arg_1);
+    PolyDestroy(&poly_arg_2);
+}
+
+static void ParallelAddTest(void **state)
+{
+    (void)state;
+    unsigned seed = 2;
+    poly_arg_1 = NestedTestPoly(3, 12, &seed);
+    poly_arg_2 = NestedTestPoly(3, 12, &seed);
+
+    expected = PolyAdd(&poly_arg_1, &poly_arg_2);
+    PolySetThreadCount(4);
+    result = PolyAdd(&poly_arg_1, &poly_arg_2);
+    PolySetThreadCount(1);
+    assert_true(PolyIsEq(&result, &expected));
+
+    PolyDestroy(&result);
+    PolyDestroy(&expected);
+    PolyDestroy(&poly_arg_1);
+    PolyDestroy(&poly_arg_2);
+}
+
+static void ParallelComposeTest(void **state)
+{
+    (void)state;
+    unsigned seed = 3;
+    Poly x[2];
+    poly_arg_1 = NestedTestPoly(2, 8, &seed);
+    x[0] = NestedTestPoly(2, 4, &seed);
+    x[1] = NestedTestPoly(1, 4, &seed);
+
+    expected = PolyCompose(&poly_arg_1, 2, x);
+    PolySetThreadCount(4);
+    result = PolyCompose(&poly_arg_1, 2, x);
+    PolySetThreadCount(1);
+    assert_true(PolyIsEq(&result, &expected));
+
+    PolyDestroy(&result);
+    PolyDestroy(&expected);
+    PolyDestroy(&poly_arg_1);
+    PolyDestroy(&x[0]);
+    PolyDestroy(&x[1]);
+}
+
+/**
+ * Tworzy wielomian @p depth zmiennych, w którym każdy niestały wielomian ma
+ * @p width jednomianów o pseudolosowych, rosnących wykładnikach
+ * i współczynnikach.
+ * @param[in] depth : liczba zmiennych
+ * @param[in] width : liczba jednomianów na każdym poziomie
+ * @param[in, out] seed : stan generatora
+ * @return wielomian
+ */
+static Poly SparseTestPoly(unsigned depth, unsigned width, unsigned *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    if (depth == 0)
+    {
+        return PolyFromCoeff((long)(*seed >> 16) % 19 - 9);
+    }
+    Mono *monos = malloc(width * sizeof(Mono));
+    assert_non_null(monos);
+    poly_exp_t exp = 0;
+    for (unsigned i = 0; i < width; ++i)
+    {
+        Poly cf = SparseTestPoly(depth - 1, width, seed);
+        exp += (poly_exp_t)(*seed >> 16) % 3;
+        monos[i] = MonoFromPoly(&cf, exp++);
+    }
+    Poly out = PolyAddMonos(width, monos);
+    free(monos);
+    return out;
+}
+
+static void ParallelSparseComposeTest(void **state)
+{
+    (void)state;
+    unsigned seed = 5;
+    Poly x[4];
+    poly_arg_1 = SparseTestPoly(3, 8, &seed);
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        x[i] = NestedTestPoly(1, 3, &seed);
+    }
+
+    for (unsigned count = 1; count <= 4; ++count)
+    {
+        expected = PolyCompose(&poly_arg_1, count, x);
+        PolySetThreadCount(4);
+        result = PolyCompose(&poly_arg_1, count, x);
+        PolySetThreadCount(1);
+        assert_true(PolyIsEq(&result, &expected));
+        PolyDestroy(&result);
+        PolyDestroy(&expected);
+    }
+
+    PolyDestroy(&poly_arg_1);
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        PolyDestroy(&x[i]);
+    }
+}
+
+static void ParallelAddMonosTest(void **state)
+{
+    (void)state;
+    const unsigned count = 1 << 15;
+    unsigned seed = 4;
+    Mono *serial = malloc(count * sizeof(Mono));
+    Mono *parallel = malloc(count * sizeof(Mono));
+    assert_non_null(serial);
+    assert_non_null(parallel);
+    for (unsigned i = 0; i < count; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        Poly cf = NestedTestPoly(1, 2, &seed);
+        serial[i] = MonoFromPoly(&cf, (poly_exp_t)(seed >> 8) % (count / 4));
+        parallel[i] = MonoClone(&serial[i]);
+    }
+
+    expected = PolyAddMonos(count, serial);
+    PolySetThreadCount(4);
+    result = PolyAddMonos(count, parallel);
+    PolySetThreadCount(1);
+    assert_true(PolyIsEq(&result, &expected));
+
+    free(serial);
+    free(parallel);
+    PolyDestroy(&result);
+    PolyDestroy(&expected);
+}
+
+/** Liczba wątków w MonoCacheThreadsTest. */
+#define CACHE_TEST_THREADS 4
+
+/** Liczba wielomianów tworzonych przez wątek w MonoCacheThreadsTest. */
+#define CACHE_TEST_POLYS 64
+
+/**
+ * Wielomiany tworzone przez wątki MonoCacheThreadsTest w fazach parzystych
+ * i nieparzystych. Każdy wątek niszczy wielomiany utworzone przez sąsiedni
+ * wątek w poprzedniej fazie, więc jednomiany trafiają do pamięci podręcznej
+ * innego wątku, niż je przydzielił.
+ */
+static Poly cache_test_polys[2][CACHE_TEST_THREADS][CACHE_TEST_POLYS];
+
+/**
+ * Faza MonoCacheThreadsTest: niszczy wielomiany sąsiedniego wątku (jeżeli
+ * istnieją) i tworzy nowe, sprawdzając je z wielomianem wzorcowym.
+ * @param[in] arg : numer fazy pomnożony przez liczbę wątków plus numer wątku
+ * @return NULL
+ */
+static void* MonoCacheThreadPhase(void *arg)
+{
+    unsigned phase = (unsigned)(uintptr_t)arg / CACHE_TEST_THREADS;
+    unsigned idx = (unsigned)(uintptr_t)arg % CACHE_TEST_THREADS;
+    unsigned seed = 1;
+    Poly pattern = NestedTestPoly(2, 8, &seed);
+    for (unsigned i = 0; i < CACHE_TEST_POLYS; ++i)
+    {
+        Poly *victim =
+            &cache_test_polys[(phase + 1) % 2][(idx + 1) % CACHE_TEST_THREADS][i];
+        PolyDestroy(victim);
+        seed = 1;
+        Poly fresh = NestedTestPoly(2, 8, &seed);
+        Poly product = PolyMul(&fresh, &pattern);
+        if (!PolyIsEq(&fresh, &pattern))
+        {
+            PolyDestroy(&product);
+            product = PolyZero();
+        }
+        PolyDestroy(&fresh);
+        cache_test_polys[phase % 2][idx][i] = product;
+    }
+    PolyDestroy(&pattern);
+    return NULL;
+}
+
+static void MonoCacheThreadsTest(void **state)
+{
+    (void)state;
+    pthread_t threads[CACHE_TEST_THREADS];
+    unsigned seed = 1;
+    Poly pattern = NestedTestPoly(2, 8, &seed);
+    expected = PolyMul(&pattern, &pattern);
+    PolyDestroy(&pattern);
+    for (unsigned t = 0; t < CACHE_TEST_THREADS; ++t)
+    {
+        for (unsigned i = 0; i < CACHE_TEST_POLYS; ++i)
+        {
+            cache_test_polys[1][t][i] = PolyZero();
+        }
+    }
+
+    for (unsigned phase = 0; phase < 3; ++phase)
+    {
+        for (unsigned t = 0; t < CACHE_TEST_THREADS; ++t)
+        {
+            assert_int_equal(pthread_create(&threads[t], NULL,
+                                             MonoCacheThreadPhase,
+                                             (void*)(uintptr_t)
+                                             (phase * CACHE_TEST_THREADS + t)),
+                             0);
+        }
+        for (unsigned t = 0; t < CACHE_TEST_THREADS; ++t)
+        {
+            assert_int_equal(pthread_join(threads[t], NULL), 0);
+        }
+    }
+    for (unsigned t = 0; t < CACHE_TEST_THREADS; ++t)
+    {
+        for (unsigned i = 0; i < CACHE_TEST_POLYS; ++i)
+        {
+            assert_true(PolyIsEq(&cache_test_polys[0][t][i], &expected));
+            PolyDestroy(&cache_test_polys[0][t][i]);
+        }
+    }
+    PolyDestroy(&expected);
+}
+
+static void AsyncThreadsPollCancelTest(void **state)
+{
+    (void)state;
+    unsigned seed = 5;
+    Poly x[2];
+    PolyOperation *cancelled, *mul, *compose;
+    poly_arg_1 = NestedTestPoly(3, 8, &seed);
+    poly_arg_2 = NestedTestPoly(3, 8, &seed);
+    x[0] = NestedTestPoly(2, 4, &seed);
+    x[1] = NestedTestPoly(1, 4, &seed);
+    expected = PolyMul(&poly_arg_1, &poly_arg_2);
+    Poly composed = PolyCompose(&poly_arg_1, 2, x);
+
+    PolySetThreadCount(4);
+    PolyMulAsync(&poly_arg_1, &poly_arg_2, &cancelled);
+    PolyMulAsync(&poly_arg_1, &poly_arg_2, &mul);
+    PolyComposeAsync(&poly_arg_1, 2, x, &compose);
+    PolyCancel(cancelled);
+    PolyDestroy(&poly_arg_1);
+    PolyDestroy(&poly_arg_2);
+    PolyDestroy(&x[0]);
+    PolyDestroy(&x[1]);
+
+    while (!PolyPoll(mul))
+    {
+        sched_yield();
+    }
+    result = PolyWait(mul);
+    assert_true(PolyIsEq(&result, &expected));
+    PolyDestroy(&result);
+    result = PolyWait(compose);
+    PolySetThreadCount(1);
+    assert_true(PolyIsEq(&result, &composed));
+
+    PolyDestroy(&result);
+    PolyDestroy(&composed);
+    PolyDestroy(&expected);
+}
+
+static void MultivariateDivExactTest(void **state)
+{
+    (void)state;
+    Poly cf, inner;
+    Mono monos[2];
+
+    cf = PolyFromCoeff(3);
+    monos[0] = MonoFromPoly(&cf, 2);
+    inner = PolyAddMonos(1, monos); // 3y^2
+    monos[0] = MonoFromPoly(&inner, 1);
+    cf = PolyFromCoeff(-5);
+    monos[1] = MonoFromPoly(&cf, 0);
+    poly_arg_1 = PolyAddMonos(2, monos); // 3y^2 x - 5
+    cf = PolyFromCoeff(1);
+    monos[0] = MonoFromPoly(&cf, 1);
+    cf = PolyFromCoeff(1);
+    monos[1] = MonoFromPoly(&cf, 3);
+    inner = PolyAddMonos(2, monos); // y + y^3
+    monos[0] = MonoFromPoly(&inner, 4);
+    cf = PolyFromCoeff(2);
+    monos[1] = MonoFromPoly(&cf, 0);
+    poly_arg_2 = PolyAddMonos(2, monos); // (y + y^3) x^4 + 2
+
+    expected = PolyMul(&poly_arg_1, &poly_arg_2);
+    result = PolyDivExact(&expected, &poly_arg_2);
+    assert_true(PolyIsEq(&result, &poly_arg_1));
+
+    PolyDestroy(&result);
+    PolyDestroy(&expected);
+    PolyDestroy(&poly_arg_1);
+    PolyDestroy(&poly_arg_2);
+}
+
+static void MulConstantTermOverflowTest(void **state)
+{
+    (void)state;
+    const poly_coeff_t half = (poly_coeff_t)1 << 31;
+    Poly cf;
+    Mono monos[3];
+
+    poly_arg_1 = PolyFromCoeff(half);
+    result = PolyMul(&poly_arg_1, &poly_arg_1);
+    expected = PolyFromCoeff(half * half);
+    assert_true(PolyIsEq(&result, &expected));
+    PolyDestroy(&poly_arg_1);
+    PolyDestroy(&result);
+    PolyDestroy(&expected);
+
+    cf = PolyFromCoeff(half);
+    monos[0] = MonoFromPoly(&cf, 0);
+    cf = PolyFromCoeff(1);
+    monos[1] = MonoFromPoly(&cf, 1);
+    poly_arg_1 = PolyAddMonos(2, monos); // 2^31 + x
+    result = PolyMul(&poly_arg_1, &poly_arg_1);
+    cf = PolyFromCoeff(half * half);
+    monos[0] = MonoFromPoly(&cf, 0);
+    cf = PolyFromCoeff(2 * half);
+    monos[1] = MonoFromPoly(&cf, 1);
+    cf = PolyFromCoeff(1);
+    monos[2] = MonoFromPoly(&cf, 2);
+    expected = PolyAddMonos(3, monos); // 2^62 + 2^32 x + x^2
+    assert_true(PolyIsEq(&result, &expected));
+    PolyDestroy(&poly_arg_1);
+    PolyDestroy(&result);
+    PolyDestroy(&expected);
+}
+
+static void PowMatchesRepeatedMulTest(void **state)
+{
+    (void)state;
+    Poly cf, inner;
+    Mono monos[4];
+    Poly bases[4];
+
+    cf = PolyFromCoeff(1);
+    monos[0] = MonoFromPoly(&cf, 0);
+    cf = PolyFromCoeff(-2);
+    monos[1] = MonoFromPoly(&cf, 3);
+    bases[0] = PolyAddMonos(2, monos); // 1 - 2x^3
+    cf = PolyFromCoeff(1);
+    monos[0] = MonoFromPoly(&cf, 1);
+    cf = PolyFromCoeff(2);
+    monos[1] = MonoFromPoly(&cf, 2);
+    cf = PolyFromCoeff(-1);
+    monos[2] = MonoFromPoly(&cf, 3);
+    cf = PolyFromCoeff(3);
+    monos[3] = MonoFromPoly(&cf, 4);
+    bases[1] = PolyAddMonos(4, monos); // x + 2x^2 - x^3 + 3x^4
+    cf = PolyFromCoeff(1);
+    monos[0] = MonoFromPoly(&cf, 0);
+    cf = PolyFromCoeff(1);
+    monos[1] = MonoFromPoly(&cf, 1);
+    inner = PolyAddMonos(2, monos); // 1 + y
+    monos[0] = MonoFromPoly(&inner, 2);
+    cf = PolyFromCoeff(-1);
+    monos[1] = MonoFromPoly(&cf, 1);
+    cf = PolyFromCoeff(2);
+    monos[2] = MonoFromPoly(&cf, 0);
+    bases[2] = PolyAddMonos(3, monos); // (1 + y) x^2 - x + 2
+    cf = PolyFromCoeff(3);
+    monos[0] = MonoFromPoly(&cf, 1);
+    inner = PolyAddMonos(1, monos); // 3y
+    monos[0] = MonoFromPoly(&inner, 2);
+    bases[3] = PolyAddMonos(1, monos); // 3y x^2
+
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        expected = PolyFromCoeff(1);
+        for (poly_exp_t exp = 0; exp <= 7; ++exp)
+        {
+            result = PolyPow(&bases[i], exp);
+            assert_true(PolyIsEq(&result, &expected));
+            PolyDestroy(&result);
+            result = PolyMul(&expected, &bases[i]);
+            PolyDestroy(&expected);
+            expected = result;
+        }
+        PolyDestroy(&expected);
+        PolyDestroy(&bases[i]);
+    }
+}
+
+static void PowCommandTest(void **state)
+{
+    (void)state;
+
+    init_input_stream("(1,0)+(1,1)\nPOW 3\nPRINT\nPOW 0\nPRINT\nPOW -1\n"
+                      "POW 2147483648\nPOW\nPOP\nPOW 2");
+    mock_main();
+    assert_string_equal(printf_buffer, "(1,0)+(3,1)+(3,2)+(1,3)\n1\n");
+    assert_string_equal(fprintf_buffer,
+                        "ERROR 6 WRONG EXPONENT\n"
+                        "ERROR 7 WRONG EXPONENT\n"
+                        "ERROR 8 WRONG EXPONENT\n"
+                        "ERROR 10 STACK UNDERFLOW\n");
+}
+
+static void PowDegreeOverflowTest(void **state)
+{
+    (void)state;
+
+    init_input_stream("(1,5)\nPOW 2147483647\nPOW 429496730\nPOW 429496729\n"
+                      "PRINT\n0\nPOW 2147483647\nPRINT\n((1,2),2)\n"
+                      "POW 1073741824\nPOW 1073741823\nPRINT");
+    mock_main();
+    assert_string_equal(printf_buffer, "(1,2147483645)\n0\n"
+                                       "((1,2147483646),2147483646)\n");
+    assert_string_equal(fprintf_buffer,
+                        "ERROR 2 WRONG EXPONENT\n"
+                        "ERROR 3 WRONG EXPONENT\n"
+                        "ERROR 10 WRONG EXPONENT\n");
+}
+
+static void DivisionByZeroTest(void **state)
+{
+    (void)state;
+
+    init_input_stream("0\n(1,1)\nDIV\nREM\nPOP\nDIV");
+    mock_main();
+    assert_string_equal(printf_buffer, "");
+    assert_string_equal(fprintf_buffer,
+                        "ERROR 3 DIVISION BY ZERO\n"
+                        "ERROR 4 DIVISION BY ZERO\n"
+                        "ERROR 6 STACK UNDERFLOW\n");
+}
+
+static void DivRemCommandTest(void **state)
+{
+    (void)state;
+
+    init_input_stream("(1,0)+(2,1)\n(-1,0)+(4,2)\nDIV\nPRINT\nPOP\n"
+                      "(1,0)+(1,1)\n(1,0)+(1,2)\nREM\nPRINT");
+    mock_main();
+    assert_string_equal(printf_buffer, "(-4,0)+(8,1)\n2\n");
+    assert_string_equal(fprintf_buffer, "");
+}
+
+static void UnivariateGcdTest(void **state)
+{
+    (void)state;
+    Poly cf;
+    Mono monos[3];
+
+    cf = PolyFromCoeff(-1);
+    monos[0] = MonoFromPoly(&cf, 0);
+    cf = PolyFromCoeff(1);
+    monos[1] = MonoFromPoly(&cf, 2);
+    poly_arg_1 = PolyAddMonos(2, monos); // x^2 - 1
+    cf = PolyFromCoeff(-1);
+    monos[0] = MonoFromPoly(&cf, 0);
+    cf = PolyFromCoeff(-2);
+    monos[1] = MonoFromPoly(&cf, 1);
+    cf = PolyFromCoeff(-1);
+    monos[2] = MonoFromPoly(&cf, 2);
+    poly_arg_2 = PolyAddMonos(3, monos); // -x^2 - 2x - 1
+
+    result = PolyGcd(&poly_arg_1, &poly_arg_2);
+    cf = PolyFromCoeff(1);
+    monos[0] = MonoFromPoly(&cf, 0);
+    cf = PolyFromCoeff(1);
+    monos[1] = MonoFromPoly(&cf, 1);
+    expected = PolyAddMonos(2, monos); // x + 1
+    assert_true(PolyIsEq(&result, &expected));
+
+    PolyDestroy(&result);
+    PolyDestroy(&expected);
+    PolyDestroy(&poly_arg_1);
+    PolyDestroy(&poly_arg_2);
+}
+
+static void ZeroAndCoeffGcdTest(void **state)
+{
+    (void)state;
+    Poly cf;
+    Mono monos[2];
+
+    poly_arg_1 = PolyZero();
+    poly_arg_2 = PolyZero();
+    result = PolyGcd(&poly_arg_1, &poly_arg_2);
+    assert_true(PolyIsZero(&result));
+    PolyDestroy(&result);
+
+    cf = PolyFromCoeff(8);
+    monos[0] = MonoFromPoly(&cf, 0);
+    cf = PolyFromCoeff(-4);
+    monos[1] = MonoFromPoly(&cf, 1);
+    poly_arg_2 = PolyAddMonos(2, monos); // -4x + 8
+    result = PolyGcd(&poly_arg_1, &poly_arg_2);
+    expected = PolyNeg(&poly_arg_2);
+    assert_true(PolyIsEq(&result, &expected));
+    PolyDestroy(&result);
+    PolyDestroy(&expected);
+
+    poly_arg_1 = PolyFromCoeff(-6);
+    result = PolyGcd(&poly_arg_1, &poly_arg_2);
+    assert_true(PolyIsCoeff(&result));
+    assert_int_equal(result.abs_term, 2);
+
+    PolyDestroy(&result);
+    PolyDestroy(&poly_arg_2);
+}
+
+static void PlantedFactorGcdCommandTest(void **state)
+{
+    (void)state;
+
+    init_input_stream("((1,1),1)+(1,0)\n(2,0)+(1,1)\nMUL\n6\nMUL\n"
+                      "((1,1),1)+(1,0)\n(1,1)+((-1,1),0)\nMUL\n4\nMUL\n"
+                      "GCD\nPRINT\nGCD");
+    mock_main();
+    assert_string_equal(printf_buffer, "(2,0)+((2,1),1)\n");
+    assert_string_equal(fprintf_buffer, "ERROR 13 STACK UNDERFLOW\n");
+}
+
+static void LargeCoeffGcdCommandTest(void **state)
+{
+    (void)state;
+
+    init_input_stream("(2305843009213693951,1)+(1,2)\n"
+                      "(2305843009213693951,0)+(2305843009213693952,1)+(1,2)\n"
+                      "GCD\nPRINT\nPOP\n"
+                      "(-9223372036854775807,1)+(1,2)\n"
+                      "(-9223372036854775807,0)+(-9223372036854775806,1)+(1,2)\n"
+                      "GCD\nPRINT");
+    mock_main();
+    assert_string_equal(printf_buffer, "(2305843009213693951,0)+(1,1)\n"
+                        "(-9223372036854775807,0)+(1,1)\n");
+    assert_string_equal(fprintf_buffer, "");
+}
+
+static void InvalidThreadCountArgTest(void **state)
+{
+    (void)state;
+
+    char *argv[] = {"calc_poly", "--threads", "0", NULL};
+    init_input_stream("(1,1)\nPRINT");
+    assert_int_equal(calc_poly_main(3, argv), 1);
+    assert_string_equal(printf_buffer, "");
+    assert_string_equal(fprintf_buffer, "Usage: calc_poly [--threads N] "
+                        "[--lazy] [--memo MB] [--input FILE] "
+                        "[--pipeline | --compile FILE | --run FILE | "
+                        "--chain DIR | "
+                        "--batch DIR|LIST [-j N]]\n");
+}
+
+static void MissingThreadCountArgTest(void **state)
+{
+    (void)state;
+
+    char *argv[] = {"calc_poly", "--threads", NULL};
+    init_input_stream("(1,1)\nPRINT");
+    assert_int_equal(calc_poly_main(2, argv), 1);
+    assert_string_equal(printf_buffer, "");
+    assert_string_equal(fprintf_buffer, "Usage: calc_poly [--threads N] "
+                        "[--lazy] [--memo MB] [--input FILE] "
+                        "[--pipeline | --compile FILE | --run FILE | "
+                        "--chain DIR | "
+                        "--batch DIR|LIST [-j N]]\n");
+}
+
+static void MissingInputFileArgTest(void **state)
+{
+    (void)state;
+
+    char *argv[] = {"calc_poly", "--input", "no_such_file.txt", NULL};
+    init_input_stream("(1,1)\nPRINT");
+    assert_int_equal(calc_poly_main(3, argv), 1);
+    assert_string_equal(printf_buffer, "");
+    assert_string_equal(fprintf_buffer, "Cannot read no_such_file.txt\n");
+}
+
+static void InputFileArgTest(void **state)
+{
+    (void)state;
+    const char *path = "unit_tests_poly_input.txt";
+
+    FILE *file = fopen(path, "w");
+    assert_non_null(file);
+    fputs("(1,2)+(3,4)\nDEG\n(1,x)\nPRINT", file);
+    fclose(file);
+
+    char *argv[] = {"calc_poly", "--input", (char*)path, NULL};
+    init_input_stream("ZERO\nPRINT");
+    assert_int_equal(calc_poly_main(3, argv), 0);
+    remove(path);
+    assert_string_equal(printf_buffer, "4\n(1,2)+(3,4)\n");
+    assert_string_equal(fprintf_buffer, "ERROR 3 4\n");
+}
+
+static void CompileAndRunArgTest(void **state)
+{
+    (void)state;
+    const char *path = "unit_tests_poly_bytecode.bin";
+
+    char *compile_argv[] = {"calc_poly", "--compile", (char*)path, NULL};
+    init_input_stream("((1,2)+(-3,0),1)+(5,0)\nCLONE\nMUL\nPRINT\n"
+                      "AT -2\nPRINT\nDEG_BY 1\n(1,x)\nADD\nADD\n"
+                      "COMPOSE 0 2\nFOO\nDEG");
+    assert_int_equal(calc_poly_main(3, compile_argv), 0);
+    assert_string_equal(printf_buffer, "");
+    assert_string_equal(fprintf_buffer, "");
+
+    char *run_argv[] = {"calc_poly", "--run", (char*)path, NULL};
+    init_input_stream("ZERO\nPRINT");
+    assert_int_equal(calc_poly_main(3, run_argv), 0);
+    assert_string_equal(printf_buffer, "(25,0)+((-30,0)+(10,2),1)+"
+                        "((9,0)+(-6,2)+(1,4),2)\n"
+                        "(121,0)+(-44,2)+(4,4)\n0\n0\n");
+    assert_string_equal(fprintf_buffer, "ERROR 8 4\nERROR 9 STACK UNDERFLOW\n"
+                        "ERROR 10 STACK UNDERFLOW\nERROR 12 WRONG COMMAND\n");
+
+    FILE *file = fopen(path, "r+b");
+    assert_non_null(file);
+    fseek(file, -1, SEEK_END);
+    fputc(0xff, file);
+    fclose(file);
+    count_test_setup(NULL);
+    assert_int_equal(calc_poly_main(3, run_argv), 1);
+    remove(path);
+    assert_string_equal(fprintf_buffer, "ERROR 8 4\nERROR 9 STACK UNDERFLOW\n"
+                        "ERROR 10 STACK UNDERFLOW\nERROR 12 WRONG COMMAND\n"
+                        "Invalid bytecode unit_tests_poly_bytecode.bin\n");
+}
+
+static void CorruptBytecodeArgTest(void **state)
+{
+    (void)state;
+    const char *path = "unit_tests_poly_bytecode.bin";
+    const struct
+    {
+        const char *script; ///< skompilowany program
+        size_t drop;        ///< liczba usuwanych bajtów z końca kodu
+        size_t size;        ///< liczba dopisywanych bajtów
+        unsigned char bytes[8]; ///< bajty argumentu spoza zakresu
+    } cases[] = {
+        {"(1,1)\nPOW 2", 1, 1, {0x01}},                         // -1
+        {"(1,1)\nPOW 2", 1, 5, {0x80, 0x80, 0x80, 0x80, 0x10}}, // 2^31
+        {"(1,1)\nDEG_BY 0", 1, 1, {0x01}},                      // -1
+        {"(1,1)\nCOMPOSE 0", 2, 2, {0x01, 0x00}},               // -1
+        {"(1,1)\nCOMPOSE 0 2", 1, 3, {0x80, 0x89, 0x7a}},       // 1000000
+    };
+
+    char *compile_argv[] = {"calc_poly", "--compile", (char*)path, NULL};
+    char *run_argv[] = {"calc_poly", "--run", (char*)path, NULL};
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        count_test_setup(NULL);
+        init_input_stream(cases[i].script);
+        assert_int_equal(calc_poly_main(3, compile_argv), 0);
+
+        unsigned char code[64];
+        FILE *file = fopen(path, "rb");
+        assert_non_null(file);
+        size_t size = fread(code, 1, sizeof(code), file);
+        fclose(file);
+        assert_true(cases[i].drop <= size);
+        size -= cases[i].drop;
+        memcpy(code + size, cases[i].bytes, cases[i].size);
+        size += cases[i].size;
+        file = fopen(path, "wb");
+        assert_non_null(file);
+        assert_int_equal(fwrite(code, 1, size, file), size);
+        fclose(file);
+
+        count_test_setup(NULL);
+        init_input_stream("");
+        assert_int_equal(calc_poly_main(3, run_argv), 1);
+        assert_string_equal(printf_buffer, "");
+        assert_string_equal(fprintf_buffer,
+                            "Invalid bytecode unit_tests_poly_bytecode.bin\n");
+    }
+    remove(path);
+}
+
+/**
+ * Zapisuje tekst do pliku o ścieżce @p path.
+ * @param[in] path : ścieżka pliku
+ * @param[in] text : tekst
+ */
+static void write_file(const char *path, const char *text)
+{
+    FILE *file = fopen(path, "w");
+    assert_non_null(file);
+    fputs(text, file);
+    fclose(file);
+}
+
+static void ChainArgTest(void **state)
+{
+    (void)state;
+    const char *directory = "unit_tests_poly_chain";
+
+    mkdir(directory, 0700);
+    write_file("unit_tests_poly_chain/a", "START\n(1,2)\n(2,3)\nPRINT\nADD\n"
+               "PRINT\nDEG\nFILE b\n");
+    write_file("unit_tests_poly_chain/b", "IS_EQ\nPRINT\nPOP\nx(\nMUL\n"
+               "PRINT\nCLONE\nPRINT\nFILE c");
+    write_file("unit_tests_poly_chain/c", "ADD\nPRINT\nDEG_BY 1\nSTOP\n");
+
+    char *argv[] = {"calc_poly", "--chain", (char*)directory, NULL};
+    init_input_stream("ZERO\nPRINT");
+    assert_int_equal(calc_poly_main(3, argv), 0);
+    remove("unit_tests_poly_chain/a");
+    remove("unit_tests_poly_chain/b");
+    remove("unit_tests_poly_chain/c");
+    remove(directory);
+    assert_string_equal(printf_buffer, "(4,5)+(8,6)\n0\n");
+    assert_string_equal(fprintf_buffer, "ERROR 7 WRONG COMMAND\n");
+}
+
+/**
+ * Sprawdza, czy plik o ścieżce @p path zawiera dokładnie tekst @p text.
+ * @param[in] path : ścieżka pliku
+ * @param[in] text : oczekiwany tekst
+ */
+static void assert_file_equal(const char *path, const char *text)
+{
+    char content[256];
+    FILE *file = fopen(path, "r");
+    assert_non_null(file);
+    size_t length = fread(content, 1, sizeof(content) - 1, file);
+    fclose(file);
+    content[length] = '\0';
+    assert_string_equal(content, text);
+}
+
+static void BatchArgTest(void **state)
+{
+    (void)state;
+    const char *directory = "unit_tests_poly_batch";
+
+    mkdir(directory, 0700);
+    write_file("unit_tests_poly_batch/a", "(1,2)\nCLONE\nMUL\nPRINT\nPOP\nPOP");
+    write_file("unit_tests_poly_batch/b", "(1,1)\nDEG\n(1,\nIS_ZERO\n");
+    write_file("unit_tests_poly_batch/list", "unit_tests_poly_batch/b\n"
+               "unit_tests_poly_batch/a\n\n");
+
+    char *argv[] = {"calc_poly", "--batch", (char*)directory, "-j", "1",
+                    NULL};
+    init_input_stream("ZERO\nPRINT");
+    assert_int_equal(calc_poly_main(5, argv), 0);
+    assert_string_equal(printf_buffer, "");
+    assert_string_equal(fprintf_buffer, "");
+    assert_file_equal("unit_tests_poly_batch/a.out", "(1,4)\n");
+    assert_file_equal("unit_tests_poly_batch/a.err",
+                      "ERROR 6 STACK UNDERFLOW\n");
+    assert_file_equal("unit_tests_poly_batch/b.out", "1\n0\n");
+    assert_file_equal("unit_tests_poly_batch/b.err", "ERROR 3 4\n");
+    //lista skryptów nie jest skryptem, więc powstały też jej wyniki
+    assert_file_equal("unit_tests_poly_batch/list.out", "");
+    assert_file_equal("unit_tests_poly_batch/list.err",
+                      "ERROR 1 WRONG COMMAND\nERROR 2 WRONG COMMAND\n");
+
+    argv[2] = "unit_tests_poly_batch/list";
+    argv[3] = NULL;
+    remove("unit_tests_poly_batch/a.out");
+    assert_int_equal(calc_poly_main(3, argv), 0);
+    assert_file_equal("unit_tests_poly_batch/a.out", "(1,4)\n");
+
+    const char *files[] = {"a", "b", "list"};
+    char path[64];
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        sprintf(path, "unit_tests_poly_batch/%s", files[i]);
+        remove(path);
+        sprintf(path, "unit_tests_poly_batch/%s.out", files[i]);
+        remove(path);
+        sprintf(path, "unit_tests_poly_batch/%s.err", files[i]);
+        remove(path);
+    }
+    remove(directory);
+}
+
+static void BatchComposeThreadCountTest(void **state)
+{
+    (void)state;
+    const char *directory = "unit_tests_poly_batch_compose";
+
+    mkdir(directory, 0700);
+    write_file("unit_tests_poly_batch_compose/a",
+               "(1,0)+(1,1)\n(1,2)\nCOMPOSE 1 2\nCOMPOSE 1\nPRINT\n");
+    write_file("unit_tests_poly_batch_compose/b",
+               "(1,1)\n(1,3)\nCOMPOSE 1 4\nPRINT\n");
+
+    char *argv[] = {"calc_poly", "--threads", "2", "--batch", (char*)directory,
+                    "-j", "2", NULL};
+    assert_int_equal(calc_poly_main(7, argv), 0);
+    assert_string_equal(printf_buffer, "");
+    assert_string_equal(fprintf_buffer, "");
+    assert_file_equal("unit_tests_poly_batch_compose/a.out",
+                      "(1,0)+(2,1)+(1,2)\n");
+    assert_file_equal("unit_tests_poly_batch_compose/a.err",
+                      "ERROR 3 WRONG THREAD COUNT\n");
+    assert_file_equal("unit_tests_poly_batch_compose/b.out", "(1,3)\n");
+    assert_file_equal("unit_tests_poly_batch_compose/b.err",
+                      "ERROR 3 WRONG THREAD COUNT\n");
+
+    const char *files[] = {"a", "b"};
+    char path[64];
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        sprintf(path, "unit_tests_poly_batch_compose/%s", files[i]);
+        remove(path);
+        sprintf(path, "unit_tests_poly_batch_compose/%s.out", files[i]);
+        remove(path);
+        sprintf(path, "unit_tests_poly_batch_compose/%s.err", files[i]);
+        remove(path);
+    }
+    remove(directory);
+}
+
+static void PipelineArgTest(void **state)
+{
+    (void)state;
+
+    char *argv[] = {"calc_poly", "--pipeline", "--run", "unit_tests_poly.pcb",
+                    NULL};
+    init_input_stream("(1,1)\nPRINT");
+    assert_int_equal(calc_poly_main(4, argv), 1);
+    assert_string_equal(printf_buffer, "");
+    assert_string_equal(fprintf_buffer, "Usage: calc_poly [--threads N] "
+                        "[--lazy] [--memo MB] [--input FILE] "
+                        "[--pipeline | --compile FILE | --run FILE | "
+                        "--chain DIR | --batch DIR|LIST [-j N]]\n");
+
+    argv[2] = "--input";
+    argv[3] = "missing_unit_tests_poly_input.txt";
+    count_test_setup(state);
+    assert_int_equal(calc_poly_main(4, argv), 1);
+    assert_string_equal(printf_buffer, "");
+    assert_string_equal(fprintf_buffer,
+                        "Cannot read missing_unit_tests_poly_input.txt\n");
+}
+
+static void LazyArgTest(void **state)
+{
+    (void)state;
+
+    const char *script = "((1,1)+(2,0),1)+(3,0)\nCLONE\nCLONE\nMUL\nADD\n"
+                         "CLONE\nDEG\nCLONE\nAT 2\nIS_ZERO\nCLONE\nNEG\nSUB\n"
+                         "IS_COEFF\nAT -1\nCLONE\nPRINT\n(1,2)\nDIV\nPRINT\n"
+                         "(2,1)\nIS_EQ\nCOMPOSE 1\nPRINT\nPOP\nPOP\nPOP\nPOP\n"
+                         "POP\n";
+    char *argv[] = {"calc_poly", "--lazy", NULL};
+    init_input_stream(script);
+    assert_int_equal(calc_poly_main(1, argv), 0);
+    char expected[256];
+    strcpy(expected, printf_buffer);
+    assert_string_equal(fprintf_buffer, "ERROR 29 STACK UNDERFLOW\n");
+
+    count_test_setup(state);
+    init_input_stream(script);
+    assert_int_equal(calc_poly_main(2, argv), 0);
+    assert_string_equal(printf_buffer, expected);
+    assert_string_equal(fprintf_buffer, "ERROR 29 STACK UNDERFLOW\n");
+
+    char *compile_argv[] = {"calc_poly", "--lazy", "--compile",
+                            "unit_tests_poly.pcb", NULL};
+    count_test_setup(state);
+    assert_int_equal(calc_poly_main(4, compile_argv), 1);
+    assert_string_equal(printf_buffer, "");
+    assert_string_equal(fprintf_buffer, "Usage: calc_poly [--threads N] "
+                        "[--lazy] [--memo MB] [--input FILE] "
+                        "[--pipeline | --compile FILE | --run FILE | "
+                        "--chain DIR | --batch DIR|LIST [-j N]]\n");
+}
+
+static void MemoArgTest(void **state)
+{
+    (void)state;
+
+    char *argv[] = {"calc_poly", "--memo", "1", NULL};
+    init_input_stream("((1,1)+(1,0),1)\nCLONE\nCLONE\nMUL\nPRINT\nPOP\n"
+                      "CLONE\nCLONE\nMUL\nAT 2\nPRINT\nPOP\nCLONE\nAT 2\n"
+                      "PRINT");
+    assert_int_equal(calc_poly_main(3, argv), 0);
+    assert_string_equal(printf_buffer, "((1,0)+(2,1)+(1,2),2)\n"
+                        "(4,0)+(8,1)+(4,2)\n(2,0)+(2,1)\n");
+    assert_string_equal(fprintf_buffer, "Memo: 1 hits, 3 misses "
+                        "(25.0% hit rate), 0 evictions\n");
+
+    argv[2] = "0";
+    count_test_setup(state);
+    assert_int_equal(calc_poly_main(3, argv), 1);
+    assert_string_equal(printf_buffer, "");
+    assert_string_equal(fprintf_buffer, "Usage: calc_poly [--threads N] "
+                        "[--lazy] [--memo MB] [--input FILE] "
+                        "[--pipeline | --compile FILE | --run FILE | "
+                        "--chain DIR | --batch DIR|LIST [-j N]]\n");
+}
+
+static void SingleThreadArgTest(void **state)
+{
+    (void)state;
+
+    char *argv[] = {"calc_poly", "--threads", "1", NULL};
+    init_input_stream("(1,1)\nCLONE\nMUL\nPRINT");
+    assert_int_equal(calc_poly_main(3, argv), 0);
+    assert_string_equal(printf_buffer, "(1,2)\n");
+    assert_string_equal(fprintf_buffer, "");
+}
+
+
+int main(void)
+{
+    srand(time(NULL));
+    const struct CMUnitTest poly_compose_tests[] = {
+        cmocka_unit_test_setup_teardown(ZeroPolyNullComposeTest, pc_test_setup, pc_test_teardown),
+        cmocka_unit_test_setup_teardown(ZeroPolyCoeffComposeTest, pc_test_setup, pc_test_teardown),
+        cmocka_unit_test_setup_teardown(CoeffPolyNullComposeTest, pc_test_setup, pc_test_teardown),
+        cmocka_unit_test_setup_teardown(CoeffPolyCoeffComposeTest, pc_test_setup, pc_test_teardown),
+        cmocka_unit_test_setup_teardown(LinearPolyNullComposeTest, pc_test_setup, pc_test_teardown),
+        cmocka_unit_test_setup_teardown(LinearPolyCoeffComposeTest, pc_test_setup, pc_test_teardown),
+        cmocka_unit_test_setup_teardown(LinearPolyLinearComposeTest, pc_test_setup, pc_test_teardown),
+    };
+    const struct CMUnitTest count_calc_tests[] = {
+        cmocka_unit_test_setup_teardown(NullCountArgTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(ZeroCountArgTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(UINT_MAXCountArgTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(NegativeCountArgTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(UINT_MAXPlusOneCountArgTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(VeryBigCountArgTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(RandomLettersCountArgTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(RandomLettersAndNumbersCountArgTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(ThreadCountComposeArgTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(WrongThreadCountComposeArgTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(NonNumericThreadCountComposeArgTest, count_test_setup, release_cache_teardown),
+    };
+    const struct CMUnitTest poly_div_tests[] = {
+        cmocka_unit_test_teardown(ExactUnivariateDivRemTest, release_cache_teardown),
+        cmocka_unit_test_teardown(PseudoDivRemTest, release_cache_teardown),
+        cmocka_unit_test_teardown(MultivariateDivExactTest, release_cache_teardown),
+        cmocka_unit_test_teardown(DenseNewtonDivRemTest, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(DivisionByZeroTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(DivRemCommandTest, count_test_setup, release_cache_teardown),
+    };
+    const struct CMUnitTest poly_gcd_tests[] = {
+        cmocka_unit_test_teardown(UnivariateGcdTest, release_cache_teardown),
+        cmocka_unit_test_teardown(ZeroAndCoeffGcdTest, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(PlantedFactorGcdCommandTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(LargeCoeffGcdCommandTest, count_test_setup, release_cache_teardown),
+    };
+    const struct CMUnitTest poly_parallel_tests[] = {
+        cmocka_unit_test_teardown(ParallelMulTest, release_cache_teardown),
+        cmocka_unit_test_teardown(ParallelAddTest, release_cache_teardown),
+        cmocka_unit_test_teardown(ParallelComposeTest, release_cache_teardown),
+        cmocka_unit_test_teardown(ParallelSparseComposeTest, release_cache_teardown),
+        cmocka_unit_test_teardown(ParallelAddMonosTest, release_cache_teardown),
+        cmocka_unit_test_teardown(MonoCacheThreadsTest, release_cache_teardown),
+    };
+    const struct CMUnitTest poly_async_tests[] = {
+        cmocka_unit_test_teardown(AsyncMulTest, release_cache_teardown),
+        cmocka_unit_test_teardown(AsyncComposeCancelTest, release_cache_teardown),
+        cmocka_unit_test_teardown(AsyncThreadsPollCancelTest, release_cache_teardown),
+    };
+    const struct CMUnitTest program_args_tests[] = {
+        cmocka_unit_test_setup_teardown(InvalidThreadCountArgTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(MissingThreadCountArgTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(SingleThreadArgTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(MissingInputFileArgTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(InputFileArgTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(CompileAndRunArgTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(CorruptBytecodeArgTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(ChainArgTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(BatchArgTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(BatchComposeThreadCountTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(PipelineArgTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(LazyArgTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(MemoArgTest, count_test_setup, release_cache_teardown),
+    };
+    const struct CMUnitTest poly_meta_tests[] = {
+        cmocka_unit_test_teardown(DegCacheAfterCancellationTest, release_cache_teardown),
+        cmocka_unit_test_teardown(DegCacheZeroAndCoeffTest, release_cache_teardown),
+        cmocka_unit_test_teardown(HashOfEqualPolysTest, release_cache_teardown),
+        cmocka_unit_test_teardown(SharedPolyRefTest, release_cache_teardown),
+        cmocka_unit_test_teardown(ChunkQueueTest, release_cache_teardown),
+        cmocka_unit_test_teardown(MemoCacheTest, release_cache_teardown),
+        cmocka_unit_test_teardown(SerializeRoundTripTest, release_cache_teardown),
+        cmocka_unit_test_teardown(AddMonosOrderTest, release_cache_teardown),
+        cmocka_unit_test_teardown(AddMonosCancellationTest, release_cache_teardown),
+        cmocka_unit_test_teardown(MulConstantTermOverflowTest, release_cache_teardown),
+        cmocka_unit_test_teardown(PowMatchesRepeatedMulTest, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(ZeroMonoDegTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(ErrorPositionAcrossBlocksTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(UnsortedAndNestedLiteralTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(DeeplyNestedLiteralTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(BufferedPrintTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(CommandDispatchTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(SaveLoadCommandTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(PowCommandTest, count_test_setup, release_cache_teardown),
+        cmocka_unit_test_setup_teardown(PowDegreeOverflowTest, count_test_setup, release_cache_teardown),
     };
 
     bool status = 0;
 
     status |= cmocka_run_group_tests(poly_compose_tests, NULL, NULL);
     status |= cmocka_run_group_tests(count_calc_tests, NULL, NULL);
+    status |= cmocka_run_group_tests(poly_meta_tests, NULL, NULL);
+    status |= cmocka_run_group_tests(poly_div_tests, NULL, NULL);
+    status |= cmocka_run_group_tests(poly_gcd_tests, NULL, NULL);
+    status |= cmocka_run_group_tests(poly_parallel_tests, NULL, NULL);
+    status |= cmocka_run_group_tests(poly_async_tests, NULL, NULL);
+    status |= cmocka_run_group_tests(program_args_tests, NULL, NULL);
 
     return status;
 }
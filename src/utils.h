@@ -65,6 +65,23 @@ extern int mock_scanf(const char *format, ...);
 #define getchar() mock_getchar()
 extern int mock_getchar();
 
+/* Redirect fread to a function in the test application so it's possible to
+ * test the standard input read in blocks. */
+#ifdef fread
+#undef fread
+#endif /* fread */
+#define fread(ptr, size, count, stream) mock_fread(ptr, size, count, stream)
+extern size_t mock_fread(void *ptr, size_t size, size_t count, FILE *stream);
+
+/* Redirect fwrite to a function in the test application so it's possible to
+ * test the standard output written in blocks. */
+#ifdef fwrite
+#undef fwrite
+#endif /* fwrite */
+#define fwrite(ptr, size, count, stream) mock_fwrite(ptr, size, count, stream)
+extern size_t mock_fwrite(const void *ptr, size_t size, size_t count,
+                          FILE *stream);
+
 /* Redirect ungetc to a function in the test application so it's possible to
  * test the standard input. */
 #ifdef ungetc
@@ -82,34 +99,35 @@ extern int mock_ungetc(int c, FILE *stream);
 void mock_assert(const int result, const char* expression, const char *file,
                  const int line);
 
-/* Redirect calloc, malloc, realloc and free to _test_malloc, _test_calloc,
- * _test_realloc and _test_free, respectively, so cmocka can check for memory
- * leaks. */
+/* Redirect calloc, malloc, realloc and free to mock_calloc, mock_malloc,
+ * mock_realloc and mock_free, respectively. They serialize calls to
+ * _test_calloc, _test_malloc, _test_realloc and _test_free, so cmocka can
+ * check for memory leaks also when pool worker threads allocate memory. */
 #ifdef calloc
 #undef calloc
 #endif /* calloc */
-#define calloc(num, size) _test_calloc(num, size, __FILE__, __LINE__)
+#define calloc(num, size) mock_calloc(num, size, __FILE__, __LINE__)
 #ifdef malloc
 #undef malloc
 #endif /* malloc */
-#define malloc(size) _test_malloc(size, __FILE__, __LINE__)
+#define malloc(size) mock_malloc(size, __FILE__, __LINE__)
 #ifdef realloc
 #undef realloc
 #endif /* realloc */
-#define realloc(ptr, size) _test_realloc(ptr, size, __FILE__, __LINE__)
+#define realloc(ptr, size) mock_realloc(ptr, size, __FILE__, __LINE__)
 #ifdef free
 #undef free
 #endif /* free */
-#define free(ptr) _test_free(ptr, __FILE__, __LINE__)
-void* _test_calloc(size_t number_of_elements, size_t size, const char* file, int line);
-void* _test_malloc(size_t size, char* const file, int line);
-void* _test_realloc(void* const ptr, size_t size, char* const file, int line);
-void _test_free(void* const ptr, char* const file, const int line);
+#define free(ptr) mock_free(ptr, __FILE__, __LINE__)
+void* mock_calloc(size_t number_of_elements, size_t size, const char* file, int line);
+void* mock_malloc(size_t size, char* const file, int line);
+void* mock_realloc(void* const ptr, size_t size, char* const file, int line);
+void mock_free(void* const ptr, char* const file, const int line);
 
 /* Function main is defined in the unit test so redefine name of the main
  * function here. */
 #define main(...) calc_poly_main(__VA_ARGS__)
-int calc_poly_main();
+int calc_poly_main(int argc, char **argv);
 
 /* All functions in this object need to be exposed to the test application,
  * so redefine static to nothing. Do not do it - it dangerous! */